@@ -0,0 +1,174 @@
+#pragma once
+
+#include "benchmark.hpp"
+#include "../controllers/bluetooth_controller.hpp"
+#include "../controllers/motion_arbiter.hpp"
+#include "../interfaces/motordriver_interfaces.hpp"
+
+/// <summary>
+/// @file arbiter_benchmark.hpp
+/// @brief Host benchmark of the HYBRID Control Mode's [MotionArbiter]: the cost of a decision, and the virtual
+/// time control takes to change hands between the autonomous and the Bluetooth controller.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details Set up as in main.cpp: the autonomous side is a stand-in commanding forward at [AUTONOMOUS_SPEED]
+/// on every step (as the line followers do), the manual side a [BluetoothController] fed single-letter
+/// commands on the mock serial port, both scheduled on every loop pass and the arbiter every
+/// [DualWheelDriveBase::RAMP_PERIOD_MS]. A session holds a button for a while, then lets go; another pins
+/// manual control with 'X', stays silent, and releases it with 'x'. Handoffs later than their bound (a loop
+/// pass to take over, the hold time plus an arbiter period to fall back) count as failures.
+
+namespace arbiter_benchmark {
+
+static const int AUTONOMOUS_SPEED = 150;
+
+static const unsigned long HOLD_MS = 1500;
+
+/// SoftwareSerial pins of the benchmark (A10/A11), clear of the ports other benchmarks keep open.
+static const uint8_t BLUETOOTH_RX_PIN = 64, BLUETOOTH_TX_PIN = 65;
+
+/// The two controllers of the HYBRID Control Mode, their channels and the arbiter.
+struct Hybrid {
+    FastL298NInterface driver;
+    FastL298NInterface *drivers[1];
+    NDualWheelDrive<FastL298NInterface, 1> drive;
+    MotionArbiter arbiter;
+    ArbitratedDrive autonomousDrive, manualDrive;
+    SoftwareSerialTransport transport;
+    BluetoothInterface bluetooth;
+    BluetoothController bluetoothController;
+    TaskScheduler scheduler;
+
+    Hybrid() : driver(2, 3, 4, 5, 6, 7), drivers{&driver}, drive(drivers), arbiter(&drive),
+        autonomousDrive(&arbiter, 0, 0), manualDrive(&arbiter, 1, HOLD_MS),
+        transport(BLUETOOTH_RX_PIN, BLUETOOTH_TX_PIN, 9600), bluetooth(&transport),
+        bluetoothController(&bluetooth, &manualDrive) {
+        drive.setRamp(1000, 2000);
+        bluetoothController.setArbiter(&arbiter, manualDrive.getChannel());
+        scheduler.every(0, autonomousTask, this);
+        scheduler.every(0, bluetoothTask, this);
+        scheduler.every(DualWheelDriveBase::RAMP_PERIOD_MS, arbiterTask, this);
+    }
+
+    static void autonomousTask(void *context) {
+        static_cast<Hybrid *>(context)->autonomousDrive.forward(AUTONOMOUS_SPEED);
+    }
+
+    static void bluetoothTask(void *context) {
+        static_cast<Hybrid *>(context)->bluetoothController.step();
+    }
+
+    static void arbiterTask(void *context) {
+        static_cast<Hybrid *>(context)->arbiter.update();
+    }
+
+    hal::native::SerialPort &port() {
+        return *hal::native::findSerial(BLUETOOTH_RX_PIN);
+    }
+};
+
+/// Virtual time in microseconds of the events of a session.
+struct Handoffs {
+    unsigned long long takeoverUs, wheelsTakenUs, lastManualUs, fallbackUs, wheelsBackUs;
+    unsigned long handoffsWhileManual;
+};
+
+/// @brief Runs a session with loop passes of [passUs]: 'R' every 50 ms from 0.5 s to 1 s (a held button),
+/// then silence; with [pinned], 'X' at 0.5 s instead and 'x' at 3 s.
+inline Handoffs runSession(unsigned long passUs, bool pinned) {
+    hal::native::resetGpio();
+    hal::native::resetClock();
+    Hybrid hybrid;
+    Handoffs result = {0, 0, 0, 0, 0, 0};
+    const unsigned long long startUs = 500000, endUs = pinned ? 3000000 : 1000000;
+    unsigned long handoffsAtTakeover = 0;
+    for (unsigned long long us = 0; us < 6000000; us += passUs) {
+        if (pinned && (us == startUs || us == endUs)) hybrid.port().inject(us == startUs ? "X" : "x");
+        if (!pinned && us >= startUs && us <= endUs && (us - startUs) % 50000 == 0) {
+            hybrid.port().inject("R");
+            result.lastManualUs = us;
+        }
+        hybrid.scheduler.tick();
+        // Events are timed at the end of the pass they happened in.
+        unsigned long long now = us + passUs;
+        bool manual = hybrid.arbiter.getActiveChannel() == hybrid.manualDrive.getChannel();
+        if (manual && result.takeoverUs == 0) {
+            result.takeoverUs = now - startUs;
+            handoffsAtTakeover = hybrid.arbiter.getHandoffs();
+        }
+        if (result.takeoverUs != 0 && result.wheelsTakenUs == 0 && hybrid.drive.getLeftSpeed() < AUTONOMOUS_SPEED) {
+            result.wheelsTakenUs = now - startUs;
+        }
+        if (result.takeoverUs != 0 && !manual && result.fallbackUs == 0) {
+            result.handoffsWhileManual = hybrid.arbiter.getHandoffs() - handoffsAtTakeover - 1;
+            result.fallbackUs = now;
+        }
+        if (result.fallbackUs != 0 && result.wheelsBackUs == 0 && hybrid.drive.getLeftSpeed() == AUTONOMOUS_SPEED
+            && hybrid.drive.getRightSpeed() == AUTONOMOUS_SPEED) {
+            result.wheelsBackUs = now;
+        }
+        hal::native::advanceMicros(passUs);
+    }
+    // The last manual intent is the controller's own stop, its command timeout after the last command.
+    if (!pinned) result.lastManualUs += BluetoothController::DEFAULT_COMMAND_TIMEOUT_MS * 1000;
+    else result.lastManualUs = endUs;
+    result.lastManualUs += passUs;
+    return result;
+}
+
+/// Average host time in nanoseconds of a decision with 2 channels, keeping or changing hands.
+inline double decisionCostNs(bool changing) {
+    hal::native::resetClock();
+    Hybrid hybrid;
+    hybrid.autonomousDrive.forward(AUTONOMOUS_SPEED);
+    hybrid.manualDrive.stop();
+    const long iterations = 1000000;
+    long long start = benchmark::nowNs();
+    for (long i = 0; i < iterations; i++) {
+        if (changing) hybrid.arbiter.setOverride((i & 1) ? hybrid.manualDrive.getChannel() : -1);
+        else hybrid.arbiter.decide();
+    }
+    long long elapsed = benchmark::nowNs() - start;
+    benchmark::doNotOptimize(hybrid.arbiter.getHandoffs());
+    return double(elapsed) / iterations;
+}
+
+/// @return [int] number of handoffs later than their bound.
+inline int run() {
+    bool consoleEnabled = hal::native::consoleEnabled();
+    hal::native::consoleEnabled() = false;
+    benchmark::section("HYBRID motion arbiter (host)");
+    benchmark::report("decision, same channel", decisionCostNs(false), "ns");
+    benchmark::report("decision, changing hands (override on/off)", decisionCostNs(true), "ns");
+
+    int failures = 0;
+    const unsigned long passes[] = {100, 1000, 4000};
+    for (unsigned int i = 0; i < sizeof(passes) / sizeof(passes[0]); i++) {
+        for (int pinned = 0; pinned < 2; pinned++) {
+            unsigned long passUs = passes[i];
+            Handoffs handoffs = runSession(passUs, pinned != 0);
+            std::printf("  %s, loop pass %lu us\n", pinned ? "manual override 'X' ... 'x'" : "button held 0.5 s", passUs);
+            char name[96];
+            benchmark::report("    manual takes over after the first byte", handoffs.takeoverUs / 1000.0, "ms");
+            benchmark::report("    wheels start to change", handoffs.wheelsTakenUs / 1000.0, "ms");
+            benchmark::report("    handoffs while manual", handoffs.handoffsWhileManual, "");
+            double fallbackMs = (double) (handoffs.fallbackUs - handoffs.lastManualUs) / 1000.0;
+            std::snprintf(name, sizeof(name), "    autonomy back after the last manual intent%s", pinned ? " ('x')" : "");
+            benchmark::report(name, fallbackMs, "ms");
+            benchmark::report("    wheels back at the autonomous speed", (handoffs.wheelsBackUs - handoffs.lastManualUs) / 1000.0, "ms");
+            double fallbackBoundMs = (pinned ? 0 : HOLD_MS) + DualWheelDriveBase::RAMP_PERIOD_MS + passUs / 1000.0;
+            bool late = handoffs.takeoverUs > passUs || handoffs.handoffsWhileManual != 0 || handoffs.fallbackUs == 0
+                || fallbackMs > fallbackBoundMs;
+            if (late) {
+                std::printf("    FAILED: takeover within %lu us and fallback within %.1f ms expected\n", passUs, fallbackBoundMs);
+                failures++;
+            }
+        }
+    }
+    hal::native::consoleEnabled() = consoleEnabled;
+    return failures;
+}
+
+}
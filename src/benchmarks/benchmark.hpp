@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+/// <summary>
+/// @file benchmark.hpp
+/// @brief Small helpers shared by the host (native) benchmarks.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+
+namespace benchmark {
+
+/// Keeps the optimiser from deleting work whose result is otherwise unused.
+template <typename T>
+inline void doNotOptimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// Nanoseconds on the host's steady clock.
+inline long long nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Prints the title line of a benchmark section.
+inline void section(const char *title) {
+    std::printf("\n== %s ==\n", title);
+}
+
+/// Prints one named result.
+inline void report(const char *name, double value, const char *unit) {
+    std::printf("  %-56s %12.2f %s\n", name, value, unit);
+}
+
+}
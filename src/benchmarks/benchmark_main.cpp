@@ -0,0 +1,45 @@
+/// <summary>
+/// @file benchmark_main.cpp
+/// @brief Entry point of the host (native) benchmarks. Build and run with `pio run -e native_benchmark -t exec`.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+
+#include "scheduler_benchmark.hpp"
+#include "gpio_benchmark.hpp"
+#include "pwm_benchmark.hpp"
+#include "status_benchmark.hpp"
+#include "protocol_benchmark.hpp"
+#include "serial_benchmark.hpp"
+#include "telemetry_benchmark.hpp"
+#include "arbiter_benchmark.hpp"
+#include "command_latency_benchmark.hpp"
+#include "deadman_benchmark.hpp"
+#include "line_follow_sim.hpp"
+#include "odometry_sim.hpp"
+#include "lifter_sim.hpp"
+#include "mission_sim.hpp"
+#include "calibration_sim.hpp"
+#include "session_sim.hpp"
+#include "fixed_point_benchmark.hpp"
+
+int main() {
+    scheduler_benchmark::run();
+    gpio_benchmark::run();
+    int failures = pwm_benchmark::run();
+    status_benchmark::run();
+    failures += protocol_benchmark::run();
+    serial_benchmark::run();
+    failures += telemetry_benchmark::run();
+    failures += arbiter_benchmark::run();
+    failures += command_latency_benchmark::run();
+    failures += deadman_benchmark::run();
+    failures += line_follow_sim::run();
+    failures += odometry_sim::run();
+    failures += lifter_sim::run();
+    failures += mission_sim::run();
+    failures += calibration_sim::run();
+    failures += session_sim::run();
+    failures += fixed_point_benchmark::run();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+#include "benchmark.hpp"
+#include "robot_model.hpp"
+#include "odometry_sim.hpp"
+#include "../controllers/bluetooth_controller.hpp"
+#include "../controllers/calibration_sweep.hpp"
+
+/// <summary>
+/// @file calibration_sim.hpp
+/// @brief Host simulation of the motor speed calibration: a sweep triggered over Bluetooth on a robot with
+/// mismatched sides, its curves kept in EEPROM across a reboot, and how straight the robot drives before and after.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details The [robot_model]'s right side is given a weaker motor with a wider dead band, so [forward] curves
+/// to the right. 'C' is sent over the mocked Bluetooth link, the [CalibrationSweep] runs in virtual time, and
+/// the robot is rebuilt (a reboot), loading the curves from the mock EEPROM. The heading and sideways drift of
+/// 3 s straight runs are reported before and after; the calibrated runs must drift less. The save must never
+/// make the loop wait for the EEPROM, and the curves must survive the reboot, a corrupted byte must leave the motors uncalibrated, and a drive command must abort a
+/// sweep without touching the stored curves. Without wheel encoders, 'C' must be refused. Every check that fails counts as a failure.
+
+namespace calibration_sim {
+
+/// SoftwareSerial pins of the simulation, clear of the ports other benchmarks keep open.
+static const uint8_t BLUETOOTH_RX_PIN = 48, BLUETOOTH_TX_PIN = 49;
+
+/// The weaker right side: full speed as a fraction of the left's, and dead band.
+static const double RIGHT_GAIN = 0.8;
+static const int RIGHT_DEAD_BAND = 55;
+
+/// Speeds of the straight runs, and their length.
+static const int SPEEDS[] = {80, 160, 255};
+static const unsigned long RUN_MS = 3000;
+
+/// The robot as setup() builds it for the BLUETOOTH Control Mode, with one motor driver and the model it moves.
+/// Building one is a boot: the curves are loaded from EEPROM.
+struct Robot {
+    SpeedCalibration calibration;
+    bool loaded;
+    FastL298NInterface driver;
+    FastL298NInterface *drivers[1];
+    NDualWheelDrive<FastL298NInterface, 1> drive;
+    WheelEncodersInterface encoders;
+    SoftwareSerialTransport transport;
+    BluetoothInterface bluetooth;
+    BluetoothController controller;
+    CalibrationSweep sweep;
+    robot_model::DriveModel model;
+    unsigned long ms;
+
+    Robot() : loaded(calibration.load()), driver(2, 3, 4, 5, 6, 7), drivers{&driver}, drive(drivers),
+        encoders(odometry_sim::LEFT_ENCODER_PIN, odometry_sim::RIGHT_ENCODER_PIN, odometry_sim::COUNTS_PER_REVOLUTION,
+            odometry_sim::WHEEL_DIAMETER_MM, odometry_sim::WHEEL_BASE_MM),
+        transport(BLUETOOTH_RX_PIN, BLUETOOTH_TX_PIN, 9600), bluetooth(&transport), controller(&bluetooth, &drive),
+        sweep(&drive, &encoders, &calibration, 1), model(drivePins(), driveParameters()), ms(0) {
+        driver.setCalibration(&calibration, 0);
+        drive.setRamp(1000, 2000);
+        drive.setEncoders(&encoders);
+        controller.setCalibrationSweep(&sweep);
+        model.setRightMotor(RIGHT_GAIN, RIGHT_DEAD_BAND);
+        model.attachEncoders(odometry_sim::LEFT_ENCODER_PIN, odometry_sim::RIGHT_ENCODER_PIN,
+            odometry_sim::PI * odometry_sim::WHEEL_DIAMETER_MM / 1000.0 / odometry_sim::COUNTS_PER_REVOLUTION);
+    }
+
+    static robot_model::DrivePins drivePins() {
+        robot_model::DrivePins pins = {2, 3, 4, 5, 6, 7};
+        return pins;
+    }
+
+    static robot_model::DriveParameters driveParameters() {
+        robot_model::DriveParameters parameters = robot_model::defaultDriveParameters();
+        parameters.maxSpeed = odometry_sim::REFERENCE.maxSpeed;
+        parameters.turnEfficiency = odometry_sim::REFERENCE.turnEfficiency;
+        return parameters;
+    }
+
+    hal::native::SerialPort &port() {
+        return *hal::native::findSerial(BLUETOOTH_RX_PIN);
+    }
+
+    /// @brief Runs the robot for one millisecond: a controller step, the drive updates and the model.
+    void step() {
+        controller.step();
+        if (ms % DualWheelDriveBase::RAMP_PERIOD_MS == 0) drive.update();
+        model.step(0.001);
+        hal::native::advanceMicros(1000);
+        ms++;
+    }
+
+    void run(unsigned long durationMs) {
+        for (unsigned long end = ms + durationMs; ms < end;) step();
+    }
+};
+
+/// Heading change in degrees and sideways drift in millimetres of a straight run.
+struct Drift {
+    double headingDeg, sidewaysMm;
+};
+
+/// @brief Drives [robot] forward at [speed] for [RUN_MS] from the origin, then stops it.
+inline Drift driveStraight(Robot &robot, int speed) {
+    robot.model.place(0, 0, 0);
+    robot.drive.forward(speed);
+    robot.run(RUN_MS);
+    robot.drive.stop();
+    robot.run(1000);
+    Drift drift = {robot.model.heading * 180 / odometry_sim::PI, robot.model.y * 1000};
+    return drift;
+}
+
+/// @brief Reports the straight runs of [robot], and keeps their largest heading change.
+inline double reportStraightRuns(Robot &robot, const char *name) {
+    double worst = 0;
+    for (unsigned int i = 0; i < sizeof(SPEEDS) / sizeof(SPEEDS[0]); i++) {
+        Drift drift = driveStraight(robot, SPEEDS[i]);
+        char label[96];
+        std::snprintf(label, sizeof(label), "%s, speed %d: heading after %lu ms", name, SPEEDS[i], RUN_MS);
+        benchmark::report(label, drift.headingDeg, "deg");
+        std::snprintf(label, sizeof(label), "%s, speed %d: sideways drift", name, SPEEDS[i]);
+        benchmark::report(label, drift.sidewaysMm, "mm");
+        if (std::fabs(drift.headingDeg) > worst) worst = std::fabs(drift.headingDeg);
+    }
+    return worst;
+}
+
+/// @return [int] number of failed checks of the sweep, the reboot and the straight runs.
+inline int checkCalibration() {
+    int failures = 0;
+    hal::native::resetGpio();
+    hal::native::resetClock();
+    hal::native::resetEeprom();
+    double uncalibrated;
+    {
+        Robot robot;
+        if (robot.loaded) {
+            std::printf("  FAILED: curves loaded from an erased EEPROM\n");
+            failures++;
+        }
+        uncalibrated = reportStraightRuns(robot, "uncalibrated");
+
+        robot.port().inject("C");
+        unsigned long startMs = robot.ms, writes = hal::native::eeprom().writes;
+        unsigned long long waitedUs = hal::native::eeprom().waitedMicros;
+        robot.run(1);
+        while (robot.sweep.isRunning() && robot.ms - startMs < 60000) robot.step();
+        benchmark::report("sweep and save, triggered by 'C'", (robot.ms - startMs) / 1000.0, "s");
+        benchmark::report("  EEPROM bytes written", hal::native::eeprom().writes - writes, "");
+        waitedUs = hal::native::eeprom().waitedMicros - waitedUs;
+        benchmark::report("  loop time spent waiting for the EEPROM", waitedUs / 1000.0, "ms");
+        if (waitedUs > 0) {
+            std::printf("  FAILED: saving the curves waited for the EEPROM\n");
+            failures++;
+        }
+        benchmark::report("  counts measured at speed 255, left side", robot.sweep.getCounts(16, false), "");
+        benchmark::report("  counts measured at speed 255, right side", robot.sweep.getCounts(16, true), "");
+        benchmark::report("  fitted duty of speed 255, left motor", robot.calibration.getCurve(0).apply(255), "");
+        benchmark::report("  fitted duty of speed 1, right motor", robot.calibration.getCurve(1).apply(1), "");
+        if (robot.sweep.getOutcome() != CalibrationSweep::Outcome::CALIBRATED
+            || robot.port().transmitted().find("calibrated") == std::string::npos) {
+            std::printf("  FAILED: the sweep did not calibrate the motors, or did not say so\n");
+            failures++;
+        }
+    }
+    {
+        Robot rebooted;
+        if (!rebooted.loaded || rebooted.calibration.getNumberOfCurves() != 2) {
+            std::printf("  FAILED: the curves were not loaded after a reboot\n");
+            failures++;
+        }
+        double calibrated = reportStraightRuns(rebooted, "calibrated");
+        if (calibrated > uncalibrated / 4) {
+            std::printf("  FAILED: calibrated runs turn %.2f deg, uncalibrated %.2f deg\n", calibrated, uncalibrated);
+            failures++;
+        }
+
+        // A drive command takes the wheels back at once, and the curves stay as they were.
+        SpeedCurve before = rebooted.calibration.getCurve(1);
+        unsigned long writes = hal::native::eeprom().writes;
+        rebooted.port().inject("C");
+        rebooted.run(2000);
+        rebooted.port().inject("S");
+        rebooted.run(1);
+        bool stopped = !rebooted.sweep.isRunning();
+        // The reply goes out a byte per step on SoftwareSerial.
+        rebooted.run(50);
+        bool aborted = stopped && rebooted.sweep.getOutcome() == CalibrationSweep::Outcome::ABORTED
+            && rebooted.port().transmitted().find("calibration aborted") != std::string::npos
+            && rebooted.calibration.isEnabled() && std::memcmp(before.knots, rebooted.calibration.getCurve(1).knots,
+            sizeof(before.knots)) == 0 && hal::native::eeprom().writes == writes;
+        if (!aborted) {
+            std::printf("  FAILED: 'S' did not abort the sweep cleanly\n");
+            failures++;
+        }
+    }
+    // A flipped bit in a stored knot fails the CRC: the motors are left uncalibrated.
+    hal::native::eeprom().bytes[SpeedCalibration::EEPROM_ADDRESS + 2 + 20] ^= 0x04;
+    {
+        Robot corrupted;
+        benchmark::report("curves loaded after a bit flip in EEPROM", corrupted.calibration.getNumberOfCurves(), "");
+        if (corrupted.loaded || corrupted.calibration.apply(1, 100) != 100) {
+            std::printf("  FAILED: corrupted curves were applied\n");
+            failures++;
+        }
+    }
+    return failures;
+}
+
+/// @return [int] 1 if a sweep without wheel encoders, as setup() builds it when they are not fitted, moved the
+/// Robot, wrote to EEPROM or did not say it was not started.
+inline int checkWithoutEncoders() {
+    hal::native::resetGpio();
+    hal::native::resetClock();
+    Robot robot;
+    CalibrationSweep blind(&robot.drive, NULL, &robot.calibration, 1);
+    robot.controller.setCalibrationSweep(&blind);
+    unsigned long writes = hal::native::eeprom().writes;
+    robot.port().transmitted().clear();
+    robot.port().inject("C");
+    robot.run(500);
+    bool refused = !blind.isRunning() && robot.drive.getLeftSpeed() == 0 && robot.drive.getRightSpeed() == 0
+        && hal::native::eeprom().writes == writes
+        && robot.port().transmitted().find("calibration not started") != std::string::npos;
+    if (refused) return 0;
+    std::printf("  FAILED: a sweep without wheel encoders was started\n");
+    return 1;
+}
+
+/// @brief Reports the host time of a [SpeedCalibration::apply] over every speed.
+inline void reportApplyCost() {
+    SpeedCalibration calibration;
+    calibration.setNumberOfCurves(2);
+    const int repeats = 4000;
+    long long start = benchmark::nowNs();
+    int sum = 0;
+    for (int r = 0; r < repeats; r++) {
+        for (int speed = 0; speed < 256; speed++) {
+            sum += calibration.apply(speed & 1, speed);
+            benchmark::doNotOptimize(sum);
+        }
+    }
+    benchmark::report("SpeedCalibration::apply, host time per call", double(benchmark::nowNs() - start) / (repeats * 256), "ns");
+}
+
+/// @return [int] number of failed checks.
+inline int run() {
+    bool consoleEnabled = hal::native::consoleEnabled();
+    hal::native::consoleEnabled() = false;
+    benchmark::section("Motor speed calibration (virtual time, mismatched sides)");
+    int failures = checkCalibration();
+    failures += checkWithoutEncoders();
+    reportApplyCost();
+    hal::native::resetGpio();
+    hal::native::resetEeprom();
+    hal::native::consoleEnabled() = consoleEnabled;
+    return failures;
+}
+
+}
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include "benchmark.hpp"
+#include "gpio_benchmark.hpp"
+#include "../controllers/bluetooth_controller.hpp"
+#include "../interfaces/motordriver_interfaces.hpp"
+#include "../utils/telemetry.hpp"
+
+/// <summary>
+/// @file command_latency_benchmark.hpp
+/// @brief Host benchmark of the end-to-end command latency of the BLUETOOTH Control Mode: the virtual time from
+/// the first byte of a command arriving on the Bluetooth link to the motor driver pins showing its wheel speeds.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details The robot is set up as in main.cpp (two [FastL298NInterface]s, [BluetoothController] scheduled on
+/// every loop pass of [LOOP_PASS_US], the drive updated every [DualWheelDriveBase::RAMP_PERIOD_MS]), but without
+/// ramping, so a command's speeds reach the pins as soon as it is executed. A stream of drive commands, each
+/// with other wheel speeds than the last, is injected into the mock serial port byte by byte at the time each
+/// byte has arrived at the baud rate, the commands [commandPeriodUs] apart with a fixed pseudo-random phase to
+/// the loop. A [hal::native::outputObserver] takes the latency of the oldest command waiting for its speeds when
+/// the wheels all show them. Serial writes move the virtual clock by the time they would wait on the robot
+/// ([hal::native::waitsTakeTime]), so debug output delays the loop as it would on the Mega.
+///
+/// A command whose speeds never show counts as a failure. Bytes arriving in a step that sends on SoftwareSerial
+/// are also counted: its sending holds interrupts off, so on the robot they would likely be garbled.
+
+namespace command_latency_benchmark {
+
+/// Virtual time of a loop pass without waits, as in main.cpp's host main().
+static const unsigned long LOOP_PASS_US = 100;
+
+static const unsigned long RUN_MS = 10000;
+
+/// SoftwareSerial pins of the benchmark (A12/A13), clear of the ports other benchmarks keep open.
+static const uint8_t SOFTWARE_RX_PIN = 66, SOFTWARE_TX_PIN = 67;
+
+/// Drive commands cycled through, each changing the wheel speeds of the last: as a letter, an opcode and a
+/// joystick position (throttle, turn) of [CommandOpcode::DRIVE_ARCADE], all giving the same full wheel speeds.
+struct DriveCommand {
+    char letter;
+    uint8_t opcode;
+    int throttle, turn;
+    int left, right;
+};
+
+static const DriveCommand COMMANDS[] = {
+    {'F', CommandOpcode::DRIVE_FORWARD, 127, 0, 255, 255},
+    {'R', CommandOpcode::DRIVE_HARD_LEFT, 0, -127, -255, 255},
+    {'B', CommandOpcode::DRIVE_BACKWARD, -127, 0, -255, -255},
+    {'L', CommandOpcode::DRIVE_HARD_RIGHT, 0, 127, 255, -255},
+    {'I', CommandOpcode::DRIVE_SMOOTH_LEFT, 127, -127, 0, 255},
+    {'G', CommandOpcode::DRIVE_SMOOTH_RIGHT, 127, 127, 255, 0}
+};
+
+static const int NUMBER_OF_COMMANDS = sizeof(COMMANDS) / sizeof(COMMANDS[0]);
+
+/// Debug output of the controller.
+enum Debug {
+    NO_DEBUG,
+    SERIAL_DEBUG,
+    BLUETOOTH_STATUS_TEXT,
+    TELEMETRY
+};
+
+/// How the commands are sent: the original app's single letters, or one per frame.
+enum Encoding {
+    LETTERS,
+    FRAMES,
+    ARCADE_FRAMES
+};
+
+struct Scenario {
+    const char *name;
+    bool software;
+    long baud;
+    Encoding encoding;
+    unsigned long commandPeriodUs;
+    Debug debug;
+};
+
+/// One byte of the stream, when it has arrived, and whether it is the first of a command.
+struct StreamByte {
+    unsigned long long arrivalUs;
+    uint8_t byte;
+    bool first;
+};
+
+/// One command of the stream: when its first byte arrived, and the wheel speeds it asks for.
+struct Pending {
+    unsigned long long arrivalUs;
+    int left, right;
+};
+
+/// Commands waiting for their speeds to show, and the latencies of those that did.
+struct Trace {
+    std::deque<Pending> pending;
+    std::vector<unsigned long long> latenciesUs;
+};
+
+inline Trace &trace() {
+    static Trace instance;
+    return instance;
+}
+
+/// [hal::native::outputObserver] taking the latency of the oldest pending command once every wheel shows it.
+inline void observeWheels() {
+    Trace &current = trace();
+    if (current.pending.empty()) return;
+    const Pending &oldest = current.pending.front();
+    for (int i = 0; i < gpio_benchmark::NUMBER_OF_WHEELS; i++) {
+        // Wheels 0 and 2 are on the left, 1 and 3 on the right.
+        int wanted = i % 2 == 0 ? oldest.left : oldest.right;
+        if (gpio_benchmark::wheelState(gpio_benchmark::WHEELS[i]) != wanted) return;
+    }
+    current.latenciesUs.push_back(hal::native::nowMicros() - oldest.arrivalUs);
+    current.pending.pop_front();
+}
+
+/// The robot of main.cpp's BLUETOOTH Control Mode, without ramping.
+struct Robot {
+    FastL298NInterface front, back;
+    FastL298NInterface *drivers[2];
+    NDualWheelDrive<FastL298NInterface, 2> drive;
+    SoftwareSerialTransport softwareTransport;
+    HardwareSerialTransport hardwareTransport;
+    BluetoothInterface bluetooth;
+    BluetoothController controller;
+    Telemetry telemetry;
+    TaskScheduler scheduler;
+    Debug debug;
+
+    Robot(const Scenario &scenario) : front(2, 3, 4, 5, 6, 7), back(14, 15, 16, 17, 18, 19),
+        drivers{&front, &back}, drive(drivers),
+        softwareTransport(SOFTWARE_RX_PIN, SOFTWARE_TX_PIN, scenario.baud),
+        hardwareTransport(hal::serial2(), scenario.baud),
+        bluetooth(scenario.software ? (SerialTransport *) &softwareTransport : &hardwareTransport),
+        controller(&bluetooth, &drive), telemetry(&bluetooth, 50), debug(scenario.debug) {
+        if (debug == TELEMETRY) controller.setTelemetry(&telemetry);
+        scheduler.every(0, bluetoothTask, this);
+        scheduler.every(DualWheelDriveBase::RAMP_PERIOD_MS, rampTask, this);
+    }
+
+    static void bluetoothTask(void *context) {
+        Robot *robot = static_cast<Robot *>(context);
+        robot->controller.step(robot->debug == SERIAL_DEBUG, robot->debug == BLUETOOTH_STATUS_TEXT);
+    }
+
+    static void rampTask(void *context) {
+        static_cast<Robot *>(context)->drive.update();
+    }
+};
+
+/// Latency distribution of a scenario, in microseconds.
+struct Result {
+    unsigned long commands, responses;
+    unsigned long long p50, p90, p99, maximum;
+    double mean;
+    unsigned long bytesWhileSending;
+};
+
+/// @return [unsigned long long] the latency [percent] % of the commands did not exceed.
+inline unsigned long long percentile(const std::vector<unsigned long long> &sorted, int percent) {
+    if (sorted.empty()) return 0;
+    size_t index = (sorted.size() * percent + 99) / 100;
+    return sorted[index == 0 ? 0 : index - 1];
+}
+
+inline Result run(const Scenario &scenario) {
+    hal::native::resetGpio();
+    hal::native::resetClock();
+    hal::native::waitsTakeTime() = true;
+    hal::console().begin(scenario.debug == SERIAL_DEBUG ? 9600 : 0);
+    Robot robot(scenario);
+    hal::native::SerialPort *port = scenario.software ? hal::native::findSerial(SOFTWARE_RX_PIN) : &hal::serial2();
+    Trace &current = trace();
+    current.pending.clear();
+    current.latenciesUs.clear();
+    hal::native::outputObserver() = observeWheels;
+
+    // Bytes of the stream with their arrival times: the last bit of byte i of a command starting at t is in at
+    // t + (i + 1) byte times.
+    const unsigned long long byteUs = 10000000ULL / scenario.baud;
+    std::deque<StreamByte> stream;
+    uint32_t phase = 12345;
+    unsigned long commands = 0;
+    // The stream ends a second before the run, for the last commands to be acted on.
+    for (unsigned long long startUs = 0; startUs < (RUN_MS - 1000) * 1000ULL;
+         startUs += scenario.commandPeriodUs) {
+        phase = phase * 1103515245UL + 12345;
+        unsigned long long offsetUs = (phase >> 8) % 1000;
+        const DriveCommand &command = COMMANDS[commands % NUMBER_OF_COMMANDS];
+        uint8_t bytes[8];
+        size_t length = 1;
+        if (scenario.encoding == LETTERS) {
+            bytes[0] = (uint8_t) command.letter;
+        } else {
+            CommandFrameWriter writer(bytes, sizeof(bytes));
+            if (scenario.encoding == FRAMES) writer.add(command.opcode);
+            else writer.addAxes(CommandOpcode::DRIVE_ARCADE, command.throttle, command.turn);
+            length = writer.finish();
+        }
+        for (size_t i = 0; i < length; i++) {
+            StreamByte streamByte = {startUs + offsetUs + (i + 1) * byteUs, bytes[i], i == 0};
+            stream.push_back(streamByte);
+        }
+        commands++;
+    }
+
+    Result result = {commands, 0, 0, 0, 0, 0, 0, 0};
+    unsigned long sent = 0;
+    while (hal::native::nowMicros() < RUN_MS * 1000ULL) {
+        unsigned long long passStartUs = hal::native::nowMicros();
+        unsigned long long blockedBefore = port->blockedMicros();
+        while (!stream.empty() && stream.front().arrivalUs <= passStartUs) {
+            const StreamByte &streamByte = stream.front();
+            port->inject(&streamByte.byte, 1);
+            // The first byte of a command starts its latency.
+            if (streamByte.first) {
+                const DriveCommand &command = COMMANDS[sent++ % NUMBER_OF_COMMANDS];
+                Pending pending = {streamByte.arrivalUs, command.left, command.right};
+                current.pending.push_back(pending);
+            }
+            stream.pop_front();
+        }
+        robot.scheduler.tick();
+        if (scenario.software && port->blockedMicros() != blockedBefore) {
+            unsigned long long passEndUs = hal::native::nowMicros();
+            for (size_t i = 0; i < stream.size() && stream[i].arrivalUs < passEndUs; i++) result.bytesWhileSending++;
+        }
+        hal::native::advanceMicros(LOOP_PASS_US);
+    }
+    hal::native::outputObserver() = NULL;
+    hal::native::waitsTakeTime() = false;
+    hal::console().begin(0);
+
+    std::vector<unsigned long long> &latencies = current.latenciesUs;
+    std::sort(latencies.begin(), latencies.end());
+    result.responses = latencies.size();
+    result.p50 = percentile(latencies, 50);
+    result.p90 = percentile(latencies, 90);
+    result.p99 = percentile(latencies, 99);
+    result.maximum = latencies.empty() ? 0 : latencies.back();
+    unsigned long long total = 0;
+    for (size_t i = 0; i < latencies.size(); i++) total += latencies[i];
+    result.mean = latencies.empty() ? 0 : double(total) / latencies.size();
+    return result;
+}
+
+static const Scenario SCENARIOS[] = {
+    // Command rates: the app sends a held button again and again.
+    {"SoftwareSerial 9600, letters at 5 Hz", true, 9600, LETTERS, 200000, NO_DEBUG},
+    {"SoftwareSerial 9600, letters at 20 Hz", true, 9600, LETTERS, 50000, NO_DEBUG},
+    {"SoftwareSerial 9600, letters at 50 Hz", true, 9600, LETTERS, 20000, NO_DEBUG},
+    {"SoftwareSerial 9600, letters at 200 Hz", true, 9600, LETTERS, 5000, NO_DEBUG},
+    // Debug settings
+    {"  + serial debug (Serial at 9600)", true, 9600, LETTERS, 50000, SERIAL_DEBUG},
+    {"  + Bluetooth status text", true, 9600, LETTERS, 50000, BLUETOOTH_STATUS_TEXT},
+    {"  + telemetry at 20 Hz", true, 9600, LETTERS, 50000, TELEMETRY},
+    // Link and encoding
+    {"SoftwareSerial 9600, frames at 20 Hz", true, 9600, FRAMES, 50000, NO_DEBUG},
+    {"SoftwareSerial 9600, joystick frames at 50 Hz", true, 9600, ARCADE_FRAMES, 20000, NO_DEBUG},
+    {"SoftwareSerial 9600, joystick frames at 100 Hz", true, 9600, ARCADE_FRAMES, 10000, NO_DEBUG},
+    {"UART 115200, letters at 20 Hz", false, 115200, LETTERS, 50000, NO_DEBUG},
+    {"UART 115200, frames at 20 Hz", false, 115200, FRAMES, 50000, NO_DEBUG},
+    {"  + Bluetooth status text", false, 115200, FRAMES, 50000, BLUETOOTH_STATUS_TEXT},
+    {"  + telemetry at 20 Hz", false, 115200, FRAMES, 50000, TELEMETRY}
+};
+
+/// @return [int] number of scenarios in which a command's speeds never reached the pins.
+inline int run() {
+    bool consoleEnabled = hal::native::consoleEnabled();
+    hal::native::consoleEnabled() = false;
+    benchmark::section("End-to-end command latency: first byte on the link to motor pins (10 s each)");
+    std::printf("  %-46s %8s %8s %8s %8s %8s  %s\n", "latency in ms", "mean", "p50", "p90", "p99", "max", "commands acted on");
+    int failures = 0;
+    for (unsigned int i = 0; i < sizeof(SCENARIOS) / sizeof(SCENARIOS[0]); i++) {
+        Result result = run(SCENARIOS[i]);
+        std::printf("  %-46s %8.2f %8.2f %8.2f %8.2f %8.2f  %lu/%lu", SCENARIOS[i].name, result.mean / 1000,
+            result.p50 / 1000.0, result.p90 / 1000.0, result.p99 / 1000.0, result.maximum / 1000.0, result.responses,
+            result.commands);
+        if (result.bytesWhileSending > 0) std::printf(", %lu bytes in while sending", result.bytesWhileSending);
+        bool missed = result.responses != result.commands;
+        if (missed) failures++;
+        std::printf("%s\n", missed ? "  FAILED" : "");
+    }
+    hal::native::consoleEnabled() = consoleEnabled;
+    return failures;
+}
+
+}
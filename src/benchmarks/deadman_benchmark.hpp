@@ -0,0 +1,260 @@
+#pragma once
+
+#include "benchmark.hpp"
+#include "../controllers/bluetooth_controller.hpp"
+#include "../interfaces/motordriver_interfaces.hpp"
+
+/// <summary>
+/// @file deadman_benchmark.hpp
+/// @brief Host checks, in virtual time, of the [BluetoothController]'s deadman and of the hardware watchdog.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details The deadman must keep the Robot moving until the command timeout has passed since the last command,
+/// and stop it within a loop pass (and the millisecond of millis()) after. A held button, repeating its command
+/// faster than the timeout, must drive without a stop, and the former 40 ms stop is run beside it for
+/// comparison. The watchdog must round its timeout down to the AVR's steps, leave passes shorter than it alone
+/// and bite exactly when it runs out. The latency report asked for with 'P', and the text replies to commands
+/// sent with it, must reach the link whole, line by line, with no loop pass waiting on the 9600 baud
+/// SoftwareSerial for more than [MAX_REPLY_WAIT_US], the waits taking their time. Every check that fails counts as a failure.
+
+namespace deadman_benchmark {
+
+/// SoftwareSerial pins of the benchmark (A14/A15), clear of the ports other benchmarks keep open.
+static const uint8_t BLUETOOTH_RX_PIN = 68, BLUETOOTH_TX_PIN = 69;
+
+/// Interval at which the controller app repeats the command of a held button.
+static const unsigned long REPEAT_MS = 100;
+
+/// Longest a loop pass may wait on the link to send replies: a byte of the replies and one of the latency
+/// report, as a line of one ends, at 9600 baud.
+static const unsigned long long MAX_REPLY_WAIT_US = 2 * 10000000ULL / 9600;
+
+struct Robot {
+    FastL298NInterface driver;
+    FastL298NInterface *drivers[1];
+    NDualWheelDrive<FastL298NInterface, 1> drive;
+    SoftwareSerialTransport transport;
+    BluetoothInterface bluetooth;
+    BluetoothController controller;
+
+    Robot(unsigned long commandTimeoutMs) : driver(2, 3, 4, 5, 6, 7), drivers{&driver}, drive(drivers),
+        transport(BLUETOOTH_RX_PIN, BLUETOOTH_TX_PIN, 9600), bluetooth(&transport), controller(&bluetooth, &drive) {
+        controller.setCommandTimeout(commandTimeoutMs);
+    }
+
+    hal::native::SerialPort &port() {
+        return *hal::native::findSerial(BLUETOOTH_RX_PIN);
+    }
+
+    bool moving() {
+        return drive.getLeftSpeed() != 0 || drive.getRightSpeed() != 0;
+    }
+};
+
+/// Virtual time in microseconds from the step acting on a single 'F' to the step stopping the Robot, with loop
+/// passes of [passUs]. 0 if it never stopped.
+inline unsigned long long silenceBeforeStop(unsigned long commandTimeoutMs, unsigned long passUs) {
+    hal::native::resetGpio();
+    hal::native::resetClock();
+    Robot robot(commandTimeoutMs);
+    // A command arriving mid-millisecond, to take the resolution of millis() into account.
+    const unsigned long long commandUs = 10500;
+    unsigned long long startedUs = 0;
+    for (unsigned long long us = 0; us < 1000000; us += passUs) {
+        if (startedUs == 0 && us >= commandUs) robot.port().inject("F");
+        robot.controller.step();
+        if (startedUs == 0 && robot.moving()) startedUs = us;
+        if (startedUs != 0 && !robot.moving()) return us - startedUs;
+        hal::native::advanceMicros(passUs);
+    }
+    return 0;
+}
+
+/// Stops of a button held for 2 s (its command repeated every [REPEAT_MS]) while it was held, and the time in
+/// microseconds from its last repeat to the stop.
+struct HeldButton {
+    unsigned long stopsWhileHeld;
+    unsigned long long stopAfterReleaseUs;
+};
+
+inline HeldButton holdButton(unsigned long commandTimeoutMs) {
+    hal::native::resetGpio();
+    hal::native::resetClock();
+    Robot robot(commandTimeoutMs);
+    const unsigned long passUs = 100;
+    const unsigned long long holdUs = 2000000;
+    HeldButton result = {0, 0};
+    const unsigned long long finalRepeatUs = (holdUs - 1) / (REPEAT_MS * 1000) * (REPEAT_MS * 1000);
+    unsigned long long lastRepeatUs = 0;
+    bool moved = false;
+    for (unsigned long long us = 0; us < holdUs + 1000000; us += passUs) {
+        if (us < holdUs && us % (REPEAT_MS * 1000) == 0) {
+            robot.port().inject("F");
+            lastRepeatUs = us;
+        }
+        bool wasMoving = robot.moving();
+        robot.controller.step();
+        if (robot.moving()) moved = true;
+        if (moved && wasMoving && !robot.moving()) {
+            if (us < finalRepeatUs) result.stopsWhileHeld++;
+            else if (result.stopAfterReleaseUs == 0) result.stopAfterReleaseUs = us - lastRepeatUs;
+        }
+        hal::native::advanceMicros(passUs);
+    }
+    return result;
+}
+
+/// @return [int] number of failed deadman checks.
+inline int checkDeadman() {
+    int failures = 0;
+    const unsigned long timeouts[] = {40, BluetoothController::DEFAULT_COMMAND_TIMEOUT_MS};
+    const unsigned long passes[] = {100, 1000, 4000};
+    for (unsigned int i = 0; i < sizeof(timeouts) / sizeof(timeouts[0]); i++) {
+        for (unsigned int j = 0; j < sizeof(passes) / sizeof(passes[0]); j++) {
+            unsigned long long silenceUs = silenceBeforeStop(timeouts[i], passes[j]);
+            char name[96];
+            std::snprintf(name, sizeof(name), "timeout %lu ms, loop pass %lu us: stopped after", timeouts[i], passes[j]);
+            benchmark::report(name, silenceUs / 1000.0, "ms");
+            // Not before the timeout (less the millisecond millis() may already be into), at most a pass and
+            // that millisecond after it.
+            unsigned long long earliestUs = timeouts[i] * 1000ULL - 1000, latestUs = timeouts[i] * 1000ULL + 1000 + passes[j];
+            if (silenceUs < earliestUs || silenceUs > latestUs) {
+                std::printf("    FAILED: a stop between %.1f and %.1f ms expected\n", earliestUs / 1000.0, latestUs / 1000.0);
+                failures++;
+            }
+        }
+    }
+    for (unsigned int i = 0; i < sizeof(timeouts) / sizeof(timeouts[0]); i++) {
+        HeldButton held = holdButton(timeouts[i]);
+        char name[96];
+        std::snprintf(name, sizeof(name), "button held 2 s, repeats every %lu ms, timeout %lu ms: stops", REPEAT_MS, timeouts[i]);
+        benchmark::report(name, held.stopsWhileHeld, "");
+        std::snprintf(name, sizeof(name), "  stopped after the last repeat");
+        benchmark::report(name, held.stopAfterReleaseUs / 1000.0, "ms");
+        bool expectContinuous = timeouts[i] > REPEAT_MS;
+        if ((expectContinuous && held.stopsWhileHeld != 0) || held.stopAfterReleaseUs == 0) {
+            std::printf("    FAILED: %s\n", held.stopAfterReleaseUs == 0 ? "no stop after release" : "stopped while held");
+            failures++;
+        }
+    }
+    return failures;
+}
+
+static unsigned long watchdogResets;
+
+inline void countWatchdogReset() {
+    watchdogResets++;
+}
+
+/// @return [int] number of failed watchdog checks.
+inline int checkWatchdog() {
+    int failures = 0;
+    hal::native::Watchdog &dog = hal::native::watchdog();
+
+    // Timeouts rounded down to the AVR's steps.
+    const unsigned long asked[][2] = {{10, 15}, {250, 250}, {300, 250}, {1000, 1000}, {10000, 8000}};
+    for (unsigned int i = 0; i < sizeof(asked) / sizeof(asked[0]); i++) {
+        hal::watchdogEnable(asked[i][0]);
+        if (dog.timeoutMicros != asked[i][1] * 1000ULL) {
+            std::printf("  FAILED: watchdog of %lu ms runs out after %llu us, %lu ms expected\n", asked[i][0],
+                dog.timeoutMicros, asked[i][1]);
+            failures++;
+        }
+    }
+    hal::watchdogDisable();
+
+    // Passes shorter than the timeout, then a hang just short of it and one of it.
+    hal::native::resetClock();
+    hal::native::resetWatchdog();
+    watchdogResets = 0;
+    dog.handler = countWatchdogReset;
+    const unsigned long timeoutMs = 250;
+    hal::watchdogEnable(timeoutMs);
+    for (int pass = 0; pass < 1000; pass++) {
+        hal::watchdogReset();
+        hal::native::advanceMicros(1000);
+    }
+    hal::watchdogReset();
+    hal::native::advanceMicros(timeoutMs * 1000ULL - 1);
+    unsigned long bitesShortOfTimeout = dog.bites;
+    hal::watchdogReset();
+    unsigned long long hangUs = hal::native::nowMicros();
+    hal::delay(timeoutMs + 50);
+    bool bitOnTime = dog.bites == 1 && watchdogResets == 1 && dog.lastBiteMicros == hangUs + timeoutMs * 1000ULL
+        && hal::resetByWatchdog() && !hal::resetByWatchdog();
+    // Disabled, it never bites.
+    hal::watchdogEnable(timeoutMs);
+    hal::watchdogDisable();
+    hal::delay(10 * timeoutMs);
+    bool quietWhenDisabled = dog.bites == 1;
+
+    benchmark::report("watchdog 250 ms: resets, 1000 passes of 1 ms and a 249.999 ms one", bitesShortOfTimeout, "");
+    benchmark::report("watchdog 250 ms: a 300 ms hang bites after", (dog.lastBiteMicros - hangUs) / 1000.0, "ms");
+    if (bitesShortOfTimeout != 0 || !bitOnTime || !quietWhenDisabled) {
+        std::printf("  FAILED: the watchdog bit %s\n", bitesShortOfTimeout != 0 ? "too early" :
+            (!bitOnTime ? "late, or not once" : "while disabled"));
+        failures++;
+    }
+    dog.handler = NULL;
+    hal::native::resetWatchdog();
+    return failures;
+}
+
+/// @return [int] 1 if a 'P' followed by two commands replied to in text ('C' and 'Y', neither set up), under the
+/// 250 ms watchdog and the serial waits taking time, reset the Robot, held a loop pass longer than
+/// [MAX_REPLY_WAIT_US] on top of it, or did not send every line of the latency report and the replies whole.
+inline int checkLatencyReport() {
+    hal::native::resetGpio();
+    hal::native::resetClock();
+    hal::native::resetWatchdog();
+    bool waitsTakeTime = hal::native::waitsTakeTime();
+    hal::native::waitsTakeTime() = true;
+    watchdogResets = 0;
+    hal::native::Watchdog &dog = hal::native::watchdog();
+    dog.handler = countWatchdogReset;
+    Robot robot(BluetoothController::DEFAULT_COMMAND_TIMEOUT_MS);
+    robot.port().transmitted().clear();
+    hal::watchdogEnable(250);
+    robot.port().inject("PCY");
+    unsigned long long longestPassUs = 0;
+    for (int pass = 0; pass < 2000 && watchdogResets == 0; pass++) {
+        hal::watchdogReset();
+        unsigned long long startUs = hal::native::nowMicros();
+        robot.controller.step();
+        if (hal::native::nowMicros() - startUs > longestPassUs) longestPassUs = hal::native::nowMicros() - startUs;
+        hal::native::advanceMicros(100);
+    }
+    hal::watchdogDisable();
+    int lines = 0;
+    const std::string &sent = robot.port().transmitted();
+    for (size_t i = 0; i < sent.size(); i++) lines += sent[i] == '\n';
+    bool repliesWhole = sent.find("calibration not started\r\n") != std::string::npos
+        && sent.find("replay not started\r\n") != std::string::npos;
+    benchmark::report("latency report and replies at 9600 baud: longest step", longestPassUs / 1000.0, "ms");
+    benchmark::report("latency report and replies at 9600 baud: lines sent", lines, "");
+    dog.handler = NULL;
+    hal::native::resetWatchdog();
+    hal::native::waitsTakeTime() = waitsTakeTime;
+    if (watchdogResets == 0 && longestPassUs <= MAX_REPLY_WAIT_US && repliesWhole
+        && lines == LatencyStage::NUMBER_OF_LATENCY_STAGES + 2) return 0;
+    std::printf("  FAILED: %s\n", watchdogResets != 0 ? "the latency report reset the Robot through the watchdog"
+        : (longestPassUs > MAX_REPLY_WAIT_US ? "a loop pass waited on the link to send replies"
+        : "the latency report and replies were not sent whole"));
+    return 1;
+}
+
+/// @return [int] number of failed checks.
+inline int run() {
+    bool consoleEnabled = hal::native::consoleEnabled();
+    hal::native::consoleEnabled() = false;
+    benchmark::section("Deadman and watchdog (virtual time)");
+    int failures = checkDeadman();
+    failures += checkWatchdog();
+    failures += checkLatencyReport();
+    hal::native::consoleEnabled() = consoleEnabled;
+    return failures;
+}
+
+}
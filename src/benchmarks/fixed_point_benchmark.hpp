@@ -0,0 +1,250 @@
+#pragma once
+
+#include <cmath>
+#include <cstdlib>
+#include "benchmark.hpp"
+#include "../interfaces/2N_wheel_drive_interface.hpp"
+#include "../utils/fixed_point.hpp"
+
+/// <summary>
+/// @file fixed_point_benchmark.hpp
+/// @brief Accuracy checks of [Q8_8]/[Q16_16] and the cost of fixed point wheel-speed mixing versus soft-float.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details The accuracy section checks every operation against double precision: exact rounding of
+/// multiplication and division, saturation instead of wrap-around, the sin/cos table error over all angles,
+/// and PWM conversion. Any failed check is printed and counted in the return value of [run].
+///
+/// The mixing section drives [NDualWheelDriveInterface::steer] and a float version of the same mixing,
+/// checks they agree, and compares their cost. The AVR side is a cost model, as there is no Mega in the loop:
+/// each implementation's operations are counted and weighted with cycle estimates of avr-libc's soft-float
+/// routines and of the integer code avr-gcc generates for the fixed point operations.
+
+namespace fixed_point_benchmark {
+
+static const double CPU_HZ = 16000000.0;
+
+/// Estimated AVR cycles of avr-libc's soft-float routines.
+static const double FLOAT_ADD_CYCLES = 110;
+static const double FLOAT_MULTIPLY_CYCLES = 150;
+static const double FLOAT_DIVIDE_CYCLES = 470;
+static const double FLOAT_COMPARE_CYCLES = 35;
+static const double FLOAT_CONVERT_CYCLES = 70;
+
+/// Estimated AVR cycles of the [Q8_8] operations: saturating add, MUL-based multiply, 16 bit division plus
+/// shift and subtract, compare, and conversion from and to a PWM speed.
+static const double FIXED_ADD_CYCLES = 8;
+static const double FIXED_MULTIPLY_CYCLES = 28;
+static const double FIXED_DIVIDE_CYCLES = 320;
+static const double FIXED_COMPARE_CYCLES = 4;
+static const double FIXED_CONVERT_CYCLES = 30;
+
+/// Operations of one wheel-speed mix.
+struct OperationCount {
+    int adds;
+    int multiplies;
+    int divides;
+    int compares;
+    int converts;
+};
+
+/// Number of failed checks.
+inline int &failures() {
+    static int count = 0;
+    return count;
+}
+
+inline void check(bool passed, const char *what) {
+    if (passed) return;
+    if (failures() < 10) std::printf("  FAILED: %s\n", what);
+    failures()++;
+}
+
+/// Motor driver that only remembers the speeds of its last [drive] command.
+class RecordingDriver : public MotorDriverInterface {
+public:
+    int leftSpeed, rightSpeed;
+
+    RecordingDriver() : leftSpeed(0), rightSpeed(0) { status = StatusCode::READY; }
+
+    void leftMotorForward(int) override {}
+    void leftMotorBackward(int) override {}
+    void rightMotorForward(int) override {}
+    void rightMotorBackward(int) override {}
+    void leftMotorStop() override {}
+    void rightMotorStop() override {}
+
+    void drive(int leftSpeed, int rightSpeed) override {
+        this->leftSpeed = leftSpeed;
+        this->rightSpeed = rightSpeed;
+    }
+};
+
+/// [NDualWheelDriveInterface::steer] written with float, as it would be without the fixed point types.
+inline void floatSteer(int speed, int turnSpeed, int &leftSpeed, int &rightSpeed) {
+    float throttle = speed * (1 / 255.0f), turn = turnSpeed * (1 / 255.0f);
+    float left = throttle + turn, right = throttle - turn;
+    float fastest = std::fabs(left) > std::fabs(right) ? std::fabs(left) : std::fabs(right);
+    if (fastest > 1.0f) {
+        float scale = 1.0f / fastest;
+        left *= scale;
+        right *= scale;
+    }
+    leftSpeed = (int) std::lround(left * 255.0f);
+    rightSpeed = (int) std::lround(right * 255.0f);
+}
+
+/// Operations of [floatSteer] and of [NDualWheelDriveInterface::steer] when the mix saturates (the worst case).
+static const OperationCount FLOAT_STEER_OPERATIONS = {2, 6, 1, 2, 4};
+static const OperationCount FIXED_STEER_OPERATIONS = {2, 2, 1, 2, 4};
+
+inline double floatCycles(const OperationCount &count) {
+    return count.adds * FLOAT_ADD_CYCLES + count.multiplies * FLOAT_MULTIPLY_CYCLES
+        + count.divides * FLOAT_DIVIDE_CYCLES + count.compares * FLOAT_COMPARE_CYCLES
+        + count.converts * FLOAT_CONVERT_CYCLES;
+}
+
+inline double fixedCycles(const OperationCount &count) {
+    return count.adds * FIXED_ADD_CYCLES + count.multiplies * FIXED_MULTIPLY_CYCLES
+        + count.divides * FIXED_DIVIDE_CYCLES + count.compares * FIXED_COMPARE_CYCLES
+        + count.converts * FIXED_CONVERT_CYCLES;
+}
+
+/// @return [double] [value] rounded half away from zero and clamped to [low]-[high].
+inline double roundClamped(double value, double low, double high) {
+    value = std::floor(std::fabs(value) + 0.5) * (value < 0 ? -1 : 1);
+    return value < low ? low : (value > high ? high : value);
+}
+
+inline void checkQ8_8() {
+    for (long a = -32768; a < 32768; a += 37) {
+        for (long b = -32768; b < 32768; b += 41) {
+            Q8_8 x = Q8_8::fromRaw((int16_t) a), y = Q8_8::fromRaw((int16_t) b);
+            check((x + y).raw() == roundClamped(a + b, -32768, 32767), "Q8.8 saturating addition");
+            check((x - y).raw() == roundClamped(a - b, -32768, 32767), "Q8.8 saturating subtraction");
+            // Multiplication rounds halves up, i.e. towards +infinity.
+            check((x * y).raw() == roundClamped(std::floor(a * b / 256.0 + 0.5), -32768, 32767),
+                "Q8.8 multiplication");
+            if (b != 0) check((x / y).raw() == roundClamped(a * 256.0 / b, -32768, 32767), "Q8.8 division");
+        }
+    }
+    check(Q8_8::fromInt(1) / Q8_8() == Q8_8::max(), "Q8.8 division by zero");
+    check(-Q8_8::min() == Q8_8::max(), "Q8.8 negation of the most negative value");
+    check(Q8_8::fromInt(200) == Q8_8::max(), "Q8.8 integer conversion");
+    check(Q8_8::fromRatio(1, 3).raw() == 85, "Q8.8 ratio");
+    check(Q8_8::fromFloat(-2.5).toInt() == -3, "Q8.8 rounding to integer");
+}
+
+inline void checkQ16_16() {
+    std::srand(1);
+    for (int i = 0; i < 500000; i++) {
+        int32_t a = (int32_t) (((uint32_t) std::rand() << 1 ^ std::rand()) >> (std::rand() % 31));
+        int32_t b = (int32_t) (((uint32_t) std::rand() << 1 ^ std::rand()) >> (std::rand() % 31));
+        if (std::rand() & 1) a = -a;
+        if (std::rand() & 1) b = -b;
+        Q16_16 x = Q16_16::fromRaw(a), y = Q16_16::fromRaw(b);
+        const long double low = -2147483648.0L, high = 2147483647.0L;
+        long double product = std::round((long double) a * b / 65536);
+        check((x * y).raw() == (product < low ? low : (product > high ? high : product)), "Q16.16 multiplication");
+        if (b == 0) continue;
+        long double quotient = std::round((long double) a * 65536 / b);
+        check((x / y).raw() == (quotient < low ? low : (quotient > high ? high : quotient)), "Q16.16 division");
+    }
+    check(Q16_16::max() + Q16_16::fromInt(1) == Q16_16::max(), "Q16.16 saturating addition");
+    check(Q16_16::min() - Q16_16::fromInt(1) == Q16_16::min(), "Q16.16 saturating subtraction");
+    check(Q16_16::from(Q8_8::fromFloat(-1.5)) == Q16_16::fromFloat(-1.5), "Q8.8 to Q16.16 conversion");
+    check(Q8_8::from(Q16_16::fromInt(1000)) == Q8_8::max(), "Q16.16 to Q8.8 conversion");
+}
+
+/// @return [double] largest error of [fixedSin]/[fixedCos] over all angles.
+inline double sineError() {
+    double largest = 0;
+    for (long angle = 0; angle < 65536; angle++) {
+        double radians = angle * 2 * 3.14159265358979 / 65536;
+        double error = std::fabs(fixedSin((BinaryAngle) angle).toFloat() - std::sin(radians));
+        if (error > largest) largest = error;
+        error = std::fabs(fixedCos((BinaryAngle) angle).toFloat() - std::cos(radians));
+        if (error > largest) largest = error;
+    }
+    check(largest < 1e-4, "sin/cos error");
+    check(degreesToBinaryAngle(-90) == 49152, "degrees to binary angle");
+    return largest;
+}
+
+inline void checkPwm() {
+    for (int raw = -300; raw <= 300; raw++) {
+        check(Q8_8::fromRaw(raw).toPwm() == roundClamped(raw * 255 / 256.0, -255, 255), "Q8.8 to PWM");
+        check(Q8_8::fromPwm(raw).toPwm() == (raw < -255 ? -255 : (raw > 255 ? 255 : raw)), "PWM round trip");
+    }
+}
+
+/// @return [int] largest difference in PWM steps between [NDualWheelDriveInterface::steer] and [floatSteer].
+inline int steerError(NDualWheelDriveInterface &drive, RecordingDriver &driver) {
+    int largest = 0;
+    for (int speed = -255; speed <= 255; speed += 5) {
+        for (int turn = -255; turn <= 255; turn += 5) {
+            int leftSpeed, rightSpeed;
+            floatSteer(speed, turn, leftSpeed, rightSpeed);
+            drive.steer(Q8_8::fromPwm(speed), Q8_8::fromPwm(turn));
+            int error = std::abs(driver.leftSpeed - leftSpeed);
+            if (std::abs(driver.rightSpeed - rightSpeed) > error) error = std::abs(driver.rightSpeed - rightSpeed);
+            if (error > largest) largest = error;
+        }
+    }
+    check(largest <= 2, "fixed point mixing agrees with float");
+    return largest;
+}
+
+/// @return [double] host nanoseconds per mix of [NDualWheelDriveInterface::steer].
+inline double fixedSteerNs(NDualWheelDriveInterface &drive) {
+    const int iterations = 2000000;
+    long long start = benchmark::nowNs();
+    for (int i = 0; i < iterations; i++) drive.steer(Q8_8::fromPwm(i & 0xFF), Q8_8::fromPwm((i >> 8 & 0x1FF) - 255));
+    return double(benchmark::nowNs() - start) / iterations;
+}
+
+/// @return [double] host nanoseconds per mix of [floatSteer] followed by [NDualWheelDriveInterface::drive].
+inline double floatSteerNs(NDualWheelDriveInterface &drive) {
+    const int iterations = 2000000;
+    long long start = benchmark::nowNs();
+    for (int i = 0; i < iterations; i++) {
+        int leftSpeed, rightSpeed;
+        floatSteer(i & 0xFF, (i >> 8 & 0x1FF) - 255, leftSpeed, rightSpeed);
+        drive.drive(leftSpeed, rightSpeed);
+    }
+    return double(benchmark::nowNs() - start) / iterations;
+}
+
+/// @return [int] number of failed checks.
+inline int run() {
+    failures() = 0;
+    benchmark::section("Fixed point accuracy (host)");
+    checkQ8_8();
+    checkQ16_16();
+    checkPwm();
+    benchmark::report("Largest sin/cos error", sineError() * 1e6, "millionths");
+
+    RecordingDriver driver;
+    MotorDriverInterface *drivers[] = {&driver};
+    NDualWheelDriveInterface drive(1, drivers);
+    benchmark::report("Largest steer() difference from float mixing", steerError(drive, driver), "PWM steps");
+    benchmark::report("Failed checks", failures(), "");
+
+    benchmark::section("Wheel-speed mixing, float versus Q8.8 (AVR cost model)");
+    double floatMix = floatCycles(FLOAT_STEER_OPERATIONS), fixedMix = fixedCycles(FIXED_STEER_OPERATIONS);
+    benchmark::report("Soft-float mix", floatMix, "cycles");
+    benchmark::report("Soft-float mix", floatMix * 1e6 / CPU_HZ, "us");
+    benchmark::report("Q8.8 steer() mix", fixedMix, "cycles");
+    benchmark::report("Q8.8 steer() mix", fixedMix * 1e6 / CPU_HZ, "us");
+    benchmark::report("Speed-up", floatMix / fixedMix, "x");
+    benchmark::report("Soft-float multiply / Q8.8 multiply", FLOAT_MULTIPLY_CYCLES / FIXED_MULTIPLY_CYCLES, "x");
+
+    benchmark::section("Wheel-speed mixing, float versus Q8.8 (host, with an FPU)");
+    benchmark::report("float mix, then drive()", floatSteerNs(drive), "ns");
+    benchmark::report("Q8.8 steer()", fixedSteerNs(drive), "ns");
+    return failures();
+}
+
+}
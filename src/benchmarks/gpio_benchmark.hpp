@@ -0,0 +1,215 @@
+#pragma once
+
+#include "benchmark.hpp"
+#include "../interfaces/2N_wheel_drive_interface.hpp"
+
+/// <summary>
+/// @file gpio_benchmark.hpp
+/// @brief Simulated-AVR comparison of [L298NInterface] (digitalWrite) and [FastL298NInterface] (port registers),
+/// of the runtime [NDualWheelDriveInterface] and compile-time [NDualWheelDrive] drive topologies, and of the
+/// wheel skew of driving the motor drivers one after another and together.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details Both drivers run against the mock HAL's simulated Mega GPIO, wired to the robot's pins.
+/// For each drive command the benchmark reports the flash table reads, I/O register accesses and interrupt locks
+/// counted by the simulation, an AVR cycle estimate derived from them, and the host time per command.
+/// The topology section compares the RAM of the two drive classes and the virtual calls a speed change makes.
+/// The skew section traces every output change of the 4 wheels in modelled AVR cycles and reports the time
+/// between the first and the last wheel reaching its new state, and how long wheels of one side fight.
+
+namespace gpio_benchmark {
+
+/// Cycle weights of the counted operations on the ATmega2560: a flash table read (LPM with address setup),
+/// an I/O register access above 0x5F (LDS/STS) and an interrupt lock (SREG save, cli, SREG restore).
+static const int CYCLES_PER_FLASH_READ = 5;
+static const int CYCLES_PER_IO_ACCESS = 2;
+static const int CYCLES_PER_INTERRUPT_LOCK = 3;
+
+/// The sequence of drive commands a benchmark iteration performs.
+static const int COMMANDS_PER_ITERATION = 4;
+
+/// Cycles a virtual call costs on the ATmega2560 over an inlined one: loading the vtable pointer and the entry
+/// (4 LD/LDD), ICALL, RET and the argument registers the call forces to be saved.
+static const int CYCLES_PER_VIRTUAL_CALL = 21;
+
+template <typename Drive>
+inline void driveCommands(Drive &drive) {
+    drive.forward(200);
+    drive.hardLeft(200);
+    drive.backward(200);
+    drive.stop();
+}
+
+template <typename Drive>
+inline void reportDrive(const char *title, Drive &drive) {
+    benchmark::section(title);
+
+    // Warm up once, so a driver's one-off work (first speed write) is not counted as steady-state cost.
+    driveCommands(drive);
+    hal::native::resetCounters();
+    driveCommands(drive);
+    const hal::native::Counters counted = hal::native::counters();
+    double flashReads = double(counted.flashReads) / COMMANDS_PER_ITERATION;
+    double ioAccesses = double(counted.ioReads + counted.ioWrites) / COMMANDS_PER_ITERATION;
+    double locks = double(counted.interruptLocks) / COMMANDS_PER_ITERATION;
+    benchmark::report("flash table reads per drive command", flashReads, "");
+    benchmark::report("I/O register accesses per drive command", ioAccesses, "");
+    benchmark::report("interrupt locks per drive command", locks, "");
+    benchmark::report("est. AVR cycles per drive command (excl. calls)",
+        flashReads * CYCLES_PER_FLASH_READ + ioAccesses * CYCLES_PER_IO_ACCESS + locks * CYCLES_PER_INTERRUPT_LOCK,
+        "cycles");
+
+    const long iterations = 200000;
+    long long start = benchmark::nowNs();
+    for (long i = 0; i < iterations; i++) driveCommands(drive);
+    benchmark::report("host time per drive command", double(benchmark::nowNs() - start) / (iterations * COMMANDS_PER_ITERATION), "ns");
+}
+
+/// Pins of one wheel: its driver's direction pins and enable pin, as wired in main.cpp.
+struct WheelPins {
+    uint8_t forward, backward, enable;
+};
+
+static const int NUMBER_OF_WHEELS = 4;
+
+/// Front left, front right, back left, back right.
+static const WheelPins WHEELS[NUMBER_OF_WHEELS] = {{2, 3, 6}, {4, 5, 7}, {14, 15, 18}, {16, 17, 19}};
+
+/// Output changes of the wheels during one command, timed in modelled AVR cycles.
+struct SkewTrace {
+    int state[NUMBER_OF_WHEELS];
+    bool changed[NUMBER_OF_WHEELS];
+    double lastChange[NUMBER_OF_WHEELS];
+    double fightStart;
+    double fightCycles;
+};
+
+inline SkewTrace &skewTrace() {
+    static SkewTrace instance;
+    return instance;
+}
+
+/// @return [double] cycles the counted GPIO work so far would take on the Mega.
+inline double modelledCycles() {
+    const hal::native::Counters &counted = hal::native::counters();
+    return double(counted.flashReads) * CYCLES_PER_FLASH_READ + double(counted.ioReads + counted.ioWrites) * CYCLES_PER_IO_ACCESS
+        + double(counted.interruptLocks) * CYCLES_PER_INTERRUPT_LOCK;
+}
+
+/// @return [int] signed effective duty the wheel's motor is driven with.
+inline int wheelState(const WheelPins &wheel) {
+    bool forward = hal::native::outputLevel(wheel.forward), backward = hal::native::outputLevel(wheel.backward);
+    if (forward == backward) return 0;
+    return (forward ? 1 : -1) * hal::native::outputDuty(wheel.enable);
+}
+
+/// @return [bool] true if the front and back wheel of a side are driven in opposite directions.
+inline bool wheelsFight(const int state[]) {
+    return (long) state[0] * state[2] < 0 || (long) state[1] * state[3] < 0;
+}
+
+/// [hal::native::outputObserver] recording when each wheel changes and when wheels start and stop fighting.
+inline void traceWheels() {
+    SkewTrace &trace = skewTrace();
+    double now = modelledCycles();
+    bool fought = wheelsFight(trace.state);
+    for (int i = 0; i < NUMBER_OF_WHEELS; i++) {
+        int state = wheelState(WHEELS[i]);
+        if (state == trace.state[i]) continue;
+        trace.state[i] = state;
+        trace.changed[i] = true;
+        trace.lastChange[i] = now;
+    }
+    bool fights = wheelsFight(trace.state);
+    if (fights && !fought) trace.fightStart = now;
+    if (!fights && fought) trace.fightCycles += now - trace.fightStart;
+}
+
+/// @return [int] -1, 0 or 1 for the direction of [speed].
+inline int direction(int speed) {
+    return speed > 0 ? 1 : (speed < 0 ? -1 : 0);
+}
+
+/// @brief Runs a sequence of commands through [apply] (signed left and right speeds), starting from a stop, with
+/// the wheels traced, and reports the largest skew between the wheels and the time they fight. Skews of
+/// direction changes (port writes) and of speed-only changes (analogWrite() per enable pin) are reported apart.
+template <typename Apply>
+inline void reportSkew(const char *title, Apply apply) {
+    static const int COMMANDS[][2] = {{200, 200}, {160, 200}, {-200, -200}, {-200, 200}, {160, -200}, {0, 0}};
+    const int numberOfCommands = sizeof(COMMANDS) / sizeof(COMMANDS[0]);
+    benchmark::section(title);
+    SkewTrace &trace = skewTrace();
+    for (int i = 0; i < NUMBER_OF_WHEELS; i++) trace.state[i] = wheelState(WHEELS[i]);
+    trace.fightCycles = 0;
+    hal::native::outputObserver() = traceWheels;
+    double maxDirectionSkew = 0, maxSpeedSkew = 0, commandCycles = 0;
+    for (int c = 0; c < numberOfCommands; c++) {
+        bool directionChange = c == 0
+            || direction(COMMANDS[c][0]) != direction(COMMANDS[c - 1][0])
+            || direction(COMMANDS[c][1]) != direction(COMMANDS[c - 1][1]);
+        for (int i = 0; i < NUMBER_OF_WHEELS; i++) trace.changed[i] = false;
+        double start = modelledCycles();
+        apply(COMMANDS[c][0], COMMANDS[c][1]);
+        commandCycles += modelledCycles() - start;
+        double first = 0, last = 0;
+        bool any = false;
+        for (int i = 0; i < NUMBER_OF_WHEELS; i++) {
+            if (!trace.changed[i]) continue;
+            if (!any || trace.lastChange[i] < first) first = trace.lastChange[i];
+            if (!any || trace.lastChange[i] > last) last = trace.lastChange[i];
+            any = true;
+        }
+        double &maxSkew = directionChange ? maxDirectionSkew : maxSpeedSkew;
+        if (last - first > maxSkew) maxSkew = last - first;
+    }
+    hal::native::outputObserver() = NULL;
+    benchmark::report("max. skew between wheels, direction change (modelled)", maxDirectionSkew, "cycles");
+    benchmark::report("max. skew between wheels, speed change (modelled)", maxSpeedSkew, "cycles");
+    benchmark::report("max. skew between wheels at 16 MHz", (maxDirectionSkew > maxSpeedSkew ? maxDirectionSkew : maxSpeedSkew) / 16, "us");
+    benchmark::report("front and back wheels fighting, all commands", trace.fightCycles, "cycles");
+    benchmark::report("est. AVR cycles per command (excl. calls)", commandCycles / numberOfCommands, "cycles");
+}
+
+inline void run() {
+    L298NInterface front(2, 3, 4, 5, 6, 7), back(14, 15, 16, 17, 18, 19);
+    MotorDriverInterface *slowDrivers[] = {&front, &back};
+    NDualWheelDriveInterface slowDrive(2, slowDrivers);
+    reportDrive("4-wheel drive on L298NInterface (digitalWrite)", slowDrive);
+
+    FastL298NInterface fastFront(2, 3, 4, 5, 6, 7), fastBack(14, 15, 16, 17, 18, 19);
+    MotorDriverInterface *fastDrivers[] = {&fastFront, &fastBack};
+    NDualWheelDriveInterface fastDrive(2, fastDrivers);
+    reportDrive("4-wheel drive on FastL298NInterface (port registers)", fastDrive);
+
+    FastL298NInterface *templateDrivers[] = {&fastFront, &fastBack};
+    NDualWheelDrive<FastL298NInterface, 2> templateDrive(templateDrivers);
+    reportDrive("4-wheel drive on NDualWheelDrive<FastL298NInterface, 2>", templateDrive);
+
+    // RAM: the runtime class keeps a count and room for MAX_NUMBER_OF_MOTOR_DRIVERS pointers, the template
+    // exactly N pointers (2 bytes each on AVR). Virtual calls per speed change: the runtime class calls
+    // writeSpeeds, then drive and 2 primitive movements per driver through the vtable; the template only
+    // writeSpeeds, with the drivers' calls direct and inlined.
+    const int numberOfDrivers = 2;
+    benchmark::section("Drive topology: NDualWheelDriveInterface vs NDualWheelDrive<FastL298NInterface, 2>");
+    benchmark::report("host bytes, NDualWheelDriveInterface", sizeof(NDualWheelDriveInterface), "B");
+    benchmark::report("host bytes, NDualWheelDrive<FastL298NInterface, 2>", sizeof(templateDrive), "B");
+    benchmark::report("AVR bytes of driver list, runtime", 2 + 2 * DualWheelDriveBase::MAX_NUMBER_OF_MOTOR_DRIVERS, "B");
+    benchmark::report("AVR bytes of driver list, template", 2 * numberOfDrivers, "B");
+    benchmark::report("virtual calls per speed change, runtime", 1 + 3 * numberOfDrivers, "");
+    benchmark::report("virtual calls per speed change, template", 1, "");
+    benchmark::report("est. AVR cycles saved per speed change", 3 * numberOfDrivers * CYCLES_PER_VIRTUAL_CALL, "cycles");
+
+    templateDrive.stop();
+    reportSkew("Wheel skew: FastL298NInterface drivers written one after another", [&](int left, int right) {
+        fastFront.drive(left, right);
+        fastBack.drive(left, right);
+    });
+    templateDrive.stop();
+    reportSkew("Wheel skew: NDualWheelDrive, all drivers written together", [&](int left, int right) {
+        templateDrive.drive(left, right);
+    });
+}
+
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <cmath>
+#include "benchmark.hpp"
+#include "robot_model.hpp"
+#include "../interfaces/lifter_interface.hpp"
+
+/// <summary>
+/// @file lifter_sim.hpp
+/// @brief Host simulation of the lifter claw: timed moves against [LifterInterface::moveTo] with limit switches
+/// or a potentiometer, on a fresh and a drained battery, and stall detection.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details The claw is a [robot_model::LifterModel] on the claw driver's pins 8/9, with limit switches on
+/// pins 22/23 and a potentiometer on A0 when fitted. The arena missions' timed moves (down for 1020 ms, up for
+/// 3000 ms) are reported first: too short on a drained battery, pushing against the end of the travel on a
+/// fresh one. With feedback every move must end where it was sent, as soon as it gets there, and a jammed claw
+/// must have its power cut. Every check that fails counts as a failure.
+
+namespace lifter_sim {
+
+/// Pins of the claw's motor driver (the up and down inputs of its first motor) and of its feedback.
+static const uint8_t UP_PIN = 8, DOWN_PIN = 9;
+static const uint8_t LOWER_LIMIT_PIN = 22, UPPER_LIMIT_PIN = 23;
+static const uint8_t POTENTIOMETER_PIN = 54;
+
+/// Full travel of the claw on a fresh battery, and the motor speed left on a drained one.
+static const double UP_SECONDS = 2.2, DOWN_SECONDS = 0.8;
+static const double DRAINED_SUPPLY = 0.75;
+
+/// Times of the arena missions' timed claw moves.
+static const unsigned long TIMED_DOWN_MS = 1020, TIMED_UP_MS = 3000;
+
+inline robot_model::LifterPins pins() {
+    robot_model::LifterPins pins = {UP_PIN, DOWN_PIN, LOWER_LIMIT_PIN, UPPER_LIMIT_PIN, POTENTIOMETER_PIN};
+    return pins;
+}
+
+/// Feedback fitted to the claw.
+enum Feedback {
+    NONE,
+    LIMIT_SWITCHES,
+    POTENTIOMETER
+};
+
+/// The claw's driver and [LifterInterface] as setup() builds them, and the model they move.
+struct Claw {
+    L298NInterface driver;
+    LifterInterface lifter;
+    robot_model::LifterModel model;
+    unsigned long ms;
+
+    Claw(Feedback feedback, double supply) : driver(UP_PIN, DOWN_PIN, 10, 11), lifter(&driver),
+        model(pins(), UP_SECONDS, DOWN_SECONDS), ms(0) {
+        model.supply = supply;
+        if (feedback == Feedback::LIMIT_SWITCHES) lifter.setLimitSwitches(LOWER_LIMIT_PIN, UPPER_LIMIT_PIN);
+        if (feedback == Feedback::POTENTIOMETER) {
+            lifter.setPotentiometer(POTENTIOMETER_PIN, robot_model::LifterModel::POTENTIOMETER_DOWN,
+                robot_model::LifterModel::POTENTIOMETER_UP);
+        }
+    }
+
+    /// @brief Runs the claw for one millisecond: the [LifterInterface] update, then the model.
+    void step() {
+        if (ms % LifterInterface::UPDATE_PERIOD_MS == 0) lifter.update();
+        model.step(0.001);
+        hal::native::advanceMicros(1000);
+        ms++;
+    }
+
+    /// @return [unsigned long] milliseconds until the claw stopped, at most [maxMs].
+    unsigned long runWhileMoving(unsigned long maxMs) {
+        unsigned long start = ms;
+        while (lifter.isMoving() && ms - start < maxMs) step();
+        return ms - start;
+    }
+
+    /// @brief Drives the claw for [durationMs], then stops it: a timed move.
+    void runTimed(bool up, unsigned long durationMs) {
+        if (up) lifter.moveUp();
+        else lifter.moveDown();
+        for (unsigned long end = ms + durationMs; ms < end;) step();
+        lifter.stop();
+    }
+};
+
+inline void reset() {
+    hal::native::resetGpio();
+    hal::native::resetClock();
+}
+
+/// @brief Reports the arena missions' timed down and up moves on a battery giving [supply].
+inline void reportTimed(const char *battery, double supply) {
+    reset();
+    Claw claw(Feedback::NONE, supply);
+    claw.model.position = 1;
+    char label[96];
+    claw.runTimed(false, TIMED_DOWN_MS);
+    std::snprintf(label, sizeof(label), "timed, %s battery: claw after %lu ms down", battery, TIMED_DOWN_MS);
+    benchmark::report(label, claw.model.position * 1000, "/1000");
+    claw.runTimed(true, TIMED_UP_MS);
+    std::snprintf(label, sizeof(label), "timed, %s battery: claw after %lu ms up", battery, TIMED_UP_MS);
+    benchmark::report(label, claw.model.position * 1000, "/1000");
+    std::snprintf(label, sizeof(label), "timed, %s battery: motor driven against the ends", battery);
+    benchmark::report(label, claw.model.stalledSeconds * 1000, "ms");
+}
+
+/// @return [int] number of failed checks of a full down and up move with [feedback] on a battery giving [supply].
+inline int checkFullTravel(const char *name, Feedback feedback, double supply) {
+    int failures = 0;
+    reset();
+    Claw claw(feedback, supply);
+    claw.model.position = 1;
+    claw.model.writeFeedback();
+    char label[96];
+    const int targets[] = {LifterInterface::POSITION_DOWN, LifterInterface::POSITION_UP};
+    for (int i = 0; i < 2; i++) {
+        bool measured = claw.lifter.moveTo(targets[i]);
+        unsigned long ms = claw.runWhileMoving(10000);
+        std::snprintf(label, sizeof(label), "%s: moveTo(%d) done after", name, targets[i]);
+        benchmark::report(label, ms, "ms");
+        double error = std::fabs(claw.model.position * 1000 - targets[i]);
+        if (!measured || claw.lifter.getOutcome() != LifterInterface::Outcome::REACHED
+            || error > LifterInterface::POSITION_TOLERANCE + 5) {
+            std::printf("  FAILED: %s: moveTo(%d) ended at %.0f\n", name, targets[i], claw.model.position * 1000);
+            failures++;
+        }
+    }
+    std::snprintf(label, sizeof(label), "%s: motor driven against the ends", name);
+    benchmark::report(label, claw.model.stalledSeconds * 1000, "ms");
+    if (claw.model.stalledSeconds > 0.01) {
+        std::printf("  FAILED: %s: the motor was driven against an end\n", name);
+        failures++;
+    }
+    return failures;
+}
+
+/// @return [int] number of failed checks of moves to positions between the ends, with the potentiometer.
+inline int checkPositions() {
+    int failures = 0;
+    reset();
+    Claw claw(Feedback::POTENTIOMETER, DRAINED_SUPPLY);
+    const int targets[] = {500, 850, 200, 210};
+    double worst = 0;
+    for (unsigned int i = 0; i < sizeof(targets) / sizeof(targets[0]); i++) {
+        claw.lifter.moveTo(targets[i]);
+        claw.runWhileMoving(10000);
+        double error = std::fabs(claw.model.position * 1000 - targets[i]);
+        if (error > worst) worst = error;
+        if (claw.lifter.getOutcome() != LifterInterface::Outcome::REACHED) failures++;
+    }
+    benchmark::report("potentiometer: largest error of moves between the ends", worst, "/1000");
+    // The overshoot of one update period at full speed is allowed for.
+    if (failures > 0 || worst > LifterInterface::POSITION_TOLERANCE + 5) {
+        std::printf("  FAILED: moves between the ends did not stop where they were sent\n");
+        failures++;
+    }
+    return failures;
+}
+
+/// @return [int] number of failed checks of a claw jammed on its way up, with [feedback].
+inline int checkStall(const char *name, Feedback feedback) {
+    reset();
+    Claw claw(feedback, 1);
+    claw.model.jamAt = 0.6;
+    claw.lifter.moveTo(LifterInterface::POSITION_UP);
+    claw.runWhileMoving(10000);
+    char label[96];
+    std::snprintf(label, sizeof(label), "%s: jammed claw driven before its power was cut", name);
+    benchmark::report(label, claw.model.stalledSeconds * 1000, "ms");
+    unsigned long limitMs = feedback == Feedback::POTENTIOMETER ? 2 * LifterInterface::STALL_MS
+        : LifterInterface::DEFAULT_TRAVEL_TIMEOUT_MS;
+    if (claw.lifter.getOutcome() != LifterInterface::Outcome::STALLED || claw.model.direction() != 0
+        || claw.lifter.getStatus() != StatusCode::LIFT_STALLED || claw.model.stalledSeconds * 1000 > limitMs) {
+        std::printf("  FAILED: %s: the jammed claw's power was not cut\n", name);
+        return 1;
+    }
+    return 0;
+}
+
+/// @return [int] number of failed checks of a manual move up, which the upper limit switch must end.
+inline int checkManualMove() {
+    reset();
+    Claw claw(Feedback::LIMIT_SWITCHES, 1);
+    claw.lifter.moveUp();
+    claw.runWhileMoving(10000);
+    if (claw.model.position < 1 || claw.lifter.getOutcome() != LifterInterface::Outcome::REACHED
+        || claw.model.stalledSeconds > 0.01) {
+        std::printf("  FAILED: the upper limit switch did not end a manual move up\n");
+        return 1;
+    }
+    // At the end already, a move further does not drive the motor at all.
+    claw.lifter.moveUp();
+    if (claw.lifter.isMoving() || claw.model.direction() != 0) {
+        std::printf("  FAILED: the claw was driven up from its upper limit switch\n");
+        return 1;
+    }
+    return 0;
+}
+
+/// @brief Reports the host time of a [LifterInterface::update] of a move measured by the potentiometer.
+inline void reportUpdateCost() {
+    reset();
+    Claw claw(Feedback::POTENTIOMETER, 1);
+    claw.lifter.moveTo(LifterInterface::POSITION_UP);
+    const int iterations = 1000000;
+    long long start = benchmark::nowNs();
+    for (int i = 0; i < iterations; i++) claw.lifter.update();
+    benchmark::report("LifterInterface::update, host time per call", double(benchmark::nowNs() - start) / iterations, "ns");
+    claw.lifter.stop();
+}
+
+/// @return [int] number of failed checks.
+inline int run() {
+    bool consoleEnabled = hal::native::consoleEnabled();
+    hal::native::consoleEnabled() = false;
+    benchmark::section("Lifter claw position control (virtual time)");
+    reportTimed("fresh", 1);
+    reportTimed("drained", DRAINED_SUPPLY);
+    int failures = checkFullTravel("limit switches, fresh battery", Feedback::LIMIT_SWITCHES, 1);
+    failures += checkFullTravel("limit switches, drained battery", Feedback::LIMIT_SWITCHES, DRAINED_SUPPLY);
+    failures += checkFullTravel("potentiometer, drained battery", Feedback::POTENTIOMETER, DRAINED_SUPPLY);
+    failures += checkPositions();
+    failures += checkStall("potentiometer", Feedback::POTENTIOMETER);
+    failures += checkStall("limit switches", Feedback::LIMIT_SWITCHES);
+    failures += checkManualMove();
+    reportUpdateCost();
+    hal::native::resetGpio();
+    hal::native::consoleEnabled() = consoleEnabled;
+    return failures;
+}
+
+}
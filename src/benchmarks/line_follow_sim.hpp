@@ -0,0 +1,254 @@
+#pragma once
+
+#include <cmath>
+#include "benchmark.hpp"
+#include "robot_model.hpp"
+#include "../controllers/autonomous_controller.hpp"
+
+/// <summary>
+/// @file line_follow_sim.hpp
+/// @brief Host simulation comparing lap times of the bang-bang line followers with the PID line follower.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details The track is a stadium-shaped white line (two straights joined by semicircles) driven
+/// anticlockwise. The [AutonomousController] runs unchanged on the mock HAL: the simulation sets its digital
+/// IR inputs (for [lineFollow]/[lineFollowSmooth], sampled by the tick interrupt) or the analog sensor array inputs (for [lineFollowPID])
+/// from the modelled robot pose every millisecond of virtual time, and moves the robot according to the
+/// motor pins. A run fails if the robot leaves the line by more than [OFF_TRACK_DISTANCE]. A PID lap that fails,
+/// or a fastest PID lap no faster than the bang-bang followers' fastest, counts as a failure. A last section
+/// shows the latency, interrupt time and lap results of several IR sampling periods and debounce counts.
+
+namespace line_follow_sim {
+
+static const double PI = 3.14159265358979;
+
+/// Track: length of each straight and radius of the bends.
+static const double STRAIGHT_LENGTH = 1.5;
+static const double BEND_RADIUS = 0.25;
+static const double LINE_WIDTH = 0.03;
+static const double LAP_LENGTH = 2 * STRAIGHT_LENGTH + 2 * PI * BEND_RADIUS;
+
+/// Distance from the line beyond which the robot is considered lost.
+static const double OFF_TRACK_DISTANCE = 0.12;
+
+/// Sensors: distance ahead of the axle, spacing of the two digital sensors and of the analog array.
+static const double SENSOR_FORWARD = 0.10;
+static const double DIGITAL_SENSOR_OFFSET = 0.01;
+static const double ARRAY_SPACING = 0.015;
+static const int ARRAY_SIZE = 8;
+
+/// Width of the blur at the edge of a sensor's view of the line.
+static const double SENSOR_BLUR = 0.008;
+
+/// Wiring of the simulated robot.
+static const uint8_t LEFT_IR_PIN = 12, RIGHT_IR_PIN = 13;
+static const uint8_t ARRAY_PINS[ARRAY_SIZE] = {54, 55, 56, 57, 58, 59, 60, 61};
+
+/// @return [double] signed distance of a point from the track's centre line (positive outside the stadium).
+inline double lineOffset(double x, double y) {
+    double nearestX = x < -STRAIGHT_LENGTH / 2 ? -STRAIGHT_LENGTH / 2 : (x > STRAIGHT_LENGTH / 2 ? STRAIGHT_LENGTH / 2 : x);
+    return std::sqrt((x - nearestX) * (x - nearestX) + y * y) - BEND_RADIUS;
+}
+
+/// @return [double] distance along the track (0 to [LAP_LENGTH]) of the point of the line nearest to a point.
+inline double trackProgress(double x, double y) {
+    const double half = STRAIGHT_LENGTH / 2;
+    if (x >= half) return STRAIGHT_LENGTH + (std::atan2(y, x - half) + PI / 2) * BEND_RADIUS;
+    if (x <= -half) {
+        double angle = std::atan2(y, x + half);
+        if (angle < 0) angle += 2 * PI;
+        return 2 * STRAIGHT_LENGTH + PI * BEND_RADIUS + (angle - PI / 2) * BEND_RADIUS;
+    }
+    if (y < 0) return x + half;
+    return STRAIGHT_LENGTH + PI * BEND_RADIUS + (half - x);
+}
+
+/// @return [double] how much of a sensor's view at a point is covered by the line (0-1).
+inline double lineCoverage(double x, double y) {
+    double edge = (std::fabs(lineOffset(x, y)) - LINE_WIDTH / 2) / SENSOR_BLUR;
+    return edge < -0.5 ? 1 : (edge > 0.5 ? 0 : 0.5 - edge);
+}
+
+/// The line followers compared.
+enum Follower {
+    BANG_BANG,
+    BANG_BANG_SMOOTH,
+    PID
+};
+
+struct LapResult {
+    bool completed;
+    double lapTime;
+    double meanError;
+    double maxError;
+};
+
+/// Sampling of the digital IR sensors (see [DigitalLineSensorsInterface]).
+struct IrSampling {
+    uint8_t periodTicks;
+    uint8_t debounceSamples;
+};
+
+/// The simulated sensors switch cleanly, so laps are compared without debouncing by default.
+static const IrSampling UNDEBOUNCED = {1, 1};
+
+/// Drives one lap of the track with [follower] at [speed], with the wheel speeds ramped at [rampAcceleration]
+/// (and braked at twice that) if it is not 0, and the digital IR sensors sampled as set by [irSampling].
+inline LapResult runLap(Follower follower, int speed, int rampAcceleration = 0, IrSampling irSampling = UNDEBOUNCED) {
+    hal::native::resetGpio();
+    hal::native::resetClock();
+    FastL298NInterface driver(2, 3, 4, 5, 6, 7);
+    MotorDriverInterface *drivers[] = {&driver};
+    NDualWheelDriveInterface drive(1, drivers);
+    drive.setRamp(rampAcceleration, 2 * rampAcceleration);
+    const uint8_t irPins[] = {LEFT_IR_PIN, RIGHT_IR_PIN};
+    DigitalLineSensorsInterface irSensors(2, irPins, irSampling.periodTicks, irSampling.debounceSamples);
+    hal::attachTickInterrupt(DigitalLineSensorsInterface::tickHandler, &irSensors);
+    AutonomousController controller(&drive, NULL, &irSensors);
+    LineSensorArrayInterface lineSensors(ARRAY_SIZE, ARRAY_PINS);
+    if (follower == Follower::PID) controller.setLineSensors(&lineSensors);
+
+    robot_model::DrivePins pins = {2, 3, 4, 5, 6, 7};
+    robot_model::DriveModel robot(pins, robot_model::defaultDriveParameters());
+    robot.place(-STRAIGHT_LENGTH / 2 + 0.1, -BEND_RADIUS, 0);
+
+    LapResult result = {false, 0, 0, 0};
+    double travelled = 0, previousProgress = trackProgress(robot.x, robot.y), errorSum = 0;
+    const double dt = 0.001;
+    const long maxSteps = 60000;
+    unsigned int noise = 12345;
+    long steps = 0;
+    for (; steps < maxSteps && travelled < LAP_LENGTH; steps++) {
+        // Sensors see the line from the current pose.
+        bool leftWhite = lineCoverage(robot.bodyX(SENSOR_FORWARD, DIGITAL_SENSOR_OFFSET),
+            robot.bodyY(SENSOR_FORWARD, DIGITAL_SENSOR_OFFSET)) > 0.5;
+        bool rightWhite = lineCoverage(robot.bodyX(SENSOR_FORWARD, -DIGITAL_SENSOR_OFFSET),
+            robot.bodyY(SENSOR_FORWARD, -DIGITAL_SENSOR_OFFSET)) > 0.5;
+        hal::native::setDigitalInput(LEFT_IR_PIN, leftWhite ? LOW : HIGH);
+        hal::native::setDigitalInput(RIGHT_IR_PIN, rightWhite ? LOW : HIGH);
+        for (int i = 0; i < ARRAY_SIZE; i++) {
+            double left = ((ARRAY_SIZE - 1) / 2.0 - i) * ARRAY_SPACING;
+            double coverage = lineCoverage(robot.bodyX(SENSOR_FORWARD, left), robot.bodyY(SENSOR_FORWARD, left));
+            noise = noise * 1103515245 + 12345;
+            hal::native::setAnalogInput(ARRAY_PINS[i], (int) (900 - 800 * coverage) + (int) ((noise >> 16) % 21) - 10);
+        }
+
+        switch (follower) {
+            case Follower::BANG_BANG: controller.lineFollow(speed); break;
+            case Follower::BANG_BANG_SMOOTH: controller.lineFollowSmooth(speed); break;
+            case Follower::PID: controller.lineFollowPID(speed); break;
+        }
+        if (steps % NDualWheelDriveInterface::RAMP_PERIOD_MS == 0) drive.update();
+
+        robot.step(dt);
+        hal::native::advanceMicros(1000);
+
+        double progress = trackProgress(robot.x, robot.y);
+        double delta = progress - previousProgress;
+        if (delta > LAP_LENGTH / 2) delta -= LAP_LENGTH;
+        if (delta < -LAP_LENGTH / 2) delta += LAP_LENGTH;
+        travelled += delta;
+        previousProgress = progress;
+
+        double error = std::fabs(lineOffset(robot.x, robot.y));
+        errorSum += error;
+        if (error > result.maxError) result.maxError = error;
+        if (error > OFF_TRACK_DISTANCE) break;
+    }
+    hal::attachTickInterrupt(NULL, NULL);
+    if (result.maxError > OFF_TRACK_DISTANCE) return result;
+    result.completed = travelled >= LAP_LENGTH;
+    result.lapTime = steps * dt;
+    result.meanError = errorSum / steps;
+    return result;
+}
+
+inline LapResult reportLap(Follower follower, const char *followerName, int speed, int rampAcceleration = 0,
+    IrSampling irSampling = UNDEBOUNCED) {
+    LapResult result = runLap(follower, speed, rampAcceleration, irSampling);
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s, speed %d: lap time", followerName, speed);
+    if (!result.completed) {
+        std::printf("  %-56s %12s\n", name, "lost line");
+        return result;
+    }
+    benchmark::report(name, result.lapTime, "s");
+    std::snprintf(name, sizeof(name), "%s, speed %d: mean / max off line", followerName, speed);
+    std::printf("  %-56s %5.1f / %4.1f mm\n", name, result.meanError * 1000, result.maxError * 1000);
+    return result;
+}
+
+/// @brief Keeps in [fastest] the lap time of [result] if it completed the lap faster.
+inline void keepFastest(const LapResult &result, double &fastest) {
+    if (result.completed && (fastest == 0 || result.lapTime < fastest)) fastest = result.lapTime;
+}
+
+/// Modelled AVR cycles of one tick interrupt sampling the sensors: entry and exit (register saves, handler
+/// call), each input register read and the debounce of each sensor.
+static const int CYCLES_PER_TICK_INTERRUPT = 60;
+static const int CYCLES_PER_PORT_READ = 2;
+static const int CYCLES_PER_DEBOUNCED_SENSOR = 12;
+
+/// @brief Reports the latency and interrupt time of [irSampling] and a lap of [lineFollowSmooth] sampled by it.
+inline void reportIrSampling(IrSampling irSampling, int speed) {
+    const uint8_t irPins[] = {LEFT_IR_PIN, RIGHT_IR_PIN};
+    DigitalLineSensorsInterface irSensors(2, irPins, irSampling.periodTicks, irSampling.debounceSamples);
+    hal::native::resetCounters();
+    const int samples = 1000;
+    for (int i = 0; i < samples; i++) irSensors.sample();
+    double portReads = double(hal::native::counters().ioReads) / samples;
+    double cycles = CYCLES_PER_TICK_INTERRUPT + portReads * CYCLES_PER_PORT_READ + 2 * CYCLES_PER_DEBOUNCED_SENSOR;
+    char name[64];
+    std::snprintf(name, sizeof(name), "IR every %d tick(s), debounce %d: max. latency",
+        irSampling.periodTicks, irSampling.debounceSamples);
+    benchmark::report(name, irSensors.getLatencyUs() / 1000.0, "ms");
+    std::snprintf(name, sizeof(name), "IR every %d tick(s), debounce %d: CPU time at 16 MHz",
+        irSampling.periodTicks, irSampling.debounceSamples);
+    benchmark::report(name, 100 * cycles / (irSampling.periodTicks * hal::TICK_PERIOD_US * 16.0), "%");
+    std::snprintf(name, sizeof(name), "lineFollowSmooth, IR %d/%d", irSampling.periodTicks, irSampling.debounceSamples);
+    reportLap(Follower::BANG_BANG_SMOOTH, name, speed, 0, irSampling);
+}
+
+/// @return [int] number of failed checks: every PID lap must be completed, and the fastest PID lap must beat
+/// the fastest lap of the bang-bang followers.
+inline int run() {
+    bool consoleEnabled = hal::native::consoleEnabled();
+    hal::native::consoleEnabled() = false;
+    benchmark::section("Line following lap of a 4.6 m stadium track");
+    int failures = 0;
+    double fastestBangBang = 0, fastestPid = 0;
+    const int bangBangSpeeds[] = {95, 140, 185, 230};
+    for (unsigned int i = 0; i < sizeof(bangBangSpeeds) / sizeof(bangBangSpeeds[0]); i++)
+        keepFastest(reportLap(Follower::BANG_BANG, "bang-bang lineFollow", bangBangSpeeds[i]), fastestBangBang);
+    for (unsigned int i = 0; i < sizeof(bangBangSpeeds) / sizeof(bangBangSpeeds[0]); i++) {
+        keepFastest(reportLap(Follower::BANG_BANG_SMOOTH, "bang-bang lineFollowSmooth", bangBangSpeeds[i]),
+            fastestBangBang);
+    }
+    const int pidSpeeds[] = {140, 185, 230, 255};
+    for (int ramped = 0; ramped < 2; ramped++) {
+        for (unsigned int i = 0; i < sizeof(pidSpeeds) / sizeof(pidSpeeds[0]); i++) {
+            LapResult result = ramped ? reportLap(Follower::PID, "PID ramped 1000/s", pidSpeeds[i], 1000)
+                : reportLap(Follower::PID, "PID lineFollowPID", pidSpeeds[i]);
+            keepFastest(result, fastestPid);
+            if (!result.completed) {
+                std::printf("  FAILED: the PID follower lost the line at speed %d\n", pidSpeeds[i]);
+                failures++;
+            }
+        }
+    }
+    if (fastestPid == 0 || fastestBangBang == 0 || fastestPid >= fastestBangBang) {
+        std::printf("  FAILED: the fastest PID lap (%.2f s) did not beat the fastest bang-bang lap (%.2f s)\n",
+            fastestPid, fastestBangBang);
+        failures++;
+    }
+
+    benchmark::section("Digital IR sensors sampled from the tick interrupt (2 sensors, 1 port read)");
+    const IrSampling samplings[] = {{1, 1}, {1, 3}, {2, 2}, {4, 2}, {8, 2}};
+    for (unsigned int i = 0; i < sizeof(samplings) / sizeof(samplings[0]); i++) reportIrSampling(samplings[i], 140);
+    hal::native::consoleEnabled() = consoleEnabled;
+    return failures;
+}
+
+}
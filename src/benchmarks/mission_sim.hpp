@@ -0,0 +1,354 @@
+#pragma once
+
+#include <cmath>
+#include "benchmark.hpp"
+#include "robot_model.hpp"
+#include "odometry_sim.hpp"
+#include "line_follow_sim.hpp"
+#include "lifter_sim.hpp"
+#include "../controllers/autonomous_controller.hpp"
+
+/// <summary>
+/// @file mission_sim.hpp
+/// @brief Host runner of [Mission]s: runs the [AutonomousController] mission interpreter on the mock HAL with
+/// the [robot_model], tracing every instruction.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details The robot is the one of the odometry simulation (encoders on pins 20/21, the speeds its timings
+/// imply) with the claw lifter on pins 8-11, modelled with the [lifter_sim] travel times and optionally its
+/// limit switches. The arena task missions run on a straight 1 m line that ends, as
+/// the arena's does, in front of the object to pick up: the trace shows each instruction the mission held
+/// on (those in between run at once), when it was reached and where the robot was. A square mission is then uploaded over the Bluetooth link in command frames,
+/// stored in the mock EEPROM and run from there, and uploaded again with a frame lost, which must be refused.
+///
+/// A task that does not end at rest, with the claw up, within [ARENA_POSITION_TOLERANCE] and
+/// [ARENA_HEADING_TOLERANCE_DEG] of [ARENA_TASK_END_X] and its final heading, is a failure; so is an upload that
+/// does not store every instruction sent, holds the loop on the EEPROM or stores a mission missing a frame, or a
+/// square that does not end within [SQUARE_POSITION_TOLERANCE] and [SQUARE_HEADING_TOLERANCE_DEG] of its start.
+
+namespace mission_sim {
+
+/// Track: a straight line along x from the origin, ending at [LINE_LENGTH].
+static const double LINE_LENGTH = 1.0;
+
+/// Where the arena tasks end along x, in metres: an IR sensor leaves the line with the robot
+/// [line_follow_sim::SENSOR_FORWARD] behind its end, then the missions approach 110 mm and retreat 1150 mm.
+static const double ARENA_TASK_END_X = LINE_LENGTH - line_follow_sim::SENSOR_FORWARD + 0.110 - 1.150;
+
+/// How far from [ARENA_TASK_END_X] (metres) and from its final heading (degrees) an arena task may end.
+static const double ARENA_POSITION_TOLERANCE = 0.05, ARENA_HEADING_TOLERANCE_DEG = 2 * odometry_sim::TURN_TOLERANCE_DEG;
+
+/// Side of the uploaded square in millimetres.
+static const int SQUARE_SIDE_MM = 400;
+
+/// How far from its start (metres) and its start heading (degrees) the uploaded square may end: the bounds of a
+/// single drive of a side and a single turn in the odometry simulation, for the whole square.
+static const double SQUARE_POSITION_TOLERANCE =
+    (odometry_sim::DISTANCE_TOLERANCE_MM + odometry_sim::DISTANCE_TOLERANCE * SQUARE_SIDE_MM) / 1000;
+static const double SQUARE_HEADING_TOLERANCE_DEG = odometry_sim::TURN_TOLERANCE_DEG;
+
+/// Wiring of the simulated robot's Bluetooth module: SoftwareSerial on pins 50/51.
+static const uint8_t BLUETOOTH_RX_PIN = 50, BLUETOOTH_TX_PIN = 51;
+
+/// @return [const char*] the name of a mission opcode, as written in a mission table.
+inline const char *opcodeName(uint8_t opcode) {
+    switch (opcode) {
+        case MissionOpcode::MISSION_END: return "END";
+        case MissionOpcode::MISSION_FOLLOW_LINE: return "FOLLOW_LINE";
+        case MissionOpcode::MISSION_HOLD: return "HOLD";
+        case MissionOpcode::MISSION_DRIVE: return "DRIVE";
+        case MissionOpcode::MISSION_SPIN: return "SPIN";
+        case MissionOpcode::MISSION_DRIVE_DISTANCE: return "DRIVE_DISTANCE";
+        case MissionOpcode::MISSION_TURN_ANGLE: return "TURN_ANGLE";
+        case MissionOpcode::MISSION_STOP: return "STOP";
+        case MissionOpcode::MISSION_LIFT: return "LIFT";
+        case MissionOpcode::MISSION_WAIT: return "WAIT";
+        case MissionOpcode::MISSION_WAIT_LINE: return "WAIT_LINE";
+        case MissionOpcode::MISSION_WAIT_MANOEUVRE: return "WAIT_MANOEUVRE";
+        case MissionOpcode::MISSION_LIFT_TO: return "LIFT_TO";
+        case MissionOpcode::MISSION_WAIT_LIFT: return "WAIT_LIFT";
+    }
+    return "?";
+}
+
+/// @return [bool] true if a sensor at a point sees the straight line.
+inline bool seesLine(double x, double y) {
+    double nearestX = x < 0 ? 0 : (x > LINE_LENGTH ? LINE_LENGTH : x);
+    double distance = std::sqrt((x - nearestX) * (x - nearestX) + y * y);
+    return distance < line_follow_sim::LINE_WIDTH / 2;
+}
+
+/// @class SimulatedRobot
+/// @brief The [AutonomousController] with its drive, encoders, lifter, IR sensors and Bluetooth link on the mock
+/// HAL, and the modelled robot they move.
+class SimulatedRobot {
+public:
+    FastL298NInterface driver;
+    FastL298NInterface *drivers[1];
+    NDualWheelDrive<FastL298NInterface, 1> drive;
+    WheelEncodersInterface encoders;
+    L298NInterface clawDriver;
+    LifterInterface lifter;
+    DigitalLineSensorsInterface irSensors;
+    SoftwareSerialTransport transport;
+    BluetoothInterface bluetooth;
+    AutonomousController controller;
+    robot_model::DriveModel robot;
+    robot_model::LifterModel claw;
+    unsigned long ms;
+
+    /// @param withEncoders [bool] false to run the manoeuvres and the claw timed, true to measure them with the
+    /// wheel encoders and the lifter's limit switches.
+    explicit SimulatedRobot(bool withEncoders)
+        : driver(2, 3, 4, 5, 6, 7), drivers{&driver}, drive(drivers),
+          encoders(odometry_sim::LEFT_ENCODER_PIN, odometry_sim::RIGHT_ENCODER_PIN, odometry_sim::COUNTS_PER_REVOLUTION,
+              odometry_sim::WHEEL_DIAMETER_MM, odometry_sim::WHEEL_BASE_MM),
+          clawDriver(8, 9, 10, 11), lifter(&clawDriver), irSensors(2, irPins(), 1, 1),
+          transport(BLUETOOTH_RX_PIN, BLUETOOTH_TX_PIN, 9600), bluetooth(&transport),
+          controller(&drive, &lifter, &irSensors), robot(drivePins(), driveParameters()),
+          claw(lifter_sim::pins(), lifter_sim::UP_SECONDS, lifter_sim::DOWN_SECONDS), ms(0) {
+        drive.setRamp(1000, 2000);
+        if (withEncoders) {
+            drive.setEncoders(&encoders);
+            lifter.setLimitSwitches(lifter_sim::LOWER_LIMIT_PIN, lifter_sim::UPPER_LIMIT_PIN);
+        }
+        // The claw starts up, as it is carried.
+        claw.position = 1;
+        claw.writeFeedback();
+        robot.attachEncoders(odometry_sim::LEFT_ENCODER_PIN, odometry_sim::RIGHT_ENCODER_PIN,
+            odometry_sim::PI * odometry_sim::WHEEL_DIAMETER_MM / 1000.0 / odometry_sim::COUNTS_PER_REVOLUTION);
+        controller.setTuningLink(&bluetooth);
+        hal::attachTickInterrupt(DigitalLineSensorsInterface::tickHandler, &irSensors);
+    }
+
+    ~SimulatedRobot() {
+        hal::attachTickInterrupt(NULL, NULL);
+    }
+
+    static const uint8_t *irPins() {
+        static const uint8_t pins[] = {line_follow_sim::LEFT_IR_PIN, line_follow_sim::RIGHT_IR_PIN};
+        return pins;
+    }
+
+    static robot_model::DrivePins drivePins() {
+        robot_model::DrivePins pins = {2, 3, 4, 5, 6, 7};
+        return pins;
+    }
+
+    static robot_model::DriveParameters driveParameters() {
+        robot_model::DriveParameters parameters = robot_model::defaultDriveParameters();
+        parameters.maxSpeed = odometry_sim::REFERENCE.maxSpeed;
+        parameters.maxAcceleration = odometry_sim::REFERENCE.maxAcceleration;
+        parameters.turnEfficiency = odometry_sim::REFERENCE.turnEfficiency;
+        return parameters;
+    }
+
+    /// @brief Runs the robot for one millisecond: sensors, one [AutonomousController::runMission], the drive
+    /// and lifter updates and the models.
+    void step() {
+        double forward = line_follow_sim::SENSOR_FORWARD, offset = line_follow_sim::DIGITAL_SENSOR_OFFSET;
+        hal::native::setDigitalInput(line_follow_sim::LEFT_IR_PIN,
+            seesLine(robot.bodyX(forward, offset), robot.bodyY(forward, offset)) ? LOW : HIGH);
+        hal::native::setDigitalInput(line_follow_sim::RIGHT_IR_PIN,
+            seesLine(robot.bodyX(forward, -offset), robot.bodyY(forward, -offset)) ? LOW : HIGH);
+        controller.runMission();
+        if (ms % DualWheelDriveBase::RAMP_PERIOD_MS == 0) drive.update();
+        if (ms % LifterInterface::UPDATE_PERIOD_MS == 0) lifter.update();
+        robot.step(0.001);
+        claw.step(0.001);
+        hal::native::advanceMicros(1000);
+        ms++;
+    }
+
+    /// @brief Runs [mission] to its end (at most [maxMs]), printing a line per instruction held on if [trace].
+    void run(const Mission &mission, bool trace, unsigned long maxMs = 60000) {
+        controller.startMission(mission);
+        int counter = -1;
+        for (unsigned long start = ms; controller.isMissionRunning() && ms - start < maxMs;) {
+            if (trace && controller.getMissionCounter() != counter) {
+                counter = controller.getMissionCounter();
+                MissionInstruction instruction = mission.read(counter);
+                std::printf("    %6.3f s  %2d %-15s %3d %6d   at x %6.0f mm, y %5.0f mm, heading %5.0f deg\n",
+                    ms / 1000.0, counter, opcodeName(instruction.opcode), instruction.argument, instruction.value,
+                    robot.x * 1000, robot.y * 1000, robot.heading * 180 / odometry_sim::PI);
+            }
+            step();
+        }
+        for (unsigned long settle = 0; settle < 1000; settle++) step();
+    }
+};
+
+/// @return [double] the robot's heading in degrees, between -180 and 180.
+inline double headingDegrees(const robot_model::DriveModel &robot) {
+    double heading = std::fmod(robot.heading * 180 / odometry_sim::PI, 360.0);
+    if (heading > 180) heading -= 360;
+    if (heading <= -180) heading += 360;
+    return heading;
+}
+
+/// @brief Runs an arena task mission from the start of the line, tracing it, and reports where it ended.
+/// @param endHeading [double] heading in degrees the task must end at.
+/// @return [int] 1 if the task did not end at rest, with the claw up, near [ARENA_TASK_END_X] and [endHeading].
+inline int reportArenaTask(const char *name, const Mission &mission, bool withEncoders, double endHeading) {
+    hal::native::resetGpio();
+    hal::native::resetClock();
+    SimulatedRobot simulated(withEncoders);
+    simulated.robot.place(0.05, 0, 0);
+    std::printf("  %s, %s (%d instructions, %d bytes of flash):\n", name,
+        withEncoders ? "encoders and limit switches" : "timed",
+        mission.getNumberOfInstructions(), mission.getNumberOfInstructions() * MissionInstruction::SIZE);
+    simulated.run(mission, true);
+    std::printf("    %6.3f s  at rest at x %6.0f mm, y %5.0f mm, heading %5.0f deg, claw %s, stalled %.2f s\n",
+        simulated.ms / 1000.0, simulated.robot.x * 1000, simulated.robot.y * 1000,
+        simulated.robot.heading * 180 / odometry_sim::PI, simulated.claw.position >= 1 ? "up" : "not up",
+        simulated.claw.stalledSeconds);
+    double headingError = std::fabs(headingDegrees(simulated.robot) - endHeading);
+    if (headingError > 180) headingError = 360 - headingError;
+    bool atRest = !simulated.controller.isMissionRunning() && simulated.drive.getLeftSpeed() == 0
+        && simulated.drive.getRightSpeed() == 0;
+    if (atRest && simulated.claw.position >= 1 && std::fabs(simulated.robot.y) <= ARENA_POSITION_TOLERANCE
+        && std::fabs(simulated.robot.x - ARENA_TASK_END_X) <= ARENA_POSITION_TOLERANCE
+        && headingError <= ARENA_HEADING_TOLERANCE_DEG) return 0;
+    std::printf("  FAILED: %s did not end at rest with the claw up at x %.0f mm, y 0 mm, heading %.0f deg\n", name,
+        ARENA_TASK_END_X * 1000, endHeading);
+    return 1;
+}
+
+/// A square of [SQUARE_SIDE_MM] sides driven to the left, uploaded over Bluetooth.
+static const uint8_t SQUARE_MISSION[] = {
+    MISSION_DRIVE_DISTANCE, 200, MISSION_VALUE(SQUARE_SIDE_MM), MISSION_WAIT_MANOEUVRE, 0, MISSION_VALUE(3000),
+    MISSION_TURN_ANGLE, 185, MISSION_VALUE(90), MISSION_WAIT_MANOEUVRE, 0, MISSION_VALUE(3000),
+    MISSION_DRIVE_DISTANCE, 200, MISSION_VALUE(SQUARE_SIDE_MM), MISSION_WAIT_MANOEUVRE, 0, MISSION_VALUE(3000),
+    MISSION_TURN_ANGLE, 185, MISSION_VALUE(90), MISSION_WAIT_MANOEUVRE, 0, MISSION_VALUE(3000),
+    MISSION_DRIVE_DISTANCE, 200, MISSION_VALUE(SQUARE_SIDE_MM), MISSION_WAIT_MANOEUVRE, 0, MISSION_VALUE(3000),
+    MISSION_TURN_ANGLE, 185, MISSION_VALUE(90), MISSION_WAIT_MANOEUVRE, 0, MISSION_VALUE(3000),
+    MISSION_DRIVE_DISTANCE, 200, MISSION_VALUE(SQUARE_SIDE_MM), MISSION_WAIT_MANOEUVRE, 0, MISSION_VALUE(3000),
+    MISSION_TURN_ANGLE, 185, MISSION_VALUE(90), MISSION_WAIT_MANOEUVRE, 0, MISSION_VALUE(3000),
+    MISSION_END, 0, MISSION_VALUE(0)
+};
+
+/// @brief Writes the frames uploading [SQUARE_MISSION], 6 instructions per frame, and running it, leaving out
+/// frame [lost] (-1 for none) as if it had been lost on the way.
+/// @return [size_t] number of bytes written to [bytes]; [frames] is set to the number of frames sent.
+inline size_t buildSquareUpload(uint8_t *bytes, size_t size, int lost, int *frames) {
+    const int numberOfInstructions = sizeof(SQUARE_MISSION) / MissionInstruction::SIZE;
+    const uint8_t commit[] = {(uint8_t) numberOfInstructions, crc8(SQUARE_MISSION, sizeof(SQUARE_MISSION))};
+    size_t length = 0;
+    *frames = 0;
+    for (int first = -1; first <= numberOfInstructions; first += 6) {
+        CommandFrameWriter writer(bytes + length, size - length);
+        for (int i = first; i < first + 6 && i <= numberOfInstructions; i++) {
+            if (i < 0) writer.add(CommandOpcode::UPLOAD_MISSION_BEGIN);
+            else if (i < numberOfInstructions) writer.add(CommandOpcode::UPLOAD_MISSION_INSTRUCTION, SQUARE_MISSION + i * MissionInstruction::SIZE);
+            else writer.add(CommandOpcode::UPLOAD_MISSION_COMMIT, commit);
+        }
+        size_t frameSize = writer.finish();
+        if ((*frames)++ != lost) length += frameSize;
+    }
+    CommandFrameWriter writer(bytes + length, size - length);
+    writer.add(CommandOpcode::RUN_MISSION, AutonomousController::UPLOADED_MISSION);
+    return length + writer.finish();
+}
+
+/// @brief Sends [length] bytes to the robot at the pace of the 9600 baud link (about a byte per millisecond),
+/// running it meanwhile, then runs it until the mission starts (at most a second more).
+inline void sendPaced(SimulatedRobot &simulated, const uint8_t *bytes, size_t length) {
+    hal::native::SerialPort *serial = hal::native::findSerial(BLUETOOTH_RX_PIN);
+    for (size_t i = 0; i < length; i++) {
+        serial->inject(bytes + i, 1);
+        simulated.step();
+    }
+    for (int i = 0; i < 1000 && !simulated.controller.isMissionRunning(); i++) simulated.step();
+}
+
+/// @brief Uploads [SQUARE_MISSION] over the Bluetooth link, 6 instructions per frame, runs it from EEPROM and
+/// reports the upload and where the robot ended. Then uploads it again with an instruction frame lost.
+/// @return [int] number of failures: instructions lost on the way, loop passes held on the EEPROM, a square that
+/// does not end near its start, and an upload missing instructions that is stored all the same.
+inline int reportUploadedMission() {
+    hal::native::resetGpio();
+    hal::native::resetClock();
+    hal::native::resetEeprom();
+    const int numberOfInstructions = sizeof(SQUARE_MISSION) / MissionInstruction::SIZE;
+    uint8_t upload[256];
+    int frames;
+    size_t bytes = buildSquareUpload(upload, sizeof(upload), -1, &frames);
+    SimulatedRobot simulated(true);
+    sendPaced(simulated, upload, bytes);
+
+    Mission stored = MissionStore().load();
+    benchmark::report("square mission uploaded: instructions stored", stored.getNumberOfInstructions(), "");
+    benchmark::report("square mission uploaded: frames sent", frames, "");
+    benchmark::report("square mission uploaded: bytes sent", (double) bytes, "B");
+    benchmark::report("square mission uploaded: EEPROM bytes written", hal::native::eeprom().writes, "B");
+    benchmark::report("square mission uploaded: loop time waiting for EEPROM",
+        hal::native::eeprom().waitedMicros / 1000.0, "ms");
+    int failures = 0;
+    if (stored.getNumberOfInstructions() != numberOfInstructions) {
+        std::printf("  FAILED: %d of the %d instructions sent were stored\n", stored.getNumberOfInstructions(),
+            numberOfInstructions);
+        failures++;
+    }
+    if (hal::native::eeprom().waitedMicros > 0) {
+        std::printf("  FAILED: the upload held the loop waiting for the EEPROM\n");
+        failures++;
+    }
+    if (!simulated.controller.isMissionRunning()) {
+        std::printf("  FAILED: the uploaded mission did not start\n");
+        failures++;
+    }
+
+    simulated.run(stored, false);
+    benchmark::report("square mission from EEPROM: time", simulated.ms / 1000.0, "s");
+    double distance = std::sqrt(simulated.robot.x * simulated.robot.x + simulated.robot.y * simulated.robot.y);
+    benchmark::report("square mission from EEPROM: distance from the start", 1000 * distance, "mm");
+    double heading = headingDegrees(simulated.robot);
+    benchmark::report("square mission from EEPROM: heading error", heading, "deg");
+    if (distance > SQUARE_POSITION_TOLERANCE || std::fabs(heading) > SQUARE_HEADING_TOLERANCE_DEG) {
+        std::printf("  FAILED: the uploaded square did not end near its start\n");
+        failures++;
+    }
+
+    // The second frame, instructions 5 to 10, is lost: the commit's count and CRC refuse the upload.
+    bytes = buildSquareUpload(upload, sizeof(upload), 1, &frames);
+    sendPaced(simulated, upload, bytes);
+    for (int i = 0; i < 1000; i++) simulated.step();
+    int refused = MissionStore().load().getNumberOfInstructions();
+    benchmark::report("square mission, a frame lost: instructions stored", refused, "");
+    if (refused != 0) {
+        std::printf("  FAILED: an upload missing instructions was stored\n");
+        failures++;
+    }
+    return failures;
+}
+
+/// @return [double] host nanoseconds of one [AutonomousController::runMission] step holding on a wait.
+inline double waitStepNs() {
+    hal::native::resetGpio();
+    hal::native::resetClock();
+    SimulatedRobot simulated(true);
+    static const uint8_t waiting[] = {MISSION_WAIT, 0, MISSION_VALUE(60000)};
+    simulated.controller.startMission(Mission::inRam(waiting, sizeof(waiting)));
+    const int iterations = 1000000;
+    long long start = benchmark::nowNs();
+    for (int i = 0; i < iterations; i++) simulated.controller.runMission();
+    return double(benchmark::nowNs() - start) / iterations;
+}
+
+/// @return [int] number of arena tasks that did not end where they should, and of upload failures.
+inline int run() {
+    bool consoleEnabled = hal::native::consoleEnabled();
+    hal::native::consoleEnabled() = false;
+    benchmark::section("Mission interpreter: arena tasks on a 1 m line ending at the object");
+    int failures = reportArenaTask("arenaTask1Mission", arenaTask1Mission(), true, 180);
+    failures += reportArenaTask("arenaTask2Mission", arenaTask2Mission(), false, 0);
+    benchmark::section("Mission interpreter: upload over Bluetooth into EEPROM");
+    failures += reportUploadedMission();
+    benchmark::report("runMission() step holding on a wait (host)", waitStepNs(), "ns");
+    hal::native::consoleEnabled() = consoleEnabled;
+    return failures;
+}
+
+}
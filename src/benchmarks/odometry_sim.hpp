@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cmath>
+#include "benchmark.hpp"
+#include "robot_model.hpp"
+#include "../interfaces/2N_wheel_drive_interface.hpp"
+
+/// <summary>
+/// @file odometry_sim.hpp
+/// @brief Host simulation comparing the timed pick-up manoeuvres with the ones measured by the wheel encoders.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details The manoeuvres of the [AutonomousController] pick-up task (the 180 degree turn, the approach and
+/// the retreat) are driven on the [robot_model], ramped as in main.cpp, in two ways: for a fixed time, tuned
+/// so that it hits its target in the reference conditions (as the timings in the controller were tuned on the
+/// robot), and by [DualWheelDriveBase::turnAngle]/[DualWheelDriveBase::driveDistance] with the encoders of
+/// main.cpp. Both are then driven with a weaker battery (lower top speed), on a slippery floor (wheels
+/// spinning while they speed up) and on a floor the chassis scrubs more on while turning. The angle or
+/// distance reached after the robot came to rest is reported. A manoeuvre measured by the encoders that ends
+/// further from its target than [TURN_TOLERANCE_DEG] or [DISTANCE_TOLERANCE_MM] plus [DISTANCE_TOLERANCE], or
+/// no closer than the timed one on a weaker battery, counts as a failure. The scrubbing floor is reported only:
+/// the wheels turn as far as they should there, so their encoders cannot see the chassis turning less.
+
+namespace odometry_sim {
+
+static const double PI = 3.14159265358979;
+
+/// Wiring and geometry of the simulated robot, as in main.cpp.
+static const uint8_t LEFT_ENCODER_PIN = 20, RIGHT_ENCODER_PIN = 21;
+static const int COUNTS_PER_REVOLUTION = 40;
+static const int WHEEL_DIAMETER_MM = 65;
+static const int WHEEL_BASE_MM = 300;
+
+/// Floor and battery the manoeuvres are driven in.
+struct Conditions {
+    const char *name;
+    /// Wheel ground speed at full duty.
+    double maxSpeed;
+    /// See [robot_model::DriveParameters].
+    double maxAcceleration;
+    double turnEfficiency;
+    /// Whether the wheels' turns show the error, so the encoders must correct it.
+    bool seenByEncoders;
+};
+
+/// Full battery on the arena floor: a 180 mm track turning like a 300 mm one, at about the speeds the
+/// controller's timings imply.
+static const Conditions REFERENCE = {"reference", 0.28, 3.0, 0.6, true};
+
+static const Conditions CONDITIONS[] = {
+    REFERENCE,
+    {"battery at 75%", 0.21, 3.0, 0.6, true},
+    {"battery at 55%", 0.154, 3.0, 0.6, true},
+    {"slippery floor", 0.28, 0.4, 0.6, true},
+    {"scrubbing floor", 0.28, 3.0, 0.5, false}
+};
+
+/// Largest error at rest of a manoeuvre measured by the encoders: a turn, and a drive (a fixed part and a
+/// share of the distance).
+static const double TURN_TOLERANCE_DEG = 8;
+static const double DISTANCE_TOLERANCE_MM = 15, DISTANCE_TOLERANCE = 0.03;
+
+/// A manoeuvre of the pick-up task: a turn on the spot to the left, or a straight drive.
+struct Manoeuvre {
+    const char *name;
+    bool turning;
+    int speed;
+    /// Degrees to the left, or millimetres, negative to reverse.
+    int target;
+};
+
+static const Manoeuvre MANOEUVRES[] = {
+    {"turn 180 deg at 185", true, 185, 180},
+    {"approach 110 mm at 125", false, 125, 110},
+    {"retreat 1150 mm at 255", false, 255, -1150}
+};
+
+struct ManoeuvreResult {
+    /// Degrees or millimetres reached, in the direction of the target.
+    double reached;
+    /// Milliseconds until the stop command.
+    unsigned long durationMs;
+};
+
+/// @brief Drives [manoeuvre] in [conditions], for [timedMs] if it is not 0, else with the encoders.
+inline ManoeuvreResult runManoeuvre(const Manoeuvre &manoeuvre, const Conditions &conditions, unsigned long timedMs) {
+    hal::native::resetGpio();
+    hal::native::resetClock();
+    FastL298NInterface driver(2, 3, 4, 5, 6, 7);
+    FastL298NInterface *drivers[] = {&driver};
+    NDualWheelDrive<FastL298NInterface, 1> drive(drivers);
+    drive.setRamp(1000, 2000);
+    WheelEncodersInterface encoders(LEFT_ENCODER_PIN, RIGHT_ENCODER_PIN, COUNTS_PER_REVOLUTION,
+        WHEEL_DIAMETER_MM, WHEEL_BASE_MM);
+    if (timedMs == 0) drive.setEncoders(&encoders);
+
+    robot_model::DrivePins pins = {2, 3, 4, 5, 6, 7};
+    robot_model::DriveParameters parameters = robot_model::defaultDriveParameters();
+    parameters.maxSpeed = conditions.maxSpeed;
+    parameters.maxAcceleration = conditions.maxAcceleration;
+    parameters.turnEfficiency = conditions.turnEfficiency;
+    robot_model::DriveModel robot(pins, parameters);
+    robot.attachEncoders(LEFT_ENCODER_PIN, RIGHT_ENCODER_PIN, PI * WHEEL_DIAMETER_MM / 1000.0 / COUNTS_PER_REVOLUTION);
+
+    if (timedMs == 0) {
+        if (manoeuvre.turning) drive.turnAngle(manoeuvre.speed, manoeuvre.target);
+        else drive.driveDistance(manoeuvre.speed, manoeuvre.target);
+    } else if (manoeuvre.turning) {
+        drive.hardLeft(manoeuvre.speed);
+    } else if (manoeuvre.target < 0) {
+        drive.backward(manoeuvre.speed);
+    } else {
+        drive.forward(manoeuvre.speed);
+    }
+
+    ManoeuvreResult result = {0, 0};
+    bool stopped = false;
+    const unsigned long settleMs = 1000, maxMs = 20000;
+    for (unsigned long ms = 0; ms < maxMs && (!stopped || ms < result.durationMs + settleMs); ms++) {
+        if (ms % DualWheelDriveBase::RAMP_PERIOD_MS == 0) drive.update();
+        if (!stopped && (timedMs != 0 ? ms >= timedMs : !drive.isManoeuvreInProgress())) {
+            if (timedMs != 0) drive.stop();
+            stopped = true;
+            result.durationMs = ms;
+        }
+        robot.step(0.001);
+        hal::native::advanceMicros(1000);
+    }
+    result.reached = manoeuvre.turning ? robot.heading * 180 / PI : robot.x * 1000;
+    if (manoeuvre.target < 0) result.reached = -result.reached;
+    return result;
+}
+
+/// @return [unsigned long] duration of the timed [manoeuvre] reaching its target in the [REFERENCE] conditions.
+inline unsigned long calibrate(const Manoeuvre &manoeuvre) {
+    double target = std::fabs((double) manoeuvre.target);
+    unsigned long shortest = 1, longest = 20000;
+    while (longest - shortest > 1) {
+        unsigned long middle = (shortest + longest) / 2;
+        if (runManoeuvre(manoeuvre, REFERENCE, middle).reached < target) shortest = middle;
+        else longest = middle;
+    }
+    return longest;
+}
+
+/// @return [int] number of conditions in which [manoeuvre] measured by the encoders missed its tolerance.
+inline int reportManoeuvre(const Manoeuvre &manoeuvre) {
+    const char *unit = manoeuvre.turning ? "deg" : "mm";
+    double target = std::fabs((double) manoeuvre.target);
+    double tolerance = manoeuvre.turning ? TURN_TOLERANCE_DEG : DISTANCE_TOLERANCE_MM + DISTANCE_TOLERANCE * target;
+    unsigned long timedMs = calibrate(manoeuvre);
+    std::printf("  %s (timed: %lu ms)\n", manoeuvre.name, timedMs);
+    int failures = 0;
+    for (unsigned int i = 0; i < sizeof(CONDITIONS) / sizeof(CONDITIONS[0]); i++) {
+        ManoeuvreResult timed = runManoeuvre(manoeuvre, CONDITIONS[i], timedMs);
+        ManoeuvreResult measured = runManoeuvre(manoeuvre, CONDITIONS[i], 0);
+        char name[64];
+        std::snprintf(name, sizeof(name), "%s: timed / encoders", CONDITIONS[i].name);
+        std::printf("    %-54s %+7.1f / %+6.1f %s off (%lu ms)\n", name, timed.reached - target,
+            measured.reached - target, unit, measured.durationMs);
+        double timedError = std::fabs(timed.reached - target), measuredError = std::fabs(measured.reached - target);
+        bool weakerBattery = CONDITIONS[i].maxSpeed < REFERENCE.maxSpeed;
+        if (CONDITIONS[i].seenByEncoders
+            && (measuredError > tolerance || (weakerBattery && measuredError >= timedError))) {
+            std::printf("  FAILED: %s, %s: %.1f %s off with the encoders, %.1f allowed\n", manoeuvre.name,
+                CONDITIONS[i].name, measuredError, unit, tolerance);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+/// @return [int] number of manoeuvres measured by the encoders that missed their tolerance.
+inline int run() {
+    bool consoleEnabled = hal::native::consoleEnabled();
+    hal::native::consoleEnabled() = false;
+    benchmark::section("Pick-up manoeuvres: timed vs. measured by the wheel encoders (error at rest)");
+    int failures = 0;
+    for (unsigned int i = 0; i < sizeof(MANOEUVRES) / sizeof(MANOEUVRES[0]); i++) {
+        failures += reportManoeuvre(MANOEUVRES[i]);
+    }
+    hal::native::consoleEnabled() = consoleEnabled;
+    return failures;
+}
+
+}
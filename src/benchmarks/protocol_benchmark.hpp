@@ -0,0 +1,293 @@
+#pragma once
+
+#include <cstring>
+#include "benchmark.hpp"
+#include "../controllers/bluetooth_controller.hpp"
+#include "../interfaces/motordriver_interfaces.hpp"
+
+/// <summary>
+/// @file protocol_benchmark.hpp
+/// @brief Host benchmark of the framed command protocol: parser throughput and latency, and how many controller
+/// steps it takes to drain a burst of commands compared with the former one-letter-per-step receive.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+
+namespace protocol_benchmark {
+
+/// Builds a frame of [numberOfCommands] commands alternating SET_SPEED and a drive opcode.
+/// @return [size_t] size of the frame in bytes.
+inline size_t buildFrame(uint8_t *buffer, size_t size, int numberOfCommands) {
+    CommandFrameWriter writer(buffer, size);
+    for (int i = 0; i < numberOfCommands; i++) {
+        if (i % 2 == 0) writer.add(CommandOpcode::SET_SPEED, (uint8_t) (i * 16));
+        else writer.add(CommandOpcode::DRIVE_FORWARD + (i / 2) % 6);
+    }
+    return writer.finish();
+}
+
+/// Average host time in nanoseconds to parse a frame of [numberOfCommands] commands and take them all.
+inline double parseCostNs(int numberOfCommands, size_t *frameSize) {
+    uint8_t frame[CommandParser::MAX_FRAME_PAYLOAD + 3];
+    *frameSize = buildFrame(frame, sizeof(frame), numberOfCommands);
+    CommandParser parser;
+    Command command;
+    const long iterations = 200000;
+    unsigned long taken = 0;
+    long long start = benchmark::nowNs();
+    for (long i = 0; i < iterations; i++) {
+        for (size_t j = 0; j < *frameSize; j++) {
+            if (parser.feed(frame[j])) {
+                while (parser.next(command)) taken++;
+            }
+        }
+    }
+    long long elapsed = benchmark::nowNs() - start;
+    benchmark::doNotOptimize(taken);
+    return double(elapsed) / iterations;
+}
+
+/// Average host time in nanoseconds to parse one legacy single-letter command.
+inline double letterCostNs() {
+    const char letters[] = "5FGSBIRL";
+    CommandParser parser;
+    Command command;
+    const long iterations = 2000000;
+    unsigned long taken = 0;
+    long long start = benchmark::nowNs();
+    for (long i = 0; i < iterations; i++) {
+        if (parser.feed(letters[i & 7])) taken += parser.next(command);
+    }
+    long long elapsed = benchmark::nowNs() - start;
+    benchmark::doNotOptimize(taken);
+    return double(elapsed) / iterations;
+}
+
+/// Number of controller steps needed to act on a burst of [numberOfCommands] commands that arrived together,
+/// with the [BluetoothController] draining its backlog, or reading a single letter per step as it used to.
+/// The robot is built once: [BluetoothInterface] keeps its serial port for the life of the program.
+inline int stepsToDrain(int numberOfCommands, bool onePerStep) {
+    static FastL298NInterface driver(2, 3, 4, 5, 6, 7);
+    static MotorDriverInterface *drivers[] = {&driver};
+    static NDualWheelDriveInterface drive(1, drivers);
+    static SoftwareSerialTransport transport(53, 52, 9600);
+    static BluetoothInterface bluetooth(&transport);
+    static BluetoothController controller(&bluetooth, &drive);
+    hal::native::SerialPort *serial = hal::native::findSerial(53);
+
+    uint8_t frame[CommandParser::MAX_FRAME_PAYLOAD + 3];
+    if (onePerStep) {
+        for (int i = 0; i < numberOfCommands; i++) serial->inject(i % 2 == 0 ? "5" : "F");
+    } else {
+        serial->inject(frame, buildFrame(frame, sizeof(frame), numberOfCommands));
+    }
+
+    int steps = 0;
+    if (onePerStep) {
+        while (bluetooth.receiveChar() != '\0') steps++;
+    } else {
+        while (serial->available() > 0 || bluetooth.getParser().hasCommand()) {
+            controller.step();
+            steps++;
+        }
+    }
+    return steps;
+}
+
+/// Joystick position of a [CommandOpcode::DRIVE_ARCADE] command and the wheel speeds it must give.
+struct ArcadeCheck {
+    int throttle, turn;
+    int left, right;
+};
+
+static const ArcadeCheck ARCADE_CHECKS[] = {
+    {0, 0, 0, 0},
+    {127, 0, 255, 255},
+    {-127, 0, -255, -255},
+    {64, 0, 128, 128},
+    {0, 127, 255, -255},
+    {127, 127, 255, 0},
+    {-127, 64, -84, -255},
+    {1, 0, 2, 2}
+};
+
+/// @brief Sends the proportional drive commands over the simulated link and compares the wheel speeds with the
+/// expected ones, and counts the speeds a side can be given with letters and with joystick frames.
+/// @return [int] number of wrong wheel speeds.
+inline int checkProportionalDrive() {
+    FastL298NInterface driver(2, 3, 4, 5, 6, 7);
+    FastL298NInterface *drivers[] = {&driver};
+    NDualWheelDrive<FastL298NInterface, 1> drive(drivers);
+    SoftwareSerialTransport transport(50, 51, 9600);
+    BluetoothInterface bluetooth(&transport);
+    BluetoothController controller(&bluetooth, &drive);
+    hal::native::SerialPort *serial = hal::native::findSerial(50);
+
+    int failures = 0;
+    uint8_t frame[8];
+    for (unsigned int i = 0; i < sizeof(ARCADE_CHECKS) / sizeof(ARCADE_CHECKS[0]); i++) {
+        const ArcadeCheck &check = ARCADE_CHECKS[i];
+        CommandFrameWriter writer(frame, sizeof(frame));
+        writer.addAxes(CommandOpcode::DRIVE_ARCADE, check.throttle, check.turn);
+        serial->inject(frame, writer.finish());
+        controller.step();
+        if (drive.getLeftSpeed() == check.left && drive.getRightSpeed() == check.right) continue;
+        std::printf("  FAILED: arcade (%d, %d) gave wheel speeds (%d, %d), (%d, %d) expected\n", check.throttle,
+            check.turn, drive.getLeftSpeed(), drive.getRightSpeed(), check.left, check.right);
+        failures++;
+    }
+    CommandFrameWriter writer(frame, sizeof(frame));
+    writer.addAxes(CommandOpcode::DRIVE_TANK, -127, 50);
+    serial->inject(frame, writer.finish());
+    controller.step();
+    if (drive.getLeftSpeed() != -255 || drive.getRightSpeed() != 101) {
+        std::printf("  FAILED: tank (-127, 50) gave wheel speeds (%d, %d)\n", drive.getLeftSpeed(), drive.getRightSpeed());
+        failures++;
+    }
+    controller.execute(Command{CommandOpcode::DRIVE_STOP, {0}});
+
+    // Forward speeds a side can be given: the letters' speed digits and 'Q', or every throttle of a frame.
+    bool seen[256] = {false};
+    int letterSpeeds = 0, joystickSpeeds = 0;
+    const char letters[] = "0123456789Q";
+    Command command;
+    for (const char *letter = letters; *letter != '\0'; letter++) {
+        if (commandFromLetter(*letter, command) && !seen[command.payload[0]]) {
+            seen[command.payload[0]] = true;
+            letterSpeeds++;
+        }
+    }
+    for (int i = 0; i < 256; i++) seen[i] = false;
+    for (int throttle = 0; throttle <= COMMAND_AXIS_MAX; throttle++) {
+        int speed = commandAxis(commandAxisByte(throttle)).toPwm();
+        if (!seen[speed]) {
+            seen[speed] = true;
+            joystickSpeeds++;
+        }
+    }
+    benchmark::report("forward speeds, speed digit letters", letterSpeeds, "");
+    benchmark::report("forward speeds, joystick frames", joystickSpeeds, "");
+    size_t frameSize = writer.finish();
+    benchmark::report("joystick frame size", frameSize, "B");
+    benchmark::report("joystick updates per second at 9600 baud, at most", 9600.0 / 10 / frameSize, "Hz");
+    benchmark::report("share of a 9600 baud link at 50 Hz", 100.0 * 50 * frameSize / (9600.0 / 10), "%");
+    return failures;
+}
+
+/// @return [int] number of commands [parser] decodes from [length] bytes of [bytes].
+inline int commandsDecoded(CommandParser &parser, const uint8_t *bytes, size_t length) {
+    int commands = 0;
+    Command command;
+    for (size_t i = 0; i < length; i++) {
+        if (parser.feed(bytes[i])) {
+            while (parser.next(command)) commands++;
+        }
+    }
+    return commands;
+}
+
+/// Feeds joystick frames whose sync byte was lost, or whose length byte is corrupted, with axes that are
+/// letters ('F' drives forward at full speed, 'C' starts a calibration sweep, 'Y' a replay), on a parser
+/// that has not received a frame yet and on one that has.
+/// @return [int] number of broken frames some command came out of, or intact frames that did not give theirs.
+inline int checkLostSync() {
+    const int8_t axes[][2] = {{'F', 0}, {'C', 'Y'}, {'Y', 'F'}, {'B', 'L'}};
+    int failures = 0;
+    for (int afterFrame = 0; afterFrame < 2; afterFrame++) {
+        for (unsigned int i = 0; i < sizeof(axes) / sizeof(axes[0]); i++) {
+            uint8_t frame[8];
+            CommandFrameWriter writer(frame, sizeof(frame));
+            writer.addAxes(CommandOpcode::DRIVE_ARCADE, axes[i][0], axes[i][1]);
+            size_t size = writer.finish();
+            CommandParser parser;
+            if (afterFrame && commandsDecoded(parser, frame, size) != 1) failures++;
+            int lostSync = commandsDecoded(parser, frame + 1, size - 1);
+            uint8_t badLength[8];
+            for (size_t j = 0; j < size; j++) badLength[j] = frame[j];
+            badLength[1] = CommandParser::MAX_FRAME_PAYLOAD + 1;
+            int rejectedLength = commandsDecoded(parser, badLength, size);
+            // The next intact frame is decoded again.
+            int resynced = commandsDecoded(parser, frame, size);
+            if (lostSync != 0 || rejectedLength != 0 || resynced != 1) {
+                std::printf("  FAILED: arcade (0x%02X, 0x%02X)%s: %d commands from a lost sync, %d from a bad length,"
+                    " %d from the next frame\n", (uint8_t) axes[i][0], (uint8_t) axes[i][1],
+                    afterFrame ? " after a frame" : "", lostSync, rejectedLength, resynced);
+                failures++;
+            }
+        }
+    }
+    return failures;
+}
+
+/// Sends a noise byte the HC05 may give on connecting (or a lone sync byte), then the letters of a button held
+/// down in the letter-only app, and counts the letters lost.
+/// @return [int] number of noise bytes after which a letter was still lost past the frame the noise can be,
+/// or after which a NUL cost any letter.
+inline int checkNoiseBeforeLetters() {
+    const uint8_t noise[] = {0x00, 0x01, '\r', 0x1F, CommandParser::SYNC_BYTE};
+    const int letters = 2 * CommandParser::MAX_FRAME_PAYLOAD;
+    int failures = 0, worstLost = 0;
+    for (unsigned int i = 0; i < sizeof(noise) / sizeof(noise[0]); i++) {
+        CommandParser parser;
+        uint8_t bytes[1 + letters + 1];
+        bytes[0] = noise[i];
+        for (int j = 1; j <= letters; j++) bytes[j] = 'F';
+        bytes[letters + 1] = 'S';
+        int lost = letters + 1 - commandsDecoded(parser, bytes, sizeof(bytes));
+        Command command;
+        bool stopped = parser.feed('S') && parser.next(command) && command.opcode == CommandOpcode::DRIVE_STOP;
+        if (lost > worstLost) worstLost = lost;
+        if (!stopped || lost > CommandParser::MAX_FRAME_PAYLOAD + 2 || (noise[i] == 0x00 && lost != 0)) {
+            std::printf("  FAILED: after a 0x%02X, %d letters were lost%s\n", noise[i], lost,
+                stopped ? "" : " and the next 'S' did not stop");
+            failures++;
+        }
+    }
+    benchmark::report("letters lost after a noise byte, at most", worstLost, "");
+    return failures;
+}
+
+/// @return [int] number of known opcodes that [commandName] has no name for.
+inline int checkCommandNames() {
+    int failures = 0;
+    for (int opcode = 0; opcode < 256; opcode++) {
+        if (commandPayloadLength(opcode) >= 0 && std::strcmp(commandName(opcode), "unknown") == 0) {
+            std::printf("  FAILED: opcode 0x%02X has no name\n", opcode);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+/// @return [int] number of wrong wheel speeds given by proportional drive commands, and of broken frames
+/// decoded as commands or noise leaving letters undecoded, and of opcodes without a name.
+inline int run() {
+    benchmark::section("Command parser cost");
+    benchmark::report("legacy single-letter command", letterCostNs(), "ns");
+    for (int commands = 1; commands <= 16; commands *= 2) {
+        size_t frameSize;
+        double costNs = parseCostNs(commands, &frameSize);
+        char name[64];
+        std::snprintf(name, sizeof(name), "frame of %d commands (%u bytes), per frame", commands, (unsigned) frameSize);
+        benchmark::report(name, costNs, "ns");
+        std::snprintf(name, sizeof(name), "frame of %d commands, per byte", commands);
+        benchmark::report(name, costNs / frameSize, "ns");
+        std::snprintf(name, sizeof(name), "frame of %d commands, throughput", commands);
+        benchmark::report(name, commands * 1e3 / costNs, "Mcommands/s");
+    }
+
+    benchmark::section("Controller steps to act on a burst of commands");
+    for (int commands = 2; commands <= 16; commands *= 2) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "%d commands, one letter per step", commands);
+        benchmark::report(name, stepsToDrain(commands, true), "steps");
+        std::snprintf(name, sizeof(name), "%d commands, framed and drained", commands);
+        benchmark::report(name, stepsToDrain(commands, false), "steps");
+    }
+
+    benchmark::section("Proportional (joystick) drive commands");
+    int failures = checkProportionalDrive();
+    return failures + checkLostSync() + checkNoiseBeforeLetters() + checkCommandNames();
+}
+
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "benchmark.hpp"
+#include "gpio_benchmark.hpp"
+#include "../interfaces/timer_pwm.hpp"
+
+/// <summary>
+/// @file pwm_benchmark.hpp
+/// @brief Simulated-AVR comparison of the drive's enable pins on analogWrite() and on [TimerPwmOutput]s, with
+/// checks of the pin to timer map and of the timer set up.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details The map of [timer_pwm::timerOf] and [timer_pwm::channelOf] must agree with the mock HAL's copy of the
+/// core's pin tables, pins not on a 16-bit timer must be refused, the frequencies must come out with the
+/// prescaler and TOP expected, and wheels on Timer4 and Timer5 must get the same duty for every speed. Every
+/// check that fails counts as a failure. Reported beside them: the frequencies and pulse widths of the robot's
+/// enable pins both ways, and the counted cost of a speed change.
+
+namespace pwm_benchmark {
+
+/// Timer PWM frequency of the comparison.
+static const unsigned long FREQUENCY_HZ = 20000;
+
+/// Enable pins of the back driver rewired for timer PWM (Timer5's channels A and B), as main.cpp suggests.
+static const int BACK_ENABLE_LEFT_PIN = 46, BACK_ENABLE_RIGHT_PIN = 45;
+
+/// @return [int] number of pins whose timer or channel differs from the mock's pin table.
+inline int checkPinMap() {
+    static const uint8_t firstChannels[] = {hal::native::TIMER0A, hal::native::TIMER1A, hal::native::TIMER2A,
+        hal::native::TIMER3A, hal::native::TIMER4A, hal::native::TIMER5A};
+    int failures = 0;
+    for (int pin = 0; pin < hal::native::NUMBER_OF_PINS; pin++) {
+        uint8_t timer = timer_pwm::timerOf(pin);
+        uint8_t expected = hal::native::PIN_TO_TIMER[pin];
+        uint8_t mapped = timer == timer_pwm::NO_TIMER ? (uint8_t) hal::native::NOT_ON_TIMER
+            : uint8_t(firstChannels[timer] + timer_pwm::channelOf(pin));
+        if (mapped != expected) {
+            std::printf("  FAILED: pin %d mapped to timer %d channel %d\n", pin, timer, timer_pwm::channelOf(pin));
+            failures++;
+        }
+    }
+    // Refused: Timer0 (millis()), Timer2 (8-bit) and pins without a timer.
+    const int refused[] = {4, 13, 9, 10, 18, 19, 22};
+    for (unsigned int i = 0; i < sizeof(refused) / sizeof(refused[0]); i++) {
+        TimerPwmOutput output;
+        if (output.attach(refused[i], FREQUENCY_HZ)) {
+            std::printf("  FAILED: timer PWM on pin %d accepted\n", refused[i]);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+/// @return [int] number of frequencies set up with another prescaler or TOP than expected.
+inline int checkFrequencies() {
+    // Frequency, clock select bits and TOP: the smallest prescaler whose period fits in 16 bits.
+    static const unsigned long expected[][3] = {{20000, 1, 799}, {25000, 1, 639}, {62500, 1, 255}, {1000, 1, 15999},
+        {245, 1, 65305}, {200, 2, 9999}, {100, 2, 19999}, {20, 3, 12499}, {62501, 0, 0}, {0, 0, 0}};
+    int failures = 0;
+    for (unsigned int i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        unsigned long frequencyHz = expected[i][0];
+        if (timer_pwm::clockSelectFor(frequencyHz) != expected[i][1] || timer_pwm::topFor(frequencyHz) != expected[i][2]) {
+            std::printf("  FAILED: %lu Hz set up with clock select %d and TOP %u\n", frequencyHz,
+                timer_pwm::clockSelectFor(frequencyHz), timer_pwm::topFor(frequencyHz));
+            failures++;
+        }
+    }
+    return failures;
+}
+
+/// @return [int] 1 if wheels on Timer4 and Timer5 get different duties for a speed, or a duty off the speed
+/// by more than a step.
+inline int checkDutyMatch() {
+    hal::native::resetGpio();
+    TimerPwmOutput front, back;
+    front.attach(6, FREQUENCY_HZ);
+    back.attach(BACK_ENABLE_LEFT_PIN, FREQUENCY_HZ);
+    int worst = 0;
+    bool matched = true;
+    for (int speed = 0; speed <= 255; speed++) {
+        front.write(speed);
+        back.write(speed);
+        int frontDuty = hal::native::outputDuty(6), backDuty = hal::native::outputDuty(BACK_ENABLE_LEFT_PIN);
+        if (frontDuty != backDuty) matched = false;
+        int error = frontDuty > speed ? frontDuty - speed : speed - frontDuty;
+        if (error > worst) worst = error;
+    }
+    benchmark::report("timer PWM duty, Timer4 and Timer5 pins alike", matched ? 1 : 0, "");
+    benchmark::report("timer PWM duty, largest error over speeds 0-255", worst, "steps");
+    if (!matched || worst > 1) {
+        std::printf("  FAILED: the duties of a speed differ between timers, or from the speed\n");
+        return 1;
+    }
+    return 0;
+}
+
+/// Alternating speeds, so every command changes only the enable pins' duties.
+template <typename Drive>
+inline void speedChanges(Drive &drive) {
+    drive.forward(100);
+    drive.forward(200);
+}
+
+/// @brief Reports the counted work of a speed change of the 4-wheel drive.
+template <typename Drive>
+inline void reportSpeedChange(const char *name, Drive &drive) {
+    speedChanges(drive);
+    hal::native::resetCounters();
+    speedChanges(drive);
+    const hal::native::Counters counted = hal::native::counters();
+    double cycles = (double(counted.flashReads) * gpio_benchmark::CYCLES_PER_FLASH_READ
+        + double(counted.ioReads + counted.ioWrites) * gpio_benchmark::CYCLES_PER_IO_ACCESS
+        + double(counted.interruptLocks) * gpio_benchmark::CYCLES_PER_INTERRUPT_LOCK) / 2;
+    char label[96];
+    std::snprintf(label, sizeof(label), "est. AVR cycles per speed change, %s", name);
+    benchmark::report(label, cycles, "cycles");
+}
+
+/// @return [int] number of failed checks.
+inline int run() {
+    bool consoleEnabled = hal::native::consoleEnabled();
+    hal::native::consoleEnabled() = false;
+    benchmark::section("Drive enable PWM: analogWrite() vs timer PWM on the 16-bit timers");
+    int failures = checkPinMap();
+    failures += checkFrequencies();
+
+    hal::native::resetGpio();
+    FastL298NInterface front(2, 3, 4, 5, 6, 7), back(14, 15, 16, 17, 18, 19);
+    FastL298NInterface *drivers[] = {&front, &back};
+    NDualWheelDrive<FastL298NInterface, 2> drive(drivers);
+    drive.forward(128);
+    benchmark::report("analogWrite(): frequency, front enable pin 6 (Timer4)", hal::native::pwmFrequencyHz(6), "Hz");
+    benchmark::report("analogWrite(): frequency, pin 4 (Timer0)", hal::native::pwmFrequencyHz(4), "Hz");
+    benchmark::report("analogWrite(): frequency, back enable pin 18 (no timer)", hal::native::pwmFrequencyHz(18), "Hz");
+    benchmark::report("analogWrite(): duty at speed 128, back enable pin 18", hal::native::outputDuty(18), "");
+    benchmark::report("analogWrite(): pulse at speed 128, pin 6 (Timer4)",
+        1e6 * hal::native::outputDuty(6) / 255 / hal::native::pwmFrequencyHz(6), "us");
+    reportSpeedChange("analogWrite()", drive);
+
+    hal::native::resetGpio();
+    FastL298NInterface timerFront(2, 3, 4, 5, 6, 7, FREQUENCY_HZ);
+    FastL298NInterface timerBack(14, 15, 16, 17, BACK_ENABLE_LEFT_PIN, BACK_ENABLE_RIGHT_PIN, FREQUENCY_HZ);
+    FastL298NInterface *timerDrivers[] = {&timerFront, &timerBack};
+    NDualWheelDrive<FastL298NInterface, 2> timerDrive(timerDrivers);
+    timerDrive.forward(128);
+    benchmark::report("timer PWM: frequency, front enable pin 6 (Timer4)", hal::native::pwmFrequencyHz(6), "Hz");
+    benchmark::report("timer PWM: frequency, back enable pin 46 (Timer5)", hal::native::pwmFrequencyHz(46), "Hz");
+    benchmark::report("timer PWM: duty steps per period", timer_pwm::topFor(FREQUENCY_HZ) + 1, "");
+    benchmark::report("timer PWM: pulse at speed 128, every timer",
+        1e6 * hal::native::outputDuty(46) / 255 / hal::native::pwmFrequencyHz(46), "us");
+    if (hal::native::pwmFrequencyHz(6) != FREQUENCY_HZ || hal::native::pwmFrequencyHz(BACK_ENABLE_RIGHT_PIN) != FREQUENCY_HZ
+        || hal::native::outputDuty(6) != 128 || hal::native::outputDuty(BACK_ENABLE_RIGHT_PIN) != 128) {
+        std::printf("  FAILED: the drive's enable pins do not run at %lu Hz with the speed's duty\n", FREQUENCY_HZ);
+        failures++;
+    }
+    reportSpeedChange("timer PWM", timerDrive);
+    timerDrive.stop();
+    failures += checkDutyMatch();
+    hal::native::resetGpio();
+    hal::native::consoleEnabled() = consoleEnabled;
+    return failures;
+}
+
+}
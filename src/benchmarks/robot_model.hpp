@@ -0,0 +1,239 @@
+#pragma once
+
+#include <cmath>
+#include "../interfaces/hal/hal.hpp"
+
+/// <summary>
+/// @file robot_model.hpp
+/// @brief Simple physical model of the robot's differential drive, driven by the mock HAL's motor pins.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details The model reads the L298N direction and enable pins of one motor driver (both wheels of a side
+/// turn together), turns the duty into a wheel speed with a dead band and a first-order motor lag, and
+/// integrates the pose of the robot. Wheel speed changes are also limited to what the tyres can transmit:
+/// the wheel surfaces follow the motors, the ground speeds lag behind them while the tyres slip. A skid-steer
+/// chassis also turns slower than its wheel speeds suggest ([DriveParameters::turnEfficiency]). The right side
+/// can be given its own gain and dead band ([setRightMotor]), as mismatched motors have. Optional
+/// wheel encoders toggle their mock HAL inputs from the travel of the wheel surfaces ([attachEncoders]).
+/// Units are metres, seconds and radians. The lifter claw has its own model ([LifterModel]), with the limit
+/// switches and potentiometer it moves.
+
+namespace robot_model {
+
+/// Pins of the motor driver the model reads the wheel commands from, as given to [FastL298NInterface].
+struct DrivePins {
+    uint8_t leftForward, leftBackward, rightForward, rightBackward, enableLeft, enableRight;
+};
+
+/// Physical parameters of the drive.
+struct DriveParameters {
+    /// Distance between the left and right wheels.
+    double trackWidth;
+    /// Wheel ground speed at full duty.
+    double maxSpeed;
+    /// Duty below which the motors do not turn.
+    int deadBand;
+    /// Time constant of the motor speed response.
+    double motorLag;
+    /// Largest change of wheel speed per second the tyres transmit before slipping.
+    double maxAcceleration;
+    /// Fraction of the turn rate given by the wheel ground speeds that the chassis turns at, as the tyres
+    /// scrub sideways. 1 for an ideal differential drive.
+    double turnEfficiency;
+};
+
+/// Parameters of a small geared DC motor robot like ours.
+inline DriveParameters defaultDriveParameters() {
+    DriveParameters parameters = {0.18, 1.0, 30, 0.06, 3.0, 1.0};
+    return parameters;
+}
+
+/// @class DriveModel
+/// @brief Pose and wheel speeds of the modelled robot.
+class DriveModel {
+private:
+    DrivePins pins;
+
+    DriveParameters parameters;
+
+    /// Full speed of the right side as a fraction of the left's, and its dead band.
+    double rightGain;
+    int rightDeadBand;
+
+    /// Encoder pins, 0 if not attached, distance of wheel surface per edge, and travel since the last edge.
+    uint8_t leftEncoderPin, rightEncoderPin;
+    double metresPerEdge, leftTravel, rightTravel;
+
+    /// Moves a wheel speed towards [target] with the motor lag, limited by the tyre grip if [grip].
+    double respond(double speed, double target, double dt, bool grip = true) const {
+        double change = (target - speed) * dt / (parameters.motorLag + dt);
+        double limit = parameters.maxAcceleration * dt;
+        if (grip) change = change > limit ? limit : (change < -limit ? -limit : change);
+        return speed + change;
+    }
+
+    /// Adds the travel of a wheel surface, toggling its encoder input on every [metresPerEdge].
+    void turnEncoder(uint8_t pin, double &travel, double distance) {
+        if (pin == 0) return;
+        travel += std::fabs(distance);
+        while (travel >= metresPerEdge) {
+            travel -= metresPerEdge;
+            hal::native::setDigitalInput(pin, hal::digitalRead(pin) == LOW ? HIGH : LOW);
+        }
+    }
+
+    /// Signed wheel speed a side is commanded to, with full speed [gain] times [DriveParameters::maxSpeed].
+    double commandedSpeed(uint8_t forwardPin, uint8_t backwardPin, uint8_t enablePin, double gain, int deadBand) const {
+        int direction = (hal::native::outputLevel(forwardPin) ? 1 : 0) - (hal::native::outputLevel(backwardPin) ? 1 : 0);
+        int duty = hal::native::outputDuty(enablePin);
+        if (direction == 0 || duty <= deadBand) return 0;
+        return direction * gain * parameters.maxSpeed * (duty - deadBand) / (255.0 - deadBand);
+    }
+
+public:
+    double x, y, heading;
+
+    /// Ground speeds of the wheels.
+    double leftSpeed, rightSpeed;
+
+    /// Surface speeds of the wheels, which differ from the ground speeds while the tyres slip.
+    double leftSurfaceSpeed, rightSurfaceSpeed;
+
+    DriveModel(const DrivePins &pins, const DriveParameters &parameters) : pins(pins), parameters(parameters) {
+        rightGain = 1;
+        rightDeadBand = parameters.deadBand;
+        leftEncoderPin = rightEncoderPin = 0;
+        metresPerEdge = 1;
+        place(0, 0, 0);
+    }
+
+    /// @brief Turns single channel wheel encoder inputs on [leftPin] and [rightPin], with an edge every
+    /// [metresPerEdge] of wheel surface travel.
+    void attachEncoders(uint8_t leftPin, uint8_t rightPin, double metresPerEdge) {
+        leftEncoderPin = leftPin;
+        rightEncoderPin = rightPin;
+        this->metresPerEdge = metresPerEdge;
+        leftTravel = rightTravel = 0;
+    }
+
+    /// @brief Mismatches the right side: its full speed is [gain] times the left's, and it turns from [deadBand].
+    void setRightMotor(double gain, int deadBand) {
+        rightGain = gain;
+        rightDeadBand = deadBand;
+    }
+
+    /// @brief Puts the robot at rest at a pose.
+    void place(double x, double y, double heading) {
+        this->x = x;
+        this->y = y;
+        this->heading = heading;
+        leftSpeed = 0;
+        rightSpeed = 0;
+        leftSurfaceSpeed = 0;
+        rightSurfaceSpeed = 0;
+    }
+
+    /// @brief Advances the model by [dt] seconds under the current pin outputs.
+    void step(double dt) {
+        double left = commandedSpeed(pins.leftForward, pins.leftBackward, pins.enableLeft, 1, parameters.deadBand);
+        double right = commandedSpeed(pins.rightForward, pins.rightBackward, pins.enableRight, rightGain, rightDeadBand);
+        leftSpeed = respond(leftSpeed, left, dt);
+        rightSpeed = respond(rightSpeed, right, dt);
+        leftSurfaceSpeed = respond(leftSurfaceSpeed, left, dt, false);
+        rightSurfaceSpeed = respond(rightSurfaceSpeed, right, dt, false);
+        turnEncoder(leftEncoderPin, leftTravel, leftSurfaceSpeed * dt);
+        turnEncoder(rightEncoderPin, rightTravel, rightSurfaceSpeed * dt);
+        double speed = (leftSpeed + rightSpeed) / 2;
+        double turnRate = (rightSpeed - leftSpeed) * parameters.turnEfficiency / parameters.trackWidth;
+        x += speed * std::cos(heading) * dt;
+        y += speed * std::sin(heading) * dt;
+        heading += turnRate * dt;
+    }
+
+    /// @return [double] x of a point fixed to the robot, [forward] ahead of the axle and [left] to its left.
+    double bodyX(double forward, double left) const {
+        return x + forward * std::cos(heading) - left * std::sin(heading);
+    }
+
+    /// @return [double] y of a point fixed to the robot, [forward] ahead of the axle and [left] to its left.
+    double bodyY(double forward, double left) const {
+        return y + forward * std::sin(heading) + left * std::cos(heading);
+    }
+};
+
+/// Pins of the lifter's motor driver, as given to [L298NInterface], and of its feedback, -1 where not fitted.
+struct LifterPins {
+    uint8_t up, down;
+    int lowerLimit, upperLimit, potentiometer;
+};
+
+/// @class LifterModel
+/// @brief Position of the modelled lifter claw, driven by the mock HAL's lifter pins, and its feedback.
+///
+/// @details The claw moves at a steady speed while its motor is driven, slower as the battery drains
+/// ([supply]), and stops at the ends of its travel or where it jams ([jamAt]). The limit switches read LOW
+/// while pressed, the potentiometer from [POTENTIOMETER_DOWN] to [POTENTIOMETER_UP]. The time the motor is
+/// driven without the claw moving is counted ([stalledSeconds]). Positions run from 0 (down) to 1 (up).
+class LifterModel {
+public:
+    static const int POTENTIOMETER_DOWN = 120, POTENTIOMETER_UP = 900;
+
+    LifterPins pins;
+
+    /// Seconds of a full travel up and down on a fresh battery.
+    double upSeconds, downSeconds;
+
+    /// Speed of the motor as a fraction of a fresh battery's.
+    double supply;
+
+    /// Position the claw jams at on its way up, above 1 for none.
+    double jamAt;
+
+    double position;
+
+    double stalledSeconds;
+
+    LifterModel(const LifterPins &pins, double upSeconds, double downSeconds) {
+        this->pins = pins;
+        this->upSeconds = upSeconds;
+        this->downSeconds = downSeconds;
+        supply = 1;
+        jamAt = 2;
+        position = 0;
+        stalledSeconds = 0;
+        writeFeedback();
+    }
+
+    /// @return [int] direction the motor is driven: 1 up, -1 down, 0 stopped.
+    int direction() const {
+        bool up = hal::native::outputLevel(pins.up), down = hal::native::outputLevel(pins.down);
+        return up == down ? 0 : (up ? 1 : -1);
+    }
+
+    /// @brief Advances the model by [dt] seconds under the current pin outputs.
+    void step(double dt) {
+        int driven = direction();
+        if (driven == 0) return;
+        double top = jamAt < 1 ? jamAt : 1;
+        double next = position + driven * supply * dt / (driven > 0 ? upSeconds : downSeconds);
+        if (next < 0) next = 0;
+        if (driven > 0 && next > top) next = position > top ? position : top;
+        if (next == position) stalledSeconds += dt;
+        position = next;
+        writeFeedback();
+    }
+
+    /// @brief Sets the limit switch and potentiometer inputs from [position].
+    void writeFeedback() const {
+        if (pins.lowerLimit != -1) hal::native::setDigitalInput(pins.lowerLimit, position <= 0 ? LOW : HIGH);
+        if (pins.upperLimit != -1) hal::native::setDigitalInput(pins.upperLimit, position >= 1 ? LOW : HIGH);
+        if (pins.potentiometer != -1) {
+            hal::native::setAnalogInput(pins.potentiometer,
+                (int) std::lround(POTENTIOMETER_DOWN + position * (POTENTIOMETER_UP - POTENTIOMETER_DOWN)));
+        }
+    }
+};
+
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <thread>
+#include "benchmark.hpp"
+#include "../utils/task_scheduler.hpp"
+
+/// <summary>
+/// @file scheduler_benchmark.hpp
+/// @brief Host benchmark of the [TaskScheduler] tick overhead and the worst-case loop latency of
+/// a timed manoeuvre written with delay() versus as a [Timer] driven state machine.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+
+namespace scheduler_benchmark {
+
+static volatile unsigned long taskRuns = 0;
+
+static void emptyTask(void *) { taskRuns = taskRuns + 1; }
+
+/// Average cost of one [TaskScheduler::tick] with [numberOfTasks] tasks that are all due (interval 0)
+/// or none due (interval of an hour).
+inline double tickCostNs(int numberOfTasks, bool due) {
+    TaskScheduler scheduler;
+    for (int i = 0; i < numberOfTasks; i++) scheduler.every(due ? 0 : 3600000UL, emptyTask);
+    const long iterations = 1000000;
+    long long start = benchmark::nowNs();
+    for (long i = 0; i < iterations; i++) scheduler.tick();
+    return double(benchmark::nowNs() - start) / iterations;
+}
+
+/// Manoeuvre segment lengths in milliseconds, a scaled down version of the pick-up sequence.
+static const unsigned long SEGMENTS_MS[] = {10, 9, 30, 42};
+static const int NUMBER_OF_SEGMENTS = sizeof(SEGMENTS_MS) / sizeof(SEGMENTS_MS[0]);
+
+/// Largest gap in microseconds between two passes of the loop while the manoeuvre is performed with
+/// blocking sleeps, as the controllers did with delay().
+inline unsigned long blockingWorstLatencyUs() {
+    unsigned long worst = 0, last = hal::micros();
+    for (int i = 0; i < NUMBER_OF_SEGMENTS; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(SEGMENTS_MS[i]));
+        unsigned long now = hal::micros();
+        if (now - last > worst) worst = now - last;
+        last = now;
+    }
+    return worst;
+}
+
+/// State of the non-blocking version of the same manoeuvre.
+struct Manoeuvre {
+    Timer timer;
+    int segment;
+};
+
+static void manoeuvreTask(void *context) {
+    Manoeuvre *manoeuvre = (Manoeuvre *) context;
+    if (manoeuvre->segment >= NUMBER_OF_SEGMENTS || !manoeuvre->timer.hasExpired()) return;
+    manoeuvre->segment++;
+    if (manoeuvre->segment < NUMBER_OF_SEGMENTS) manoeuvre->timer.start(SEGMENTS_MS[manoeuvre->segment]);
+}
+
+/// Largest gap in microseconds between two passes of the loop while the same manoeuvre runs as a
+/// scheduled state machine next to a sensor task and a 10 ms status task.
+inline unsigned long scheduledWorstLatencyUs(unsigned long *passes) {
+    TaskScheduler scheduler;
+    Manoeuvre manoeuvre;
+    manoeuvre.segment = 0;
+    manoeuvre.timer.start(SEGMENTS_MS[0]);
+    scheduler.every(0, manoeuvreTask, &manoeuvre);
+    scheduler.every(0, emptyTask);
+    scheduler.every(10, emptyTask);
+
+    unsigned long worst = 0, last = hal::micros();
+    *passes = 0;
+    while (manoeuvre.segment < NUMBER_OF_SEGMENTS) {
+        scheduler.tick();
+        unsigned long now = hal::micros();
+        if (now - last > worst) worst = now - last;
+        last = now;
+        (*passes)++;
+    }
+    return worst;
+}
+
+inline void run() {
+    // Timers and latencies here are measured in host time, not the mock HAL's virtual time.
+    hal::native::setRealTime(true);
+    benchmark::section("TaskScheduler tick overhead");
+    for (int tasks = 0; tasks <= TaskScheduler::MAX_NUMBER_OF_TASKS; tasks += 2) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "tick, %d tasks, all due", tasks);
+        benchmark::report(name, tickCostNs(tasks, true), "ns");
+        std::snprintf(name, sizeof(name), "tick, %d tasks, none due", tasks);
+        benchmark::report(name, tickCostNs(tasks, false), "ns");
+    }
+
+    benchmark::section("Worst-case loop latency during a manoeuvre");
+    benchmark::report("blocking delay() manoeuvre", blockingWorstLatencyUs(), "us");
+    unsigned long passes;
+    benchmark::report("scheduled state machine manoeuvre", scheduledWorstLatencyUs(&passes), "us");
+    benchmark::report("loop passes during scheduled manoeuvre", passes, "");
+    hal::native::setRealTime(false);
+}
+
+}
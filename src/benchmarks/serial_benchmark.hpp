@@ -0,0 +1,141 @@
+#pragma once
+
+#include <vector>
+#include "benchmark.hpp"
+#include "../interfaces/bluetooth_interface.hpp"
+#include "../utils/telemetry.hpp"
+
+/// <summary>
+/// @file serial_benchmark.hpp
+/// @brief Bytes per second and per-byte CPU cost of the Bluetooth link on each [SerialTransport] backend.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details The AVR side is a cost model, as there is no Mega in the loop: a SoftwareSerial byte costs its
+/// pin change interrupt, which busy-waits with interrupts off from the start bit into the stop bit (about 9.5
+/// bit times, plus entry and exit), while a hardware UART byte costs only the core's USART receive interrupt.
+/// The cycle counts are estimates from the Arduino core's generated code. SoftwareSerial also sends each byte
+/// with interrupts off, so a byte whose start bit arrives meanwhile is lost: the link is modelled for a second of
+/// [Telemetry] frames sent while joystick frames arrive, counting the received bytes and frames lost. The host
+/// side measures the [BluetoothInterface] receive path through each transport on the mock HAL.
+
+namespace serial_benchmark {
+
+static const double CPU_HZ = 16000000.0;
+
+/// Estimated cycles of the SoftwareSerial receive interrupt besides its bit-time waits.
+static const double SOFTWARE_ISR_OVERHEAD_CYCLES = 120;
+
+/// Estimated cycles of the core's USART receive interrupt, prologue and epilogue included.
+static const double HARDWARE_ISR_CYCLES = 80;
+
+/// Estimated cycles for loop() to take a byte out of either backend's buffer through the transport.
+static const double READ_CYCLES = 60;
+
+struct Backend {
+    const char *name;
+    long baud;
+    bool software;
+};
+
+static const Backend BACKENDS[] = {
+    {"SoftwareSerial", 9600, true},
+    {"SoftwareSerial", 38400, true},
+    {"SoftwareSerial", 57600, true},
+    {"hardware UART", 115200, false},
+    {"hardware UART", 230400, false},
+    {"hardware UART", 460800, false}
+};
+
+/// Modelled time in microseconds interrupts are held off by receiving one byte.
+inline double interruptsOffUs(const Backend &backend) {
+    if (backend.software) return 9.5 * 1e6 / backend.baud + SOFTWARE_ISR_OVERHEAD_CYCLES * 1e6 / CPU_HZ;
+    return HARDWARE_ISR_CYCLES * 1e6 / CPU_HZ;
+}
+
+/// Modelled CPU time in microseconds spent on one received byte.
+inline double cpuPerByteUs(const Backend &backend) {
+    return interruptsOffUs(backend) + READ_CYCLES * 1e6 / CPU_HZ;
+}
+
+/// Joystick frames the controlling application sends while it drives: 6 bytes, 50 times a second.
+static const int JOYSTICK_FRAME_SIZE = 6;
+static const long JOYSTICK_PERIOD_US = 20000;
+
+/// @brief Models a second of [Telemetry] frames sent every [Telemetry::DEFAULT_SAMPLE_PERIOD_MS] while joystick
+/// frames arrive, their bytes back to back at the line rate. A SoftwareSerial byte is sent with interrupts off,
+/// so a byte whose start bit arrives during it is only seen afterwards, mid-character, and lost; a hardware
+/// UART receives while it sends.
+/// @param framesLost [int*] set to the number of joystick frames a lost byte broke.
+/// @return [int] number of received bytes lost.
+inline int bytesLostWhileSending(const Backend &backend, int *framesLost) {
+    const double byteUs = 10 * 1e6 / backend.baud;
+    const long telemetryPeriodUs = Telemetry::DEFAULT_SAMPLE_PERIOD_MS * 1000;
+    int lost = 0;
+    *framesLost = 0;
+    for (long frameStart = 0; frameStart < 1000000; frameStart += JOYSTICK_PERIOD_US) {
+        bool broken = false;
+        for (int i = 0; i < JOYSTICK_FRAME_SIZE; i++) {
+            double startBit = frameStart + i * byteUs;
+            double sinceRecord = startBit - (long) (startBit / telemetryPeriodUs) * telemetryPeriodUs;
+            if (backend.software && sinceRecord < TelemetryRecord::FRAME_SIZE * byteUs) {
+                lost++;
+                broken = true;
+            }
+        }
+        if (broken) (*framesLost)++;
+    }
+    return lost;
+}
+
+/// Host time in nanoseconds per byte for [bluetooth] to receive a stream of single-letter commands fed to [port].
+inline double receiveCostNs(BluetoothInterface &bluetooth, hal::native::SerialPort &port) {
+    std::vector<uint8_t> chunk(4096, 'F');
+    const int chunks = 250;
+    Command command;
+    unsigned long received = 0;
+    long long elapsed = 0;
+    for (int i = 0; i < chunks; i++) {
+        port.inject(chunk.data(), chunk.size());
+        long long start = benchmark::nowNs();
+        while (bluetooth.receiveCommand(command)) received++;
+        elapsed += benchmark::nowNs() - start;
+    }
+    benchmark::doNotOptimize(received);
+    return double(elapsed) / (chunk.size() * chunks);
+}
+
+inline void run() {
+    benchmark::section("Bluetooth link per backend (AVR cost model)");
+    for (unsigned int i = 0; i < sizeof(BACKENDS) / sizeof(BACKENDS[0]); i++) {
+        const Backend &backend = BACKENDS[i];
+        double bytesPerSecond = backend.baud / 10.0;
+        char name[64];
+        std::snprintf(name, sizeof(name), "%s %ld: line rate", backend.name, backend.baud);
+        benchmark::report(name, bytesPerSecond, "bytes/s");
+        std::snprintf(name, sizeof(name), "%s %ld: CPU per byte", backend.name, backend.baud);
+        benchmark::report(name, cpuPerByteUs(backend), "us");
+        std::snprintf(name, sizeof(name), "%s %ld: interrupts off per byte", backend.name, backend.baud);
+        benchmark::report(name, interruptsOffUs(backend), "us");
+        std::snprintf(name, sizeof(name), "%s %ld: CPU load at line rate", backend.name, backend.baud);
+        benchmark::report(name, 100.0 * cpuPerByteUs(backend) * bytesPerSecond / 1e6, "%");
+        int framesLost;
+        int bytesLost = bytesLostWhileSending(backend, &framesLost);
+        std::snprintf(name, sizeof(name), "%s %ld: bytes lost to telemetry, per s", backend.name, backend.baud);
+        benchmark::report(name, bytesLost, "B");
+        std::snprintf(name, sizeof(name), "%s %ld: joystick frames lost, per s", backend.name, backend.baud);
+        benchmark::report(name, framesLost, "");
+    }
+
+    benchmark::section("BluetoothInterface receive path per transport (host)");
+    SoftwareSerialTransport softwareTransport(10, 11, 57600);
+    BluetoothInterface softwareBluetooth(&softwareTransport);
+    benchmark::report("SoftwareSerialTransport, per byte",
+        receiveCostNs(softwareBluetooth, *hal::native::findSerial(10)), "ns");
+    HardwareSerialTransport hardwareTransport(hal::serial2(), 460800);
+    BluetoothInterface hardwareBluetooth(&hardwareTransport);
+    benchmark::report("HardwareSerialTransport, per byte", receiveCostNs(hardwareBluetooth, hal::serial2()), "ns");
+}
+
+}
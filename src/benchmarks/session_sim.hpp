@@ -0,0 +1,301 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include "benchmark.hpp"
+#include "robot_model.hpp"
+#include "odometry_sim.hpp"
+#include "../controllers/bluetooth_controller.hpp"
+#include "../utils/session_recording.hpp"
+
+/// <summary>
+/// @file session_sim.hpp
+/// @brief Host simulation of recording a Bluetooth driving session and replaying it, straight after and after
+/// a reboot from EEPROM.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details A route of held buttons, lifter moves and 50 Hz joystick frames is driven over the mocked link
+/// between 'M' and 'm', the modelled wheel speeds and lifter sampled every 10 ms. 'Y' replays it; the robot is
+/// then rebuilt (a reboot), loading the session from the mock EEPROM, and replays it again. Both replays must
+/// follow the live wheel speeds and end where the live run ended. A session recorded in RAM only must stop
+/// itself when full, a corrupted session must not be loaded, and a drive command must abort a replay. The
+/// host time of [SessionRecorder::record] and the EEPROM use are reported. Every check that fails counts as a
+/// failure.
+
+namespace session_sim {
+
+/// SoftwareSerial pins of the simulation, clear of the ports other benchmarks keep open.
+static const uint8_t BLUETOOTH_RX_PIN = 46, BLUETOOTH_TX_PIN = 47;
+
+/// Pins of the lifter motor driver.
+static const uint8_t LIFTER_UP_PIN = 40, LIFTER_DOWN_PIN = 41;
+
+/// Length of the route, from 'M' to 'm', and the sample period of the traces.
+static const unsigned long ROUTE_MS = 6000;
+static const unsigned long SAMPLE_MS = 10;
+
+/// Largest gaps allowed between a replay and the live run: wheel speed at any sample, and end pose.
+static const double MAX_SPEED_ERROR = 0.02;
+static const double MAX_POSITION_ERROR_MM = 10;
+static const double MAX_HEADING_ERROR_DEG = 1;
+
+/// The robot as setup() builds it for the BLUETOOTH Control Mode, with one motor driver, the lifter and the model
+/// it moves. Building one is a boot: the session is loaded from EEPROM.
+struct Robot {
+    FastL298NInterface driver;
+    FastL298NInterface *drivers[1];
+    NDualWheelDrive<FastL298NInterface, 1> drive;
+    L298NInterface lifterDriver;
+    LifterInterface lifter;
+    SoftwareSerialTransport transport;
+    BluetoothInterface bluetooth;
+    BluetoothController controller;
+    SessionRecorder recorder;
+    bool loaded;
+    SessionReplayer replayer;
+    robot_model::DriveModel model;
+    unsigned long ms;
+
+    explicit Robot(bool spillToEeprom) : driver(2, 3, 4, 5, 6, 7), drivers{&driver}, drive(drivers),
+        lifterDriver(LIFTER_UP_PIN, LIFTER_DOWN_PIN, 42, 43, 44, 45), lifter(&lifterDriver),
+        transport(BLUETOOTH_RX_PIN, BLUETOOTH_TX_PIN, 9600), bluetooth(&transport),
+        controller(&bluetooth, &drive, &lifter), recorder(spillToEeprom), loaded(recorder.load()),
+        replayer(&recorder), model(drivePins(), driveParameters()), ms(0) {
+        drive.setRamp(1000, 2000);
+        controller.setSession(&recorder, &replayer);
+    }
+
+    static robot_model::DrivePins drivePins() {
+        robot_model::DrivePins pins = {2, 3, 4, 5, 6, 7};
+        return pins;
+    }
+
+    static robot_model::DriveParameters driveParameters() {
+        robot_model::DriveParameters parameters = robot_model::defaultDriveParameters();
+        parameters.maxSpeed = odometry_sim::REFERENCE.maxSpeed;
+        parameters.turnEfficiency = odometry_sim::REFERENCE.turnEfficiency;
+        return parameters;
+    }
+
+    hal::native::SerialPort &port() {
+        return *hal::native::findSerial(BLUETOOTH_RX_PIN);
+    }
+
+    /// @brief Runs the robot for one millisecond: a controller step, the drive updates and the model.
+    void step() {
+        controller.step();
+        if (ms % DualWheelDriveBase::RAMP_PERIOD_MS == 0) drive.update();
+        model.step(0.001);
+        hal::native::advanceMicros(1000);
+        ms++;
+    }
+
+    void run(unsigned long durationMs) {
+        for (unsigned long end = ms + durationMs; ms < end;) step();
+    }
+
+    /// @return [int] direction the lifter motor is driven: 1 up, -1 down, 0 stopped.
+    static int lifterDirection() {
+        return hal::native::outputLevel(LIFTER_UP_PIN) ? 1 : (hal::native::outputLevel(LIFTER_DOWN_PIN) ? -1 : 0);
+    }
+};
+
+/// Wheel speeds in metres per second and lifter direction, sampled every [SAMPLE_MS].
+struct Sample {
+    double left, right;
+    int lifter;
+};
+
+/// A trace and the pose it ended at.
+struct Run {
+    std::vector<Sample> samples;
+    double x, y, headingDeg;
+};
+
+/// @brief Sends what the route sends at [elapsedMs] after 'M': held buttons repeated every 50 ms, the lifter
+/// raised and stopped, and joystick frames at 50 Hz let go to the deadman.
+inline void sendRoute(Robot &robot, unsigned long elapsedMs) {
+    if (elapsedMs < 1500) {
+        if (elapsedMs % 50 == 0) robot.port().inject("F");
+    } else if (elapsedMs == 1500) {
+        robot.port().inject("S");
+    } else if (elapsedMs == 1700) {
+        robot.port().inject("W");
+    } else if (elapsedMs == 2500) {
+        robot.port().inject("w");
+    } else if (elapsedMs >= 2600 && elapsedMs < 3600) {
+        if (elapsedMs % 20 == 0) {
+            uint8_t frame[8];
+            CommandFrameWriter writer(frame, sizeof(frame));
+            writer.addAxes(CommandOpcode::DRIVE_ARCADE, 90, (int) (elapsedMs - 2600) / 10 - 50);
+            robot.port().inject(frame, writer.finish());
+        }
+    } else if (elapsedMs == 4000) {
+        robot.port().inject("6");
+    } else if (elapsedMs > 4000 && elapsedMs < 5200) {
+        if (elapsedMs % 50 == 0) robot.port().inject("G");
+    } else if (elapsedMs == 5200) {
+        robot.port().inject("S");
+    }
+}
+
+/// @brief Runs [robot] for [ROUTE_MS] from the origin after [start] is sent, driving the route if [live].
+inline Run drive(Robot &robot, const char *start, bool live) {
+    Run run;
+    robot.model.place(0, 0, 0);
+    robot.port().inject(start);
+    for (unsigned long elapsedMs = 0; elapsedMs < ROUTE_MS; elapsedMs++) {
+        if (live && elapsedMs > 0) sendRoute(robot, elapsedMs);
+        if (elapsedMs % SAMPLE_MS == 0) {
+            Sample sample = {robot.model.leftSpeed, robot.model.rightSpeed, Robot::lifterDirection()};
+            run.samples.push_back(sample);
+        }
+        robot.step();
+    }
+    if (live) robot.port().inject("m");
+    robot.run(1000);
+    run.x = robot.model.x;
+    run.y = robot.model.y;
+    run.headingDeg = robot.model.heading * 180 / odometry_sim::PI;
+    return run;
+}
+
+/// @return [bool] true if [replay] follows [live] within the limits, after reporting how far it strays.
+inline bool compare(const Run &live, const Run &replay, const char *name) {
+    double speedError = 0;
+    int lifterMismatches = 0;
+    for (size_t i = 0; i < live.samples.size() && i < replay.samples.size(); i++) {
+        speedError = std::fmax(speedError, std::fabs(live.samples[i].left - replay.samples[i].left));
+        speedError = std::fmax(speedError, std::fabs(live.samples[i].right - replay.samples[i].right));
+        // The lifter switches on a millisecond, so one sample may fall either side of it.
+        if (live.samples[i].lifter != replay.samples[i].lifter) lifterMismatches++;
+    }
+    double positionError = std::hypot(live.x - replay.x, live.y - replay.y) * 1000;
+    double headingError = std::fabs(live.headingDeg - replay.headingDeg);
+    char label[96];
+    std::snprintf(label, sizeof(label), "%s: largest wheel speed gap", name);
+    benchmark::report(label, speedError, "m/s");
+    std::snprintf(label, sizeof(label), "%s: end position gap", name);
+    benchmark::report(label, positionError, "mm");
+    std::snprintf(label, sizeof(label), "%s: end heading gap", name);
+    benchmark::report(label, headingError, "deg");
+    std::snprintf(label, sizeof(label), "%s: lifter samples differing", name);
+    benchmark::report(label, lifterMismatches, "");
+    return replay.samples.size() == live.samples.size() && speedError <= MAX_SPEED_ERROR
+        && positionError <= MAX_POSITION_ERROR_MM && headingError <= MAX_HEADING_ERROR_DEG && lifterMismatches <= 2;
+}
+
+/// @return [int] number of failed checks of recording, replaying and reloading a session.
+inline int checkSession() {
+    int failures = 0;
+    hal::native::resetGpio();
+    hal::native::resetClock();
+    hal::native::resetEeprom();
+    Run live;
+    {
+        Robot robot(true);
+        if (robot.loaded) {
+            std::printf("  FAILED: a session loaded from an erased EEPROM\n");
+            failures++;
+        }
+        unsigned long writes = hal::native::eeprom().writes;
+        live = drive(robot, "M", true);
+        std::printf("  live route: ended at (%.3f, %.3f) m, heading %.1f deg\n", live.x, live.y, live.headingDeg);
+        int raising = 0;
+        for (size_t i = 0; i < live.samples.size(); i++) raising += live.samples[i].lifter == 1;
+        benchmark::report("  lifter raised", raising * SAMPLE_MS, "ms");
+        benchmark::report("session recorded", robot.recorder.getLength(), "bytes");
+        benchmark::report("  EEPROM bytes written, header included", hal::native::eeprom().writes - writes, "");
+        if (!robot.recorder.isStored() || robot.recorder.isFull()) {
+            std::printf("  FAILED: the session was not stored in EEPROM a second after 'm'\n");
+            failures++;
+        }
+
+        Run replay = drive(robot, "Y", false);
+        if (!compare(live, replay, "replay") || robot.port().transmitted().find("replay done") == std::string::npos) {
+            std::printf("  FAILED: the replay did not follow the live run\n");
+            failures++;
+        }
+    }
+    {
+        Robot rebooted(true);
+        Run replay = drive(rebooted, "Y", false);
+        if (!rebooted.loaded || !compare(live, replay, "replay after a reboot, from EEPROM")) {
+            std::printf("  FAILED: the session replayed after a reboot did not follow the live run\n");
+            failures++;
+        }
+
+        // A drive command received takes the wheels back from the replay.
+        rebooted.port().inject("Y");
+        rebooted.run(500);
+        rebooted.port().inject("S");
+        rebooted.run(1000);
+        if (rebooted.replayer.isReplaying() || std::fabs(rebooted.model.leftSpeed) > 0.001
+            || std::fabs(rebooted.model.rightSpeed) > 0.001) {
+            std::printf("  FAILED: 'S' did not abort the replay\n");
+            failures++;
+        }
+    }
+    // A flipped bit in the stored session fails the CRC: there is nothing to replay.
+    hal::native::eeprom().bytes[SessionRecorder::EEPROM_ADDRESS + 3 + 10] ^= 0x10;
+    {
+        Robot corrupted(true);
+        corrupted.port().inject("Y");
+        // The reply goes out a byte per step on SoftwareSerial.
+        corrupted.run(50);
+        if (corrupted.loaded || corrupted.port().transmitted().find("replay not started") == std::string::npos) {
+            std::printf("  FAILED: a corrupted session was loaded\n");
+            failures++;
+        }
+    }
+    {
+        // In RAM only, the route overflows the buffer: recording stops itself, and what it kept replays.
+        Robot ramOnly(false);
+        drive(ramOnly, "M", true);
+        benchmark::report("session recorded in RAM only", ramOnly.recorder.getLength(), "bytes");
+        ramOnly.port().inject("Y");
+        ramOnly.run(ROUTE_MS);
+        if (!ramOnly.recorder.isFull() || ramOnly.recorder.getLength() > SessionRecorder::BUFFER_SIZE
+            || ramOnly.replayer.isReplaying() || ramOnly.port().transmitted().find("replay done") == std::string::npos) {
+            std::printf("  FAILED: recording in RAM only did not stop itself when full\n");
+            failures++;
+        }
+    }
+    return failures;
+}
+
+/// @brief Reports the host time of a [SessionRecorder::record] of a joystick frame.
+inline void reportRecordCost() {
+    SessionRecorder recorder(false);
+    Command command = {CommandOpcode::DRIVE_ARCADE, {100, 20}};
+    const int repeats = 20000, commandsPerSession = 24;
+    long long elapsed = 0;
+    for (int r = 0; r < repeats; r++) {
+        recorder.start();
+        long long start = benchmark::nowNs();
+        for (int i = 0; i < commandsPerSession; i++) {
+            command.payload[1] = (uint8_t) i;
+            recorder.record(command);
+        }
+        elapsed += benchmark::nowNs() - start;
+        benchmark::doNotOptimize(recorder);
+    }
+    benchmark::report("SessionRecorder::record, host time per call", double(elapsed) / (repeats * commandsPerSession), "ns");
+}
+
+/// @return [int] number of failed checks.
+inline int run() {
+    bool consoleEnabled = hal::native::consoleEnabled();
+    hal::native::consoleEnabled() = false;
+    benchmark::section("Driving session record and replay (virtual time)");
+    int failures = checkSession();
+    reportRecordCost();
+    hal::native::resetGpio();
+    hal::native::resetEeprom();
+    hal::native::consoleEnabled() = consoleEnabled;
+    return failures;
+}
+
+}
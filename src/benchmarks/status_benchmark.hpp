@@ -0,0 +1,249 @@
+#pragma once
+
+#include "benchmark.hpp"
+#include <cstdlib>
+#include <cstring>
+#include "../interfaces/2N_wheel_drive_interface.hpp"
+
+/// <summary>
+/// @file status_benchmark.hpp
+/// @brief Heap use and cost of status reporting: the former String status fields versus [StatusCode] snapshots.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details The former reporting is reproduced by [LegacyMotorDriver]/[LegacyDrive], which keep a String status
+/// and build the concatenated getStatus() String exactly as the interfaces used to. Both sides run the same
+/// [NDualWheelDriveInterface] over motor drivers with empty primitives, the legacy side adding its String
+/// bookkeeping on top of each command, so the difference is the status bookkeeping swapped (the drive's own
+/// [StatusCode] stores, a few bytes, are left in the legacy side). Heap use is counted by [LegacyString], which
+/// grows like the Arduino core's String.
+
+namespace status_benchmark {
+
+/// Heap use counted by [LegacyString].
+struct Heap {
+    unsigned long allocations;
+    long liveBytes;
+    long peakBytes;
+};
+
+inline Heap &heap() {
+    static Heap instance = {0, 0, 0};
+    return instance;
+}
+
+inline void resetHeap() {
+    heap().allocations = 0;
+    heap().peakBytes = heap().liveBytes;
+}
+
+inline void heapResized(long fromBytes, long toBytes) {
+    heap().allocations++;
+    heap().liveBytes += toBytes - fromBytes;
+    if (heap().liveBytes > heap().peakBytes) heap().peakBytes = heap().liveBytes;
+}
+
+/// Heap-backed String that grows like the Arduino core's WString (realloc only when the capacity is exceeded,
+/// a copy for every temporary of a concatenation), counting its allocations in [heap].
+class LegacyString {
+private:
+    char *buffer;
+
+    unsigned int capacity;
+
+    unsigned int len;
+
+    void reserve(unsigned int size) {
+        if (buffer != NULL && capacity >= size) return;
+        heapResized(buffer == NULL ? 0 : capacity + 1, size + 1);
+        buffer = (char *) std::realloc(buffer, size + 1);
+        capacity = size;
+    }
+
+    void copy(const char *text, unsigned int length) {
+        reserve(length);
+        std::memcpy(buffer, text, length);
+        buffer[length] = '\0';
+        len = length;
+    }
+
+public:
+    LegacyString(const char *text = "") : buffer(NULL), capacity(0), len(0) { copy(text, std::strlen(text)); }
+
+    LegacyString(const LegacyString &other) : buffer(NULL), capacity(0), len(0) { copy(other.c_str(), other.len); }
+
+    explicit LegacyString(int value) : buffer(NULL), capacity(0), len(0) {
+        char digits[12];
+        std::snprintf(digits, sizeof(digits), "%d", value);
+        copy(digits, std::strlen(digits));
+    }
+
+    ~LegacyString() {
+        if (buffer != NULL) heapResized(capacity + 1, 0);
+        std::free(buffer);
+    }
+
+    LegacyString &operator=(const LegacyString &other) { if (this != &other) copy(other.c_str(), other.len); return *this; }
+
+    LegacyString &operator=(const char *text) { copy(text, std::strlen(text)); return *this; }
+
+    LegacyString &operator+=(const LegacyString &other) { return *this += other.c_str(); }
+
+    LegacyString &operator+=(const char *text) {
+        unsigned int extra = std::strlen(text);
+        reserve(len + extra);
+        std::memcpy(buffer + len, text, extra + 1);
+        len += extra;
+        return *this;
+    }
+
+    char operator[](unsigned int index) const { return index < len ? buffer[index] : '\0'; }
+
+    bool operator==(const char *text) const { return std::strcmp(c_str(), text) == 0; }
+
+    bool operator!=(const char *text) const { return !(*this == text); }
+
+    const char *c_str() const { return buffer != NULL ? buffer : ""; }
+
+    unsigned int length() const { return len; }
+};
+
+inline LegacyString operator+(const LegacyString &a, const LegacyString &b) { LegacyString sum(a); sum += b; return sum; }
+inline LegacyString operator+(const LegacyString &a, const char *b) { LegacyString sum(a); sum += b; return sum; }
+inline LegacyString operator+(const char *a, const LegacyString &b) { LegacyString sum(a); sum += b; return sum; }
+
+/// Motor driver with the former String status and no hardware.
+class LegacyMotorDriver {
+public:
+    LegacyString status;
+
+    LegacyMotorDriver() : status("ready") {}
+
+    void forward() { status = "forward"; }
+    void backward() { status = "backward"; }
+    void hardLeft() { status = "hard_left"; }
+    void stop() { status = "stop"; }
+    LegacyString getStatus() { return status; }
+};
+
+/// 2 Motor Driver drive system with the former String status and getStatus(), driving [drive] as the current
+/// one does.
+class LegacyDrive {
+public:
+    static const int NUMBER_OF_MOTOR_DRIVERS = 2;
+
+    DualWheelDriveBase &drive;
+
+    LegacyMotorDriver drivers[NUMBER_OF_MOTOR_DRIVERS];
+
+    LegacyString status;
+
+    explicit LegacyDrive(DualWheelDriveBase &drive) : drive(drive), status("ready") {}
+
+    void forward() {
+        drive.forward(200);
+        for (int i = 0; i < NUMBER_OF_MOTOR_DRIVERS; i++) drivers[i].forward();
+        status = "forward";
+    }
+    void backward() {
+        drive.backward(200);
+        for (int i = 0; i < NUMBER_OF_MOTOR_DRIVERS; i++) drivers[i].backward();
+        status = "backward";
+    }
+    void hardLeft() {
+        drive.hardLeft(200);
+        for (int i = 0; i < NUMBER_OF_MOTOR_DRIVERS; i++) drivers[i].hardLeft();
+        status = "hard_left";
+    }
+    void stop() {
+        drive.stop();
+        for (int i = 0; i < NUMBER_OF_MOTOR_DRIVERS; i++) drivers[i].stop();
+        status = "stopped";
+    }
+
+    LegacyString getStatus() {
+        LegacyString fullStatus = LegacyString(NUMBER_OF_MOTOR_DRIVERS) + " Wheel Drive System Status: " + status;
+        for (int i = 0; i < NUMBER_OF_MOTOR_DRIVERS; i++) {
+            fullStatus += ", " + LegacyString(i + 1) + ": " + drivers[i].getStatus();
+        }
+        return fullStatus;
+    }
+};
+
+/// Motor driver with empty primitives, so that only [MotorDriverInterface]'s status bookkeeping runs.
+class NullMotorDriver : public MotorDriverInterface {
+public:
+    void leftMotorForward(int) override {}
+    void leftMotorBackward(int) override {}
+    void rightMotorForward(int) override {}
+    void rightMotorBackward(int) override {}
+    void leftMotorStop() override {}
+    void rightMotorStop() override {}
+};
+
+static const int COMMANDS_PER_ITERATION = 4;
+
+inline void legacyCommands(LegacyDrive &drive, bool report) {
+    drive.forward();
+    if (report) benchmark::doNotOptimize(drive.getStatus().length());
+    drive.hardLeft();
+    if (report) benchmark::doNotOptimize(drive.getStatus().length());
+    drive.backward();
+    if (report) benchmark::doNotOptimize(drive.getStatus().length());
+    drive.stop();
+    if (report) benchmark::doNotOptimize(drive.getStatus().length());
+}
+
+inline void snapshotCommands(NDualWheelDriveInterface &drive, bool report) {
+    char text[NDualWheelDriveInterface::STATUS_TEXT_SIZE];
+    drive.forward(200);
+    if (report) benchmark::doNotOptimize(drive.formatStatus(text, sizeof(text)));
+    drive.hardLeft(200);
+    if (report) benchmark::doNotOptimize(drive.formatStatus(text, sizeof(text)));
+    drive.backward(200);
+    if (report) benchmark::doNotOptimize(drive.formatStatus(text, sizeof(text)));
+    drive.stop();
+    if (report) benchmark::doNotOptimize(drive.formatStatus(text, sizeof(text)));
+}
+
+/// Runs [commands] once under heap counting and then for timing, reporting both per drive command.
+template <typename Commands>
+inline void measure(const char *name, Commands commands) {
+    char label[80];
+    resetHeap();
+    long liveBefore = heap().liveBytes;
+    commands();
+    std::snprintf(label, sizeof(label), "%s: heap allocations/command", name);
+    benchmark::report(label, double(heap().allocations) / COMMANDS_PER_ITERATION, "");
+    std::snprintf(label, sizeof(label), "%s: peak temporary heap", name);
+    benchmark::report(label, heap().peakBytes - liveBefore, "bytes");
+
+    const long iterations = 200000;
+    long long start = benchmark::nowNs();
+    for (long i = 0; i < iterations; i++) commands();
+    std::snprintf(label, sizeof(label), "%s: host time/command", name);
+    benchmark::report(label, double(benchmark::nowNs() - start) / (iterations * COMMANDS_PER_ITERATION), "ns");
+}
+
+inline void run() {
+    benchmark::section("Status reporting: String fields versus StatusCode snapshots");
+    NullMotorDriver front, back, legacyFront, legacyBack;
+    MotorDriverInterface *drivers[] = {&front, &back}, *legacyDrivers[] = {&legacyFront, &legacyBack};
+    NDualWheelDriveInterface drive(2, drivers), legacyStack(2, legacyDrivers);
+
+    long heapBefore = heap().liveBytes;
+    LegacyDrive *legacy = new LegacyDrive(legacyStack);
+    benchmark::report("String status: heap held by a 2 driver drive", heap().liveBytes - heapBefore, "bytes");
+    benchmark::report("String status: RAM of the status fields", 3 * 6, "bytes (AVR)");
+    benchmark::report("StatusCode status: heap held by a 2 driver drive", 0, "bytes");
+    benchmark::report("StatusCode status: RAM of the status fields", 3 * sizeof(StatusCode), "bytes");
+
+    measure("String, command only", [&]() { legacyCommands(*legacy, false); });
+    measure("StatusCode, command only", [&]() { snapshotCommands(drive, false); });
+    measure("String, command + text", [&]() { legacyCommands(*legacy, true); });
+    measure("StatusCode, command + text", [&]() { snapshotCommands(drive, true); });
+    delete legacy;
+}
+
+}
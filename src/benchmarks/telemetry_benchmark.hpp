@@ -0,0 +1,129 @@
+#pragma once
+
+#include "benchmark.hpp"
+#include "../controllers/bluetooth_controller.hpp"
+#include "../interfaces/motordriver_interfaces.hpp"
+#include "../utils/telemetry.hpp"
+
+/// <summary>
+/// @file telemetry_benchmark.hpp
+/// @brief Host benchmark of the debug output of the [BluetoothController]: the status text sent on every step
+/// against the binary [Telemetry] stream, on SoftwareSerial and on a hardware UART.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details The controller runs for [RUN_MS] of virtual time, a step every millisecond, driven by single-letter
+/// commands. The mock serial ports time their transmit at the baud rate, so the time the robot would have
+/// spent waiting for the line inside a step is reported per step. What was sent is decoded back with the
+/// [TelemetryDecoder], which must find every record queued: a mismatch counts as a failure.
+
+namespace telemetry_benchmark {
+
+static const unsigned long RUN_MS = 5000;
+
+/// SoftwareSerial pins of the benchmark (A8/A9), clear of the ports other benchmarks keep open.
+static const uint8_t SOFTWARE_RX_PIN = 62, SOFTWARE_TX_PIN = 63;
+
+struct Link {
+    const char *name;
+    bool software;
+    long baud;
+};
+
+static const Link LINKS[] = {
+    {"SoftwareSerial 9600", true, 9600},
+    {"hardware UART 115200", false, 115200}
+};
+
+struct Output {
+    const char *name;
+    /// Milliseconds between two telemetry records, or -1 for the status text on every step.
+    long samplePeriodMs;
+};
+
+static const Output OUTPUTS[] = {
+    {"status text every step", -1},
+    {"telemetry at 20 Hz", 50},
+    {"telemetry at 100 Hz", 10},
+    {"telemetry every step", 0}
+};
+
+struct Result {
+    double blockedUsPerStep;
+    double hostNsPerStep;
+    unsigned long recorded, dropped, decoded, corrupted, lost;
+    bool consistent;
+};
+
+inline Result run(const Link &link, const Output &output) {
+    hal::native::resetGpio();
+    hal::native::resetClock();
+    FastL298NInterface driver(2, 3, 4, 5, 6, 7);
+    FastL298NInterface *drivers[] = {&driver};
+    NDualWheelDrive<FastL298NInterface, 1> drive(drivers);
+    SoftwareSerialTransport softwareTransport(SOFTWARE_RX_PIN, SOFTWARE_TX_PIN, link.baud);
+    HardwareSerialTransport hardwareTransport(hal::serial2(), link.baud);
+    SerialTransport *transport = link.software ? (SerialTransport *) &softwareTransport : &hardwareTransport;
+    hal::native::SerialPort *port = link.software ? hal::native::findSerial(SOFTWARE_RX_PIN) : &hal::serial2();
+    BluetoothInterface bluetooth(transport);
+    BluetoothController controller(&bluetooth, &drive);
+    Telemetry telemetry(&bluetooth, output.samplePeriodMs < 0 ? 0 : output.samplePeriodMs);
+    if (output.samplePeriodMs >= 0) controller.setTelemetry(&telemetry);
+    hal::serial2().transmitted().clear();
+    port->transmitted().clear();
+
+    const char commands[] = "FLBRGIHJ";
+    long long hostNs = 0;
+    for (unsigned long ms = 0; ms < RUN_MS; ms++) {
+        if (ms % 20 == 0) {
+            char command[2] = {commands[(ms / 20) % 8], '\0'};
+            port->inject(command);
+        }
+        long long start = benchmark::nowNs();
+        controller.step(false, output.samplePeriodMs < 0);
+        hostNs += benchmark::nowNs() - start;
+        hal::native::advanceMicros(1000);
+    }
+
+    Result result;
+    result.blockedUsPerStep = double(port->blockedMicros()) / RUN_MS;
+    result.hostNsPerStep = double(hostNs) / RUN_MS;
+    result.recorded = telemetry.getRecorded();
+    result.dropped = telemetry.getDropped();
+    TelemetryDecoder decoder;
+    const std::string &sent = port->transmitted();
+    for (size_t i = 0; i < sent.size(); i++) decoder.feed((uint8_t) sent[i]);
+    result.decoded = decoder.getDecoded();
+    result.corrupted = decoder.getCorrupted();
+    result.lost = decoder.getLost();
+    // Every record due was dropped, decoded, or is still (partly) queued.
+    unsigned long queued = (telemetry.getQueued() + TelemetryRecord::FRAME_SIZE - 1) / TelemetryRecord::FRAME_SIZE;
+    result.consistent = output.samplePeriodMs < 0 || (result.corrupted == 0 && result.lost == 0
+        && result.decoded + result.dropped + queued == result.recorded);
+    return result;
+}
+
+/// @return [int] number of runs whose stream did not decode back to the records queued.
+inline int run() {
+    benchmark::section("Bluetooth debug output: status text vs. binary telemetry (5 s, a step every ms)");
+    int failures = 0;
+    for (unsigned int i = 0; i < sizeof(LINKS) / sizeof(LINKS[0]); i++) {
+        for (unsigned int j = 0; j < sizeof(OUTPUTS) / sizeof(OUTPUTS[0]); j++) {
+            Result result = run(LINKS[i], OUTPUTS[j]);
+            char name[96];
+            std::snprintf(name, sizeof(name), "%s, %s: waiting per step", LINKS[i].name, OUTPUTS[j].name);
+            benchmark::report(name, result.blockedUsPerStep, "us");
+            std::snprintf(name, sizeof(name), "%s, %s: host per step", LINKS[i].name, OUTPUTS[j].name);
+            benchmark::report(name, result.hostNsPerStep, "ns");
+            if (OUTPUTS[j].samplePeriodMs < 0) continue;
+            std::printf("    %lu records: %lu decoded, %lu dropped on the robot, %lu lost, %lu corrupted%s\n",
+                result.recorded, result.decoded, result.dropped, result.lost, result.corrupted,
+                result.consistent ? "" : "  FAILED");
+            if (!result.consistent) failures++;
+        }
+    }
+    return failures;
+}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../utils/mission.hpp"
+#include "../interfaces/lifter_interface.hpp"
+
+/// <summary>
+/// @file arena_missions.hpp
+/// @brief This file contains the missions of the arena tasks, run by [AutonomousController::step1] and
+/// [AutonomousController::step2].
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details Both tasks follow the line for a while, drive on until an IR sensor leaves the line, then pick up
+/// the object in front of them: lower the claw, approach, raise the claw and retreat. The approach, retreat and
+/// turn are measured by the wheel encoders when the drive has them, and the claw by its limit switches or
+/// potentiometer when the lifter has them; they are timed otherwise (the times were tuned on the robot). Will
+/// only work in the specific arena by the specific robot.
+
+/// First task: follows the line turning on the spot, picks up at the end of the line and turns around.
+inline Mission arenaTask1Mission() {
+    static const uint8_t program[] PROGMEM = {
+        MISSION_FOLLOW_LINE, 140, MISSION_VALUE(FOLLOW_ON_SPOT),
+        MISSION_WAIT, 0, MISSION_VALUE(5000),
+        MISSION_HOLD, 0, MISSION_VALUE(0),
+        MISSION_WAIT_LINE, 1, MISSION_VALUE(0),
+        MISSION_STOP, 0, MISSION_VALUE(0),
+        MISSION_LIFT_TO, 255, MISSION_VALUE(LifterInterface::POSITION_DOWN),
+        MISSION_WAIT_LIFT, 0, MISSION_VALUE(1020),
+        MISSION_DRIVE_DISTANCE, 125, MISSION_VALUE(110),
+        MISSION_WAIT_MANOEUVRE, 0, MISSION_VALUE(950),
+        MISSION_STOP, 0, MISSION_VALUE(0),
+        MISSION_LIFT_TO, 255, MISSION_VALUE(LifterInterface::POSITION_UP),
+        MISSION_WAIT_LIFT, 0, MISSION_VALUE(3000),
+        MISSION_DRIVE_DISTANCE, 255, MISSION_VALUE(-1150),
+        MISSION_WAIT_MANOEUVRE, 0, MISSION_VALUE(4200),
+        MISSION_TURN_ANGLE, 185, MISSION_VALUE(180),
+        MISSION_WAIT_MANOEUVRE, 0, MISSION_VALUE(2450),
+        MISSION_END, 0, MISSION_VALUE(0)
+    };
+    return Mission::inFlash(program, sizeof(program));
+}
+
+/// Second task: follows the line with smooth turns for longer, picks up at the end of the line and retreats.
+inline Mission arenaTask2Mission() {
+    static const uint8_t program[] PROGMEM = {
+        MISSION_FOLLOW_LINE, 95, MISSION_VALUE(FOLLOW_SMOOTH),
+        MISSION_WAIT, 0, MISSION_VALUE(15000),
+        MISSION_HOLD, 0, MISSION_VALUE(0),
+        MISSION_WAIT_LINE, 0, MISSION_VALUE(0),
+        MISSION_STOP, 0, MISSION_VALUE(0),
+        MISSION_LIFT_TO, 255, MISSION_VALUE(LifterInterface::POSITION_DOWN),
+        MISSION_WAIT_LIFT, 0, MISSION_VALUE(1020),
+        MISSION_DRIVE_DISTANCE, 125, MISSION_VALUE(110),
+        MISSION_WAIT_MANOEUVRE, 0, MISSION_VALUE(950),
+        MISSION_STOP, 0, MISSION_VALUE(0),
+        MISSION_LIFT_TO, 255, MISSION_VALUE(LifterInterface::POSITION_UP),
+        MISSION_WAIT_LIFT, 0, MISSION_VALUE(3000),
+        MISSION_DRIVE_DISTANCE, 255, MISSION_VALUE(-1150),
+        MISSION_WAIT_MANOEUVRE, 0, MISSION_VALUE(4200),
+        MISSION_END, 0, MISSION_VALUE(0)
+    };
+    return Mission::inFlash(program, sizeof(program));
+}
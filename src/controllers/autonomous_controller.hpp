@@ -1,5 +1,14 @@
-#include "..\interfaces\2N_wheel_drive_interface.hpp"
-#include "..\interfaces\lifter_interface.hpp"
+#pragma once
+
+#include "../interfaces/2N_wheel_drive_interface.hpp"
+#include "../interfaces/lifter_interface.hpp"
+#include "../interfaces/line_sensor_array_interface.hpp"
+#include "../interfaces/digital_line_sensors_interface.hpp"
+#include "../interfaces/bluetooth_interface.hpp"
+#include "arena_missions.hpp"
+#include "../utils/pid_controller.hpp"
+#include "../utils/task_scheduler.hpp"
+#include "../utils/latency_probe.hpp"
 
 // <summary>
 /// @file autonomous_controller.hpp
@@ -12,158 +21,492 @@
 /// @brief This class is used to control the Robot via programmed logic.
 ///
 /// @details The Robot is controlled according to the logic coded for autonomous driving,
-/// using the [NDualWheelDriveInterface] class to control the motors.
+/// using the [DualWheelDriveBase] class to control the motors.
+///
+/// The two digital IR sensors are read through a [DigitalLineSensorsInterface] snapshot, taken once per
+/// decision, so every branch of a decision sees the same readings.
+///
+/// The arena tasks are [Mission]s (see mission.hpp and arena_missions.hpp) run by a non-blocking interpreter:
+/// every call to [runMission] (or [step1]/[step2]) runs the instructions that can run at once, up to
+/// [MAX_INSTRUCTIONS_PER_STEP], then returns while a wait holds, keeping the line follower going if one was
+/// started. Waits are tracked by a [Timer] instead of delay(). When the drive has wheel encoders, the approach,
+/// retreat and turn are driven by distance and angle ([DualWheelDriveBase::driveDistance],
+/// [DualWheelDriveBase::turnAngle]); their wait ends when the encoders measure the target, or after twice the
+/// timed duration if they never do (e.g. when the robot is stuck). Likewise the claw is moved to a position
+/// measured by the lifter's limit switches or potentiometer ([LifterInterface::moveTo]) when it has them, and
+/// its wait ends as soon as it is there, instead of after the time it takes with a flat battery.
+///
+/// New missions can be uploaded over the tuning link into EEPROM ([MissionStore]) and run without reflashing:
+/// UPLOAD_MISSION_BEGIN, one UPLOAD_MISSION_INSTRUCTION per instruction, UPLOAD_MISSION_COMMIT with their number
+/// and CRC, then RUN_MISSION 0. Each step takes at most [MAX_COMMANDS_PER_STEP] commands from the link, and none
+/// while the [MissionStore]'s write queue is full, so an upload never holds the loop; the uploaded mission starts
+/// once it is written.
+///
+/// With a [LineSensorArrayInterface] attached, line following uses [lineFollowPID] instead of the two-sensor
+/// bang-bang followers: the line position steers differential wheel speeds through a [PIDController], whose
+/// gains and base speed can be tuned over Bluetooth (SET_PID_GAIN / SET_LINE_SPEED) when a tuning link is set.
 ///
 /// Messy code because messy incomplete logic. Pardon.
 class AutonomousController {
+public:
+    /// Period in milliseconds of the PID line follower updates.
+    static const unsigned long PID_PERIOD_MS = 5;
+
+    /// Default gains of the PID line follower, in 1/256 (see [PIDController]), tuned in the host simulation.
+    static const int DEFAULT_PID_KP = 32;
+    static const int DEFAULT_PID_KI = 0;
+    static const int DEFAULT_PID_KD = 320;
+
+    /// Default base speed of the PID line follower.
+    static const int DEFAULT_LINE_SPEED = 230;
+
+    /// Most instructions one [runMission] runs before returning, so a mission without waits cannot hold the loop.
+    static const int MAX_INSTRUCTIONS_PER_STEP = 8;
+
+    /// Milliseconds without an encoder count after which [MISSION_WAIT_MANOEUVRE] takes the wheels as stopped.
+    static const unsigned long REST_MS = 50;
+
+    /// Most tuning and mission commands one [runMission] takes from the tuning link.
+    static const int MAX_COMMANDS_PER_STEP = 16;
+
+    /// Missions RUN_MISSION can start: the uploaded one, and the built-in arena tasks.
+    static const uint8_t UPLOADED_MISSION = 0;
+    static const uint8_t ARENA_TASK_1_MISSION = 1;
+    static const uint8_t ARENA_TASK_2_MISSION = 2;
+
+    /// Sensors of the [DigitalLineSensorsInterface] given to the controller: left first, then right.
+    static const int LEFT_IR_SENSOR = 0;
+    static const int RIGHT_IR_SENSOR = 1;
+
 private:
-    NDualWheelDriveInterface* fourWheelDrive;
+    DualWheelDriveBase* fourWheelDrive;
 
     LifterInterface* lifter;
 
-    String status;
+    StatusCode status;
+
+    /// The 2 digital IR sensors. NULL if not given, in which case they never see white.
+    DigitalLineSensorsInterface* irSensors;
+
+    /// The mission being run, the index of its instruction running, and whether a mission was ever started.
+    Mission mission;
+
+    int missionCounter;
+
+    bool missionRunning, missionStarted;
+
+    /// True once the wait instruction at [missionCounter] has started its [missionTimer].
+    bool missionWaiting;
+
+    Timer missionTimer;
+
+    /// True if the last [MISSION_DRIVE_DISTANCE]/[MISSION_TURN_ANGLE] is measured by the encoders.
+    bool manoeuvreMeasured;
+
+    /// Encoder counts last seen by [wheelsAtRest], and since when they have not changed.
+    long restDistanceCounts, restRotationCounts;
+    unsigned long restSinceMs;
+
+    /// True if the last [MISSION_LIFT_TO] is measured by the lifter's feedback.
+    bool liftMeasured;
+
+    /// Line follower started by [MISSION_FOLLOW_LINE], run on every [runMission] while [following].
+    bool following;
+
+    uint8_t followSpeed;
+
+    uint8_t follower;
+
+    /// The uploaded mission, in EEPROM.
+    MissionStore missionStore;
+
+    /// True if RUN_MISSION asked for the uploaded mission while it was still being written.
+    bool uploadedMissionPending;
 
-    int leftIRPin, rightIRPin;
+    /// Analog sensor array used by [lineFollowPID]. NULL if the robot only has the two digital IR sensors.
+    LineSensorArrayInterface* lineSensors;
 
-    size_t init;
+    PIDController linePID;
+
+    Timer pidTimer;
+
+    int lineSpeed;
+
+    /// Bluetooth link tuning commands are read from. May be NULL.
+    BluetoothInterface* tuningLink;
+
+    /// Sets up the line follower and mission members shared by the constructors.
+    void initLineFollower() {
+        lineSensors = NULL;
+        lineSpeed = DEFAULT_LINE_SPEED;
+        tuningLink = NULL;
+        missionCounter = 0;
+        missionRunning = missionStarted = missionWaiting = false;
+        manoeuvreMeasured = liftMeasured = following = false;
+        uploadedMissionPending = false;
+        restDistanceCounts = restRotationCounts = 0;
+        restSinceMs = 0;
+        followSpeed = 0;
+        follower = MissionFollower::FOLLOW_ON_SPOT;
+    }
+
+    /// Applies the tuning and mission commands received over the tuning link, if any, and writes the next byte
+    /// of an upload.
+    void pollTuning() {
+        missionStore.update();
+        if (uploadedMissionPending && !missionStore.isWriting()) {
+            uploadedMissionPending = false;
+            startMission(missionStore.load());
+        }
+        if (tuningLink == NULL) return;
+        Command command;
+        // The rest of an upload waits in the link's buffers while the write queue is full.
+        for (int i = 0; i < MAX_COMMANDS_PER_STEP && missionStore.canAppend() && tuningLink->receiveCommand(command); i++) {
+            if (!tune(command)) handleMissionCommand(command);
+        }
+    }
+
+    /// @return [uint8_t] snapshot of the IR sensors seeing white (bit [LEFT_IR_SENSOR]/[RIGHT_IR_SENSOR]).
+    uint8_t readWhite() {
+        return irSensors != NULL ? irSensors->readWhite() : 0;
+    }
 
     /// Function using IR, says if detecting white
-    bool isWhite(int irPin) {
-    if(digitalRead(irPin))
-        return false;
-    else return true;
+    bool isWhite(int irSensor) {
+        return readWhite() & (1 << irSensor);
+    }
+
+    /// Runs the line follower started by [MISSION_FOLLOW_LINE].
+    void followLine() {
+        if (lineSensors != NULL) lineFollowPID(lineSpeed);
+        else if (follower == MissionFollower::FOLLOW_SMOOTH) lineFollowSmooth(followSpeed);
+        else lineFollow(followSpeed);
     }
 
-    /// Hard coded autonomous logic to turn 180 degrees.
-    /// Will only work in the specific arena by the specific robot.
-    void turn180() {
-        fourWheelDrive->hardLeft(185);
-        delay(2450);
+    /// @return [bool] true once the encoders have counted nothing for [REST_MS]: the wheels have stopped
+    /// coasting. Only with encoders fitted.
+    bool wheelsAtRest() {
+        Odometry &odometry = fourWheelDrive->getEncoders()->getOdometry();
+        unsigned long now = hal::millis();
+        if (odometry.getDistanceCounts() != restDistanceCounts || odometry.getRotationCounts() != restRotationCounts) {
+            restDistanceCounts = odometry.getDistanceCounts();
+            restRotationCounts = odometry.getRotationCounts();
+            restSinceMs = now;
+            return false;
+        }
+        return now - restSinceMs >= REST_MS;
+    }
+
+    /// @return [bool] true once the wait instruction running has waited [durationMs], starting its timer first.
+    bool waitFor(unsigned long durationMs) {
+        if (!missionWaiting) {
+            missionTimer.start(durationMs);
+            missionWaiting = true;
+        }
+        return missionTimer.hasExpired();
+    }
+
+    /// Stops the robot and the mission.
+    void endMission() {
+        missionRunning = following = false;
         fourWheelDrive->stop();
+        if (lifter != NULL) lifter->stop();
+    }
+
+    /// Runs [instruction]: starts an action, or checks a wait.
+    /// @return [bool] true if the mission moves on to the next instruction, false while a wait holds or once
+    /// the mission ended.
+    bool execute(const MissionInstruction &instruction) {
+        int value = instruction.value;
+        switch (instruction.opcode) {
+            case MissionOpcode::MISSION_FOLLOW_LINE:
+                following = true;
+                followSpeed = instruction.argument;
+                follower = (uint8_t) value;
+                return true;
+
+            case MissionOpcode::MISSION_HOLD:
+                following = false;
+                return true;
+
+            case MissionOpcode::MISSION_DRIVE:
+                following = false;
+                if (value >= 0) fourWheelDrive->forward(value);
+                else fourWheelDrive->backward(-value);
+                return true;
+
+            case MissionOpcode::MISSION_SPIN:
+                following = false;
+                if (value >= 0) fourWheelDrive->hardLeft(value);
+                else fourWheelDrive->hardRight(-value);
+                return true;
+
+            case MissionOpcode::MISSION_DRIVE_DISTANCE:
+                following = false;
+                manoeuvreMeasured = fourWheelDrive->driveDistance(instruction.argument, value);
+                if (manoeuvreMeasured) return true;
+                if (value >= 0) fourWheelDrive->forward(instruction.argument);
+                else fourWheelDrive->backward(instruction.argument);
+                return true;
+
+            case MissionOpcode::MISSION_TURN_ANGLE:
+                following = false;
+                manoeuvreMeasured = fourWheelDrive->turnAngle(instruction.argument, value);
+                if (manoeuvreMeasured) return true;
+                if (value >= 0) fourWheelDrive->hardLeft(instruction.argument);
+                else fourWheelDrive->hardRight(instruction.argument);
+                return true;
+
+            case MissionOpcode::MISSION_STOP:
+                following = false;
+                fourWheelDrive->stop();
+                return true;
+
+            case MissionOpcode::MISSION_LIFT:
+                if (lifter == NULL) return true;
+                if (value > 0) lifter->moveUp();
+                else if (value < 0) lifter->moveDown();
+                else lifter->stop();
+                return true;
+
+            case MissionOpcode::MISSION_WAIT:
+                return waitFor((uint16_t) value);
+
+            case MissionOpcode::MISSION_WAIT_LINE:
+                return isWhite(instruction.argument) == (value != 0);
+
+            case MissionOpcode::MISSION_WAIT_MANOEUVRE:
+                // Until the wheels have stopped too: a manoeuvre started while they still turn carries the
+                // previous one's momentum into it, a turn's overshoot bending the next straight.
+                if (manoeuvreMeasured && !fourWheelDrive->isManoeuvreInProgress()
+                    && !fourWheelDrive->isRampInProgress() && wheelsAtRest()) return true;
+                return waitFor(manoeuvreMeasured ? 2UL * (uint16_t) value : (uint16_t) value);
+
+            case MissionOpcode::MISSION_LIFT_TO:
+                if (lifter == NULL) return true;
+                liftMeasured = lifter->moveTo(value, instruction.argument);
+                return true;
+
+            case MissionOpcode::MISSION_WAIT_LIFT:
+                if (lifter == NULL || (liftMeasured && !lifter->isMoving())) return true;
+                if (!waitFor(liftMeasured ? 2UL * (uint16_t) value : (uint16_t) value)) return false;
+                lifter->stop();
+                return true;
+
+            default:
+                // MISSION_END, or an unknown opcode: stop rather than guess.
+                endMission();
+                return false;
+        }
     }
 
 public:
     /// @brief Constuctor initializing the [AutonomousController] Class.
-    /// @param fourWheelDrive [NDualWheelDriveInterface] object controlling the motors.
+    /// @param fourWheelDrive [DualWheelDriveBase] object controlling the motors.
     /// @return [AutonomousController] object
-    AutonomousController(NDualWheelDriveInterface* fourWheelDrive) {
+    AutonomousController(DualWheelDriveBase* fourWheelDrive) 
+        : linePID(DEFAULT_PID_KP, DEFAULT_PID_KI, DEFAULT_PID_KD, 255) {
         this->fourWheelDrive = fourWheelDrive;
-        status = "ready";
+        initLineFollower();
+        lifter = NULL;
+        irSensors = NULL;
+        status = StatusCode::READY;
     }
 
     /// @brief Constuctor initializing the [AutonomousController] Class.
-    /// @param fourWheelDrive [NDualWheelDriveInterface] object controlling the motors.
+    /// @param fourWheelDrive [DualWheelDriveBase] object controlling the motors.
     /// @param lifter [LifterInterface] object controlling the lifter.
+    /// @param irSensors [DigitalLineSensorsInterface] object sampling the left and right IR sensors.
     /// @return [AutonomousController] object
     AutonomousController(
-        NDualWheelDriveInterface* fourWheelDrive,
+        DualWheelDriveBase* fourWheelDrive,
         LifterInterface* lifter,
-        int leftIRPin,
-        int rightIRPin
-    ) {
+        DigitalLineSensorsInterface* irSensors
+    ) : linePID(DEFAULT_PID_KP, DEFAULT_PID_KI, DEFAULT_PID_KD, 255) {
         this->fourWheelDrive = fourWheelDrive;
+        initLineFollower();
         this->lifter = lifter;
         // Senses Set up
-        pinMode(leftIRPin, INPUT);
-        pinMode(rightIRPin, INPUT);
-        this->leftIRPin = leftIRPin;
-        this->rightIRPin = rightIRPin;
+        this->irSensors = irSensors;
         // Power Ground Rail
-        pinMode(51, OUTPUT);
-        pinMode(47, OUTPUT);
-        pinMode(49, OUTPUT);
-        digitalWrite(51, 0);
-        digitalWrite(47, 1);
-        digitalWrite(49, 1);
-
-        init = millis();
+        hal::pinMode(51, OUTPUT);
+        hal::pinMode(47, OUTPUT);
+        hal::pinMode(49, OUTPUT);
+        hal::digitalWrite(51, 0);
+        hal::digitalWrite(47, 1);
+        hal::digitalWrite(49, 1);
 
         // Set up senses
-        status = "ready";
+        status = StatusCode::READY;
     }
 
     /// @brief Most basic line following autonomous logic (taking on-spot turns)
     void lineFollow(int speed) {
-        if(isWhite(leftIRPin) && isWhite(rightIRPin)) {
+        LATENCY_PROBE(LatencyStage::LINE_FOLLOWER);
+        uint8_t white = readWhite();
+        bool leftWhite = white & (1 << LEFT_IR_SENSOR), rightWhite = white & (1 << RIGHT_IR_SENSOR);
+        if(leftWhite && rightWhite) {
             fourWheelDrive->forward(speed);
         }
-        if(isWhite(leftIRPin) && !isWhite(rightIRPin)) {
+        else if(leftWhite) {
             fourWheelDrive->hardLeft(speed);
         }
-        if(!isWhite(leftIRPin) && isWhite(rightIRPin)) {
+        else if(rightWhite) {
             fourWheelDrive->hardRight(speed);
         }
-        if(!isWhite(leftIRPin) && !isWhite(rightIRPin)) {
+        else {
             fourWheelDrive->stop();
         }
     }
 
     /// @brief Most basic line following autonomous logic (taking smooth turns)
     void lineFollowSmooth(int speed) {
-        if(isWhite(leftIRPin) && isWhite(rightIRPin)) {
+        LATENCY_PROBE(LatencyStage::LINE_FOLLOWER);
+        uint8_t white = readWhite();
+        bool leftWhite = white & (1 << LEFT_IR_SENSOR), rightWhite = white & (1 << RIGHT_IR_SENSOR);
+        if(leftWhite && rightWhite) {
             fourWheelDrive->forward(speed);
         }
-        if(isWhite(leftIRPin) && !isWhite(rightIRPin)) {
+        else if(leftWhite) {
             fourWheelDrive->smoothLeft(2*speed);
         }
-        if(!isWhite(leftIRPin) && isWhite(rightIRPin)) {
+        else if(rightWhite) {
             fourWheelDrive->smoothRight(2*speed);
         }
-        if(!isWhite(leftIRPin) && !isWhite(rightIRPin)) {
+        else {
             fourWheelDrive->stop();
         }
     }
 
-    /// @brief Specific arena based logic to perform first task
-    void step1(bool verbose = false) {
-        if (millis() - init <= 5000) 
-            lineFollow(140);
-        else {
-            if (!isWhite(rightIRPin)) {
-                fourWheelDrive->stop();
-                lifter->moveDown();
-                delay(1020);
-                lifter->stop();
-                fourWheelDrive->forward(125);
-                delay(950);
-                fourWheelDrive->stop();
-                lifter->moveUp();
-                delay(3000);
-                lifter->stop();
-                fourWheelDrive->backward(255);
-                delay(4200);
-                turn180();
+    /// @brief PID line following on the analog sensor array. Non-blocking; call on every loop, the controller
+    /// updates every [PID_PERIOD_MS]. Does nothing if no sensor array is attached.
+    /// @param speed Base speed of both sides. Range: 0-255
+    void lineFollowPID(int speed) {
+        if (lineSensors == NULL || (pidTimer.isRunning() && !pidTimer.hasExpired())) return;
+        LATENCY_PROBE(LatencyStage::LINE_FOLLOWER);
+        if (!pidTimer.isRunning()) linePID.reset();
+        pidTimer.start(PID_PERIOD_MS);
+        // Line left of centre (negative) slows the left side, turning the robot back onto the line.
+        int correction = linePID.update(lineSensors->readLinePosition());
+        fourWheelDrive->steer(Q8_8::fromPwm(speed), Q8_8::fromPwm(correction));
+    }
+
+    /// @brief Attaches the analog sensor array, switching line following over to [lineFollowPID].
+    /// @param lineSensors [LineSensorArrayInterface] object, or NULL to go back to the digital IR sensors.
+    void setLineSensors(LineSensorArrayInterface* lineSensors) {
+        this->lineSensors = lineSensors;
+        pidTimer.stop();
+    }
+
+    /// @brief Sets the Bluetooth link tuning commands are read from while the controller runs.
+    /// @param tuningLink [BluetoothInterface] object, or NULL for none.
+    void setTuningLink(BluetoothInterface* tuningLink) {
+        this->tuningLink = tuningLink;
+    }
+
+    /// @brief Applies a mission command: uploads a mission into EEPROM, or starts one.
+    /// @param command [Command] received, UPLOAD_MISSION_BEGIN, UPLOAD_MISSION_INSTRUCTION, UPLOAD_MISSION_COMMIT
+    /// or RUN_MISSION.
+    /// @return [bool] true if the command was a mission command.
+    bool handleMissionCommand(const Command &command) {
+        switch (command.opcode) {
+            case CommandOpcode::UPLOAD_MISSION_BEGIN:
+                if (missionRunning && mission.isInEeprom()) endMission();
+                uploadedMissionPending = false;
+                missionStore.begin();
+                return true;
 
-                // END PROCESS
-                while (true) fourWheelDrive->stop();
-            }   
+            case CommandOpcode::UPLOAD_MISSION_INSTRUCTION:
+                missionStore.append(command.payload);
+                return true;
+
+            case CommandOpcode::UPLOAD_MISSION_COMMIT:
+                missionStore.commit(command.payload[0], command.payload[1]);
+                return true;
+
+            case CommandOpcode::RUN_MISSION:
+                uploadedMissionPending = false;
+                switch (command.payload[0]) {
+                    case UPLOADED_MISSION:
+                        if (missionStore.isWriting()) uploadedMissionPending = true;
+                        else startMission(missionStore.load());
+                        break;
+                    case ARENA_TASK_1_MISSION: startMission(arenaTask1Mission()); break;
+                    case ARENA_TASK_2_MISSION: startMission(arenaTask2Mission()); break;
+                }
+                return true;
         }
-        if (verbose) fourWheelDrive->getStatus(true);
+        return false;
     }
 
-    /// @brief Specific arena based logic to perform second task
-    void step2(bool verbose = false) {
-        if (millis() - init <= 15000) 
-            lineFollowSmooth(95);
-        else {
-            if (!isWhite(leftIRPin)) {
-                fourWheelDrive->stop();
-                lifter->moveDown();
-                delay(1020);
-                lifter->stop();
-                fourWheelDrive->forward(125);
-                delay(950);
-                fourWheelDrive->stop();
-                lifter->moveUp();
-                delay(3000);
-                lifter->stop();
-                fourWheelDrive->backward(255);
-                delay(4200);
+    /// @brief Starts running [mission] from its first instruction, replacing any mission running.
+    /// Non-blocking: [runMission] runs it.
+    void startMission(const Mission &mission) {
+        this->mission = mission;
+        missionCounter = 0;
+        missionRunning = missionStarted = true;
+        missionWaiting = manoeuvreMeasured = liftMeasured = following = false;
+    }
 
-                // END PROCESS
-                while (true) fourWheelDrive->stop();
-            }   
+    /// @brief Runs the mission: the instructions that can run now, then the line follower if one is on.
+    /// Non-blocking; call on every loop.
+    /// @param verbose [bool] if true, prints the status of the drive in Serial.
+    void runMission(bool verbose = false) {
+        pollTuning();
+        for (int i = 0; i < MAX_INSTRUCTIONS_PER_STEP && missionRunning; i++) {
+            if (!execute(mission.read(missionCounter))) break;
+            missionCounter++;
+            missionWaiting = false;
         }
+        if (missionRunning && following) followLine();
         if (verbose) fourWheelDrive->getStatus(true);
     }
+
+    /// @return [bool] true until the mission running ends.
+    bool isMissionRunning() const {
+        return missionRunning;
+    }
+
+    /// @return [int] index of the instruction the mission is at.
+    int getMissionCounter() const {
+        return missionCounter;
+    }
+
+    /// @brief Applies a tuning command to the PID line follower.
+    /// @param command [Command] received, SET_PID_GAIN or SET_LINE_SPEED.
+    /// @return [bool] true if the command was a tuning command.
+    bool tune(const Command &command) {
+        switch (command.opcode) {
+            case CommandOpcode::SET_PID_GAIN:
+                linePID.setGain(command.payload[0], (command.payload[1] << 8) | command.payload[2]);
+                return true;
+
+            case CommandOpcode::SET_LINE_SPEED:
+                lineSpeed = command.payload[0];
+                return true;
+        }
+        return false;
+    }
+
+    /// @return [PIDController&] the controller of the PID line follower.
+    PIDController &getLinePID() {
+        return linePID;
+    }
+
+    /// @return [int] base speed of the PID line follower.
+    int getLineSpeed() {
+        return lineSpeed;
+    }
+
+    /// @brief Specific arena based logic to perform first task ([arenaTask1Mission]). Non-blocking; call on every loop.
+    void step1(bool verbose = false) {
+        if (!missionStarted) startMission(arenaTask1Mission());
+        runMission(verbose);
+    }
+
+    /// @brief Specific arena based logic to perform second task ([arenaTask2Mission]). Non-blocking; call on every loop.
+    void step2(bool verbose = false) {
+        if (!missionStarted) startMission(arenaTask2Mission());
+        runMission(verbose);
+    }
 };
\ No newline at end of file
@@ -1,6 +1,15 @@
-#include "..\interfaces\bluetooth_interface.hpp"
-#include "..\interfaces\2N_wheel_drive_interface.hpp"
-#include "..\interfaces\lifter_interface.hpp"
+#pragma once
+
+#include "../interfaces/bluetooth_interface.hpp"
+#include "../interfaces/2N_wheel_drive_interface.hpp"
+#include "../interfaces/lifter_interface.hpp"
+#include "../interfaces/digital_line_sensors_interface.hpp"
+#include "../utils/task_scheduler.hpp"
+#include "../utils/latency_probe.hpp"
+#include "../utils/telemetry.hpp"
+#include "../utils/session_recording.hpp"
+#include "motion_arbiter.hpp"
+#include "calibration_sweep.hpp"
 
 // <summary>
 /// @file bluetooth_controller.hpp
@@ -13,139 +22,461 @@
 /// @brief This class is used to control the Robot via Bluetooth.
 ///
 /// @details BluetoothController facilitates the control of the Robot according to the messages
-/// received by the [BlueToothInterface], using the [NDualWheelDriveInterface] class to control the motors.
+/// received by the [BlueToothInterface], using the [DualWheelDriveBase] class to control the motors.
+/// Besides the fixed direction commands at the set speed, a joystick can drive it proportionally with
+/// [CommandOpcode::DRIVE_ARCADE] (throttle and turn) or [CommandOpcode::DRIVE_TANK] (each side) frames, sent
+/// at 50 Hz or more.
+///
+/// A deadman keeps the Robot safe without blocking: it keeps moving while commands keep arriving, and stops once
+/// none has arrived for the command timeout ([setCommandTimeout]), e.g. when a button is let go or the link
+/// is lost. A held button repeats its command faster than the timeout, so it drives continuously.
+///
+/// With a [CalibrationSweep] set ([setCalibrationSweep]), [CommandOpcode::CALIBRATE_MOTORS] runs it from
+/// [step]; any drive command aborts it, and its outcome is sent back as a line of text.
+///
+/// Text replies are queued by the [BluetoothInterface] and sent from [step] as the link takes them, between the
+/// lines of a latency report ([CommandOpcode::REPORT_LATENCY]), so neither holds the loop.
+///
+/// With a [SessionRecorder] and [SessionReplayer] set ([setSession]), 'M' records the speed, drive and lifter
+/// commands received until 'm', and 'Y' replays them with their timing from [step], through [execute] as if they
+/// were received again, deadman included. Any drive command received aborts the replay.
+///
+/// With [Telemetry] set ([setTelemetry]), every step samples the wheel speeds, the IR sensors and the step
+/// time into binary records and sends what the link takes without waiting, instead of the status text.
 class BluetoothController {
+public:
+    /// Default time in milliseconds the Robot keeps moving after the last command (see [setCommandTimeout]).
+    static const unsigned long DEFAULT_COMMAND_TIMEOUT_MS = 200;
+
+    /// Maximum number of commands executed by one [step], bounding its run time.
+    static const int MAX_COMMANDS_PER_STEP = 16;
+
 private:
     BluetoothInterface* bluetooth;
 
-    NDualWheelDriveInterface* nDualWheelDrive;
+    DualWheelDriveBase* nDualWheelDrive;
 
     LifterInterface* lifter;
 
     int speed;
 
-    String status;
+    /// Deadman: stops the Robot [commandTimeoutMs] after the last command, without blocking [step].
+    Timer deadman;
+
+    unsigned long commandTimeoutMs;
+
+    unsigned long deadmanStops;
+
+    /// Whether the last movement command has not been followed by a stop: the deadman only runs while it is.
+    bool driving;
+
+    /// @return [bool] true for the commands that set the wheels moving.
+    static bool isMovement(uint8_t opcode) {
+        return (opcode >= CommandOpcode::DRIVE_FORWARD && opcode <= CommandOpcode::DRIVE_HARD_RIGHT)
+            || opcode == CommandOpcode::DRIVE_ARCADE || opcode == CommandOpcode::DRIVE_TANK;
+    }
+
+    StatusCode status;
+
+    Telemetry *telemetry;
+
+    DigitalLineSensorsInterface *irSensors;
+
+    /// [MotionArbiter] and channel of the drive in HYBRID mode, for [CommandOpcode::MANUAL_OVERRIDE].
+    MotionArbiter *arbiter;
+
+    int arbiterChannel;
+
+    CalibrationSweep *calibrationSweep;
+
+    /// Whether a sweep started by this controller has not reported its outcome yet, and the manual override
+    /// to restore after it in HYBRID mode.
+    bool calibrating;
+
+    int overrideBeforeCalibration;
+
+    SessionRecorder *recorder;
+
+    SessionReplayer *replayer;
+
+    /// Line of the latency report being sent (see [sendLatencyReport]) with its line break, its length and the
+    /// bytes of it sent so far, and the [LatencyStage] it summarises: -1 when no report is being sent.
+    char latencyReportLine[LATENCY_SUMMARY_SIZE + 2];
+    uint8_t latencyReportLength, latencyReportSent;
+    int latencyReportStage;
+
+    /// @brief Starts the latency report line of [latencyReportStage].
+    void formatLatencyReportLine() {
+        size_t length = formatLatencySummary(latencyReportStage, latencyReportLine, LATENCY_SUMMARY_SIZE);
+        latencyReportLine[length++] = '\r';
+        latencyReportLine[length++] = '\n';
+        latencyReportLength = length;
+        latencyReportSent = 0;
+    }
+
+    /// @brief Sends what the link takes without waiting of the latency report line being sent; the next line is
+    /// started on the next [step]. A 9600 baud link takes over 300 ms for the report, which must not hold a
+    /// single loop pass (and the watchdog).
+    void sendLatencyReport() {
+        if (latencyReportStage < 0) return;
+        latencyReportSent += bluetooth->sendAvailable((const uint8_t *) latencyReportLine + latencyReportSent,
+            latencyReportLength - latencyReportSent);
+        if (latencyReportSent < latencyReportLength) return;
+        if (++latencyReportStage < LatencyStage::NUMBER_OF_LATENCY_STAGES) formatLatencyReportLine();
+        else latencyReportStage = -1;
+    }
+
+    /// @brief Sends what the link takes without waiting of the replies queued with [BluetoothInterface::send]
+    /// and of the latency report, a whole line at a time: a line started is finished before the other's next one.
+    void sendReplies() {
+        if (latencyReportStage < 0 || latencyReportSent == 0) bluetooth->flushSend();
+        if (!bluetooth->isSending() || latencyReportSent > 0) sendLatencyReport();
+    }
+
+    /// @brief Starts the [calibrationSweep], pinning the wheels to this controller in HYBRID mode.
+    void startCalibration() {
+        if (calibrationSweep == NULL || !calibrationSweep->start()) {
+            bluetooth->send("calibration not started");
+            return;
+        }
+        calibrating = true;
+        if (arbiter != NULL) {
+            overrideBeforeCalibration = arbiter->getOverride();
+            arbiter->setOverride(arbiterChannel);
+        }
+    }
+
+    /// @brief Moves the [calibrationSweep] on, and reports its outcome once it stops driving.
+    void updateCalibration() {
+        if (calibrationSweep == NULL) return;
+        calibrationSweep->update();
+        if (!calibrating || calibrationSweep->isSweeping()) return;
+        calibrating = false;
+        if (arbiter != NULL) arbiter->setOverride(overrideBeforeCalibration);
+        switch (calibrationSweep->getOutcome()) {
+            case CalibrationSweep::Outcome::CALIBRATED: bluetooth->send("calibrated"); break;
+            case CalibrationSweep::Outcome::FAILED: bluetooth->send("calibration failed"); break;
+            default: bluetooth->send("calibration aborted"); break;
+        }
+    }
+
+    /// @brief Starts or stops recording a session; it starts with the current speed.
+    void record(bool start) {
+        if (recorder == NULL) return;
+        if (!start) {
+            recorder->stop();
+            return;
+        }
+        if (replayer != NULL) replayer->stop();
+        recorder->start();
+        Command setSpeed = {CommandOpcode::SET_SPEED, {(uint8_t) speed}};
+        recorder->record(setSpeed);
+    }
+
+    /// @brief Starts replaying the recorded session.
+    void replay() {
+        if (recorder != NULL) recorder->stop();
+        if (calibrationSweep != NULL) calibrationSweep->abort();
+        if (replayer == NULL || !replayer->start()) bluetooth->send("replay not started");
+    }
 
 public:
     /// @brief Constuctor initializing the [BluetoothController] Class.
     /// @param bluetooth [BluetoothInterface] object receiving messages over Bluetooth using the HC05 Software Serial.
-    /// @param nDualWheelDrive [NDualWheelDriveInterface] object controlling the motors.
+    /// @param nDualWheelDrive [DualWheelDriveBase] object controlling the motors.
     /// @return [BluetoothController] object
-    BluetoothController(BluetoothInterface* bluetooth, NDualWheelDriveInterface* nDualWheelDrive) {
+    BluetoothController(BluetoothInterface* bluetooth, DualWheelDriveBase* nDualWheelDrive) {
         this->bluetooth = bluetooth;
         this->nDualWheelDrive = nDualWheelDrive;
+        this->telemetry = NULL;
+        this->irSensors = NULL;
+        this->arbiter = NULL;
+        this->arbiterChannel = -1;
+        this->calibrationSweep = NULL;
+        this->calibrating = false;
+        this->overrideBeforeCalibration = -1;
+        this->recorder = NULL;
+        this->replayer = NULL;
+        this->latencyReportStage = -1;
+        this->commandTimeoutMs = DEFAULT_COMMAND_TIMEOUT_MS;
+        this->deadmanStops = 0;
+        this->driving = false;
         // Initial speed
         this->speed = 255;
         
         // Check if Bluetooth interface is initialized and ready.
-        if (this->bluetooth->getStatus() != "ready") {
-            const String error = "Bluetooth is not ready. Status: ";
-            Serial.println(error);
+        if (this->bluetooth->getStatus() != StatusCode::READY) {
+            const char *error = "Bluetooth is not ready. Status: ";
+            hal::console().print(error);
+            hal::console().println(statusText(this->bluetooth->getStatus()));
             // throw error;
         }
-        status = "ready";
+        status = StatusCode::READY;
     }
 
     /// @brief Constuctor initializing the [BluetoothController] Class with lifter.
     /// @param bluetooth [BluetoothInterface] object receiving messages over Bluetooth using the HC05 Software Serial.
-    /// @param nDualWheelDrive [NDualWheelDriveInterface] object controlling the motors.
+    /// @param nDualWheelDrive [DualWheelDriveBase] object controlling the motors.
     /// @param lifter [LifterInterface] object controlling the lifter.
     /// @return [BluetoothController] object
-    BluetoothController(BluetoothInterface* bluetooth, NDualWheelDriveInterface* nDualWheelDrive, LifterInterface* lifter) {
+    BluetoothController(BluetoothInterface* bluetooth, DualWheelDriveBase* nDualWheelDrive, LifterInterface* lifter) {
         this->bluetooth = bluetooth;
         this->nDualWheelDrive = nDualWheelDrive;
         this->lifter = lifter;
+        this->telemetry = NULL;
+        this->irSensors = NULL;
+        this->arbiter = NULL;
+        this->arbiterChannel = -1;
+        this->calibrationSweep = NULL;
+        this->calibrating = false;
+        this->overrideBeforeCalibration = -1;
+        this->recorder = NULL;
+        this->replayer = NULL;
+        this->latencyReportStage = -1;
+        this->commandTimeoutMs = DEFAULT_COMMAND_TIMEOUT_MS;
+        this->deadmanStops = 0;
+        this->driving = false;
         // Initial speed
         this->speed = 255;
         
         // Check if Bluetooth interface is initialized and ready.
-        if (this->bluetooth->getStatus() != "ready") {
-            const String error = "Bluetooth is not ready. Status: ";
-            Serial.println(error);
+        if (this->bluetooth->getStatus() != StatusCode::READY) {
+            const char *error = "Bluetooth is not ready. Status: ";
+            hal::console().print(error);
+            hal::console().println(statusText(this->bluetooth->getStatus()));
             // throw error;
         }
-        status = "ready";
+        status = StatusCode::READY;
     }
 
-    /// @brief One Step of the Robot when it is to be controlled over Bluetooth. This function is called
-    /// to control the Robot.
-    /// @param verbose [bool] if true, the function prints the command received and status of the Robot over Serial Monitor.
-    /// @param verboseBluetooth [bool] if true, the function sends the status of the Robot over Bluetooth.
-    void step(bool verbose=false, bool verboseBluetooth=false) {
-        char command = bluetooth->receiveChar();
-        // Speed parse
-        if (isdigit(command)) {
-            int digit = command - '0';
-            speed = digit/10 * 255;
+    /// @brief Sets the [Telemetry] streamed by every [step]. NULL stops it.
+    /// @param telemetry [Telemetry] sending over the same [BluetoothInterface].
+    /// @param irSensors [DigitalLineSensorsInterface] whose snapshot is recorded, or NULL to record none.
+    void setTelemetry(Telemetry *telemetry, DigitalLineSensorsInterface *irSensors = NULL) {
+        this->telemetry = telemetry;
+        this->irSensors = irSensors;
+    }
+
+    /// @brief Sets the [MotionArbiter] the drive is a channel of, so that the Robot can be put under manual
+    /// override. NULL (the default) ignores override commands.
+    /// @param arbiter [MotionArbiter] of the HYBRID Control Mode.
+    /// @param channel [ArbitratedDrive::getChannel] of the drive given to this controller.
+    void setArbiter(MotionArbiter *arbiter, int channel) {
+        this->arbiter = arbiter;
+        this->arbiterChannel = channel;
+    }
+
+    /// @brief Sets the [CalibrationSweep] run by [CommandOpcode::CALIBRATE_MOTORS]. NULL (the default) ignores it.
+    /// @param calibrationSweep [CalibrationSweep] driving the same drive as this controller.
+    void setCalibrationSweep(CalibrationSweep *calibrationSweep) {
+        this->calibrationSweep = calibrationSweep;
+    }
+
+    /// @brief Sets the session recorded by [CommandOpcode::RECORD_SESSION] and replayed by
+    /// [CommandOpcode::REPLAY_SESSION]. NULL (the default) ignores them.
+    /// @param recorder [SessionRecorder] of the commands received.
+    /// @param replayer [SessionReplayer] of [recorder]'s session.
+    void setSession(SessionRecorder *recorder, SessionReplayer *replayer) {
+        this->recorder = recorder;
+        this->replayer = replayer;
+    }
+
+    /// @brief Sets the deadman's silence window.
+    /// @param timeoutMs Milliseconds the Robot keeps moving after the last command, 0 to keep it moving until it
+    /// is told to stop.
+    void setCommandTimeout(unsigned long timeoutMs) {
+        commandTimeoutMs = timeoutMs;
+        if (timeoutMs == 0) deadman.stop();
+    }
+
+    /// @return [unsigned long] milliseconds the Robot keeps moving after the last command, 0 for until told to stop.
+    unsigned long getCommandTimeout() const {
+        return commandTimeoutMs;
+    }
+
+    /// @return [unsigned long] number of times the deadman stopped the Robot.
+    unsigned long getDeadmanStops() const {
+        return deadmanStops;
+    }
+
+    /// @brief Starts sending the latency summary of every stage over Bluetooth, one line each, a line per
+    /// [step] at most and without waiting for the link. Starts again if one is being sent.
+    void startLatencyReport() {
+        latencyReportStage = 0;
+        formatLatencyReportLine();
+    }
+
+    /// @brief Executes one command received over Bluetooth.
+    /// @param command [Command] to execute.
+    /// @param replayed [bool] true for a command of the session replayed, which is neither recorded nor aborts it.
+    void execute(const Command &command, bool replayed=false) {
+        LATENCY_PROBE(LatencyStage::COMMAND_EXECUTE);
+        if (!replayed) {
+            // Drive commands take the wheels back from a calibration sweep or a replay.
+            if (command.opcode == CommandOpcode::DRIVE_STOP || isMovement(command.opcode)) {
+                if (calibrationSweep != NULL) calibrationSweep->abort();
+                if (replayer != NULL) replayer->stop();
+            }
+            if (recorder != NULL) recorder->record(command);
         }
-        // Command Parse
-        switch (command) {
-            case 'Q':
-                speed = 255;
+        switch (command.opcode) {
+            case CommandOpcode::SET_SPEED:
+                speed = command.payload[0];
                 break;
                 
             // Drive Direction Select
-            case 'F':
+            case CommandOpcode::DRIVE_FORWARD:
                 nDualWheelDrive->forward(speed);
                 break;
 
-            case 'B':
+            case CommandOpcode::DRIVE_BACKWARD:
                 nDualWheelDrive->backward(speed);
                 break;
             
-            case 'I':
+            case CommandOpcode::DRIVE_SMOOTH_LEFT:
                 nDualWheelDrive->smoothLeft(speed);
                 break;
             
-            case 'G':
+            case CommandOpcode::DRIVE_SMOOTH_RIGHT:
                 nDualWheelDrive->smoothRight(speed);
                 break;
             
-            case 'R':
+            case CommandOpcode::DRIVE_HARD_LEFT:
                 nDualWheelDrive->hardLeft(speed);
                 break;
 
-            case 'L':
+            case CommandOpcode::DRIVE_HARD_RIGHT:
                 nDualWheelDrive->hardRight(speed);
                 break;
             
-            case 'S':
+            case CommandOpcode::DRIVE_STOP:
                 nDualWheelDrive->stop();
                 break;
+
+            // Proportional drive
+            case CommandOpcode::DRIVE_ARCADE:
+                nDualWheelDrive->steer(commandAxis(command.payload[0]), commandAxis(command.payload[1]));
+                break;
+
+            case CommandOpcode::DRIVE_TANK:
+                nDualWheelDrive->drive(commandAxis(command.payload[0]).toPwm(), commandAxis(command.payload[1]).toPwm());
+                break;
             
             // Lifter control
-            case 'W':
+            case CommandOpcode::LIFTER_UP:
                 lifter->moveUp();
                 break;
 
-            case 'U':
+            case CommandOpcode::LIFTER_DOWN:
                 lifter->moveDown();
                 break;
 
-            case 'w': case 'u':
+            case CommandOpcode::LIFTER_STOP:
                 lifter->stop();
                 break;
+
+            // Diagnostics
+            case CommandOpcode::REPORT_LATENCY:
+                startLatencyReport();
+                break;
+
+            // Hybrid control
+            case CommandOpcode::MANUAL_OVERRIDE:
+                if (arbiter != NULL) arbiter->setOverride(command.payload[0] != 0 ? arbiterChannel : -1);
+                break;
+
+            // Motor calibration
+            case CommandOpcode::CALIBRATE_MOTORS:
+                if (replayer != NULL) replayer->stop();
+                startCalibration();
+                break;
+
+            // Session recording
+            case CommandOpcode::RECORD_SESSION:
+                record(command.payload[0] != 0);
+                break;
+
+            case CommandOpcode::REPLAY_SESSION:
+                replay();
+                break;
         }
+        // The sweep drives the wheels itself, so the deadman must not stop it.
+        if (command.opcode == CommandOpcode::DRIVE_STOP || command.opcode == CommandOpcode::CALIBRATE_MOTORS) driving = false;
+        else if (isMovement(command.opcode)) driving = true;
+    }
+
+    /// @brief One Step of the Robot when it is to be controlled over Bluetooth. This function is called
+    /// to control the Robot. Every command received since the last step (up to [MAX_COMMANDS_PER_STEP]) is executed.
+    /// @param verbose [bool] if true, the function prints the command received and status of the Robot over Serial Monitor.
+    /// @param verboseBluetooth [bool] if true, the function sends the status of the Robot over Bluetooth, as text.
+    /// Lines are queued and sent over the next steps; those that find the queue full are dropped: prefer [setTelemetry].
+    void step(bool verbose=false, bool verboseBluetooth=false) {
+        // Stop the Robot if no command has arrived for the command timeout.
+        if (deadman.hasExpired()) {
+            nDualWheelDrive->stop();
+            deadman.stop();
+            driving = false;
+            deadmanStops++;
+        }
+
+        // Drain the backlog of received commands.
+        Command command;
+        uint8_t lastOpcode = CommandOpcode::NO_COMMAND;
+        for (int i = 0; i < MAX_COMMANDS_PER_STEP && bluetooth->receiveCommand(command); i++) {
+            execute(command);
+            lastOpcode = command.opcode;
+        }
+        updateCalibration();
+
+        // Replayed commands run once due, feeding the deadman as they did when received.
+        if (replayer != NULL && replayer->isReplaying()) {
+            for (int i = 0; i < MAX_COMMANDS_PER_STEP && replayer->next(command); i++) {
+                execute(command, true);
+                lastOpcode = command.opcode;
+            }
+            if (!replayer->isReplaying()) {
+                nDualWheelDrive->stop();
+                driving = false;
+                bluetooth->send("replay done");
+            }
+        }
+        if (recorder != NULL) recorder->update();
+        sendReplies();
 
         // Keep track of the status and print it if verbose is true  
         if (verbose || verboseBluetooth) { 
-            if (command == 'W' || command == 'U')
+            LATENCY_PROBE(LatencyStage::STATUS_REPORT);
+            // Status text is only built here, on the stack, when it is asked for.
+            char statusMessage[DualWheelDriveBase::STATUS_TEXT_SIZE];
+            if (lastOpcode == CommandOpcode::LIFTER_UP || lastOpcode == CommandOpcode::LIFTER_DOWN) {
                 status = lifter->getStatus();
-            else status = nDualWheelDrive->getStatus();
-        }
-        if (verbose) {
-            Serial.print("Command: " + String(command));
-            Serial.println("; Status: " + status);
-        }
-        // Send the status over Bluetooth if verboseBluetooth is true
-        if (verboseBluetooth) {
-            bluetooth->send(status);
+                StatusWriter(statusMessage, sizeof(statusMessage)).append(statusText(status));
+            } else {
+                status = nDualWheelDrive->getStatus().status;
+                nDualWheelDrive->formatStatus(statusMessage, sizeof(statusMessage));
+            }
+            if (verbose) {
+                hal::console().print("Command: ");
+                hal::console().print(commandName(lastOpcode));
+                hal::console().print("; Status: ");
+                hal::console().println(statusMessage);
+            }
+            // Send the status over Bluetooth if verboseBluetooth is true
+            if (verboseBluetooth) {
+                bluetooth->send(statusMessage);
+            }
         }
 
-        // To make control tactile, the Robot is stopped a while after each movement command is received.
-        if (command != 'S' && command != '\0') {
-            delay(40);
-            nDualWheelDrive->stop();
+        if (telemetry != NULL) {
+            LATENCY_PROBE(LatencyStage::STATUS_REPORT);
+            // The wheels themselves, not this controller's intent, when the drive is arbitrated.
+            DualWheelDriveBase *wheels = arbiter != NULL ? arbiter->getDrive() : nDualWheelDrive;
+            telemetry->sample(wheels->getLeftSpeed(), wheels->getRightSpeed(), irSensors != NULL ? irSensors->readWhite() : 0);
+            telemetry->flush();
         }
+
+        // While the Robot is driven, every command received feeds the deadman, so a held button drives continuously.
+        if (!driving || commandTimeoutMs == 0) deadman.stop();
+        else if (lastOpcode != CommandOpcode::NO_COMMAND) deadman.start(commandTimeoutMs);
     }
-};
+};
\ No newline at end of file
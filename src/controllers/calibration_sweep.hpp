@@ -0,0 +1,227 @@
+#pragma once
+
+#include "../interfaces/2N_wheel_drive_interface.hpp"
+#include "../interfaces/wheel_encoders_interface.hpp"
+#include "../utils/speed_calibration.hpp"
+#include "../utils/task_scheduler.hpp"
+
+/// <summary>
+/// @file calibration_sweep.hpp
+/// @brief This file contains the [CalibrationSweep], which measures the speed curves of the drive motors.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+
+/// @class CalibrationSweep
+/// @brief Sweeps the drive through its PWM speeds on the spot, measures each side with the wheel encoders and
+/// fits the [SpeedCurve]s of a [SpeedCalibration] from the measurements.
+///
+/// @details The Robot turns on the spot (left side forward, right side backward), so the sweep needs no more
+/// room than the Robot itself, at every knot speed of a [SpeedCurve] in turn: [SETTLE_MS] to reach it, then
+/// [MEASURE_MS] counting each side's encoder edges. The curves are turned off meanwhile, so the motors' own
+/// response is measured. Each side's curve then maps a speed to the duty turning that side at that fraction
+/// of the full speed of the weaker side, starting from the edge of its dead band: both sides match, and
+/// respond linearly. The encoders count a side, not a motor, so both motors of a side get its curve. The
+/// curves are applied at once and saved to EEPROM a byte per [update]. Non-blocking: call [update] every loop
+/// pass while [isRunning].
+class CalibrationSweep {
+public:
+    /// Time for the wheels to reach a speed of the sweep, and time they are measured at it.
+    static const unsigned long SETTLE_MS = 300;
+
+    static const unsigned long MEASURE_MS = 700;
+
+    /// How the last sweep ended.
+    enum Outcome : uint8_t {
+        NOT_RUN,
+        CALIBRATED,
+        /// A side did not turn at full speed: the curves were left as they were.
+        FAILED,
+        ABORTED
+    };
+
+private:
+    static const int NUMBER_OF_LEVELS = SpeedCurve::NUMBER_OF_KNOTS - 1;
+
+    enum Phase : uint8_t {
+        IDLE,
+        SETTLING,
+        MEASURING,
+        SAVING
+    };
+
+    DualWheelDriveBase *drive;
+
+    WheelEncodersInterface *encoders;
+
+    SpeedCalibration *calibration;
+
+    int numberOfMotors;
+
+    Phase phase;
+
+    Outcome outcome;
+
+    /// Speed being measured, 1 to [NUMBER_OF_LEVELS], and counts of each side at each speed.
+    int level;
+
+    uint16_t leftCounts[NUMBER_OF_LEVELS], rightCounts[NUMBER_OF_LEVELS];
+
+    /// Odometry counts when the measurement of [level] started.
+    long startDistance, startRotation;
+
+    Timer timer;
+
+    /// @return [int] duty of the knot [knot]: 16 per knot, and 255 for the last.
+    static int knotDuty(int knot) {
+        return knot >= NUMBER_OF_LEVELS ? 255 : knot * SpeedCurve::KNOT_SPACING;
+    }
+
+    void driveLevel() {
+        drive->drive(knotDuty(level), -knotDuty(level));
+        timer.start(SETTLE_MS);
+        phase = Phase::SETTLING;
+    }
+
+    /// @brief Fits [curve] to the [counts] of a side at each level, for the full speed [top] in counts.
+    static void fit(SpeedCurve &curve, const uint16_t counts[], long top) {
+        // Counts at duty 0, then at each level, made non-decreasing against measurement noise.
+        long rate[NUMBER_OF_LEVELS + 1];
+        rate[0] = 0;
+        for (int i = 1; i <= NUMBER_OF_LEVELS; i++) rate[i] = counts[i - 1] > rate[i - 1] ? counts[i - 1] : rate[i - 1];
+        // The first knot is the edge of the dead band, the highest duty not turning the side.
+        int still = 0;
+        while (still < NUMBER_OF_LEVELS && rate[still + 1] == 0) still++;
+        curve.knots[0] = (uint8_t) knotDuty(still);
+        // The others invert the measured rates, linearly between levels, at their share of the full speed.
+        for (int knot = 1; knot < SpeedCurve::NUMBER_OF_KNOTS; knot++) {
+            long target = top * knotDuty(knot) / 255;
+            int i = still + 1;
+            while (i < NUMBER_OF_LEVELS && rate[i] < target) i++;
+            long span = rate[i] - rate[i - 1];
+            long duty = knotDuty(i - 1) + (span == 0 ? 0 : (knotDuty(i) - knotDuty(i - 1)) * (target - rate[i - 1]) / span);
+            curve.knots[knot] = (uint8_t) (duty > 255 ? 255 : (duty < curve.knots[knot - 1] ? curve.knots[knot - 1] : duty));
+        }
+    }
+
+    /// @brief Fits and applies the curves of both sides, and starts saving them.
+    void finish() {
+        long leftTop = leftCounts[NUMBER_OF_LEVELS - 1], rightTop = rightCounts[NUMBER_OF_LEVELS - 1];
+        long top = leftTop < rightTop ? leftTop : rightTop;
+        if (top == 0) {
+            calibration->setEnabled(true);
+            outcome = Outcome::FAILED;
+            phase = Phase::IDLE;
+            return;
+        }
+        fit(calibration->getCurve(0), leftCounts, top);
+        fit(calibration->getCurve(1), rightCounts, top);
+        for (int motor = 2; motor < numberOfMotors; motor++) calibration->getCurve(motor) = calibration->getCurve(motor % 2);
+        calibration->setNumberOfCurves(numberOfMotors);
+        calibration->setEnabled(true);
+        calibration->beginSave();
+        outcome = Outcome::CALIBRATED;
+        phase = Phase::SAVING;
+    }
+
+public:
+    /// @brief Constuctor initializing the [CalibrationSweep].
+    /// @param drive [DualWheelDriveBase] turning the wheels during the sweep.
+    /// @param encoders [WheelEncodersInterface] measuring them, updated by the drive of the wheels.
+    /// @param calibration [SpeedCalibration] the motor drivers apply, which the curves are fitted into.
+    /// @param numberOfMotorDrivers Number of drive motor drivers, numbered as their motors' curves.
+    /// @return [CalibrationSweep] object
+    CalibrationSweep(DualWheelDriveBase *drive, WheelEncodersInterface *encoders, SpeedCalibration *calibration,
+        int numberOfMotorDrivers) {
+        this->drive = drive;
+        this->encoders = encoders;
+        this->calibration = calibration;
+        numberOfMotors = 2 * numberOfMotorDrivers;
+        if (numberOfMotors > SpeedCalibration::MAX_NUMBER_OF_MOTORS) numberOfMotors = SpeedCalibration::MAX_NUMBER_OF_MOTORS;
+        phase = Phase::IDLE;
+        outcome = Outcome::NOT_RUN;
+        level = 0;
+    }
+
+    /// @brief Starts the sweep, turning the Robot on the spot. Non-blocking.
+    /// @return [bool] false if no encoders are fitted, or a sweep or save is already running.
+    bool start() {
+        if (encoders == NULL || phase != Phase::IDLE) return false;
+        calibration->setEnabled(false);
+        outcome = Outcome::NOT_RUN;
+        level = 1;
+        driveLevel();
+        return true;
+    }
+
+    /// @brief Stops the Robot and ends the sweep, keeping the curves as they were. A save in progress goes on.
+    void abort() {
+        if (phase != Phase::SETTLING && phase != Phase::MEASURING) return;
+        timer.stop();
+        drive->stop();
+        calibration->setEnabled(true);
+        outcome = Outcome::ABORTED;
+        phase = Phase::IDLE;
+    }
+
+    /// @brief Moves the sweep on: to the next speed once one is measured, then fits the curves and writes a
+    /// byte of their save per call. Non-blocking.
+    void update() {
+        switch (phase) {
+            case Phase::IDLE:
+                break;
+
+            case Phase::SETTLING:
+                if (!timer.hasExpired()) break;
+                startDistance = encoders->getOdometry().getDistanceCounts();
+                startRotation = encoders->getOdometry().getRotationCounts();
+                timer.start(MEASURE_MS);
+                phase = Phase::MEASURING;
+                break;
+
+            case Phase::MEASURING: {
+                if (!timer.hasExpired()) break;
+                // Left = (distance - rotation) / 2 and right = (distance + rotation) / 2, turning backwards.
+                long distance = encoders->getOdometry().getDistanceCounts() - startDistance;
+                long rotation = encoders->getOdometry().getRotationCounts() - startRotation;
+                long left = (distance - rotation) / 2, right = -(distance + rotation) / 2;
+                leftCounts[level - 1] = (uint16_t) (left > 0 ? left : 0);
+                rightCounts[level - 1] = (uint16_t) (right > 0 ? right : 0);
+                if (level < NUMBER_OF_LEVELS) {
+                    level++;
+                    driveLevel();
+                } else {
+                    timer.stop();
+                    drive->stop();
+                    finish();
+                }
+                break;
+            }
+
+            case Phase::SAVING:
+                if (calibration->saveStep()) phase = Phase::IDLE;
+                break;
+        }
+    }
+
+    /// @return [bool] true while the sweep or the save of its curves is running.
+    bool isRunning() const {
+        return phase != Phase::IDLE;
+    }
+
+    /// @return [bool] true while the sweep is driving the Robot.
+    bool isSweeping() const {
+        return phase == Phase::SETTLING || phase == Phase::MEASURING;
+    }
+
+    /// @return [Outcome] of the last sweep, [NOT_RUN] while one is running.
+    Outcome getOutcome() const {
+        return outcome;
+    }
+
+    /// @return [int] encoder counts of the left (or right) side at the PWM speed [knotDuty] of [level], 1 to 16,
+    /// as last measured.
+    int getCounts(int level, bool right) const {
+        return right ? rightCounts[level - 1] : leftCounts[level - 1];
+    }
+};
@@ -0,0 +1,247 @@
+#pragma once
+
+#include "../interfaces/2N_wheel_drive_interface.hpp"
+#include "../utils/latency_probe.hpp"
+
+/// <summary>
+/// @file motion_arbiter.hpp
+/// @brief This file contains the [MotionArbiter] class and the [ArbitratedDrive] each controller of the HYBRID
+/// Control Mode drives through.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+
+class MotionArbiter;
+
+/// @class ArbitratedDrive
+/// @brief [DualWheelDriveBase] given to one controller in place of the drive: the speeds it would write are
+/// its motion intent, submitted to a [MotionArbiter] which decides whether they reach the wheels.
+///
+/// @details A controller drives it like the real drive (movement commands, [driveDistance], [turnAngle]), so
+/// it needs no change to take part in arbitration. Every movement command, even one repeating the last,
+/// renews the intent; the speeds of a manoeuvre slowing down are picked up by the arbiter's [update]. It never
+/// ramps: the real drive ramps what the arbiter applies, handoffs included. Fit the encoders shared (see
+/// [DualWheelDriveBase::setEncoders]).
+class ArbitratedDrive final : public DualWheelDriveBase {
+private:
+    MotionArbiter *arbiter;
+
+    int channel;
+
+    uint8_t priority;
+
+    unsigned long holdMs;
+
+    /// Latest intent: the speeds, when they were submitted, and whether there was one yet.
+    int intentLeft, intentRight;
+
+    unsigned long intentMs;
+
+    bool intending;
+
+protected:
+    /// Keeps the speeds as the intent. Called only when they changed.
+    void writeSpeeds(int leftSpeed, int rightSpeed) override {
+        intentLeft = leftSpeed;
+        intentRight = rightSpeed;
+    }
+
+    /// Renews the intent, repeated commands included, and submits it.
+    void onCommand() override;
+
+public:
+    /// @brief Constuctor initializing the [ArbitratedDrive] Class and adding it to [arbiter].
+    /// @param arbiter [MotionArbiter] the intents are submitted to.
+    /// @param priority Priority of the intents: the highest priority with a live intent drives.
+    /// @param holdMs Milliseconds an intent stays live after it was submitted, 0 for ever.
+    /// @return [ArbitratedDrive] object
+    ArbitratedDrive(MotionArbiter *arbiter, uint8_t priority, unsigned long holdMs);
+
+    /// @return [int] index of the channel in the arbiter, e.g. for [MotionArbiter::setOverride].
+    int getChannel() const {
+        return channel;
+    }
+
+    uint8_t getPriority() const {
+        return priority;
+    }
+
+    /// @return [bool] true once a movement command was given.
+    bool hasIntent() const {
+        return intending;
+    }
+
+    /// @return [bool] true if an intent was submitted and is still live at [nowMs].
+    bool isIntentLive(unsigned long nowMs) const {
+        return intending && (holdMs == 0 || nowMs - intentMs < holdMs);
+    }
+
+    int getIntentLeft() const {
+        return intentLeft;
+    }
+
+    int getIntentRight() const {
+        return intentRight;
+    }
+
+    int getNumberOfMotorDrivers() const override;
+
+    StatusCode getDriverStatus(int index) override;
+};
+
+/// @class MotionArbiter
+/// @brief Decides which controller drives the wheels, from the motion intents they submit through their
+/// [ArbitratedDrive]s.
+///
+/// @details Every controller runs on every loop, each with its own [ArbitratedDrive]. The channel with the
+/// highest priority whose latest intent is live drives: in HYBRID, Bluetooth (manual) intents are held for a
+/// while after each command and override the autonomous ones, which never expire, so once the operator has
+/// been silent for the hold time control falls back to autonomy. [setOverride] pins control to one channel
+/// (manual override) until it is released.
+///
+/// A decision is made on every movement command of a channel, so taking over is immediate, and on every
+/// [update], so a fallback happens at most one [DualWheelDriveBase::RAMP_PERIOD_MS] after the hold time ran
+/// out. The winner's latest intent is applied at once, without waiting for its controller to command again;
+/// the real drive then ramps to it. Decisions only cost a few comparisons per channel (see arbiter_benchmark.hpp).
+///
+/// Only the wheels are arbitrated: the lifter obeys whichever controller commands it.
+class MotionArbiter {
+public:
+    static const int MAX_NUMBER_OF_CHANNELS = 4;
+
+private:
+    DualWheelDriveBase *drive;
+
+    ArbitratedDrive *channels[MAX_NUMBER_OF_CHANNELS];
+
+    int numberOfChannels;
+
+    /// Channel driving the wheels, -1 for none (stopped), and the one pinned by [setOverride], -1 for none.
+    int active;
+
+    int overridden;
+
+    /// Speeds last applied to the drive, and whether any were.
+    int appliedLeft, appliedRight;
+
+    bool applied;
+
+    unsigned long handoffs;
+
+    unsigned long lastHandoffMs;
+
+public:
+    /// @brief Constuctor initializing the [MotionArbiter] Class.
+    /// @param drive [DualWheelDriveBase] writing the wheels. Its ramp and encoders are set up as usual.
+    /// @return [MotionArbiter] object
+    MotionArbiter(DualWheelDriveBase *drive) {
+        this->drive = drive;
+        numberOfChannels = 0;
+        active = -1;
+        overridden = -1;
+        appliedLeft = appliedRight = 0;
+        applied = false;
+        handoffs = 0;
+        lastHandoffMs = 0;
+    }
+
+    /// @brief Adds a channel. Called by the [ArbitratedDrive] constructor.
+    /// @return [int] index of the channel, or -1 if [MAX_NUMBER_OF_CHANNELS] are taken.
+    int addChannel(ArbitratedDrive *channel) {
+        if (numberOfChannels >= MAX_NUMBER_OF_CHANNELS) return -1;
+        channels[numberOfChannels] = channel;
+        return numberOfChannels++;
+    }
+
+    /// @brief Picks the channel that drives and applies its intent to the drive, if it changed. Non-blocking.
+    void decide() {
+        LATENCY_PROBE(LatencyStage::MOTION_ARBITER);
+        unsigned long now = hal::millis();
+        int winner = overridden;
+        if (winner < 0) {
+            for (int i = 0; i < numberOfChannels; i++) {
+                if (!channels[i]->isIntentLive(now)) continue;
+                if (winner < 0 || channels[i]->getPriority() > channels[winner]->getPriority()) winner = i;
+            }
+        }
+        if (winner != active) {
+            active = winner;
+            handoffs++;
+            lastHandoffMs = now;
+        }
+        // No live intent, or an override by a channel that has not asked for anything yet: stop.
+        int left = 0, right = 0;
+        if (winner >= 0 && channels[winner]->hasIntent()) {
+            left = channels[winner]->getIntentLeft();
+            right = channels[winner]->getIntentRight();
+        }
+        if (applied && left == appliedLeft && right == appliedRight) return;
+        drive->drive(left, right);
+        appliedLeft = left;
+        appliedRight = right;
+        applied = true;
+    }
+
+    /// @brief Follows the manoeuvres of every channel, makes a decision and ramps the drive. Non-blocking; call
+    /// every [DualWheelDriveBase::RAMP_PERIOD_MS] instead of the drive's own [DualWheelDriveBase::update].
+    void update() {
+        for (int i = 0; i < numberOfChannels; i++) channels[i]->update();
+        decide();
+        drive->update();
+    }
+
+    /// @brief Pins control to [channel] whatever the priorities and hold times (manual override), or releases
+    /// it with -1.
+    void setOverride(int channel) {
+        overridden = channel >= 0 && channel < numberOfChannels ? channel : -1;
+        decide();
+    }
+
+    /// @return [int] channel pinned by [setOverride], -1 for none.
+    int getOverride() const {
+        return overridden;
+    }
+
+    /// @return [int] channel driving the wheels, -1 for none.
+    int getActiveChannel() const {
+        return active;
+    }
+
+    /// @return [unsigned long] number of times control changed hands.
+    unsigned long getHandoffs() const {
+        return handoffs;
+    }
+
+    /// @return [unsigned long] millis() of the last change of hands.
+    unsigned long getLastHandoffMs() const {
+        return lastHandoffMs;
+    }
+
+    DualWheelDriveBase *getDrive() const {
+        return drive;
+    }
+};
+
+inline ArbitratedDrive::ArbitratedDrive(MotionArbiter *arbiter, uint8_t priority, unsigned long holdMs) {
+    this->arbiter = arbiter;
+    this->priority = priority;
+    this->holdMs = holdMs;
+    intentLeft = intentRight = 0;
+    intentMs = 0;
+    intending = false;
+    channel = arbiter->addChannel(this);
+}
+
+inline void ArbitratedDrive::onCommand() {
+    intentMs = hal::millis();
+    intending = true;
+    arbiter->decide();
+}
+
+inline int ArbitratedDrive::getNumberOfMotorDrivers() const {
+    return arbiter->getDrive()->getNumberOfMotorDrivers();
+}
+
+inline StatusCode ArbitratedDrive::getDriverStatus(int index) {
+    return arbiter->getDrive()->getDriverStatus(index);
+}
@@ -1,5 +1,6 @@
-#include "..\interfaces\bluetooth_interface.hpp"
-#include "..\interfaces\2N_wheel_drive_interface.hpp"
+#include "../interfaces/bluetooth_interface.hpp"
+#include "../interfaces/2N_wheel_drive_interface.hpp"
+#include "../interfaces/lifter_interface.hpp"
 
 // <summary>
 /// @file test_controller.hpp
@@ -12,50 +13,52 @@
 /// @brief This class is used to test the various interfaces of the Robot for quick debugging and fault detection.
 ///
 /// @details The Robot is controlled according to various test logic using the 
-/// [NDualWheelDriveInterface] class to control the motors and [BluetoothInterface] to test Bluetooth communication.
+/// [DualWheelDriveBase] class to control the motors and [BluetoothInterface] to test Bluetooth communication.
 class TestController {
 private:
     BluetoothInterface* bluetooth;
     
-    NDualWheelDriveInterface* fourWheelDrive;
+    DualWheelDriveBase* fourWheelDrive;
 
     LifterInterface* lifter;
 
-    String status;
+    StatusCode status;
 
 public:
     /// @brief Constuctor initializing the [TestController] Class.
-    /// @param fourWheelDrive [NDualWheelDriveInterface] object controlling the motors.
+    /// @param fourWheelDrive [DualWheelDriveBase] object controlling the motors.
     /// @return [TestController] object
-    TestController(BluetoothInterface* bluetooth, NDualWheelDriveInterface* fourWheelDrive) {
+    TestController(BluetoothInterface* bluetooth, DualWheelDriveBase* fourWheelDrive) {
         this->fourWheelDrive = fourWheelDrive;
         this->bluetooth = bluetooth;
 
         // Check if Bluetooth interface is initialized and ready.
-        if (this->bluetooth->getStatus() != "ready") {
-            const String error = "Bluetooth is not ready. Status: ";
-            Serial.println(error);
+        if (this->bluetooth->getStatus() != StatusCode::READY) {
+            const char *error = "Bluetooth is not ready. Status: ";
+            hal::console().print(error);
+            hal::console().println(statusText(this->bluetooth->getStatus()));
             // throw error;
         }
-        status = "ready";
+        status = StatusCode::READY;
     }
 
     /// @brief Constuctor initializing the [TestController] Class.
-    /// @param fourWheelDrive [NDualWheelDriveInterface] object controlling the motors.
+    /// @param fourWheelDrive [DualWheelDriveBase] object controlling the motors.
     /// @param lifter [LifterInterface] object controlling the lifter.
     /// @return [TestController] object
-    TestController(BluetoothInterface* bluetooth, NDualWheelDriveInterface* fourWheelDrive, LifterInterface* lifter) {
+    TestController(BluetoothInterface* bluetooth, DualWheelDriveBase* fourWheelDrive, LifterInterface* lifter) {
         this->bluetooth = bluetooth;
         this->fourWheelDrive = fourWheelDrive;
         this->lifter = lifter;
 
         // Check if Bluetooth interface is initialized and ready.
-        if (this->bluetooth->getStatus() != "ready") {
-            const String error = "Bluetooth is not ready. Status: ";
-            Serial.println(error);
+        if (this->bluetooth->getStatus() != StatusCode::READY) {
+            const char *error = "Bluetooth is not ready. Status: ";
+            hal::console().print(error);
+            hal::console().println(statusText(this->bluetooth->getStatus()));
             // throw error;
         }
-        status = "ready";
+        status = StatusCode::READY;
     }
 
     /// Unit test for the [NDualWheelDriveInterface] class. 
@@ -64,20 +67,23 @@ public:
     /// @param speed [int] speed of the motors.
     /// @param verbose [bool] if true, prints the status of the motors after each command.
     void motorsTest(int speed = 255, bool verbose=false) {
-        if (verbose) Serial.println("Running Motor Unit Tests at speed: " + String(speed));
+        if (verbose) {
+            hal::console().print("Running Motor Unit Tests at speed: ");
+            hal::console().println(speed);
+        }
         fourWheelDrive->forward(speed);
         fourWheelDrive->getStatus(verbose);
-        delay(2000);
+        hal::delay(2000);
         fourWheelDrive->backward(speed);
         fourWheelDrive->getStatus(verbose);
-        delay(2000);
+        hal::delay(2000);
         fourWheelDrive->smoothLeft(speed);
         fourWheelDrive->getStatus(verbose);
-        delay(2000);
+        hal::delay(2000);
         fourWheelDrive->hardRight(speed);
         fourWheelDrive->getStatus(verbose);
-        delay(2000);
-        Serial.println();
+        hal::delay(2000);
+        hal::console().println();
     }
 
     /// Unit test for the [BluetoothInterface] class.
@@ -85,15 +91,20 @@ public:
     ///
     /// @param verbose [bool] if true, prints the status of the motors after each command.
     void bluetoothTest(bool verbose=false) {
-        if (verbose) { Serial.println("Running Bluetooth Unit Tests!"); }
+        if (verbose) { hal::console().println("Running Bluetooth Unit Tests!"); }
         // Send message over Bluetooth.
         bluetooth->send("Send Test!");
-        if (verbose) { Serial.println("Sent: Send Test!"); }
+        while (bluetooth->isSending()) bluetooth->flushSend();
+        if (verbose) { hal::console().println("Sent: Send Test!"); }
         // Receive message from Bluetooth.
-        String message = bluetooth->receiveString();
-        if (verbose) { Serial.println("Received: " + message); }
-        Serial.println();
-        delay(200);
+        char message[64];
+        bluetooth->receiveString(message, sizeof(message));
+        if (verbose) {
+            hal::console().print("Received: ");
+            hal::console().println(message);
+        }
+        hal::console().println();
+        hal::delay(200);
     }
 
     /// Unit test for the [LifterInterface] class.
@@ -101,13 +112,13 @@ public:
     ///
     /// @param verbose [bool] if true, prints the status of the lifter after each command.
     void lifterTest(bool verbose=false) {
-        if (verbose) { Serial.println("Running Lifter Unit Tests!"); }
+        if (verbose) { hal::console().println("Running Lifter Unit Tests!"); }
         lifter->moveDown();
         if (verbose) { lifter->getStatus(verbose); }
-        delay(1000);
+        hal::delay(1000);
         lifter->stop();
         if (verbose) { lifter->getStatus(verbose); }
-        delay(5000);
+        hal::delay(5000);
     }
 
     /// Runs all defined unit tests in [TestController].
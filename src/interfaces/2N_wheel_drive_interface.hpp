@@ -1,108 +1,535 @@
 #pragma once
 #include "motordriver_interfaces.hpp"
+#include "wheel_encoders_interface.hpp"
+#include "../utils/latency_probe.hpp"
+#include "../utils/fixed_point.hpp"
 
 /// <summary>
 /// @file 2N_wheel_drive_interface.hpp
-/// @brief This file contains the [NDualWheelDriveInterface] class.
+/// @brief This file contains the [DualWheelDriveBase] class and its [NDualWheelDriveInterface] (drivers chosen at
+/// runtime) and [NDualWheelDrive] (drivers fixed at compile time) implementations.
 /// @author Dhiman Seal
 /// @version 1.0
 /// @date 2021-09-14
 
-/// @class NDualWheelDriveInterface
+/// @class DualWheelDriveBase
 /// @brief This class is used to control the 2N wheel drive robot being controlled using N Motor Drivers, 
 // each controlling 2 Motors.
 ///
-/// @details Initialized with an array of [drivers] objects, which represents the motor
-/// drivers used to control the robot and the [numberOfMotorDrivers], which CAN NOT exceed [MAX_NUMBER_OF_MOTOR_DRIVERS].
-class NDualWheelDriveInterface {
+/// @details The movement, ramping and status logic shared by [NDualWheelDriveInterface] and [NDualWheelDrive],
+/// which only differ in how the speeds reach their motor drivers ([writeSpeeds]). The controllers drive the
+/// robot through this class, whichever of the two is fitted.
+///
+/// Every movement command sets target signed speeds for the left and right wheels. By default they are written
+/// to the drivers at once. After [setRamp], the wheel speeds instead slew towards their targets at the given
+/// acceleration and deceleration, moved by [update], which must then be called periodically (every
+/// [RAMP_PERIOD_MS] from the scheduler in main.cpp). This keeps the motors from jumping between 0 and full
+/// speed, which causes current spikes, wheel slip and brown-outs.
+///
+/// All drivers change together (see [writeSpeedsTogether]), so the front and back wheels never fight each
+/// other while a command is being written.
+///
+/// With [WheelEncodersInterface] fitted ([setEncoders]), [driveDistance] and [turnAngle] drive until the
+/// encoders measure the distance or angle asked for, instead of for a time that only holds at one battery
+/// charge and on one floor. They are non-blocking: [update] follows them, and [isManoeuvreInProgress] tells
+/// when they are done. Any other movement command cancels them.
+class DualWheelDriveBase {
 public:
     static const int MAX_NUMBER_OF_MOTOR_DRIVERS = 10;
 
+    /// Size of a buffer that holds the [formatStatus] text of a 2 Motor Driver system.
+    /// Longer systems are truncated to fit.
+    static const int STATUS_TEXT_SIZE = 96;
+
+    /// Intended period in milliseconds of [update] while ramping or following a manoeuvre.
+    static const unsigned long RAMP_PERIOD_MS = 5;
+
+    /// Slowest speed a manoeuvre slows down to near its target, enough to keep the wheels turning.
+    static const int MANOEUVRE_CREEP_SPEED = 110;
+
+    /// Longest time in milliseconds one [update] ramps over, so a stalled loop does not end in a speed jump.
+    static const unsigned long MAX_RAMP_STEP_MS = 4 * RAMP_PERIOD_MS;
+
+    /// Plain snapshot of the status of the whole drive system.
+    struct DriveStatus {
+        StatusCode status;
+        uint8_t numberOfMotorDrivers;
+        StatusCode driverStatus[MAX_NUMBER_OF_MOTOR_DRIVERS];
+    };
+
 private:
-    int numberOfMotorDrivers;
+    StatusCode status;
 
-    MotorDriverInterface *drivers[MAX_NUMBER_OF_MOTOR_DRIVERS];
+    /// Signed speeds asked for by the last movement command, and the speeds the wheels are ramping through,
+    /// in PWM steps.
+    Q16_16 targetLeft, targetRight, currentLeft, currentRight;
+
+    /// Largest speed change per millisecond when speeding up and when slowing down. 0 when not ramping.
+    Q16_16 accelerationPerMs, decelerationPerMs;
+
+    /// Speeds last written to the drivers, -256 before the first write.
+    int outputLeft, outputRight;
+
+    unsigned long lastUpdateMs;
+
+    WheelEncodersInterface *encoders;
+
+    /// false when the encoders are shared with the drive that actually writes the wheels, which sets their
+    /// directions instead.
+    bool encodersFollowOutput;
 
-    String status;
+    /// Manoeuvre being followed: the counts it must reach ([Odometry::getDistanceCounts] for [driveDistance],
+    /// [Odometry::getRotationCounts] for [turnAngle]) from where it started, signed by its direction, and the
+    /// counts before it over which it slows down, and its progress at the last update.
+    bool manoeuvreInProgress, manoeuvreTurning;
+    long manoeuvreStart, manoeuvreTarget, manoeuvreSlowdown, manoeuvreLastProgress;
+    int manoeuvreSpeed;
+
+    /// @return [Q16_16] [current] moved towards [target] by at most [acceleration] while speeding up or
+    /// [deceleration] while slowing down. A change of direction slows down to 0 first.
+    static Q16_16 approach(Q16_16 current, Q16_16 target, Q16_16 acceleration, Q16_16 deceleration) {
+        Q16_16 zero;
+        bool slowing = (current > zero && target < current) || (current < zero && target > current);
+        if (!slowing) {
+            if (target > current) return current + acceleration < target ? current + acceleration : target;
+            return current - acceleration > target ? current - acceleration : target;
+        }
+        // Slow down towards the target, or towards 0 if the target is the other way
+        Q16_16 stop = (current > zero) == (target > zero) ? target : zero;
+        if (current > zero) return current - deceleration > stop ? current - deceleration : stop;
+        return current + deceleration < stop ? current + deceleration : stop;
+    }
+
+    /// Writes the current speeds to every driver, if they changed since the last write.
+    void output() {
+        int left = (int) currentLeft.toInt(), right = (int) currentRight.toInt();
+        if (left == outputLeft && right == outputRight) return;
+        LATENCY_PROBE(LatencyStage::MOTOR_OUTPUT);
+        if (encoders != NULL && encodersFollowOutput) encoders->setDirections(left, right);
+        writeSpeeds(left, right);
+        outputLeft = left;
+        outputRight = right;
+    }
+
+    /// Sets new target speeds, reached at once if not ramping.
+    void setTargets(int leftSpeed, int rightSpeed, StatusCode status) {
+        targetLeft = Q16_16::fromInt(leftSpeed > 255 ? 255 : (leftSpeed < -255 ? -255 : leftSpeed));
+        targetRight = Q16_16::fromInt(rightSpeed > 255 ? 255 : (rightSpeed < -255 ? -255 : rightSpeed));
+        this->status = status;
+        if (!isRamping()) {
+            currentLeft = targetLeft;
+            currentRight = targetRight;
+            output();
+        } else {
+            ramp();
+        }
+    }
+
+    /// Sets new target speeds for a movement command, ending any manoeuvre.
+    void command(int leftSpeed, int rightSpeed, StatusCode status) {
+        manoeuvreInProgress = false;
+        setTargets(leftSpeed, rightSpeed, status);
+        onCommand();
+    }
+
+    /// Moves the wheel speeds one step towards their targets, if ramping.
+    void ramp() {
+        if (!isRamping()) return;
+        unsigned long now = hal::millis();
+        unsigned long elapsedMs = now - lastUpdateMs;
+        lastUpdateMs = now;
+        if (!isRampInProgress()) return;
+        if (elapsedMs > MAX_RAMP_STEP_MS) elapsedMs = MAX_RAMP_STEP_MS;
+        Q16_16 elapsed = Q16_16::fromInt(elapsedMs);
+        Q16_16 acceleration = accelerationPerMs * elapsed, deceleration = decelerationPerMs * elapsed;
+        currentLeft = approach(currentLeft, targetLeft, acceleration, deceleration);
+        currentRight = approach(currentRight, targetRight, acceleration, deceleration);
+        output();
+    }
+
+    /// @return [long] counts of the manoeuvre measure since it started, positive in its direction.
+    long manoeuvreProgress() {
+        Odometry &odometry = encoders->getOdometry();
+        long counts = (manoeuvreTurning ? odometry.getRotationCounts() : odometry.getDistanceCounts()) - manoeuvreStart;
+        return manoeuvreTarget < 0 ? -counts : counts;
+    }
+
+    /// Stops the manoeuvre once it is no further from its target than it came since the last update, as the
+    /// wheels coast about that far while they stop, and slows it down over its last [manoeuvreSlowdown] counts.
+    void followManoeuvre() {
+        long target = manoeuvreTarget < 0 ? -manoeuvreTarget : manoeuvreTarget;
+        long progress = manoeuvreProgress();
+        long remaining = target - progress;
+        long lastStep = progress - manoeuvreLastProgress;
+        manoeuvreLastProgress = progress;
+        if (remaining <= lastStep) {
+            manoeuvreInProgress = false;
+            setTargets(0, 0, StatusCode::STOPPED);
+            return;
+        }
+        int speed = manoeuvreSpeed;
+        if (remaining < manoeuvreSlowdown) {
+            speed = (int) (MANOEUVRE_CREEP_SPEED + (long) (manoeuvreSpeed - MANOEUVRE_CREEP_SPEED) * remaining / manoeuvreSlowdown);
+        }
+        int left = manoeuvreTurning ? -speed : speed, right = speed;
+        if (manoeuvreTarget < 0) {
+            left = -left;
+            right = -right;
+        }
+        setTargets(left, right, status);
+    }
+
+    /// Starts following a manoeuvre of [targetCounts] (signed) at [speed], slowing down over [slowdownCounts].
+    bool startManoeuvre(bool turning, long targetCounts, long slowdownCounts, int speed) {
+        if (encoders == NULL) return false;
+        speed = speed > 255 ? 255 : (speed < 0 ? 0 : speed);
+        encoders->update();
+        Odometry &odometry = encoders->getOdometry();
+        manoeuvreTurning = turning;
+        manoeuvreStart = turning ? odometry.getRotationCounts() : odometry.getDistanceCounts();
+        manoeuvreTarget = targetCounts;
+        manoeuvreLastProgress = 0;
+        manoeuvreSpeed = speed;
+        manoeuvreSlowdown = speed > MANOEUVRE_CREEP_SPEED ? slowdownCounts : 0;
+        manoeuvreInProgress = true;
+        if (turning) status = targetCounts < 0 ? StatusCode::HARD_RIGHT : StatusCode::HARD_LEFT;
+        else status = targetCounts < 0 ? StatusCode::BACKWARD : StatusCode::FORWARD;
+        followManoeuvre();
+        onCommand();
+        return true;
+    }
+
+protected:
+    /// @brief Called after every movement command, once its speeds are set. Does nothing by default; an
+    /// [ArbitratedDrive] renews its intent.
+    virtual void onCommand() {}
+
+    /// @brief Writes signed wheel speeds to every motor driver.
+    /// @param leftSpeed Signed speed of the left wheels, negative for reverse. Range: -255-255
+    /// @param rightSpeed Signed speed of the right wheels, negative for reverse. Range: -255-255
+    virtual void writeSpeeds(int leftSpeed, int rightSpeed) = 0;
+
+    /// @brief [writeSpeeds] of [numberOfMotorDrivers] [drivers], with all wheels changing together: the
+    /// direction pins of every driver that can batch them are collected first, then, with interrupts held off,
+    /// the pins going LOW are written, the speeds, and the pins going HIGH last (see [PortWriteBatch]). No
+    /// wheel is driven against another on the way, and the wheels start in the few port writes of the last
+    /// step. Drivers that cannot batch are driven one after another under the same lock.
+    template <typename Driver>
+    static void writeSpeedsTogether(Driver *const drivers[], int numberOfMotorDrivers, int leftSpeed, int rightSpeed) {
+        PortWriteBatch batch;
+        bool batched[MAX_NUMBER_OF_MOTOR_DRIVERS];
+        for (int i = 0; i < numberOfMotorDrivers; i++)
+            batched[i] = drivers[i]->prepareDrive(batch, leftSpeed, rightSpeed);
+        hal::InterruptLock lock;
+        batch.releaseUnlocked();
+        for (int i = 0; i < numberOfMotorDrivers; i++) {
+            if (batched[i]) drivers[i]->commitDrive();
+            else drivers[i]->drive(leftSpeed, rightSpeed);
+        }
+        batch.applyUnlocked();
+    }
+
+    /// @brief Constuctor initializing the shared state of a stopped drive.
+    DualWheelDriveBase() {
+        outputLeft = outputRight = -256;
+        lastUpdateMs = hal::millis();
+        status = StatusCode::READY;
+        encoders = NULL;
+        encodersFollowOutput = true;
+        manoeuvreInProgress = manoeuvreTurning = false;
+        manoeuvreStart = manoeuvreTarget = manoeuvreSlowdown = manoeuvreLastProgress = 0;
+        manoeuvreSpeed = 0;
+    }
 
 public:
-    /// @brief Constuctor initializing the [NDualWheelDriveInterface] Class.
-    /// @param numberOfMotorDrivers Number of [MotorDriverInterface] objects, each meant to control 2 motors of the robot.
-    /// @param drivers Array of [MotorDriverInterface] objects, each meant to control 2 motors of the robot. 
-    /// Can Have a MAXIMUM of [MAX_NUMBER_OF_MOTOR_DRIVERS] drivers. Any more will be ignored.
-    /// @return [NDualWheelDriveInterface] object
-    NDualWheelDriveInterface(int numberOfMotorDrivers, MotorDriverInterface *drivers[]) {
-        this->numberOfMotorDrivers = numberOfMotorDrivers;
-        for (int i = 0; i < min(numberOfMotorDrivers, MAX_NUMBER_OF_MOTOR_DRIVERS); i++) {
-            this->drivers[i] = drivers[i]; 
+    virtual ~DualWheelDriveBase() {}
+
+    /// @return [int] number of motor drivers, each controlling 2 motors.
+    virtual int getNumberOfMotorDrivers() const = 0;
+
+    /// @return [StatusCode] status of the motor driver at [index].
+    virtual StatusCode getDriverStatus(int index) = 0;
+
+    /// @brief Limits how fast the wheel speeds may change. Commands then only set targets, which [update] ramps to.
+    /// @param acceleration Largest speed-up, in PWM steps per second, e.g. 1000 to reach full speed in about
+    /// 255 ms. 0 turns ramping off: speeds are written at once, as they were without ramping.
+    /// @param deceleration Largest slow-down (braking and stopping) in PWM steps per second. Default: [acceleration].
+    void setRamp(int acceleration, int deceleration=-1) {
+        if (deceleration < 0) deceleration = acceleration;
+        if (acceleration <= 0 || deceleration <= 0) acceleration = deceleration = 0;
+        accelerationPerMs = Q16_16::fromRatio(acceleration, 1000);
+        decelerationPerMs = Q16_16::fromRatio(deceleration, 1000);
+        lastUpdateMs = hal::millis();
+        if (!isRamping()) {
+            currentLeft = targetLeft;
+            currentRight = targetRight;
+            output();
+        }
+    }
+
+    /// @return [bool] true if speed changes are ramped by [update].
+    bool isRamping() const {
+        return accelerationPerMs > Q16_16();
+    }
+
+    /// @return [bool] true while the wheels have not reached the speeds of the last movement command.
+    bool isRampInProgress() const {
+        return currentLeft != targetLeft || currentRight != targetRight;
+    }
+
+    /// @return [int] signed speed last written to the left wheels, 0 before the first write.
+    int getLeftSpeed() const {
+        return outputLeft == -256 ? 0 : outputLeft;
+    }
+
+    /// @return [int] signed speed last written to the right wheels, 0 before the first write.
+    int getRightSpeed() const {
+        return outputLeft == -256 ? 0 : outputRight;
+    }
+
+    /// @brief Updates the odometry of the encoders, follows the manoeuvre in progress and moves the wheel speeds
+    /// one step towards their targets. Non-blocking; call every [RAMP_PERIOD_MS] while ramping or with
+    /// encoders fitted. Does nothing otherwise.
+    ///
+    /// @details The ramp step is the acceleration or deceleration times the milliseconds since the previous
+    /// update (at most [MAX_RAMP_STEP_MS]). Cost per update on the Mega: a millis() read and two Q16.16
+    /// multiplications and clamps, roughly 200 cycles (about 13 us). The drivers are only written when a
+    /// wheel's PWM speed actually changed, which adds the cost of a [drive] command on each driver.
+    void update() {
+        if (encoders != NULL) {
+            encoders->update();
+            if (manoeuvreInProgress) followManoeuvre();
         }
-        status = "ready";
+        ramp();
+    }
+
+    /// @brief Fits the wheel encoders [driveDistance] and [turnAngle] measure with. NULL removes them.
+    /// @param shared true if another drive writes the wheels and counts with the same encoders, e.g. when this
+    /// one only submits its speeds to a [MotionArbiter]: the encoders then follow the directions of that drive.
+    /// Default: false
+    void setEncoders(WheelEncodersInterface *encoders, bool shared=false) {
+        manoeuvreInProgress = false;
+        this->encoders = encoders;
+        encodersFollowOutput = !shared;
+        if (encoders != NULL && !shared && outputLeft != -256) encoders->setDirections(outputLeft, outputRight);
+    }
+
+    /// @return [WheelEncodersInterface] fitted by [setEncoders], or NULL.
+    WheelEncodersInterface *getEncoders() const {
+        return encoders;
+    }
+
+    /// @return [bool] true while a [driveDistance] or [turnAngle] has not reached its target.
+    bool isManoeuvreInProgress() const {
+        return manoeuvreInProgress;
+    }
+
+    /// MOVEMENT FUNCTIONS --> Straight, for a distance measured by the encoders. Non-blocking, see [update].
+    /// @details Slows down towards [MANOEUVRE_CREEP_SPEED] over the last 30% of the way (up to 10 cm), then
+    /// stops (ramped down at the deceleration while ramping).
+    /// @param speed Speed of the movement. Range: 0-255
+    /// @param distanceMm Distance in millimetres, negative to reverse.
+    /// @return [bool] false if no encoders are fitted: nothing is done.
+    bool driveDistance(int speed, int distanceMm){
+        if (encoders == NULL) return false;
+        Odometry &odometry = encoders->getOdometry();
+        long target = odometry.countsForDistance(distanceMm);
+        long slowdown = (target < 0 ? -target : target) * 3 / 10, longest = odometry.countsForDistance(100);
+        return startManoeuvre(false, target, slowdown < longest ? slowdown : longest, speed);
+    }
+
+    /// MOVEMENT FUNCTIONS --> On-Spot turn, by an angle measured by the encoders. Non-blocking, see [update].
+    /// @details Slows down towards [MANOEUVRE_CREEP_SPEED] over the last 30% of the turn (up to 45 degrees),
+    /// then stops (ramped down at the deceleration while ramping).
+    /// @param speed Speed of the turn. Range: 0-255
+    /// @param degrees Angle in degrees, positive to the left.
+    /// @return [bool] false if no encoders are fitted: nothing is done.
+    bool turnAngle(int speed, int degrees){
+        if (encoders == NULL) return false;
+        Odometry &odometry = encoders->getOdometry();
+        long target = odometry.countsForAngle(degrees);
+        long slowdown = (target < 0 ? -target : target) * 3 / 10, longest = odometry.countsForAngle(45);
+        return startManoeuvre(true, target, slowdown < longest ? slowdown : longest, speed);
     }
 
     /// MOVEMENT FUNCTION --> Left
     /// @param speed Speed of the left movement. Range: 0-255. Default: 255
     void smoothLeft(int speed=255){
-        for (int i = 0; i < numberOfMotorDrivers; i++)
-            drivers[i]->smoothLeft(speed);
-        status = "smooth_left";
+        command(0, speed, StatusCode::SMOOTH_LEFT);
     }
 
     /// MOVEMENT FUNCTIONS --> Right
     /// @param speed Speed of the right movement. Range: 0-255. Default: 255
     void smoothRight(int speed=255){
-        for (int i = 0; i < numberOfMotorDrivers; i++)
-            drivers[i]->smoothRight(speed);
-        status = "smooth_right";
+        command(speed, 0, StatusCode::SMOOTH_RIGHT);
     }
 
     /// MOVEMENT FUNCTIONS --> On-Spot Left
     /// @param speed Speed of the left movement. Range: 0-255. Default: 255
     void hardLeft(int speed=255){
-        for (int i = 0; i < numberOfMotorDrivers; i++)
-            drivers[i]->hardLeft(speed);
-        status = "hard_left";
+        command(-speed, speed, StatusCode::HARD_LEFT);
     }
 
     /// MOVEMENT FUNCTIONS --> On-Spot Right
     /// @param speed Speed of the right movement. Range: 0-255. Default: 255
     void hardRight(int speed=255){
-        for (int i = 0; i < numberOfMotorDrivers; i++)
-            drivers[i]->hardRight(speed);
-        status = "hard_right";
+        command(speed, -speed, StatusCode::HARD_RIGHT);
     }
 
     /// MOVEMENT FUNCTIONS --> Forward
     /// @param speed Speed of the forward movement. Range: 0-255. Default: 255
     void forward(int speed=255){
-        for (int i = 0; i < numberOfMotorDrivers; i++)
-            drivers[i]->forward(speed);
-        status = "forward";
+        command(speed, speed, StatusCode::FORWARD);
     }
 
     /// MOVEMENT FUNCTIONS --> Back
     /// @param speed Speed of the reverse/backwards movement. Range: 0-255. Default: 255
     void backward(int speed=255){
-        for (int i = 0; i < numberOfMotorDrivers; i++)
-            drivers[i]->backward(speed);
-        status = "backward";
+        command(-speed, -speed, StatusCode::BACKWARD);
+    }
+
+    /// MOVEMENT FUNCTIONS --> Differential, e.g. for steering by a controller
+    /// @param leftSpeed Signed speed of the left wheels, negative for reverse. Range: -255-255, clamped.
+    /// @param rightSpeed Signed speed of the right wheels, negative for reverse. Range: -255-255, clamped.
+    void drive(int leftSpeed, int rightSpeed){
+        leftSpeed = leftSpeed > 255 ? 255 : (leftSpeed < -255 ? -255 : leftSpeed);
+        rightSpeed = rightSpeed > 255 ? 255 : (rightSpeed < -255 ? -255 : rightSpeed);
+        command(leftSpeed, rightSpeed, differentialStatus(leftSpeed, rightSpeed));
     }
 
-    /// MOVEMENT FUNCTIONS --> Stop
+    /// MOVEMENT FUNCTIONS --> Steering, e.g. by a joystick or a line follower. Mixed in fixed point.
+    /// @details The left wheels get [throttle] + [turn] and the right wheels [throttle] - [turn]. If either
+    /// side would exceed full speed, both are scaled down together, so the robot keeps the curvature asked for
+    /// instead of having only the faster side clipped.
+    /// @param throttle Forward speed as a fraction of full speed, negative for reverse. Range: -1.0-1.0
+    /// @param turn Turn rate as a fraction of full speed, positive to the right. Range: -1.0-1.0
+    void steer(Q8_8 throttle, Q8_8 turn){
+        Q8_8 leftSpeed = throttle + turn;
+        Q8_8 rightSpeed = throttle - turn;
+        Q8_8 fastest = leftSpeed.abs() > rightSpeed.abs() ? leftSpeed.abs() : rightSpeed.abs();
+        if (fastest > Q8_8::fromInt(1)) {
+            Q8_8 scale = Q8_8::fromInt(1) / fastest;
+            leftSpeed *= scale;
+            rightSpeed *= scale;
+        }
+        drive(leftSpeed.toPwm(), rightSpeed.toPwm());
+    }
+
+    /// MOVEMENT FUNCTIONS --> Stop. Ramped down at the deceleration while ramping.
     void stop(){
-        for (int i = 0; i < numberOfMotorDrivers; i++)
-            drivers[i]->stop();
-        status = "stopped";
+        command(0, 0, StatusCode::STOPPED);
     }
 
     /// GETTER FUNCTION --> Status
     /// @param verbose [bool] if true, prints the status of the 2N wheel bot in Serial.
-    /// @return [String] containing the status of the 2N wheel bot system.
-    String getStatus(bool verbose=false){
-        String fullStatus = String(numberOfMotorDrivers) + " Wheel Drive System Status: " + status;
+    /// @return [DriveStatus] snapshot of the status of the 2N wheel bot system and each of its Motor Drivers.
+    DriveStatus getStatus(bool verbose=false){
+        DriveStatus snapshot;
+        snapshot.status = status;
+        snapshot.numberOfMotorDrivers = getNumberOfMotorDrivers();
+        for (int i = 0; i < snapshot.numberOfMotorDrivers; i++)
+            snapshot.driverStatus[i] = getDriverStatus(i);
+        if (verbose) {
+            char text[STATUS_TEXT_SIZE];
+            formatStatus(text, sizeof(text));
+            hal::console().println(text);
+        }
+        return snapshot;
+    }
+
+    /// @brief Writes the status of the 2N wheel bot system as text, only when it is needed.
+    /// @param buffer Caller-supplied buffer the text is written into. [STATUS_TEXT_SIZE] bytes fit 2 Motor Drivers.
+    /// @param size Size of [buffer] in bytes. The text is truncated to fit.
+    /// @return [size_t] length of the text written.
+    size_t formatStatus(char *buffer, size_t size){
+        StatusWriter writer(buffer, size);
+        int numberOfMotorDrivers = getNumberOfMotorDrivers();
+        writer.append(numberOfMotorDrivers).append(" Wheel Drive System Status: ").append(statusText(status));
         for (int i = 0; i < numberOfMotorDrivers; i++) {
-            fullStatus += ", " + String(i + 1) + ": " + drivers[i]->getStatus(false);
+            writer.append(", ").append(i + 1).append(": ").append(statusText(getDriverStatus(i)));
         }
-        if(verbose) Serial.println(fullStatus);
-        return fullStatus;
+        return writer.getLength();
+    }
+};
+
+
+/// @class NDualWheelDriveInterface
+/// @brief [DualWheelDriveBase] over any mix of motor drivers, chosen at runtime.
+///
+/// @details Initialized with an array of [drivers] objects, which represents the motor
+/// drivers used to control the robot and the [numberOfMotorDrivers], which CAN NOT exceed [MAX_NUMBER_OF_MOTOR_DRIVERS].
+/// Every driver is called through its virtual methods. When all drivers are of one type, [NDualWheelDrive] is
+/// smaller and faster.
+class NDualWheelDriveInterface : public DualWheelDriveBase {
+private:
+    int numberOfMotorDrivers;
+
+    MotorDriverInterface *drivers[MAX_NUMBER_OF_MOTOR_DRIVERS];
+
+protected:
+    void writeSpeeds(int leftSpeed, int rightSpeed) override {
+        writeSpeedsTogether(drivers, numberOfMotorDrivers, leftSpeed, rightSpeed);
+    }
+
+public:
+    /// @brief Constuctor initializing the [NDualWheelDriveInterface] Class.
+    /// @param numberOfMotorDrivers Number of [MotorDriverInterface] objects, each meant to control 2 motors of the robot.
+    /// @param drivers Array of [MotorDriverInterface] objects, each meant to control 2 motors of the robot. 
+    /// Can Have a MAXIMUM of [MAX_NUMBER_OF_MOTOR_DRIVERS] drivers. Any more will be ignored.
+    /// @return [NDualWheelDriveInterface] object
+    NDualWheelDriveInterface(int numberOfMotorDrivers, MotorDriverInterface *drivers[]) {
+        this->numberOfMotorDrivers = numberOfMotorDrivers < MAX_NUMBER_OF_MOTOR_DRIVERS ? 
+            numberOfMotorDrivers : MAX_NUMBER_OF_MOTOR_DRIVERS;
+        for (int i = 0; i < this->numberOfMotorDrivers; i++) {
+            this->drivers[i] = drivers[i]; 
+        }
+    }
+
+    int getNumberOfMotorDrivers() const override {
+        return numberOfMotorDrivers;
+    }
+
+    StatusCode getDriverStatus(int index) override {
+        return drivers[index]->getStatus(false);
+    }
+};
+
+
+/// @class NDualWheelDrive
+/// @brief [DualWheelDriveBase] over [N] motor drivers of one type, [Driver], both fixed at compile time.
+///
+/// @details Holds exactly [N] [Driver] pointers instead of [MAX_NUMBER_OF_MOTOR_DRIVERS]. [Driver] should be a
+/// final class (like [FastL298NInterface]): its methods are then called directly instead of through the
+/// virtual table, and with the loop over a constant [N] unrolled, writing the speeds compiles to straight-line
+/// port writes. The controllers reach it through one virtual call to [writeSpeeds] per speed change; code
+/// holding the [NDualWheelDrive] itself makes none.
+template <typename Driver, int N>
+class NDualWheelDrive final : public DualWheelDriveBase {
+    static_assert(N > 0 && N <= MAX_NUMBER_OF_MOTOR_DRIVERS, "NDualWheelDrive needs 1 to MAX_NUMBER_OF_MOTOR_DRIVERS drivers");
+
+private:
+    Driver *drivers[N];
+
+protected:
+    void writeSpeeds(int leftSpeed, int rightSpeed) override {
+        writeSpeedsTogether(drivers, N, leftSpeed, rightSpeed);
+    }
+
+public:
+    /// @brief Constuctor initializing the [NDualWheelDrive] Class.
+    /// @param drivers Array of the [N] [Driver] objects, each meant to control 2 motors of the robot.
+    /// @return [NDualWheelDrive] object
+    NDualWheelDrive(Driver *drivers[]) {
+        for (int i = 0; i < N; i++) {
+            this->drivers[i] = drivers[i];
+        }
+    }
+
+    int getNumberOfMotorDrivers() const override {
+        return N;
+    }
+
+    StatusCode getDriverStatus(int index) override {
+        return drivers[index]->getStatus(false);
     }
 };
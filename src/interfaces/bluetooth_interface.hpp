@@ -1,7 +1,12 @@
 #pragma once
 
-#include <Arduino.h>
-#include <SoftwareSerial.h>
+#include <string.h>
+#include "hal/hal.hpp"
+#include "serial_transport.hpp"
+#include "command_protocol.hpp"
+#include "../utils/ring_buffer.hpp"
+#include "../utils/latency_probe.hpp"
+#include "status_codes.hpp"
 
 // <summary>
 /// @file bluetooth_interface.hpp
@@ -13,8 +18,10 @@
 /// @class BluetoothInterface
 /// @brief This class is used to Send and Receive data from the HC05 Bluetooth module.
 ///
-/// @details Initialized with [rx] and [tx] receiver and transmitter pins that help utilize Serial 
-/// Communication to transfer messages between the Robot and the controlling application.
+/// @details Initialized with the [SerialTransport] used to transfer messages between the Robot and the
+/// controlling application: a [SoftwareSerialTransport] on [rx] and [tx] receiver and transmitter pins, or a
+/// [HardwareSerialTransport] on one of the Mega's hardware UARTs (preferred: the HC05 can be set to 115200
+/// baud with its AT commands, and receiving does not hold interrupts off).
 ///
 /// @see https://www.arduino.cc/en/Reference/SoftwareSerial
 ///
@@ -26,65 +33,157 @@
 ///     8, 9, 10, 11, 14 (MISO), 15 (SCK), 16 (MOSI).
 ///   - On Arduino or Genuino 101 the current maximum RX speed is 57600bps
 ///   - On Arduino or Genuino 101 RX doesn't work on Pin 13 
+///
+/// Received bytes are moved from the small SoftwareSerial buffer into a fixed [RECEIVE_BUFFER_SIZE] ring
+/// buffer on every receive call, and [receiveCommand] parses framed commands (see command_protocol.hpp)
+/// from it incrementally, so a whole backlog of commands can be drained in one controller step.
+///
+/// Text lines given to [send] are queued in a [SEND_BUFFER_SIZE] ring buffer and sent by [flushSend] as the
+/// transport takes them, so a reply never holds the loop: SoftwareSerial takes about 1 ms per character at
+/// 9600 baud.
 class BluetoothInterface {
+public:
+    static const uint8_t RECEIVE_BUFFER_SIZE = 64;
+
+    /// Fits one status text line ([DualWheelDriveBase::STATUS_TEXT_SIZE]) and its line break.
+    static const uint8_t SEND_BUFFER_SIZE = 128;
+
 private:
-    SoftwareSerial *serial;
+    SerialTransport *serial;
+
+    RingBuffer<uint8_t, RECEIVE_BUFFER_SIZE> receiveBuffer;
+
+    RingBuffer<uint8_t, SEND_BUFFER_SIZE> sendBuffer;
 
-    String status;
+    CommandParser parser;
+
+    StatusCode status;
+
+    /// Moves the bytes waiting in the Serial buffer into [receiveBuffer], as far as they fit.
+    void pollReceive() {
+        if (serial == NULL) return;
+        int waiting = serial->available();
+        while (waiting-- > 0 && !receiveBuffer.isFull()) {
+            receiveBuffer.push((uint8_t) serial->read());
+        }
+    }
 
 public:
-    /// @brief Initializes a new instance of the [BluetoothInterface] class.
-    /// @param rx The Serial receiver pin.
-    /// @param tx The Serial transmitter pin.
-    /// @param baud The baud rate of the serial communication. Default is 9600.
+    /// @brief Initializes a new instance of the [BluetoothInterface] class on the given transport.
+    /// @param transport The [SerialTransport] connected to the HC05: a [SoftwareSerialTransport] on any two pins,
+    /// or a [HardwareSerialTransport]. Not owned: it must outlive the [BluetoothInterface].
     /// @return [BluetoothInterface] instance.
-    BluetoothInterface(int rx, int tx, int baud=9600) {
-        serial = new SoftwareSerial(rx, tx);
-        serial->begin(baud);
-        status = "ready";
+    BluetoothInterface(SerialTransport *transport) {
+        serial = transport;
+        status = serial != NULL ? StatusCode::READY : StatusCode::NOT_READY;
     }
 
-    /// @brief Sends a message to the HC05 Bluetooth module.
+    /// @brief Queues a message, followed by a line break, to be sent to the HC05 Bluetooth module by [flushSend].
+    /// Non-blocking.
     /// @param message The message to be sent.
-    void send(String message) {
-        serial->println(message);
+    /// @return [bool] false (and nothing queued) if the line does not fit in what is left of the send buffer.
+    bool send(const char *message) {
+        if (serial == NULL) return false;
+        size_t length = strlen(message);
+        if (length + 2 > sendBuffer.available()) return false;
+        for (size_t i = 0; i < length; i++) sendBuffer.push((uint8_t) message[i]);
+        sendBuffer.push('\r');
+        sendBuffer.push('\n');
+        return true;
+    }
+
+    /// @brief Sends the queued lines the transport takes without waiting. Non-blocking; call on every step.
+    /// @return [size_t] number of bytes sent.
+    size_t flushSend() {
+        size_t count = 0;
+        int room = availableForSend();
+        uint8_t byte;
+        while (room-- > 0 && sendBuffer.peek(byte) && sendAvailable(&byte, 1) == 1) {
+            sendBuffer.pop(byte);
+            count++;
+        }
+        return count;
+    }
+
+    /// @return [bool] true while lines given to [send] are still queued.
+    bool isSending() const {
+        return !sendBuffer.isEmpty();
+    }
+
+    /// @brief Sends as many of [length] [bytes] as the transport takes without waiting for the line.
+    /// @return [size_t] number of bytes sent, from the front of [bytes].
+    size_t sendAvailable(const uint8_t *bytes, size_t length) {
+        if (serial == NULL) return 0;
+        int room = serial->availableForWrite();
+        size_t sent = 0;
+        while (sent < length && room-- > 0) serial->write(bytes[sent++]);
+        return sent;
+    }
+
+    /// @return [int] number of bytes [sendAvailable] can send now.
+    int availableForSend() {
+        return serial != NULL ? serial->availableForWrite() : 0;
     }
 
     /// @brief Receives a direct integer message from the HC05 Bluetooth module.
     /// @return [int] The message received. -1 if nothing is received.
     int receiveInt() {
-        int message = -1;
-        if (serial->available()) {
-            message = serial->read();
-        }
+        pollReceive();
+        uint8_t message;
+        if (!receiveBuffer.pop(message)) return -1;
         return message;
     }
 
     /// @brief Receives a character message from the HC05 Bluetooth module.
     /// @return [char] The message received. '\0' if nothing is received.
     char receiveChar() {
-        char message = '\0';
-        if (serial->available()) {
-            message = (char) serial->read();
+        pollReceive();
+        uint8_t message = '\0';
+        receiveBuffer.pop(message);
+        return (char) message;
+    }
+
+    /// @brief Receives a text message from the HC05 Bluetooth module.
+    /// @param buffer Caller-supplied buffer the message is written into, NUL-terminated.
+    /// @param size Size of [buffer] in bytes. Bytes that do not fit are left in the Serial buffer.
+    /// @return [size_t] The length of the message received. 0 (and "") if nothing is received.
+    size_t receiveString(char *buffer, size_t size) {
+        size_t length = 0;
+        uint8_t byte;
+        pollReceive();
+        while (length + 1 < size && receiveBuffer.pop(byte)) {
+            buffer[length++] = (char) byte;
+            pollReceive();
         }
-        return message;
+        if (size > 0) buffer[length] = '\0';
+        return length;
     }
 
-    /// @brief Receives a String message from the HC05 Bluetooth module.
-    /// @return [String] The message received. "" if nothing is received.
-    String receiveString() {
-        String message = "";
-        while (serial->available()) {
-            message += (char) serial->read();
+    /// @brief Receives the next command, framed or a single letter, parsing as many buffered bytes as needed.
+    /// @param command [Command] filled in with the command received.
+    /// @return [bool] true if a command was received, false if the received bytes hold no complete command yet.
+    bool receiveCommand(Command &command) {
+        LATENCY_PROBE(LatencyStage::BLUETOOTH_RECEIVE);
+        if (parser.next(command)) return true;
+        pollReceive();
+        uint8_t byte;
+        while (receiveBuffer.pop(byte)) {
+            if (parser.feed(byte)) return parser.next(command);
+            if (receiveBuffer.isEmpty()) pollReceive();
         }
-        return message;
+        return false;
+    }
+
+    /// @return [CommandParser&] the parser of received commands, for its frame counters.
+    const CommandParser &getParser() const {
+        return parser;
     }
 
     /// @brief Gets the status of the BluetoothInterface.
     /// @param verbose [bool] if true, prints the status of the 4 wheel bot in Serial.
-    /// @return [String] The status of the BluetoothInterface.
-    String getStatus(bool verbose=false) {
-        if (verbose) Serial.println(status);
+    /// @return [StatusCode] The status of the BluetoothInterface.
+    StatusCode getStatus(bool verbose=false) {
+        if (verbose) hal::console().println(statusText(status));
         return status;
     }
 };
@@ -0,0 +1,442 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../utils/crc8.hpp"
+#include "../utils/fixed_point.hpp"
+
+/// <summary>
+/// @file command_protocol.hpp
+/// @brief This file contains the framed binary command protocol spoken over the Bluetooth link.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details A frame carries one or more commands:
+///
+///     SYNC (0xAA) | LENGTH | OPCODE [PAYLOAD] OPCODE [PAYLOAD] ... | CRC8
+///
+/// LENGTH counts the command bytes between it and the CRC (at most [CommandParser::MAX_FRAME_PAYLOAD]).
+/// Each opcode has a fixed payload size (see [commandPayloadLength]). The CRC-8 covers LENGTH and the command
+/// bytes. Frames failing the CRC, or containing an unknown opcode, are dropped whole.
+///
+/// The single-letter commands of the original controller app ('F', 'B', 'S', ...) are still accepted between
+/// frames and decoded into the same [Command]s, as they can never be mistaken for the sync byte. The other way
+/// round, the rest of a frame whose sync byte was lost (its length and opcodes are control bytes, which no letter
+/// is), or whose length or CRC was rejected, is skipped, so it is never decoded as letters: a throttle of 0x46
+/// would be an 'F'. Only what can still be that frame is skipped, at most [CommandParser::MAX_FRAME_PAYLOAD] + 1
+/// bytes and never past the next sync byte, so a stray byte (e.g. the HC05's noise on connecting) costs a
+/// letter-only app a few letters at most and never leaves the robot deaf to them.
+///
+/// Proportional (joystick) driving sends [CommandOpcode::DRIVE_ARCADE] or [CommandOpcode::DRIVE_TANK] with two
+/// signed axis bytes (see [commandAxis]): a frame of one of them is 6 bytes, 6.25 ms at 9600 baud, so the link
+/// carries up to 160 updates per second and 50 Hz takes under a third of it.
+
+/// Operations a [Command] can ask for.
+enum CommandOpcode : uint8_t {
+    NO_COMMAND = 0x00,
+    DRIVE_STOP = 0x01,
+    DRIVE_FORWARD = 0x02,
+    DRIVE_BACKWARD = 0x03,
+    DRIVE_SMOOTH_LEFT = 0x04,
+    DRIVE_SMOOTH_RIGHT = 0x05,
+    DRIVE_HARD_LEFT = 0x06,
+    DRIVE_HARD_RIGHT = 0x07,
+    /// Payload: speed (0-255) used by the drive commands that follow.
+    SET_SPEED = 0x08,
+    LIFTER_UP = 0x09,
+    LIFTER_DOWN = 0x0A,
+    LIFTER_STOP = 0x0B,
+    /// Asks for the latency summaries (see latency_probe.hpp) to be sent back.
+    REPORT_LATENCY = 0x0C,
+    /// Payload: gain ([PIDController::Gain]), value high byte, value low byte. Tunes the line follower.
+    SET_PID_GAIN = 0x0D,
+    /// Payload: base speed (0-255) of the PID line follower.
+    SET_LINE_SPEED = 0x0E,
+    /// Starts uploading a mission (see mission.hpp), erasing the one stored.
+    UPLOAD_MISSION_BEGIN = 0x0F,
+    /// Payload: the 4 bytes of the next mission instruction.
+    UPLOAD_MISSION_INSTRUCTION = 0x10,
+    /// Payload: number of instructions uploaded, CRC-8 of their bytes. Completes the upload, storing the
+    /// mission if the instructions received match them.
+    UPLOAD_MISSION_COMMIT = 0x11,
+    /// Payload: mission to run, 0 for the uploaded one.
+    RUN_MISSION = 0x12,
+    /// Payload: 1 to keep the wheels under manual control, 0 to let autonomy take over again (HYBRID mode, see
+    /// [MotionArbiter]).
+    MANUAL_OVERRIDE = 0x13,
+    /// Payload: throttle, turn (signed axes, see [commandAxis]; turn positive to the right). Mixed into wheel
+    /// speeds by [DualWheelDriveBase::steer].
+    DRIVE_ARCADE = 0x14,
+    /// Payload: left, right (signed axes, see [commandAxis]). Wheel speeds of each side.
+    DRIVE_TANK = 0x15,
+    /// Sweeps the drive motors on the spot and stores their speed curves (see [CalibrationSweep]). Any drive
+    /// command aborts it.
+    CALIBRATE_MOTORS = 0x16,
+    /// Payload: 1 to start recording the driving commands that follow (see [SessionRecorder]), 0 to stop.
+    RECORD_SESSION = 0x17,
+    /// Replays the recorded session with its timing. Any drive command aborts it.
+    REPLAY_SESSION = 0x18
+};
+
+/// One decoded command.
+struct Command {
+    static const uint8_t MAX_PAYLOAD = 4;
+
+    uint8_t opcode;
+    uint8_t payload[MAX_PAYLOAD];
+};
+
+/// @return [int] payload size in bytes of [opcode], or -1 if the opcode is unknown.
+inline int commandPayloadLength(uint8_t opcode) {
+    switch (opcode) {
+        case CommandOpcode::DRIVE_STOP:
+        case CommandOpcode::DRIVE_FORWARD:
+        case CommandOpcode::DRIVE_BACKWARD:
+        case CommandOpcode::DRIVE_SMOOTH_LEFT:
+        case CommandOpcode::DRIVE_SMOOTH_RIGHT:
+        case CommandOpcode::DRIVE_HARD_LEFT:
+        case CommandOpcode::DRIVE_HARD_RIGHT:
+        case CommandOpcode::LIFTER_UP:
+        case CommandOpcode::LIFTER_DOWN:
+        case CommandOpcode::LIFTER_STOP:
+        case CommandOpcode::REPORT_LATENCY:
+        case CommandOpcode::UPLOAD_MISSION_BEGIN:
+        case CommandOpcode::CALIBRATE_MOTORS:
+        case CommandOpcode::REPLAY_SESSION:
+            return 0;
+        case CommandOpcode::SET_SPEED:
+        case CommandOpcode::SET_LINE_SPEED:
+        case CommandOpcode::RUN_MISSION:
+        case CommandOpcode::MANUAL_OVERRIDE:
+        case CommandOpcode::RECORD_SESSION:
+            return 1;
+        case CommandOpcode::UPLOAD_MISSION_COMMIT:
+        case CommandOpcode::DRIVE_ARCADE:
+        case CommandOpcode::DRIVE_TANK:
+            return 2;
+        case CommandOpcode::SET_PID_GAIN:
+            return 3;
+        case CommandOpcode::UPLOAD_MISSION_INSTRUCTION:
+            return 4;
+    }
+    return -1;
+}
+
+/// @return [const char*] name of [opcode], as printed in the verbose console output, or "unknown".
+inline const char *commandName(uint8_t opcode) {
+    switch (opcode) {
+        case CommandOpcode::NO_COMMAND: return "none";
+        case CommandOpcode::DRIVE_STOP: return "stop";
+        case CommandOpcode::DRIVE_FORWARD: return "forward";
+        case CommandOpcode::DRIVE_BACKWARD: return "backward";
+        case CommandOpcode::DRIVE_SMOOTH_LEFT: return "smooth_left";
+        case CommandOpcode::DRIVE_SMOOTH_RIGHT: return "smooth_right";
+        case CommandOpcode::DRIVE_HARD_LEFT: return "hard_left";
+        case CommandOpcode::DRIVE_HARD_RIGHT: return "hard_right";
+        case CommandOpcode::SET_SPEED: return "set_speed";
+        case CommandOpcode::LIFTER_UP: return "lifter_up";
+        case CommandOpcode::LIFTER_DOWN: return "lifter_down";
+        case CommandOpcode::LIFTER_STOP: return "lifter_stop";
+        case CommandOpcode::REPORT_LATENCY: return "report_latency";
+        case CommandOpcode::SET_PID_GAIN: return "set_pid_gain";
+        case CommandOpcode::SET_LINE_SPEED: return "set_line_speed";
+        case CommandOpcode::UPLOAD_MISSION_BEGIN: return "upload_mission_begin";
+        case CommandOpcode::UPLOAD_MISSION_INSTRUCTION: return "upload_mission_instruction";
+        case CommandOpcode::UPLOAD_MISSION_COMMIT: return "upload_mission_commit";
+        case CommandOpcode::RUN_MISSION: return "run_mission";
+        case CommandOpcode::MANUAL_OVERRIDE: return "manual_override";
+        case CommandOpcode::DRIVE_ARCADE: return "drive_arcade";
+        case CommandOpcode::DRIVE_TANK: return "drive_tank";
+        case CommandOpcode::CALIBRATE_MOTORS: return "calibrate_motors";
+        case CommandOpcode::RECORD_SESSION: return "record_session";
+        case CommandOpcode::REPLAY_SESSION: return "replay_session";
+    }
+    return "unknown";
+}
+
+/// Largest magnitude of a signed axis byte of the proportional drive commands.
+static const int COMMAND_AXIS_MAX = 127;
+
+/// @brief Decodes a signed axis byte of [CommandOpcode::DRIVE_ARCADE] or [CommandOpcode::DRIVE_TANK].
+/// @param byte Two's complement axis, -127 (full reverse or left) to 127 (full forward or right). -128 reads as -127.
+/// @return [Q8_8] the axis as a fraction of full speed. Range: -1.0-1.0
+inline Q8_8 commandAxis(uint8_t byte) {
+    int axis = (int8_t) byte;
+    if (axis < -COMMAND_AXIS_MAX) axis = -COMMAND_AXIS_MAX;
+    return Q8_8::fromRatio(axis, COMMAND_AXIS_MAX);
+}
+
+/// @brief Encodes [axis] as a signed axis byte, clamped to +-[COMMAND_AXIS_MAX].
+inline uint8_t commandAxisByte(int axis) {
+    if (axis > COMMAND_AXIS_MAX) axis = COMMAND_AXIS_MAX;
+    if (axis < -COMMAND_AXIS_MAX) axis = -COMMAND_AXIS_MAX;
+    return (uint8_t) (int8_t) axis;
+}
+
+/// @brief Decodes a single-letter command of the original controller app.
+/// @param character Letter received.
+/// @param command [Command] filled in when the letter is known.
+/// @return [bool] false if [character] is not a command.
+inline bool commandFromLetter(char character, Command &command) {
+    command.opcode = CommandOpcode::NO_COMMAND;
+    if (character >= '0' && character <= '9') {
+        command.opcode = CommandOpcode::SET_SPEED;
+        command.payload[0] = (character - '0') * 255 / 10;
+        return true;
+    }
+    switch (character) {
+        case 'Q': command.opcode = CommandOpcode::SET_SPEED; command.payload[0] = 255; break;
+        case 'F': command.opcode = CommandOpcode::DRIVE_FORWARD; break;
+        case 'B': command.opcode = CommandOpcode::DRIVE_BACKWARD; break;
+        case 'I': command.opcode = CommandOpcode::DRIVE_SMOOTH_LEFT; break;
+        case 'G': command.opcode = CommandOpcode::DRIVE_SMOOTH_RIGHT; break;
+        case 'R': command.opcode = CommandOpcode::DRIVE_HARD_LEFT; break;
+        case 'L': command.opcode = CommandOpcode::DRIVE_HARD_RIGHT; break;
+        case 'S': command.opcode = CommandOpcode::DRIVE_STOP; break;
+        case 'W': command.opcode = CommandOpcode::LIFTER_UP; break;
+        case 'U': command.opcode = CommandOpcode::LIFTER_DOWN; break;
+        case 'w': case 'u': command.opcode = CommandOpcode::LIFTER_STOP; break;
+        case 'P': command.opcode = CommandOpcode::REPORT_LATENCY; break;
+        case 'X': command.opcode = CommandOpcode::MANUAL_OVERRIDE; command.payload[0] = 1; break;
+        case 'x': command.opcode = CommandOpcode::MANUAL_OVERRIDE; command.payload[0] = 0; break;
+        case 'C': command.opcode = CommandOpcode::CALIBRATE_MOTORS; break;
+        case 'M': command.opcode = CommandOpcode::RECORD_SESSION; command.payload[0] = 1; break;
+        case 'm': command.opcode = CommandOpcode::RECORD_SESSION; command.payload[0] = 0; break;
+        case 'Y': command.opcode = CommandOpcode::REPLAY_SESSION; break;
+    }
+    return command.opcode != CommandOpcode::NO_COMMAND;
+}
+
+/// @class CommandParser
+/// @brief Incremental, allocation-free parser of command frames.
+///
+/// @details Bytes are fed one at a time with [feed]. Once a frame has passed its CRC, its commands are handed
+/// out by [next] straight from the frame buffer; [feed] must not be called again until they are all taken
+/// ([hasCommand] false).
+class CommandParser {
+public:
+    static const uint8_t SYNC_BYTE = 0xAA;
+
+    static const uint8_t MAX_FRAME_PAYLOAD = 32;
+
+private:
+    enum ParserState {
+        WAIT_SYNC,
+        WAIT_LENGTH,
+        READ_PAYLOAD,
+        WAIT_CRC,
+        /// After a framing error: the next [skipRemaining] bytes, up to the next sync byte, are the rest of a
+        /// broken frame.
+        SKIP_FRAME
+    };
+
+    ParserState state;
+
+    uint8_t payload[MAX_FRAME_PAYLOAD];
+
+    uint8_t length;
+
+    uint8_t received;
+
+    uint8_t crc;
+
+    /// Position of the next command in [payload] to hand out, == [length] when there is none.
+    uint8_t cursor;
+
+    /// Bytes of a broken frame still to skip in [ParserState::SKIP_FRAME].
+    uint8_t skipRemaining;
+
+    /// @brief Skips the next [count] bytes, if any, up to the next sync byte, as the rest of a broken frame.
+    void skip(uint8_t count) {
+        framesDropped++;
+        skipRemaining = count;
+        state = count > 0 ? ParserState::SKIP_FRAME : ParserState::WAIT_SYNC;
+    }
+
+    /// A letter command waiting to be handed out.
+    Command letterCommand;
+
+    bool hasLetterCommand;
+
+    unsigned int framesReceived, framesDropped;
+
+    /// @return [bool] true if every command in [payload] has a known opcode and its whole payload.
+    bool frameIsWellFormed() const {
+        uint8_t position = 0;
+        while (position < length) {
+            int payloadLength = commandPayloadLength(payload[position]);
+            if (payloadLength < 0 || position + 1 + payloadLength > length) return false;
+            position += 1 + payloadLength;
+        }
+        return true;
+    }
+
+public:
+    /// @brief Constuctor initializing the [CommandParser] waiting for a frame.
+    /// @return [CommandParser] object
+    CommandParser() {
+        state = ParserState::WAIT_SYNC;
+        length = 0;
+        received = 0;
+        crc = 0;
+        cursor = 0;
+        skipRemaining = 0;
+        hasLetterCommand = false;
+        framesReceived = 0;
+        framesDropped = 0;
+    }
+
+    /// @brief Feeds one received byte to the parser.
+    /// @return [bool] true if the byte completed a frame or a letter command, so [next] has commands.
+    bool feed(uint8_t byte) {
+        switch (state) {
+            case ParserState::WAIT_SYNC:
+                if (byte == SYNC_BYTE) {
+                    state = ParserState::WAIT_LENGTH;
+                    return false;
+                }
+                hasLetterCommand = commandFromLetter((char) byte, letterCommand);
+                // A control byte other than a line ending may be the length of a frame whose sync byte was lost:
+                // its commands and CRC follow.
+                if (!hasLetterCommand && byte > 0 && byte <= MAX_FRAME_PAYLOAD && byte != '\r' && byte != '\n') {
+                    skip(byte + 1);
+                }
+                return hasLetterCommand;
+
+            case ParserState::SKIP_FRAME:
+                if (byte == SYNC_BYTE) state = ParserState::WAIT_LENGTH;
+                else if (--skipRemaining == 0) state = ParserState::WAIT_SYNC;
+                return false;
+
+            case ParserState::WAIT_LENGTH:
+                // A repeated sync byte may be the real start of a frame.
+                if (byte == SYNC_BYTE) return false;
+                if (byte == 0 || byte > MAX_FRAME_PAYLOAD) {
+                    // The frame's commands and CRC, as long as they can be.
+                    skip(MAX_FRAME_PAYLOAD + 1);
+                    return false;
+                }
+                length = byte;
+                received = 0;
+                crc = crc8Update(0, byte);
+                state = ParserState::READ_PAYLOAD;
+                return false;
+
+            case ParserState::READ_PAYLOAD:
+                payload[received++] = byte;
+                crc = crc8Update(crc, byte);
+                if (received == length) state = ParserState::WAIT_CRC;
+                return false;
+
+            case ParserState::WAIT_CRC:
+                state = ParserState::WAIT_SYNC;
+                if (byte != crc || !frameIsWellFormed()) {
+                    // A corrupted length may have cut the frame short: the rest of the longest it can be.
+                    uint8_t rest = MAX_FRAME_PAYLOAD - length;
+                    length = 0;
+                    skip(rest);
+                    return false;
+                }
+                framesReceived++;
+                cursor = 0;
+                return true;
+        }
+        return false;
+    }
+
+    /// @return [bool] true if a decoded command is waiting to be taken with [next].
+    bool hasCommand() const {
+        return hasLetterCommand || (state == ParserState::WAIT_SYNC && cursor < length);
+    }
+
+    /// @brief Takes the next decoded command.
+    /// @param command [Command] filled in with the command.
+    /// @return [bool] false if there is no decoded command.
+    bool next(Command &command) {
+        if (hasLetterCommand) {
+            command = letterCommand;
+            hasLetterCommand = false;
+            return true;
+        }
+        if (!hasCommand()) return false;
+        command.opcode = payload[cursor++];
+        int payloadLength = commandPayloadLength(command.opcode);
+        for (int i = 0; i < payloadLength; i++) command.payload[i] = payload[cursor++];
+        if (cursor == length) length = 0;
+        return true;
+    }
+
+    /// @return [unsigned int] number of frames received with a valid CRC.
+    unsigned int getFramesReceived() const {
+        return framesReceived;
+    }
+
+    /// @return [unsigned int] number of frames dropped for a lost sync byte, or a bad length, CRC or opcode.
+    unsigned int getFramesDropped() const {
+        return framesDropped;
+    }
+};
+
+/// @class CommandFrameWriter
+/// @brief Builds a command frame into a caller-supplied buffer, as the controlling application does.
+class CommandFrameWriter {
+private:
+    uint8_t *buffer;
+
+    size_t size;
+
+    size_t length;
+
+    bool overflow;
+
+public:
+    /// @brief Constuctor starting a frame in [buffer].
+    /// @param buffer Buffer the frame is written into. Needs [CommandParser::MAX_FRAME_PAYLOAD] + 3 bytes at most.
+    /// @param size Size of [buffer] in bytes.
+    /// @return [CommandFrameWriter] object
+    CommandFrameWriter(uint8_t *buffer, size_t size) {
+        this->buffer = buffer;
+        this->size = size;
+        length = 2;
+        overflow = size < 3;
+        if (!overflow) buffer[0] = CommandParser::SYNC_BYTE;
+    }
+
+    /// @brief Appends a command with [opcode] and its payload.
+    /// @param payload Payload of the command, [commandPayloadLength] bytes. May be NULL for opcodes without one.
+    /// @return [bool] false if the opcode is unknown or the command does not fit in the frame.
+    bool add(uint8_t opcode, const uint8_t *payload = NULL) {
+        int payloadLength = commandPayloadLength(opcode);
+        if (payloadLength < 0 || (payloadLength > 0 && payload == NULL)) return false;
+        if (length + 1 + payloadLength - 2 > CommandParser::MAX_FRAME_PAYLOAD || length + 1 + payloadLength + 1 > size) {
+            overflow = true;
+            return false;
+        }
+        buffer[length++] = opcode;
+        for (int i = 0; i < payloadLength; i++) buffer[length++] = payload[i];
+        return true;
+    }
+
+    /// @brief Appends a command with a one byte payload.
+    bool add(uint8_t opcode, uint8_t value) {
+        return add(opcode, &value);
+    }
+
+    /// @brief Appends a proportional drive command with its two axes, e.g. [CommandOpcode::DRIVE_ARCADE].
+    /// @param first Throttle or left axis. Range: -127-127, clamped.
+    /// @param second Turn or right axis. Range: -127-127, clamped.
+    bool addAxes(uint8_t opcode, int first, int second) {
+        const uint8_t axes[] = {commandAxisByte(first), commandAxisByte(second)};
+        return add(opcode, axes);
+    }
+
+    /// @brief Completes the frame with its length and CRC.
+    /// @return [size_t] size of the whole frame in bytes, 0 if it is empty or something did not fit.
+    size_t finish() {
+        if (overflow || length == 2) return 0;
+        buffer[1] = length - 2;
+        buffer[length] = crc8(buffer + 1, length - 1);
+        return length + 1;
+    }
+};
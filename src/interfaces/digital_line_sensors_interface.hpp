@@ -0,0 +1,153 @@
+#pragma once
+
+#include "hal/hal.hpp"
+#include "status_codes.hpp"
+
+/// <summary>
+/// @file digital_line_sensors_interface.hpp
+/// @brief This file contains the [DigitalLineSensorsInterface] class.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+
+/// @class DigitalLineSensorsInterface
+/// @brief This class samples a set of digital IR line sensors together and debounces them into one snapshot.
+///
+/// @details Initialized with the digital pins of the sensors, which read LOW over the white line. The pins are
+/// resolved to their PINx input registers once. [sample] reads every port holding a sensor once, so all
+/// sensors are seen at the same instant, and a sensor's debounced state only changes after [debounceSamples]
+/// samples in a row disagree with it. The result is a bitmask (bit i set: sensor i sees white) that
+/// [readWhite] returns in O(1), so every decision of a controller sees one consistent set of readings.
+///
+/// [sample] is meant to run from the tick interrupt (see [tickHandler] and hal::attachTickInterrupt), every
+/// [samplePeriodTicks] ticks. A change on the floor then reaches the snapshot within [getLatencyUs]; a
+/// shorter period or fewer debounce samples lowers that latency at the cost of more interrupt time.
+class DigitalLineSensorsInterface {
+public:
+    static const int MAX_NUMBER_OF_SENSORS = 8;
+
+private:
+    int numberOfSensors;
+
+    /// Distinct input registers of the sensors, each read once per sample.
+    hal::PortRegister *inputRegisters[MAX_NUMBER_OF_SENSORS];
+
+    int numberOfPorts;
+
+    /// Index in [inputRegisters] and bit mask of each sensor.
+    uint8_t sensorPort[MAX_NUMBER_OF_SENSORS];
+
+    uint8_t sensorBit[MAX_NUMBER_OF_SENSORS];
+
+    uint8_t samplePeriodTicks, ticksUntilSample;
+
+    uint8_t debounceSamples;
+
+    /// Samples in a row each sensor has disagreed with its debounced state.
+    uint8_t disagreements[MAX_NUMBER_OF_SENSORS];
+
+    /// Debounced snapshot, written by [sample] (from the interrupt) and read by [readWhite].
+    volatile uint8_t white;
+
+    StatusCode status;
+
+    /// @return [uint8_t] the raw bitmask of the sensors seeing white right now, reading each port once.
+    uint8_t readRaw() {
+        uint8_t levels[MAX_NUMBER_OF_SENSORS];
+        for (int port = 0; port < numberOfPorts; port++) levels[port] = *inputRegisters[port];
+        uint8_t raw = 0;
+        for (int i = 0; i < numberOfSensors; i++) {
+            if (sensorBit[i] != 0 && !(levels[sensorPort[i]] & sensorBit[i])) raw |= 1 << i;
+        }
+        return raw;
+    }
+
+public:
+    /// @brief Constuctor initializing the [DigitalLineSensorsInterface] Class. The first snapshot is taken at once.
+    /// @param numberOfSensors Number of sensors. Can Have a MAXIMUM of [MAX_NUMBER_OF_SENSORS]. Any more will be ignored.
+    /// @param pins Digital pins of the sensors. Sensor i is bit i of the snapshot.
+    /// @param samplePeriodTicks Ticks between two samples. Default: 1 (about 1 ms)
+    /// @param debounceSamples Samples in a row a change must be seen in to be taken. Default: 2
+    /// @return [DigitalLineSensorsInterface] object
+    DigitalLineSensorsInterface(int numberOfSensors, const uint8_t pins[], uint8_t samplePeriodTicks = 1, uint8_t debounceSamples = 2) {
+        this->numberOfSensors = numberOfSensors < MAX_NUMBER_OF_SENSORS ? numberOfSensors : MAX_NUMBER_OF_SENSORS;
+        numberOfPorts = 0;
+        status = StatusCode::READY;
+        for (int i = 0; i < this->numberOfSensors; i++) {
+            hal::pinMode(pins[i], INPUT);
+            disagreements[i] = 0;
+            sensorPort[i] = 0;
+            sensorBit[i] = 0;
+            hal::PortRegister *inputRegister = hal::pinInputRegister(pins[i]);
+            if (inputRegister == NULL) {
+                status = StatusCode::NOT_READY;
+                continue;
+            }
+            int port = 0;
+            while (port < numberOfPorts && inputRegisters[port] != inputRegister) port++;
+            if (port == numberOfPorts) inputRegisters[numberOfPorts++] = inputRegister;
+            sensorPort[i] = port;
+            sensorBit[i] = hal::pinBitMask(pins[i]);
+        }
+        this->samplePeriodTicks = samplePeriodTicks > 0 ? samplePeriodTicks : 1;
+        ticksUntilSample = this->samplePeriodTicks;
+        this->debounceSamples = debounceSamples > 0 ? debounceSamples : 1;
+        white = readRaw();
+    }
+
+    /// @brief Samples every sensor together and updates the debounced snapshot. ISR-safe.
+    void sample() {
+        uint8_t raw = readRaw();
+        uint8_t debounced = white;
+        for (int i = 0; i < numberOfSensors; i++) {
+            uint8_t bit = 1 << i;
+            if ((raw & bit) == (debounced & bit)) disagreements[i] = 0;
+            else if (++disagreements[i] >= debounceSamples) {
+                debounced ^= bit;
+                disagreements[i] = 0;
+            }
+        }
+        white = debounced;
+    }
+
+    /// @brief Counts one tick, sampling every [samplePeriodTicks] ticks. Call from the tick interrupt.
+    void tick() {
+        if (--ticksUntilSample > 0) return;
+        ticksUntilSample = samplePeriodTicks;
+        sample();
+    }
+
+    /// @brief Tick interrupt handler ticking the [DigitalLineSensorsInterface] given as [context].
+    static void tickHandler(void *context) {
+        static_cast<DigitalLineSensorsInterface *>(context)->tick();
+    }
+
+    /// @return [uint8_t] the debounced snapshot: bit i is set if sensor i sees white.
+    uint8_t readWhite() const {
+        return white;
+    }
+
+    /// @return [bool] true if sensor [index] sees white in the debounced snapshot.
+    bool isWhite(int index) const {
+        return white & (1 << index);
+    }
+
+    /// @return [unsigned long] longest time in microseconds between a sensor settling on a new reading and the
+    /// snapshot showing it.
+    unsigned long getLatencyUs() const {
+        return (unsigned long) samplePeriodTicks * debounceSamples * hal::TICK_PERIOD_US;
+    }
+
+    /// @return [int] number of input registers read per sample.
+    int getNumberOfPorts() const {
+        return numberOfPorts;
+    }
+
+    /// GETTER FUNCTION --> Status
+    /// @param verbose [bool] if true, prints the status of the sensors in Serial.
+    /// @return [StatusCode] READY, or NOT_READY if a pin has no input register.
+    StatusCode getStatus(bool verbose=false) {
+        if (verbose) hal::console().println(statusText(status));
+        return status;
+    }
+};
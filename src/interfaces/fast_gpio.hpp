@@ -0,0 +1,148 @@
+#pragma once
+
+#include "hal/hal.hpp"
+
+/// <summary>
+/// @file fast_gpio.hpp
+/// @brief Direct port-register output pins, and batches of them written together.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+
+/// @class FastOutputPin
+/// @brief An output pin resolved once to its PORTx register and bit mask.
+///
+/// @details digitalWrite() looks the pin up in three flash tables, checks for PWM and locks interrupts on every
+/// call. [FastOutputPin] does the lookups once in [attach] and afterwards writes the port register directly.
+/// Writes are done with interrupts held off, as the ports above PORTG are not bit-addressable and an ISR
+/// touching the same port could otherwise lose an update.
+class FastOutputPin {
+    friend class PortWriteBatch;
+
+private:
+    hal::PortRegister *outputRegister;
+
+    uint8_t bitMask;
+
+    /// Port write for callers that already hold interrupts off.
+    void writeUnlocked(bool high) {
+        if (outputRegister == NULL) return;
+        if (high) *outputRegister |= bitMask;
+        else *outputRegister &= ~bitMask;
+    }
+
+public:
+    /// @brief Constuctor initializing a detached [FastOutputPin]. Writes to it are ignored.
+    /// @return [FastOutputPin] object
+    FastOutputPin() {
+        outputRegister = NULL;
+        bitMask = 0;
+    }
+
+    /// @brief Resolves [pin] to its port register and bit, sets it as output and drives it LOW.
+    /// The initial digitalWrite() also disconnects any PWM timer from the pin, which is then never checked again.
+    /// @param pin Arduino pin number. -1 leaves the pin detached.
+    void attach(int pin) {
+        outputRegister = NULL;
+        bitMask = 0;
+        if (pin < 0 || hal::pinOutputRegister(pin) == NULL) return;
+        hal::pinMode(pin, OUTPUT);
+        hal::digitalWrite(pin, LOW);
+        outputRegister = hal::pinOutputRegister(pin);
+        bitMask = hal::pinBitMask(pin);
+    }
+
+    /// @return [bool] true if the pin was resolved by [attach].
+    bool isAttached() const {
+        return outputRegister != NULL;
+    }
+
+    /// @brief Drives the pin HIGH (true) or LOW (false).
+    void write(bool high) {
+        if (outputRegister == NULL) return;
+        hal::InterruptLock lock;
+        writeUnlocked(high);
+    }
+
+    /// @brief Drives two pins under one interrupt lock. When both sit on the same port this is a single
+    /// read-modify-write of the port register, so the pins never pass through an intermediate state.
+    static void writePair(FastOutputPin &first, bool firstHigh, FastOutputPin &second, bool secondHigh) {
+        hal::InterruptLock lock;
+        if (first.outputRegister == second.outputRegister && first.outputRegister != NULL) {
+            uint8_t set = (firstHigh ? first.bitMask : 0) | (secondHigh ? second.bitMask : 0);
+            *first.outputRegister = (*first.outputRegister & ~(first.bitMask | second.bitMask)) | set;
+        } else {
+            first.writeUnlocked(firstHigh);
+            second.writeUnlocked(secondHigh);
+        }
+    }
+};
+
+
+/// @class PortWriteBatch
+/// @brief Pin writes collected first and then committed with one read-modify-write per port register.
+///
+/// @details Writing the pins of several motor drivers one by one leaves the wheels in mixed states between
+/// the writes (front wheels already reversed while the back ones still run forward). [add] only records the
+/// level of a pin, merging pins of the same port. The batch is then written break-before-make: [releaseUnlocked]
+/// drives every pin going LOW first, and [applyUnlocked] every pin going HIGH after, so no two pins of the
+/// batch are ever both at their old and new levels in conflicting ways (a wheel coasts instead of fighting
+/// one already reversed). The caller holds interrupts off across both, so no ISR runs between the port writes.
+class PortWriteBatch {
+public:
+    /// Output ports of the Mega: A-H and J-L.
+    static const int MAX_NUMBER_OF_PORTS = 11;
+
+private:
+    struct PortWrite {
+        hal::PortRegister *outputRegister;
+        uint8_t mask;
+        uint8_t value;
+    };
+
+    PortWrite writes[MAX_NUMBER_OF_PORTS];
+
+    int numberOfWrites;
+
+public:
+    /// @brief Constuctor initializing an empty [PortWriteBatch].
+    /// @return [PortWriteBatch] object
+    PortWriteBatch() : numberOfWrites(0) {}
+
+    /// @brief Records [pin] to be driven HIGH (true) or LOW (false). Detached pins are ignored.
+    void add(const FastOutputPin &pin, bool high) {
+        if (pin.outputRegister == NULL) return;
+        int i = 0;
+        while (i < numberOfWrites && writes[i].outputRegister != pin.outputRegister) i++;
+        if (i == numberOfWrites) {
+            if (numberOfWrites == MAX_NUMBER_OF_PORTS) return;
+            writes[i].outputRegister = pin.outputRegister;
+            writes[i].mask = 0;
+            writes[i].value = 0;
+            numberOfWrites++;
+        }
+        writes[i].mask |= pin.bitMask;
+        writes[i].value = (writes[i].value & ~pin.bitMask) | (high ? pin.bitMask : 0);
+    }
+
+    /// @return [int] number of port registers the batch writes.
+    int getNumberOfPorts() const {
+        return numberOfWrites;
+    }
+
+    /// @brief Drives every recorded LOW pin, one port register at a time. Interrupts must be held off by the caller.
+    void releaseUnlocked() {
+        for (int i = 0; i < numberOfWrites; i++) {
+            uint8_t low = writes[i].mask & ~writes[i].value;
+            if (low != 0) *writes[i].outputRegister &= ~low;
+        }
+    }
+
+    /// @brief Drives every recorded HIGH pin, one port register at a time, after [releaseUnlocked].
+    /// Interrupts must be held off by the caller.
+    void applyUnlocked() {
+        for (int i = 0; i < numberOfWrites; i++) {
+            if (writes[i].value != 0) *writes[i].outputRegister |= writes[i].value;
+        }
+    }
+};
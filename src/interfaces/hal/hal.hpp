@@ -0,0 +1,23 @@
+#pragma once
+
+/// <summary>
+/// @file hal.hpp
+/// @brief Hardware Abstraction Layer used by every interface and controller.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details The interfaces never call the Arduino core directly. They go through the thin functions of the
+/// [hal] namespace: GPIO (pinMode, digitalWrite, digitalRead, pin port registers), PWM and ADC (analogWrite,
+/// the 16-bit timers' frequency and compare registers, analogRead), the clock (millis, micros, delay), tick and
+/// pin interrupts, the watchdog, PROGMEM and EEPROM access, serial ports and the debug console.
+///
+/// On the robot (ARDUINO defined) every function forwards to the Arduino core and compiles away.
+/// On a host build (`native` PlatformIO environments) the same functions are backed by mocks with
+/// deterministic virtual time, so the robot's code can run, be profiled and be tested on Linux.
+
+#ifdef ARDUINO
+#include "hal_arduino.hpp"
+#else
+#include "hal_native.hpp"
+#endif
@@ -0,0 +1,21 @@
+/// <summary>
+/// @file hal_arduino.cpp
+/// @brief Interrupt vectors of the Arduino core backend of the Hardware Abstraction Layer.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-17
+///
+/// @details A vector may only be defined in one translation unit, so it lives here rather than in
+/// hal_arduino.hpp, which every interface includes. Host builds compile this file empty.
+
+#ifdef ARDUINO
+
+#include "hal_arduino.hpp"
+
+/// Tick interrupt, see [hal::attachTickInterrupt].
+ISR(TIMER0_COMPA_vect) {
+    volatile hal::Tick &tick = hal::tick();
+    if (tick.handler != NULL) tick.handler(tick.context);
+}
+
+#endif
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <Arduino.h>
+#include <SoftwareSerial.h>
+#include <avr/eeprom.h>
+#include <avr/wdt.h>
+
+/// <summary>
+/// @file hal_arduino.hpp
+/// @brief Arduino core backend of the Hardware Abstraction Layer. Include "hal.hpp" instead.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+
+namespace hal {
+
+/// Type of an I/O port register.
+typedef volatile uint8_t PortRegister;
+
+/// Serial port the debug output is printed to.
+typedef HardwareSerial Console;
+
+/// Software serial port on any pair of pins.
+typedef ::SoftwareSerial SoftwareSerial;
+
+/// Interrupt-driven hardware UART.
+typedef ::HardwareSerial HardwareSerial;
+
+/// @class InterruptLock
+/// @brief Holds interrupts off for as long as it is in scope, restoring the previous state after.
+class InterruptLock {
+private:
+    uint8_t oldSREG;
+
+public:
+    InterruptLock() {
+        oldSREG = SREG;
+        cli();
+    }
+
+    ~InterruptLock() {
+        SREG = oldSREG;
+    }
+};
+
+inline void pinMode(uint8_t pin, uint8_t mode) { ::pinMode(pin, mode); }
+
+inline void digitalWrite(uint8_t pin, uint8_t value) { ::digitalWrite(pin, value); }
+
+inline int digitalRead(uint8_t pin) { return ::digitalRead(pin); }
+
+inline void analogWrite(uint8_t pin, int value) { ::analogWrite(pin, value); }
+
+inline int analogRead(uint8_t pin) { return ::analogRead(pin); }
+
+/// Frequency of the CPU clock, which the timers count.
+static const unsigned long CPU_CLOCK_HZ = F_CPU;
+
+/// Type of the compare register (OCRnx) of a 16-bit timer channel.
+typedef volatile uint16_t PwmRegister;
+
+/// @brief Runs 16-bit [timer] (1, 3, 4 or 5) in fast PWM with ICRn as TOP (mode 14), at
+/// CPU_CLOCK_HZ / (prescaler * (top + 1)). Its channels stay connected to their pins, or not, as they were.
+/// @param clockSelect Prescaler bits: 1 (1), 2 (8), 3 (64), 4 (256) or 5 (1024).
+inline void pwmTimerBegin(uint8_t timer, uint8_t clockSelect, uint16_t top) {
+    volatile uint8_t *controlA, *controlB;
+    volatile uint16_t *topRegister, *counter;
+    switch (timer) {
+        case 1: controlA = &TCCR1A; controlB = &TCCR1B; topRegister = &ICR1; counter = &TCNT1; break;
+        case 3: controlA = &TCCR3A; controlB = &TCCR3B; topRegister = &ICR3; counter = &TCNT3; break;
+        case 4: controlA = &TCCR4A; controlB = &TCCR4B; topRegister = &ICR4; counter = &TCNT4; break;
+        case 5: controlA = &TCCR5A; controlB = &TCCR5B; topRegister = &ICR5; counter = &TCNT5; break;
+        default: return;
+    }
+    // 16-bit registers are written through the byte all timers share, so no ISR may write one in between.
+    InterruptLock lock;
+    *controlB = 0;
+    *controlA = (*controlA & ~(_BV(WGM11) | _BV(WGM10))) | _BV(WGM11);
+    *topRegister = top;
+    *counter = 0;
+    *controlB = _BV(WGM13) | _BV(WGM12) | (clockSelect & 0x07);
+}
+
+/// @return [PwmRegister*] the compare register of [channel] (0-2 for A-C) of 16-bit [timer], or NULL.
+inline PwmRegister *pwmCompareRegister(uint8_t timer, uint8_t channel) {
+    if (channel > 2) return NULL;
+    switch (timer) {
+        case 1: return channel == 0 ? &OCR1A : (channel == 1 ? &OCR1B : &OCR1C);
+        case 3: return channel == 0 ? &OCR3A : (channel == 1 ? &OCR3B : &OCR3C);
+        case 4: return channel == 0 ? &OCR4A : (channel == 1 ? &OCR4B : &OCR4C);
+        case 5: return channel == 0 ? &OCR5A : (channel == 1 ? &OCR5B : &OCR5C);
+        default: return NULL;
+    }
+}
+
+/// @brief Connects [channel] of 16-bit [timer] to its pin (non-inverting, COMnx = 2) or disconnects it, leaving
+/// the pin to its PORTx level.
+inline void pwmConnect(uint8_t timer, uint8_t channel, bool connected) {
+    volatile uint8_t *controlA;
+    switch (timer) {
+        case 1: controlA = &TCCR1A; break;
+        case 3: controlA = &TCCR3A; break;
+        case 4: controlA = &TCCR4A; break;
+        case 5: controlA = &TCCR5A; break;
+        default: return;
+    }
+    if (channel > 2) return;
+    // COMnA, COMnB and COMnC are the bit pairs 7-6, 5-4 and 3-2 of TCCRnA.
+    uint8_t mask = (_BV(COM1A1) | _BV(COM1A0)) >> (2 * channel);
+    InterruptLock lock;
+    *controlA = (*controlA & ~mask) | (connected ? _BV(COM1A1) >> (2 * channel) : 0);
+}
+
+inline unsigned long millis() { return ::millis(); }
+
+inline unsigned long micros() { return ::micros(); }
+
+inline void delay(unsigned long ms) { ::delay(ms); }
+
+inline Console &console() { return Serial; }
+
+/// @return [HardwareSerial&] Serial1 (RX 19, TX 18).
+inline HardwareSerial &serial1() { return Serial1; }
+
+/// @return [HardwareSerial&] Serial2 (RX 17, TX 16).
+inline HardwareSerial &serial2() { return Serial2; }
+
+/// @return [HardwareSerial&] Serial3 (RX 15, TX 14).
+inline HardwareSerial &serial3() { return Serial3; }
+
+/// @brief Starts the hardware watchdog, which resets the board unless [watchdogReset] is called at least every
+/// [timeoutMs]. The AVR offers 15 ms to 8 s in powers of two: the longest not over [timeoutMs] is used.
+inline void watchdogEnable(unsigned long timeoutMs) {
+    static const uint16_t timeouts[] = {15, 30, 60, 120, 250, 500, 1000, 2000, 4000, 8000};
+    uint8_t prescaler = 0;
+    while (prescaler < 9 && timeouts[prescaler + 1] <= timeoutMs) prescaler++;
+    // The prescaler is the WDTO_ constant of the timeout.
+    wdt_enable(prescaler);
+}
+
+inline void watchdogReset() { wdt_reset(); }
+
+/// @brief Stops the hardware watchdog. After a watchdog reset it only stops once [resetByWatchdog] cleared the flag.
+inline void watchdogDisable() { wdt_disable(); }
+
+/// @return [bool] true if the last reset was by the watchdog. Clears the flag (WDRF), which otherwise keeps the
+/// watchdog running.
+inline bool resetByWatchdog() {
+    bool byWatchdog = MCUSR & _BV(WDRF);
+    MCUSR &= ~_BV(WDRF);
+    return byWatchdog;
+}
+
+/// @return [PortRegister*] the PORTx output register of [pin], or NULL if it is not a pin.
+inline PortRegister *pinOutputRegister(uint8_t pin) {
+    uint8_t port = digitalPinToPort(pin);
+    return port == NOT_A_PIN ? NULL : portOutputRegister(port);
+}
+
+/// @return [uint8_t] the bit mask of [pin] within its port register.
+inline uint8_t pinBitMask(uint8_t pin) { return digitalPinToBitMask(pin); }
+
+/// @return [PortRegister*] the PINx input register of [pin], or NULL if it is not a pin.
+inline PortRegister *pinInputRegister(uint8_t pin) {
+    uint8_t port = digitalPinToPort(pin);
+    return port == NOT_A_PIN ? NULL : portInputRegister(port);
+}
+
+/// @return [uint8_t] the byte at [address] of a table placed in flash with PROGMEM.
+inline uint8_t readProgramByte(const uint8_t *address) { return pgm_read_byte(address); }
+
+/// Bytes of EEPROM: 4 KB on the Mega.
+static const int EEPROM_SIZE = E2END + 1;
+
+/// @return [uint8_t] the EEPROM byte at [address].
+inline uint8_t eepromRead(int address) { return eeprom_read_byte((const uint8_t *) address); }
+
+/// @brief Writes [value] to the EEPROM byte at [address], only if it differs: a write takes about 3.3 ms and
+/// wears the cell, which lasts about 100000 writes.
+inline void eepromWrite(int address, uint8_t value) { eeprom_update_byte((uint8_t *) address, value); }
+
+/// @return [bool] true once the last EEPROM write has completed, so the next one does not wait for it.
+inline bool eepromReady() { return eeprom_is_ready(); }
+
+/// Function run by a pin interrupt, with the context given to [attachPinInterrupt].
+typedef void (*PinInterruptHandler)(void *context);
+
+/// External interrupts INT0-INT5 of the Mega, on pins 21, 20, 19, 18, 2 and 3.
+static const int NUMBER_OF_PIN_INTERRUPTS = 6;
+
+/// Handler and context of an external interrupt.
+struct PinInterrupt {
+    PinInterruptHandler handler;
+    void *context;
+};
+
+inline PinInterrupt *pinInterrupts() {
+    static PinInterrupt instances[NUMBER_OF_PIN_INTERRUPTS] = {};
+    return instances;
+}
+
+/// Interrupt service routine of external interrupt [INTERRUPT], running its handler.
+template <int INTERRUPT>
+void runPinInterrupt() {
+    PinInterrupt &pinInterrupt = pinInterrupts()[INTERRUPT];
+    if (pinInterrupt.handler != NULL) pinInterrupt.handler(pinInterrupt.context);
+}
+
+/// @brief Runs [handler] from the external interrupt of [pin] on every edge [mode] (RISING, FALLING or CHANGE).
+/// [handler] must be short and ISR-safe.
+/// @param handler Function to run, or NULL to stop the interrupt.
+/// @param context Passed to [handler].
+/// @return [bool] false if [pin] has no external interrupt.
+inline bool attachPinInterrupt(uint8_t pin, PinInterruptHandler handler, void *context, int mode) {
+    static void (*const routines[NUMBER_OF_PIN_INTERRUPTS])() = {
+        runPinInterrupt<0>, runPinInterrupt<1>, runPinInterrupt<2>,
+        runPinInterrupt<3>, runPinInterrupt<4>, runPinInterrupt<5>
+    };
+    int interrupt = digitalPinToInterrupt(pin);
+    if (interrupt < 0 || interrupt >= NUMBER_OF_PIN_INTERRUPTS) return false;
+    if (handler == NULL) ::detachInterrupt(interrupt);
+    {
+        InterruptLock lock;
+        pinInterrupts()[interrupt].handler = handler;
+        pinInterrupts()[interrupt].context = context;
+    }
+    if (handler != NULL) ::attachInterrupt(interrupt, routines[interrupt], mode);
+    return true;
+}
+
+/// Period of the tick interrupt: one Timer0 overflow (64 * 256 cycles at 16 MHz).
+static const unsigned long TICK_PERIOD_US = 1024;
+
+/// Function run by the tick interrupt, with the context given to [attachTickInterrupt].
+typedef void (*TickHandler)(void *context);
+
+/// Handler and context of the tick interrupt.
+struct Tick {
+    TickHandler handler;
+    void *context;
+};
+
+inline volatile Tick &tick() {
+    static volatile Tick instance = {NULL, NULL};
+    return instance;
+}
+
+/// @brief Runs [handler] from an interrupt every [TICK_PERIOD_US]: Timer0's compare A match, which the Arduino
+/// core leaves free beside the overflow interrupt of millis(). [handler] must be short and ISR-safe. The
+/// interrupt's vector is defined once, in hal_arduino.cpp.
+/// @param handler Function to run, or NULL to stop the interrupt.
+/// @param context Passed to [handler].
+inline void attachTickInterrupt(TickHandler handler, void *context) {
+    InterruptLock lock;
+    tick().handler = handler;
+    tick().context = context;
+    OCR0A = 0x80;
+    if (handler != NULL) TIMSK0 |= _BV(OCIE0A);
+    else TIMSK0 &= ~_BV(OCIE0A);
+}
+
+}
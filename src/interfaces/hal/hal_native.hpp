@@ -0,0 +1,966 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <thread>
+
+/// <summary>
+/// @file hal_native.hpp
+/// @brief Host (native) mock backend of the Hardware Abstraction Layer. Include "hal.hpp" instead.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details Mocks the parts of the Arduino Mega the robot uses:
+///   - GPIO: the Mega's pin to port/bit/timer tables and its PORTx/DDRx registers. digitalWrite() follows the
+///     core's wiring_digital.c steps, and every flash table read, I/O register access and interrupt lock is
+///     counted, so benchmarks can compare GPIO code paths. An [native::outputObserver] sees every output change.
+///   - Interrupts: the external pin interrupts, run on the edges of digital inputs set by the simulation.
+///   - PWM and ADC: the duty last written to each pin (with the core's fallback to digital output on pins
+///     without a timer), the 16-bit timers' frequencies and compare registers as [hal::pwmTimerBegin] sets them,
+///     and analog input values set by the simulation.
+///   - Memories: PROGMEM tables are plain constants, and a 4 KB EEPROM keeps its bytes (and counts its
+///     writes, each busy for [native::EEPROM_WRITE_US] of virtual time, which the next write waits out) until
+///     [native::resetEeprom].
+///   - Clock: virtual time, moved only by [native::advanceMicros] or delay(), so runs are deterministic.
+///     Host benchmarks may switch it to follow the host's steady clock instead. The tick interrupt runs
+///     as virtual time passes each of its periods, and the watchdog bites once its timeout has passed.
+///   - Serial: software serial ports and the Mega's hardware UARTs Serial1-3, all with an injectable receive
+///     queue, a captured transmit log and a transmit timed at the baud rate, and a console printing to stdout,
+///     timed like Serial.
+/// The [native] namespace holds the controls a simulation or benchmark uses to drive and inspect the mocks.
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define PROGMEM
+
+namespace hal {
+
+namespace native {
+
+/// Work counted by the mock GPIO.
+struct Counters {
+    unsigned long flashReads;
+    unsigned long ioReads;
+    unsigned long ioWrites;
+    unsigned long interruptLocks;
+};
+
+inline Counters &counters() {
+    static Counters instance = {0, 0, 0, 0};
+    return instance;
+}
+
+inline void resetCounters() {
+    Counters zero = {0, 0, 0, 0};
+    counters() = zero;
+}
+
+/// Function called after every I/O register write and PWM duty change, for simulations tracing pin changes.
+typedef void (*OutputObserver)();
+
+/// @return [OutputObserver&] the observer of output changes, NULL (the default) for none.
+inline OutputObserver &outputObserver() {
+    static OutputObserver observer = NULL;
+    return observer;
+}
+
+/// One 8-bit I/O register whose reads and writes are counted.
+class IoRegister {
+private:
+    uint8_t value;
+
+public:
+    IoRegister() : value(0) {}
+
+    operator uint8_t() const { counters().ioReads++; return value; }
+
+    IoRegister &operator=(uint8_t newValue) {
+        counters().ioWrites++;
+        value = newValue;
+        if (outputObserver() != NULL) outputObserver()();
+        return *this;
+    }
+
+    IoRegister &operator|=(uint8_t bits) { return *this = uint8_t(*this) | bits; }
+
+    IoRegister &operator&=(uint8_t bits) { return *this = uint8_t(*this) & bits; }
+
+    /// Value without counting an access, for inspection by simulations.
+    uint8_t peek() const { return value; }
+
+    /// Sets the value without counting an access, for simulations driving input pins.
+    void poke(uint8_t newValue) { value = newValue; }
+};
+
+/// Ports A..L as numbered by the Mega core (PA = 1 ... PL = 12).
+static const int NUMBER_OF_PORTS = 13;
+
+enum Port { PA = 1, PB, PC, PD, PE, PF, PG, PH, PJ = 10, PK, PL };
+
+enum Timer { NOT_ON_TIMER, TIMER0A, TIMER0B, TIMER1A, TIMER1B, TIMER1C, TIMER2A, TIMER2B,
+    TIMER3A, TIMER3B, TIMER3C, TIMER4A, TIMER4B, TIMER4C, TIMER5A, TIMER5B, TIMER5C };
+
+static const int NUMBER_OF_PINS = 70;
+
+static const uint8_t PIN_TO_PORT[NUMBER_OF_PINS] = {
+    PE, PE, PE, PE, PG, PE, PH, PH, PH, PH, PB, PB, PB, PB, PJ, PJ, PH, PH, PD, PD,
+    PD, PD, PA, PA, PA, PA, PA, PA, PA, PA, PC, PC, PC, PC, PC, PC, PC, PC, PD, PG,
+    PG, PG, PL, PL, PL, PL, PL, PL, PL, PL, PB, PB, PB, PB, PF, PF, PF, PF, PF, PF,
+    PF, PF, PK, PK, PK, PK, PK, PK, PK, PK
+};
+
+static const uint8_t PIN_TO_BIT[NUMBER_OF_PINS] = {
+    0, 1, 4, 5, 5, 3, 3, 4, 5, 6, 4, 5, 6, 7, 1, 0, 1, 0, 3, 2,
+    1, 0, 0, 1, 2, 3, 4, 5, 6, 7, 7, 6, 5, 4, 3, 2, 1, 0, 7, 2,
+    1, 0, 7, 6, 5, 4, 3, 2, 1, 0, 3, 2, 1, 0, 0, 1, 2, 3, 4, 5,
+    6, 7, 0, 1, 2, 3, 4, 5, 6, 7
+};
+
+static const uint8_t PIN_TO_TIMER[NUMBER_OF_PINS] = {
+    0, 0, TIMER3B, TIMER3C, TIMER0B, TIMER3A, TIMER4A, TIMER4B, TIMER4C, TIMER2B,
+    TIMER2A, TIMER1A, TIMER1B, TIMER0A, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, TIMER5C, TIMER5B, TIMER5A, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+/// Counted equivalent of pgm_read_byte() on one of the tables above. 0 (not a pin) when out of range.
+inline uint8_t readFlash(const uint8_t *table, uint8_t pin) {
+    counters().flashReads++;
+    return pin < NUMBER_OF_PINS ? table[pin] : 0;
+}
+
+/// State of the mocked GPIO, PWM and ADC.
+struct Gpio {
+    IoRegister outputRegisters[NUMBER_OF_PORTS];
+    IoRegister modeRegisters[NUMBER_OF_PORTS];
+    IoRegister inputRegisters[NUMBER_OF_PORTS];
+    uint8_t inputLevels[NUMBER_OF_PINS];
+    int analogInputs[NUMBER_OF_PINS];
+    int pwmDuty[NUMBER_OF_PINS];
+    bool pwmConnected[NUMBER_OF_PINS];
+    bool interruptsEnabled;
+
+    Gpio() : interruptsEnabled(true) {}
+};
+
+inline Gpio &gpio() {
+    static Gpio instance;
+    return instance;
+}
+
+inline void resetPwmTimers();
+
+/// @brief Clears all pins, registers, analog inputs, PWM timers and counters.
+inline void resetGpio() {
+    Gpio &state = gpio();
+    for (int i = 0; i < NUMBER_OF_PORTS; i++) {
+        state.outputRegisters[i] = 0;
+        state.modeRegisters[i] = 0;
+        state.inputRegisters[i].poke(0);
+    }
+    for (int i = 0; i < NUMBER_OF_PINS; i++) {
+        state.inputLevels[i] = LOW;
+        state.analogInputs[i] = 0;
+        state.pwmDuty[i] = 0;
+        state.pwmConnected[i] = false;
+    }
+    state.interruptsEnabled = true;
+    resetPwmTimers();
+    resetCounters();
+}
+
+/// Handler, context and edge of the external interrupt of a pin, set by hal::attachPinInterrupt.
+struct PinInterrupt {
+    void (*handler)(void *context);
+    void *context;
+    int mode;
+};
+
+inline PinInterrupt *pinInterrupts() {
+    static PinInterrupt instances[NUMBER_OF_PINS] = {};
+    return instances;
+}
+
+/// @return [bool] true if [pin] has an external interrupt (INT0-INT5) on the Mega.
+inline bool hasPinInterrupt(uint8_t pin) {
+    return pin == 2 || pin == 3 || (pin >= 18 && pin <= 21);
+}
+
+/// @brief Sets the level a digitalRead() of input [pin] returns. An edge runs the pin's interrupt handler,
+/// if one is attached for it.
+inline void setDigitalInput(uint8_t pin, uint8_t level) {
+    if (pin >= NUMBER_OF_PINS) return;
+    uint8_t previous = gpio().inputLevels[pin];
+    gpio().inputLevels[pin] = level;
+    const PinInterrupt &pinInterrupt = pinInterrupts()[pin];
+    bool rising = previous == LOW && level != LOW, falling = previous != LOW && level == LOW;
+    bool edge = pinInterrupt.mode == CHANGE ? rising || falling : (pinInterrupt.mode == RISING ? rising : falling);
+    IoRegister &input = gpio().inputRegisters[PIN_TO_PORT[pin]];
+    uint8_t bit = 1 << PIN_TO_BIT[pin];
+    input.poke(level == LOW ? input.peek() & ~bit : input.peek() | bit);
+    if (edge && pinInterrupt.handler != NULL) pinInterrupt.handler(pinInterrupt.context);
+}
+
+/// @brief Sets the value an analogRead() of [pin] returns. Range: 0-1023.
+inline void setAnalogInput(uint8_t pin, int value) {
+    if (pin < NUMBER_OF_PINS) gpio().analogInputs[pin] = value;
+}
+
+/// @return [bool] true if output [pin] is driven HIGH (PWM pins count as HIGH while their duty is not 0).
+inline bool outputLevel(uint8_t pin) {
+    if (pin >= NUMBER_OF_PINS) return false;
+    if (gpio().pwmConnected[pin]) return gpio().pwmDuty[pin] > 0;
+    return gpio().outputRegisters[PIN_TO_PORT[pin]].peek() & (1 << PIN_TO_BIT[pin]);
+}
+
+/// @return [int] effective duty (0-255) of output [pin]: the PWM duty while a timer drives it,
+/// otherwise 255 or 0 for its digital level.
+inline int outputDuty(uint8_t pin) {
+    if (pin >= NUMBER_OF_PINS) return 0;
+    if (gpio().pwmConnected[pin]) return gpio().pwmDuty[pin];
+    return outputLevel(pin) ? 255 : 0;
+}
+
+/// Frequency of the CPU clock, which the timers count.
+static const unsigned long CPU_CLOCK_HZ = 16000000UL;
+
+/// @return [uint8_t] the pin [channel] (0-2 for A-C) of [timer] drives, or NUMBER_OF_PINS if there is none.
+inline uint8_t pinOfTimerChannel(uint8_t timer, uint8_t channel) {
+    static const uint8_t firstChannels[] = {TIMER0A, TIMER1A, TIMER2A, TIMER3A, TIMER4A, TIMER5A};
+    if (timer > 5 || channel > 2) return NUMBER_OF_PINS;
+    for (uint8_t pin = 0; pin < NUMBER_OF_PINS; pin++) {
+        if (PIN_TO_TIMER[pin] == firstChannels[timer] + channel) return pin;
+    }
+    return NUMBER_OF_PINS;
+}
+
+/// Mocked OCRnx register of a 16-bit timer channel. A write counts as the two byte accesses it takes on the AVR
+/// and, while the channel drives its pin, sets the pin's duty to the share of the timer's period it gives.
+class CompareRegister {
+private:
+    uint16_t value;
+
+    uint8_t pin;
+
+    uint16_t *top;
+
+public:
+    CompareRegister() : value(0), pin(NUMBER_OF_PINS), top(NULL) {}
+
+    /// Ties the register to the [pin] its channel drives and the TOP of its timer.
+    void wire(uint8_t channelPin, uint16_t *timerTop) {
+        pin = channelPin;
+        top = timerTop;
+    }
+
+    CompareRegister &operator=(uint16_t newValue) {
+        counters().ioWrites += 2;
+        value = newValue;
+        updateDuty();
+        return *this;
+    }
+
+    /// Sets the duty of the pin from the register, if the channel drives it: in fast PWM the pin is HIGH for
+    /// (OCRnx + 1) of the (TOP + 1) counts of a period.
+    void updateDuty() {
+        if (pin >= NUMBER_OF_PINS || !gpio().pwmConnected[pin]) return;
+        unsigned long period = (unsigned long) *top + 1;
+        unsigned long high = value >= *top ? period : (unsigned long) value + 1;
+        gpio().pwmDuty[pin] = (int) ((high * 255 + period / 2) / period);
+        if (outputObserver() != NULL) outputObserver()();
+    }
+
+    /// Value without counting an access, for inspection by simulations.
+    uint16_t peek() const { return value; }
+};
+
+/// Mocked 16-bit timer (Timer1, 3, 4 or 5) as set up by [hal::pwmTimerBegin]: its clock select bits (0 while the
+/// Arduino core's 8-bit phase correct PWM is left running), TOP and compare registers.
+struct PwmTimer {
+    uint8_t clockSelect;
+    uint16_t top;
+    CompareRegister compareRegisters[3];
+};
+
+/// @return [PwmTimer*] the timers, indexed by their number. Timer0 and Timer2 stay as the core set them up.
+inline PwmTimer *pwmTimers() {
+    static PwmTimer instances[6];
+    static bool wired = false;
+    if (!wired) {
+        wired = true;
+        for (uint8_t timer = 0; timer < 6; timer++) {
+            for (uint8_t channel = 0; channel < 3; channel++) {
+                instances[timer].compareRegisters[channel].wire(pinOfTimerChannel(timer, channel), &instances[timer].top);
+            }
+        }
+    }
+    return instances;
+}
+
+/// @brief Leaves every timer as the Arduino core set it up.
+inline void resetPwmTimers() {
+    for (uint8_t timer = 0; timer < 6; timer++) {
+        PwmTimer &pwmTimer = pwmTimers()[timer];
+        pwmTimer.clockSelect = 0;
+        pwmTimer.top = 0;
+        for (uint8_t channel = 0; channel < 3; channel++) pwmTimer.compareRegisters[channel] = 0;
+    }
+}
+
+/// @return [double] the frequency in Hz of the PWM on [pin]: the core's 976.6 Hz fast PWM on Timer0 and 490.2 Hz
+/// phase correct PWM on the others, or the frequency set by [hal::pwmTimerBegin]. 0 for pins without a timer.
+inline double pwmFrequencyHz(uint8_t pin) {
+    static const unsigned long prescalers[] = {0, 1, 8, 64, 256, 1024};
+    uint8_t timer = pin < NUMBER_OF_PINS ? PIN_TO_TIMER[pin] : 0;
+    if (timer == NOT_ON_TIMER) return 0;
+    if (timer == TIMER0A || timer == TIMER0B) return CPU_CLOCK_HZ / (64.0 * 256);
+    int number = timer >= TIMER5A ? 5 : (timer >= TIMER4A ? 4 : (timer >= TIMER3A ? 3 : (timer >= TIMER2A ? 2 : 1)));
+    const PwmTimer &pwmTimer = pwmTimers()[number];
+    if (number == 2 || pwmTimer.clockSelect == 0) return CPU_CLOCK_HZ / (64.0 * 510);
+    return double(CPU_CLOCK_HZ) / (prescalers[pwmTimer.clockSelect] * ((double) pwmTimer.top + 1));
+}
+
+/// Virtual (or host-following) clock.
+struct Clock {
+    unsigned long long micros;
+    bool realTime;
+    std::chrono::steady_clock::time_point origin;
+};
+
+inline Clock &clock() {
+    static Clock instance = {0, false, std::chrono::steady_clock::now()};
+    return instance;
+}
+
+/// Period of the tick interrupt, as on the Mega (one Timer0 overflow).
+static const unsigned long TICK_PERIOD_US = 1024;
+
+/// Handler of the mock tick interrupt, run by [advanceMicros] at every multiple of [TICK_PERIOD_US].
+struct Tick {
+    void (*handler)(void *context);
+    void *context;
+    unsigned long long nextMicros;
+};
+
+inline Tick &tick() {
+    static Tick instance = {NULL, NULL, TICK_PERIOD_US};
+    return instance;
+}
+
+/// Mock hardware watchdog (see [hal::watchdogEnable]), checked as virtual time passes.
+struct Watchdog {
+    bool enabled;
+    unsigned long long timeoutMicros;
+    unsigned long long lastResetMicros;
+    /// Times it ran out, and the virtual time it last did.
+    unsigned long bites;
+    unsigned long long lastBiteMicros;
+    /// The AVR's WDRF flag: the last reset of the board was by the watchdog.
+    bool resetFlag;
+    /// Run when it runs out, standing in for the reset of the board (e.g. running setup() again). NULL for none.
+    void (*handler)();
+};
+
+inline Watchdog &watchdog() {
+    static Watchdog instance = {false, 0, 0, 0, 0, false, NULL};
+    return instance;
+}
+
+/// @brief Turns the watchdog off and forgets its bites. Keeps the handler.
+inline void resetWatchdog() {
+    Watchdog &dog = watchdog();
+    dog.enabled = false;
+    dog.bites = 0;
+    dog.lastBiteMicros = 0;
+    dog.resetFlag = false;
+}
+
+/// @brief Bites if the watchdog has not been reset for its timeout: it is turned off, as the board's reset leaves
+/// it to setup() to turn it on again, and the handler is run.
+inline void checkWatchdog() {
+    Watchdog &dog = watchdog();
+    if (!dog.enabled || clock().micros - dog.lastResetMicros < dog.timeoutMicros) return;
+    dog.enabled = false;
+    dog.bites++;
+    dog.lastBiteMicros = dog.lastResetMicros + dog.timeoutMicros;
+    dog.resetFlag = true;
+    if (dog.handler != NULL) dog.handler();
+}
+
+/// @return [unsigned long long] the first tick time after [micros].
+inline unsigned long long nextTickAfter(unsigned long long micros) {
+    return (micros / TICK_PERIOD_US + 1) * TICK_PERIOD_US;
+}
+
+/// @brief Moves virtual time forward by [us] microseconds, running the tick interrupt handler at every tick
+/// on the way. Has no effect in real-time mode.
+inline void advanceMicros(unsigned long long us) {
+    unsigned long long end = clock().micros + us;
+    while (tick().handler != NULL && tick().nextMicros <= end) {
+        clock().micros = tick().nextMicros;
+        tick().nextMicros += TICK_PERIOD_US;
+        tick().handler(tick().context);
+    }
+    clock().micros = end;
+    checkWatchdog();
+}
+
+/// @brief Sets virtual time back to 0.
+inline void resetClock() {
+    clock().micros = 0;
+    clock().origin = std::chrono::steady_clock::now();
+    tick().nextMicros = TICK_PERIOD_US;
+}
+
+/// @brief Switches the clock between deterministic virtual time (default) and the host's steady clock.
+inline void setRealTime(bool realTime) {
+    clock().realTime = realTime;
+    clock().origin = std::chrono::steady_clock::now() - std::chrono::microseconds(clock().micros);
+}
+
+/// @return [unsigned long long] the current time in microseconds.
+inline unsigned long long nowMicros() {
+    if (clock().realTime) {
+        clock().micros = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - clock().origin).count();
+    }
+    return clock().micros;
+}
+
+/// Size of the Mega's EEPROM.
+static const int EEPROM_SIZE = 4096;
+
+/// Time an EEPROM byte takes to write (erase and program), during which the next write waits.
+static const unsigned long EEPROM_WRITE_US = 3300;
+
+/// Mock EEPROM: its bytes, erased to 0xFF, the number of bytes written (which wears a real EEPROM), the
+/// virtual time the last write completes at and the time writes waited for the one before.
+struct Eeprom {
+    uint8_t bytes[EEPROM_SIZE];
+    unsigned long writes;
+    unsigned long long busyUntilMicros;
+    unsigned long long waitedMicros;
+
+    Eeprom() : writes(0), busyUntilMicros(0), waitedMicros(0) { std::memset(bytes, 0xFF, sizeof(bytes)); }
+};
+
+inline Eeprom &eeprom() {
+    static Eeprom instance;
+    return instance;
+}
+
+/// @brief Erases the EEPROM to 0xFF, as a new Mega has it, and clears its write count.
+inline void resetEeprom() {
+    std::memset(eeprom().bytes, 0xFF, sizeof(eeprom().bytes));
+    eeprom().writes = 0;
+    eeprom().busyUntilMicros = 0;
+    eeprom().waitedMicros = 0;
+}
+
+/// Whether console output is printed to stdout.
+inline bool &consoleEnabled() {
+    static bool enabled = true;
+    return enabled;
+}
+
+/// Whether a serial write that would have waited on the robot moves virtual time on by the wait (running the
+/// tick interrupt on the way), as the robot's clock would, instead of only counting it. Off by default.
+inline bool &waitsTakeTime() {
+    static bool enabled = false;
+    return enabled;
+}
+
+/// @class TransmitTiming
+/// @brief Times the bytes written to a serial line against virtual time at its baud rate.
+///
+/// @details Bytes wait in a transmit buffer of [bufferSize] bytes (64 like the core's HardwareSerial, none for
+/// SoftwareSerial) while the line shifts them out. A write that would have waited on the robot, for a free
+/// buffer slot or for its own bits on a line without a buffer, adds that wait to [blockedMicros]. Unless
+/// [waitsTakeTime], the clock is not moved: later bytes are then timed as if it had moved on by the waits.
+class TransmitTiming {
+private:
+    long baud;
+
+    int bufferSize;
+
+    /// Virtual time the line finishes shifting out the bytes written so far.
+    unsigned long long lineFreeMicros;
+
+    unsigned long long blocked;
+
+    /// Part of [blocked] the clock was not moved on by.
+    unsigned long long unclocked;
+
+    /// @return [unsigned long long] virtual time as the robot would see it after all the waits so far.
+    unsigned long long portMicros() const { return nowMicros() + unclocked; }
+
+    void wait(unsigned long long us) {
+        blocked += us;
+        if (waitsTakeTime()) advanceMicros(us);
+        else unclocked += us;
+    }
+
+public:
+    TransmitTiming(int bufferSize) : baud(0), bufferSize(bufferSize), lineFreeMicros(0), blocked(0), unclocked(0) {}
+
+    /// @brief Starts timing at [baud], 0 for not at all, with nothing sent yet.
+    void begin(long baud) {
+        this->baud = baud;
+        lineFreeMicros = 0;
+        blocked = 0;
+        unclocked = 0;
+    }
+
+    /// Times the sending of one more byte.
+    void queueByte() {
+        if (baud <= 0) return;
+        unsigned long long now = portMicros(), byteMicros = 10000000ULL / baud;
+        if (lineFreeMicros < now) lineFreeMicros = now;
+        unsigned long long bufferedMicros = (unsigned long long) bufferSize * byteMicros;
+        if (lineFreeMicros - now > bufferedMicros) wait(lineFreeMicros - now - bufferedMicros);
+        lineFreeMicros += byteMicros;
+        if (bufferSize == 0) wait(byteMicros);
+    }
+
+    /// @return [int] free bytes of the transmit buffer: bytes that can be written now without waiting.
+    int availableForWrite() const {
+        if (baud <= 0) return bufferSize;
+        unsigned long long now = portMicros(), byteMicros = 10000000ULL / baud;
+        if (lineFreeMicros <= now) return bufferSize;
+        int queued = (int) ((lineFreeMicros - now + byteMicros - 1) / byteMicros);
+        return queued < bufferSize ? bufferSize - queued : 0;
+    }
+
+    /// @return [unsigned long long] microseconds the writes so far would have waited on the robot.
+    unsigned long long blockedMicros() const { return blocked; }
+
+    long getBaud() const { return baud; }
+};
+
+}
+
+/// Type of an I/O port register.
+typedef native::IoRegister PortRegister;
+
+/// Same steps as the Mega core's turnOffPWM(): disconnect the timer channel from its pin.
+inline void turnOffPWM(uint8_t timer) {
+    for (int pin = 0; pin < native::NUMBER_OF_PINS; pin++) {
+        if (native::PIN_TO_TIMER[pin] == timer) native::gpio().pwmConnected[pin] = false;
+    }
+    native::counters().ioWrites++;
+}
+
+/// @class InterruptLock
+/// @brief Holds interrupts off for as long as it is in scope, restoring the previous state after.
+class InterruptLock {
+private:
+    bool wasEnabled;
+
+public:
+    InterruptLock() {
+        native::counters().interruptLocks++;
+        wasEnabled = native::gpio().interruptsEnabled;
+        native::gpio().interruptsEnabled = false;
+    }
+
+    ~InterruptLock() {
+        native::gpio().interruptsEnabled = wasEnabled;
+    }
+};
+
+inline void pinMode(uint8_t pin, uint8_t mode) {
+    uint8_t bit = 1 << native::readFlash(native::PIN_TO_BIT, pin);
+    uint8_t port = native::readFlash(native::PIN_TO_PORT, pin);
+    if (port == 0) return;
+    InterruptLock lock;
+    if (mode == OUTPUT) native::gpio().modeRegisters[port] |= bit;
+    else native::gpio().modeRegisters[port] &= ~bit;
+}
+
+/// Same steps as the Mega core's digitalWrite().
+inline void digitalWrite(uint8_t pin, uint8_t value) {
+    uint8_t timer = native::readFlash(native::PIN_TO_TIMER, pin);
+    uint8_t bit = 1 << native::readFlash(native::PIN_TO_BIT, pin);
+    uint8_t port = native::readFlash(native::PIN_TO_PORT, pin);
+    if (port == 0) return;
+    if (timer != native::NOT_ON_TIMER) turnOffPWM(timer);
+    PortRegister &out = native::gpio().outputRegisters[port];
+    InterruptLock lock;
+    if (value == LOW) out &= ~bit;
+    else out |= bit;
+}
+
+/// Reads the output latch of output pins and the level set by [native::setDigitalInput] of input pins.
+inline int digitalRead(uint8_t pin) {
+    uint8_t timer = native::readFlash(native::PIN_TO_TIMER, pin);
+    uint8_t bit = 1 << native::readFlash(native::PIN_TO_BIT, pin);
+    uint8_t port = native::readFlash(native::PIN_TO_PORT, pin);
+    if (port == 0) return LOW;
+    if (timer != native::NOT_ON_TIMER) turnOffPWM(timer);
+    if (native::gpio().modeRegisters[port] & bit) return (native::gpio().outputRegisters[port] & bit) ? HIGH : LOW;
+    return native::gpio().inputLevels[pin];
+}
+
+/// Same behaviour as the Mega core's analogWrite(): 0 and 255 and pins without a timer become digital writes.
+inline void analogWrite(uint8_t pin, int value) {
+    pinMode(pin, OUTPUT);
+    if (pin >= native::NUMBER_OF_PINS) return;
+    uint8_t timer = native::readFlash(native::PIN_TO_TIMER, pin);
+    if (value == 0 || value >= 255 || timer == native::NOT_ON_TIMER) {
+        digitalWrite(pin, value < 128 ? LOW : HIGH);
+        return;
+    }
+    // Setting the compare output mode and OCRnx
+    native::counters().ioWrites += 2;
+    native::gpio().pwmConnected[pin] = true;
+    native::gpio().pwmDuty[pin] = value;
+    if (native::outputObserver() != NULL) native::outputObserver()();
+}
+
+using native::CPU_CLOCK_HZ;
+
+/// Type of the compare register (OCRnx) of a 16-bit timer channel.
+typedef native::CompareRegister PwmRegister;
+
+/// @brief Runs 16-bit [timer] (1, 3, 4 or 5) in fast PWM with TOP [top], at CPU_CLOCK_HZ / (prescaler * (top + 1)).
+/// Its channels stay connected to their pins, or not, as they were.
+/// @param clockSelect Prescaler bits: 1 (1), 2 (8), 3 (64), 4 (256) or 5 (1024).
+inline void pwmTimerBegin(uint8_t timer, uint8_t clockSelect, uint16_t top) {
+    if (timer != 1 && (timer < 3 || timer > 5)) return;
+    InterruptLock lock;
+    native::PwmTimer &pwmTimer = native::pwmTimers()[timer];
+    // TCCRnB (stopping the timer), TCCRnA, ICRn, TCNTn and TCCRnB again
+    native::counters().ioReads++;
+    native::counters().ioWrites += 7;
+    pwmTimer.clockSelect = clockSelect & 0x07;
+    pwmTimer.top = top;
+    for (uint8_t channel = 0; channel < 3; channel++) pwmTimer.compareRegisters[channel].updateDuty();
+}
+
+/// @return [PwmRegister*] the compare register of [channel] (0-2 for A-C) of 16-bit [timer], or NULL.
+inline PwmRegister *pwmCompareRegister(uint8_t timer, uint8_t channel) {
+    if ((timer != 1 && (timer < 3 || timer > 5)) || channel > 2) return NULL;
+    return &native::pwmTimers()[timer].compareRegisters[channel];
+}
+
+/// @brief Connects [channel] of 16-bit [timer] to its pin (non-inverting) or disconnects it, leaving the pin to
+/// its PORTx level.
+inline void pwmConnect(uint8_t timer, uint8_t channel, bool connected) {
+    uint8_t pin = native::pinOfTimerChannel(timer, channel);
+    if (pin >= native::NUMBER_OF_PINS || native::pwmTimers()[timer].clockSelect == 0) return;
+    InterruptLock lock;
+    // Read-modify-write of TCCRnA
+    native::counters().ioReads++;
+    native::counters().ioWrites++;
+    native::gpio().pwmConnected[pin] = connected;
+    if (connected) native::pwmTimers()[timer].compareRegisters[channel].updateDuty();
+    else if (native::outputObserver() != NULL) native::outputObserver()();
+}
+
+inline int analogRead(uint8_t pin) {
+    return pin < native::NUMBER_OF_PINS ? native::gpio().analogInputs[pin] : 0;
+}
+
+inline unsigned long millis() { return (unsigned long) (native::nowMicros() / 1000); }
+
+inline unsigned long micros() { return (unsigned long) native::nowMicros(); }
+
+/// Advances virtual time by [ms]; in real-time mode, sleeps.
+inline void delay(unsigned long ms) {
+    if (native::clock().realTime) std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    else native::advanceMicros(1000ULL * ms);
+}
+
+/// @brief Starts the watchdog, which bites (see [native::checkWatchdog]) unless [watchdogReset] is called at
+/// least every [timeoutMs], rounded down to the AVR's steps as on the robot.
+inline void watchdogEnable(unsigned long timeoutMs) {
+    static const unsigned long timeouts[] = {15, 30, 60, 120, 250, 500, 1000, 2000, 4000, 8000};
+    int prescaler = 0;
+    while (prescaler < 9 && timeouts[prescaler + 1] <= timeoutMs) prescaler++;
+    native::Watchdog &dog = native::watchdog();
+    dog.enabled = true;
+    dog.timeoutMicros = 1000ULL * timeouts[prescaler];
+    dog.lastResetMicros = native::nowMicros();
+}
+
+inline void watchdogReset() { native::watchdog().lastResetMicros = native::nowMicros(); }
+
+inline void watchdogDisable() { native::watchdog().enabled = false; }
+
+/// @return [bool] true if the last reset was by the watchdog. Clears the flag.
+inline bool resetByWatchdog() {
+    bool byWatchdog = native::watchdog().resetFlag;
+    native::watchdog().resetFlag = false;
+    return byWatchdog;
+}
+
+/// @return [PortRegister*] the PORTx output register of [pin], or NULL if it is not a pin.
+inline PortRegister *pinOutputRegister(uint8_t pin) {
+    uint8_t port = native::readFlash(native::PIN_TO_PORT, pin);
+    return port == 0 ? NULL : &native::gpio().outputRegisters[port];
+}
+
+/// @return [uint8_t] the bit mask of [pin] within its port register.
+inline uint8_t pinBitMask(uint8_t pin) { return 1 << native::readFlash(native::PIN_TO_BIT, pin); }
+
+/// @return [PortRegister*] the PINx input register of [pin], or NULL if it is not a pin. Its bits follow the
+/// levels set by [native::setDigitalInput].
+inline PortRegister *pinInputRegister(uint8_t pin) {
+    uint8_t port = native::readFlash(native::PIN_TO_PORT, pin);
+    return port == 0 ? NULL : &native::gpio().inputRegisters[port];
+}
+
+/// Function run by a pin interrupt, with the context given to [attachPinInterrupt].
+typedef void (*PinInterruptHandler)(void *context);
+
+/// @brief Runs [handler] on every edge [mode] (RISING, FALLING or CHANGE) of input [pin], as set by
+/// [native::setDigitalInput]. Only the Mega's external interrupt pins (2, 3, 18-21) have one.
+/// @param handler Function to run, or NULL to stop the interrupt.
+/// @param context Passed to [handler].
+/// @return [bool] false if [pin] has no external interrupt.
+inline bool attachPinInterrupt(uint8_t pin, PinInterruptHandler handler, void *context, int mode) {
+    if (!native::hasPinInterrupt(pin)) return false;
+    native::PinInterrupt &pinInterrupt = native::pinInterrupts()[pin];
+    pinInterrupt.handler = handler;
+    pinInterrupt.context = context;
+    pinInterrupt.mode = mode;
+    return true;
+}
+
+/// @return [uint8_t] the byte at [address] of a table declared PROGMEM (in plain memory on the host).
+inline uint8_t readProgramByte(const uint8_t *address) { return *address; }
+
+using native::EEPROM_SIZE;
+
+/// @return [uint8_t] the EEPROM byte at [address], 0xFF outside the EEPROM.
+inline uint8_t eepromRead(int address) {
+    if (address < 0 || address >= EEPROM_SIZE) return 0xFF;
+    return native::eeprom().bytes[address];
+}
+
+/// @return [bool] true once the last EEPROM write has completed (in virtual time).
+inline bool eepromReady() {
+    return native::nowMicros() >= native::eeprom().busyUntilMicros;
+}
+
+/// @brief Writes [value] to the EEPROM byte at [address], only if it differs, as eeprom_update_byte() does.
+/// Like it, first waits for the previous write to complete, moving virtual time on (see [native::advanceMicros]).
+inline void eepromWrite(int address, uint8_t value) {
+    if (address < 0 || address >= EEPROM_SIZE) return;
+    if (!eepromReady()) {
+        unsigned long long waitUs = native::eeprom().busyUntilMicros - native::nowMicros();
+        native::eeprom().waitedMicros += waitUs;
+        if (native::clock().realTime) while (!eepromReady()) {}
+        else native::advanceMicros(waitUs);
+    }
+    if (native::eeprom().bytes[address] == value) return;
+    native::eeprom().bytes[address] = value;
+    native::eeprom().writes++;
+    native::eeprom().busyUntilMicros = native::nowMicros() + native::EEPROM_WRITE_US;
+}
+
+using native::TICK_PERIOD_US;
+
+/// Function run by the tick interrupt, with the context given to [attachTickInterrupt].
+typedef void (*TickHandler)(void *context);
+
+/// @brief Runs [handler] every [TICK_PERIOD_US] of virtual time, as the Mega's tick interrupt does (see
+/// [native::advanceMicros]). Ticks are not run in real-time mode.
+/// @param handler Function to run, or NULL to stop the ticks.
+/// @param context Passed to [handler].
+inline void attachTickInterrupt(TickHandler handler, void *context) {
+    native::tick().handler = handler;
+    native::tick().context = context;
+    native::tick().nextMicros = native::nextTickAfter(native::clock().micros);
+}
+
+/// @class Console
+/// @brief Debug output printed to stdout, if [native::consoleEnabled]. Input is queued by the simulation with [inject].
+///
+/// @details Like Serial on the Mega it is a hardware UART: once begun, its output is timed at the baud rate
+/// (see [native::TransmitTiming]), whether it is printed or not.
+class Console {
+private:
+    std::deque<uint8_t> received;
+
+    native::TransmitTiming timing;
+
+    /// Times [text], and prints it if enabled.
+    void write(const char *text) {
+        for (const char *c = text; *c != '\0'; c++) timing.queueByte();
+        if (native::consoleEnabled()) std::fputs(text, stdout);
+    }
+
+public:
+    Console() : timing(64) {}
+
+    void begin(long baud) { timing.begin(baud); }
+    int available() { return (int) received.size(); }
+    int read() {
+        if (received.empty()) return -1;
+        uint8_t byte = received.front();
+        received.pop_front();
+        return byte;
+    }
+    /// @brief Queues [text] as if it had been typed in the Serial Monitor.
+    void inject(const char *text) { received.insert(received.end(), text, text + std::strlen(text)); }
+    void print(const char *text) { write(text); }
+    void print(char character) { char text[2] = {character, '\0'}; write(text); }
+    void print(int number) { print((long) number); }
+    void print(long number) { char text[12]; std::snprintf(text, sizeof(text), "%ld", number); write(text); }
+    void print(unsigned int number) { print((unsigned long) number); }
+    void print(unsigned long number) { char text[12]; std::snprintf(text, sizeof(text), "%lu", number); write(text); }
+    void println() { print('\n'); }
+    template <typename T> void println(T value) { print(value); println(); }
+
+    /// @return [unsigned long long] microseconds the output so far would have waited on the robot.
+    unsigned long long blockedMicros() const { return timing.blockedMicros(); }
+};
+
+inline Console &console() {
+    static Console instance;
+    return instance;
+}
+
+namespace native {
+
+class SerialPort;
+
+static const int MAX_NUMBER_OF_SERIAL_PORTS = 8;
+
+inline SerialPort **serialPorts() {
+    static SerialPort *ports[MAX_NUMBER_OF_SERIAL_PORTS] = {NULL};
+    return ports;
+}
+
+/// @class SerialPort
+/// @brief Mock serial port. A simulation feeds its receive queue with [inject] and reads what the robot
+/// sent from [transmitted]. Ports register themselves so that [findSerial] can find the one the robot uses.
+///
+/// @details Once begun, sending is timed against virtual time at the baud rate, with a transmit buffer of
+/// [txBufferSize] bytes (see [TransmitTiming]).
+class SerialPort {
+private:
+    uint8_t rxPin, txPin;
+
+    std::deque<uint8_t> received;
+
+    std::string sent;
+
+    TransmitTiming timing;
+
+public:
+    SerialPort(uint8_t rx, uint8_t tx, int txBufferSize = 0) : rxPin(rx), txPin(tx), timing(txBufferSize) {
+        for (int i = 0; i < MAX_NUMBER_OF_SERIAL_PORTS; i++) {
+            if (serialPorts()[i] == NULL) {
+                serialPorts()[i] = this;
+                break;
+            }
+        }
+    }
+
+    ~SerialPort() {
+        for (int i = 0; i < MAX_NUMBER_OF_SERIAL_PORTS; i++) {
+            if (serialPorts()[i] == this) serialPorts()[i] = NULL;
+        }
+    }
+
+    void begin(long baud) { timing.begin(baud); }
+
+    int available() { return (int) received.size(); }
+
+    int read() {
+        if (received.empty()) return -1;
+        uint8_t byte = received.front();
+        received.pop_front();
+        return byte;
+    }
+
+    size_t write(uint8_t byte) { sent += (char) byte; timing.queueByte(); return 1; }
+
+    size_t print(const char *text) {
+        for (const char *c = text; *c != '\0'; c++) write((uint8_t) *c);
+        return std::strlen(text);
+    }
+
+    /// @return [int] free bytes of the transmit buffer: bytes that can be written now without waiting.
+    int availableForWrite() { return timing.availableForWrite(); }
+
+    /// @return [unsigned long long] microseconds the writes so far would have waited on the robot.
+    unsigned long long blockedMicros() const { return timing.blockedMicros(); }
+
+    size_t println(const char *text) { return print(text) + print("\r\n"); }
+
+    /// @brief Queues [bytes] as if they had been received on the RX pin.
+    void inject(const uint8_t *bytes, size_t length) { received.insert(received.end(), bytes, bytes + length); }
+
+    /// @brief Queues a NUL-terminated string as if it had been received on the RX pin.
+    void inject(const char *text) { inject((const uint8_t *) text, std::strlen(text)); }
+
+    /// @return [std::string&] everything written to the port so far. May be cleared by the caller.
+    std::string &transmitted() { return sent; }
+
+    uint8_t getRxPin() const { return rxPin; }
+
+    uint8_t getTxPin() const { return txPin; }
+
+    long getBaud() const { return timing.getBaud(); }
+};
+
+/// @return [SerialPort*] the mock port receiving on [rxPin], or NULL if there is none.
+inline SerialPort *findSerial(uint8_t rxPin) {
+    for (int i = 0; i < MAX_NUMBER_OF_SERIAL_PORTS; i++) {
+        if (serialPorts()[i] != NULL && serialPorts()[i]->getRxPin() == rxPin) return serialPorts()[i];
+    }
+    return NULL;
+}
+
+}
+
+/// @class SoftwareSerial
+/// @brief Mock software serial port on any pair of pins.
+class SoftwareSerial : public native::SerialPort {
+public:
+    SoftwareSerial(uint8_t rx, uint8_t tx) : native::SerialPort(rx, tx) {}
+};
+
+/// @class HardwareSerial
+/// @brief Mock hardware UART, on the RX/TX pins of the Mega's USART it stands for.
+class HardwareSerial : public native::SerialPort {
+public:
+    static const int TX_BUFFER_SIZE = 64;
+
+    HardwareSerial(uint8_t rx, uint8_t tx) : native::SerialPort(rx, tx, TX_BUFFER_SIZE) {}
+};
+
+/// @return [HardwareSerial&] the Mega's Serial1 (RX 19, TX 18).
+inline HardwareSerial &serial1() {
+    static HardwareSerial instance(19, 18);
+    return instance;
+}
+
+/// @return [HardwareSerial&] the Mega's Serial2 (RX 17, TX 16).
+inline HardwareSerial &serial2() {
+    static HardwareSerial instance(17, 16);
+    return instance;
+}
+
+/// @return [HardwareSerial&] the Mega's Serial3 (RX 15, TX 14).
+inline HardwareSerial &serial3() {
+    static HardwareSerial instance(15, 14);
+    return instance;
+}
+
+}
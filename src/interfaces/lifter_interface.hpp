@@ -1,5 +1,7 @@
 #pragma once
+#include <stdlib.h>
 #include "motordriver_interfaces.hpp"
+#include "../utils/task_scheduler.hpp"
 
 /// <summary>
 /// @file lifter_interface.hpp
@@ -13,12 +15,109 @@
 ///
 /// @details Initialized with a [MotorDriverInterface] object, which represents the motor driver controlling
 /// the lifter motor.
+///
+/// Feedback of the claw's position is optional: limit switches at the ends of its travel
+/// ([setLimitSwitches]) and/or a potentiometer turned by it ([setPotentiometer]). With feedback, [moveTo]
+/// moves the claw to a position without blocking and [update], called every [UPDATE_PERIOD_MS], stops it as
+/// soon as it is there, whatever the battery's charge. [update] also cuts the power when the claw stalls:
+/// when a limit switch is pressed in the direction it moves, when the potentiometer stops turning, or, with
+/// limit switches only, when the end is not reached within the travel timeout ([setTravelTimeout]).
 class LifterInterface {
+public:
+    /// Positions of the claw, in thousandths of its travel.
+    static const int POSITION_DOWN = 0, POSITION_UP = 1000;
+
+    /// Period [update] is meant to be called at.
+    static const unsigned long UPDATE_PERIOD_MS = 5;
+
+    /// How close to its target [moveTo] stops the claw with a potentiometer, in thousandths of the travel.
+    static const int POSITION_TOLERANCE = 15;
+
+    /// Stall detection with a potentiometer: the claw must move [STALL_PROGRESS] thousandths of its travel
+    /// every [STALL_MS], or the power is cut.
+    static const unsigned long STALL_MS = 200;
+    static const int STALL_PROGRESS = 10;
+
+    /// Default time the claw is given to reach a limit switch, without a potentiometer.
+    static const unsigned long DEFAULT_TRAVEL_TIMEOUT_MS = 4000;
+
+    /// How the last move of the claw ended.
+    enum Outcome : uint8_t {
+        IDLE,
+        MOVING,
+        /// The target of [moveTo], or the limit switch moved towards, was reached.
+        REACHED,
+        /// The claw stopped moving, or did not reach its limit switch in time: the power was cut.
+        STALLED
+    };
+
 private:
 
     MotorDriverInterface *lifterMotorDriver;
 
-    String status;
+    StatusCode status;
+
+    int lowerLimitPin, upperLimitPin;
+
+    uint8_t limitActiveLevel;
+
+    int potentiometerPin, potentiometerDown, potentiometerUp;
+
+    /// Direction the claw is driven: 1 up, -1 down, 0 stopped.
+    int8_t direction;
+
+    /// Position [moveTo] stops the claw at, -1 for none.
+    int target;
+
+    Outcome outcome;
+
+    /// Stall detection: the potentiometer's progress every [STALL_MS], or the travel timeout.
+    Timer stallTimer;
+
+    int stallPosition;
+
+    unsigned long travelTimeoutMs;
+
+    bool hasLimit(int8_t towards) const {
+        return (towards > 0 ? upperLimitPin : lowerLimitPin) != -1;
+    }
+
+    bool isAtLimit(int8_t towards) const {
+        int pin = towards > 0 ? upperLimitPin : lowerLimitPin;
+        return pin != -1 && hal::digitalRead(pin) == limitActiveLevel;
+    }
+
+    /// @brief Drives the claw towards [towards], unless it is at that end already, and starts watching for a stall.
+    void start(int8_t towards, int speed, int target) {
+        if (isAtLimit(towards)) {
+            halt(Outcome::REACHED);
+            return;
+        }
+        if (towards > 0) lifterMotorDriver->leftMotorForward(speed);
+        else lifterMotorDriver->leftMotorBackward(speed);
+        status = towards > 0 ? StatusCode::LIFT_UP : StatusCode::LIFT_DOWN;
+        direction = towards;
+        this->target = target;
+        outcome = Outcome::MOVING;
+        if (hasPotentiometer()) {
+            stallPosition = getPosition();
+            stallTimer.start(STALL_MS);
+        } else if (hasLimit(towards) && travelTimeoutMs > 0) {
+            stallTimer.start(travelTimeoutMs);
+        } else {
+            stallTimer.stop();
+        }
+    }
+
+    /// @brief Cuts the power of the claw, the last move ending with [outcome].
+    void halt(Outcome outcome) {
+        lifterMotorDriver->stop();
+        direction = 0;
+        target = -1;
+        stallTimer.stop();
+        this->outcome = outcome;
+        status = outcome == Outcome::STALLED ? StatusCode::LIFT_STALLED : StatusCode::STOPPED;
+    }
 
 public:
     /// @brief Constuctor initializing the [LifterInterface] Class.
@@ -26,34 +125,139 @@ public:
     /// @return [LifterInterface] object
     LifterInterface(MotorDriverInterface *motorDriver) {
         this->lifterMotorDriver = motorDriver;
-        status = "ready";
+        lowerLimitPin = upperLimitPin = -1;
+        limitActiveLevel = LOW;
+        potentiometerPin = -1;
+        potentiometerDown = 0;
+        potentiometerUp = 1023;
+        direction = 0;
+        target = -1;
+        outcome = Outcome::IDLE;
+        stallPosition = 0;
+        travelTimeoutMs = DEFAULT_TRAVEL_TIMEOUT_MS;
+        status = StatusCode::READY;
+    }
+
+    /// @brief Sets the limit switches pressed by the claw at the ends of its travel.
+    /// @param lowerPin Pin of the switch at the bottom, -1 for none.
+    /// @param upperPin Pin of the switch at the top, -1 for none.
+    /// @param activeLevel Level the pins read while a switch is pressed. Default LOW (switch to ground, with a pull-up).
+    void setLimitSwitches(int lowerPin, int upperPin, uint8_t activeLevel=LOW) {
+        lowerLimitPin = lowerPin;
+        upperLimitPin = upperPin;
+        limitActiveLevel = activeLevel;
+        if (lowerPin != -1) hal::pinMode(lowerPin, INPUT);
+        if (upperPin != -1) hal::pinMode(upperPin, INPUT);
+    }
+
+    /// @brief Sets the potentiometer turned by the claw.
+    /// @param pin Analog pin of the potentiometer's wiper, -1 for none.
+    /// @param rawDown analogRead() of the wiper with the claw down. Range: 0-1023.
+    /// @param rawUp analogRead() of the wiper with the claw up, above or below [rawDown].
+    void setPotentiometer(int pin, int rawDown, int rawUp) {
+        potentiometerPin = rawDown != rawUp ? pin : -1;
+        potentiometerDown = rawDown;
+        potentiometerUp = rawUp;
+    }
+
+    /// @brief Sets the time the claw is given to reach a limit switch without a potentiometer.
+    /// @param timeoutMs Milliseconds after which the power is cut, 0 for no timeout.
+    void setTravelTimeout(unsigned long timeoutMs) {
+        travelTimeoutMs = timeoutMs;
+    }
+
+    bool hasPotentiometer() const {
+        return potentiometerPin != -1;
+    }
+
+    /// @return [int] position of the claw, from [POSITION_DOWN] to [POSITION_UP]: measured by the potentiometer,
+    /// or known at a limit switch only. -1 when unknown.
+    int getPosition() const {
+        if (hasPotentiometer()) {
+            long position = (long) (hal::analogRead(potentiometerPin) - potentiometerDown) * POSITION_UP
+                / (potentiometerUp - potentiometerDown);
+            return position < POSITION_DOWN ? POSITION_DOWN : (position > POSITION_UP ? POSITION_UP : (int) position);
+        }
+        if (isAtLimit(-1)) return POSITION_DOWN;
+        if (isAtLimit(1)) return POSITION_UP;
+        return -1;
     }
 
     /// MOVEMENT FUNCTION --> Move Claw Up
     /// @param speed Speed of the left movement. Range: 0-255. Default: 255
     void moveUp(int speed=255){
-        lifterMotorDriver->leftMotorForward(speed);
-        status = "lift_up";
+        start(1, speed, -1);
     }
 
     /// MOVEMENT FUNCTIONS --> Move Claw Down
     /// @param speed Speed of the right movement. Range: 0-255. Default: 255
     void moveDown(int speed=255){
-        lifterMotorDriver->leftMotorBackward(speed);
-        status = "lift_down";
+        start(-1, speed, -1);
     }
 
     /// MOVEMENT FUNCTIONS --> Stop
     void stop(){
-        lifterMotorDriver->stop();
-        status = "stopped";
+        halt(Outcome::IDLE);
+    }
+
+    /// @brief Starts moving the claw to [position]; [update] stops it there. Non-blocking.
+    /// @param position Target, from [POSITION_DOWN] to [POSITION_UP].
+    /// @param speed Speed of the movement. Range: 0-255. Default: 255
+    /// @return [bool] true if the feedback tells when the claw is there (see [isMoving]). Without it, the claw
+    /// moves towards the nearer end until stopped, e.g. after a time.
+    bool moveTo(int position, int speed=255) {
+        position = position < POSITION_DOWN ? POSITION_DOWN : (position > POSITION_UP ? POSITION_UP : position);
+        if (hasPotentiometer()) {
+            int current = getPosition();
+            if (abs(current - position) <= POSITION_TOLERANCE) halt(Outcome::REACHED);
+            else start(position > current ? 1 : -1, speed, position);
+            return true;
+        }
+        int8_t towards = position >= (POSITION_DOWN + POSITION_UP) / 2 ? 1 : -1;
+        start(towards, speed, towards > 0 ? POSITION_UP : POSITION_DOWN);
+        return hasLimit(towards) && (position == POSITION_DOWN || position == POSITION_UP);
+    }
+
+    /// @brief Stops the claw once it has reached its target or limit switch, or stalls. Non-blocking; call
+    /// every [UPDATE_PERIOD_MS].
+    void update() {
+        if (direction == 0) return;
+        if (isAtLimit(direction)) {
+            halt(Outcome::REACHED);
+            return;
+        }
+        if (!hasPotentiometer()) {
+            if (stallTimer.hasExpired()) halt(Outcome::STALLED);
+            return;
+        }
+        int position = getPosition();
+        if (target != -1 && (direction > 0 ? position >= target - POSITION_TOLERANCE : position <= target + POSITION_TOLERANCE)) {
+            halt(Outcome::REACHED);
+        } else if (stallTimer.hasExpired()) {
+            if (abs(position - stallPosition) < STALL_PROGRESS) {
+                halt(Outcome::STALLED);
+                return;
+            }
+            stallPosition = position;
+            stallTimer.start(STALL_MS);
+        }
+    }
+
+    /// @return [bool] true while the claw is driven.
+    bool isMoving() const {
+        return direction != 0;
+    }
+
+    /// @return [Outcome] of the last move: [Outcome::MOVING] while it goes on.
+    Outcome getOutcome() const {
+        return outcome;
     }
 
     /// GETTER FUNCTION --> Status
     /// @param verbose [bool] if true, prints the status of the lifer claw in Serial.
-    /// @return [String] containing the status of the Lifter Claw system.
-    String getStatus(bool verbose=false){
-        if(verbose) Serial.println(status);
+    /// @return [StatusCode] containing the status of the Lifter Claw system.
+    StatusCode getStatus(bool verbose=false){
+        if(verbose) hal::console().println(statusText(status));
         return status;
     }
 };
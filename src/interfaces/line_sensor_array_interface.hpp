@@ -0,0 +1,153 @@
+#pragma once
+
+#include "hal/hal.hpp"
+#include "status_codes.hpp"
+
+/// <summary>
+/// @file line_sensor_array_interface.hpp
+/// @brief This file contains the [LineSensorArrayInterface] class.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+
+/// @class LineSensorArrayInterface
+/// @brief This class reads a row of analog IR reflectance sensors and works out where the line is under it.
+///
+/// @details Initialized with the analog pins of the sensors, ordered from the leftmost to the rightmost.
+/// Each reading is scaled between the darkest and brightest values seen by [calibrate] to 0 (no line) to
+/// 1000 (fully on the line), and the line position is the average of the sensor positions weighted by
+/// those values, using integer arithmetic only.
+///
+/// Positions are in units of [POSITION_SPACING] per sensor and centred on the middle of the array: negative
+/// when the line is left of centre, positive when it is right of it. When no sensor sees the line, the
+/// position is held at the end of the array the line was last seen at, so a controller keeps turning back.
+class LineSensorArrayInterface {
+public:
+    static const int MAX_NUMBER_OF_SENSORS = 8;
+
+    /// Position units between two neighbouring sensors.
+    static const int POSITION_SPACING = 1000;
+
+    /// Scaled reading (0-1000) a sensor must exceed for the line to count as seen.
+    static const int LINE_THRESHOLD = 200;
+
+private:
+    uint8_t pins[MAX_NUMBER_OF_SENSORS];
+
+    int numberOfSensors;
+
+    /// True if the line reads lower than the floor, as a bright line does on modules with a pull-up output.
+    bool lineReadsLow;
+
+    int minimum[MAX_NUMBER_OF_SENSORS], maximum[MAX_NUMBER_OF_SENSORS];
+
+    int values[MAX_NUMBER_OF_SENSORS];
+
+    int lastPosition;
+
+    bool lineSeen;
+
+    StatusCode status;
+
+public:
+    /// @brief Constuctor initializing the [LineSensorArrayInterface] Class.
+    /// @param numberOfSensors Number of sensors. Can Have a MAXIMUM of [MAX_NUMBER_OF_SENSORS]. Any more will be ignored.
+    /// @param pins Analog pins of the sensors, leftmost first.
+    /// @param lineReadsLow [bool] true if the line reads lower than the floor. Default: true (white line)
+    /// @return [LineSensorArrayInterface] object
+    LineSensorArrayInterface(int numberOfSensors, const uint8_t pins[], bool lineReadsLow=true) {
+        this->numberOfSensors = numberOfSensors < MAX_NUMBER_OF_SENSORS ? numberOfSensors : MAX_NUMBER_OF_SENSORS;
+        for (int i = 0; i < this->numberOfSensors; i++) {
+            this->pins[i] = pins[i];
+            hal::pinMode(pins[i], INPUT);
+            values[i] = 0;
+        }
+        this->lineReadsLow = lineReadsLow;
+        resetCalibration();
+        lastPosition = 0;
+        lineSeen = false;
+        status = this->numberOfSensors > 1 ? StatusCode::READY : StatusCode::NOT_READY;
+    }
+
+    /// @brief Forgets the calibration, so that readings are scaled over the whole ADC range.
+    void resetCalibration() {
+        for (int i = 0; i < numberOfSensors; i++) {
+            minimum[i] = 1023;
+            maximum[i] = 0;
+        }
+    }
+
+    /// @brief Reads every sensor once and widens its calibration range to include the reading. Call repeatedly
+    /// while sweeping the array over the line and the floor.
+    void calibrate() {
+        for (int i = 0; i < numberOfSensors; i++) {
+            int raw = hal::analogRead(pins[i]);
+            if (raw < minimum[i]) minimum[i] = raw;
+            if (raw > maximum[i]) maximum[i] = raw;
+        }
+    }
+
+    /// @brief Reads every sensor and scales the readings to 0 (floor) - 1000 (line).
+    void read() {
+        for (int i = 0; i < numberOfSensors; i++) {
+            int raw = hal::analogRead(pins[i]);
+            int low = minimum[i], high = maximum[i];
+            if (high <= low) {
+                low = 0;
+                high = 1023;
+            }
+            raw = raw < low ? low : (raw > high ? high : raw);
+            long scaled = (long) (raw - low) * 1000 / (high - low);
+            values[i] = lineReadsLow ? 1000 - (int) scaled : (int) scaled;
+        }
+    }
+
+    /// @brief Reads every sensor and works out the position of the line.
+    /// @return [int] position of the line relative to the centre of the array. Range: -[getPositionRange]-[getPositionRange]
+    int readLinePosition() {
+        read();
+        long weightedSum = 0, sum = 0;
+        lineSeen = false;
+        for (int i = 0; i < numberOfSensors; i++) {
+            if (values[i] > LINE_THRESHOLD) lineSeen = true;
+            weightedSum += (long) values[i] * i * POSITION_SPACING;
+            sum += values[i];
+        }
+        if (!lineSeen || sum == 0) {
+            // Line lost: hold the end it was last seen at.
+            lastPosition = lastPosition < 0 ? -getPositionRange() : getPositionRange();
+            return lastPosition;
+        }
+        lastPosition = (int) (weightedSum / sum) - getPositionRange();
+        return lastPosition;
+    }
+
+    /// @return [bool] true if a sensor saw the line at the last [readLinePosition].
+    bool isLineSeen() const {
+        return lineSeen;
+    }
+
+    /// @return [int] the largest distance of a position from the centre of the array.
+    int getPositionRange() const {
+        return (numberOfSensors - 1) * POSITION_SPACING / 2;
+    }
+
+    /// @param index Index of the sensor, 0 being the leftmost.
+    /// @return [int] the scaled reading (0-1000) of the sensor at the last read.
+    int getValue(int index) const {
+        return index >= 0 && index < numberOfSensors ? values[index] : 0;
+    }
+
+    /// @return [int] number of sensors in the array.
+    int getNumberOfSensors() const {
+        return numberOfSensors;
+    }
+
+    /// GETTER FUNCTION --> Status
+    /// @param verbose [bool] if true, prints the status of the sensor array in Serial.
+    /// @return [StatusCode] status of the sensor array.
+    StatusCode getStatus(bool verbose=false) {
+        if (verbose) hal::console().println(statusText(status));
+        return status;
+    }
+};
@@ -1,6 +1,10 @@
 #pragma once
 
-#include <Arduino.h>
+#include "hal/hal.hpp"
+#include "fast_gpio.hpp"
+#include "timer_pwm.hpp"
+#include "status_codes.hpp"
+#include "../utils/speed_calibration.hpp"
 
 /// <summary>
 /// @file motordriver_interface.hpp
@@ -9,12 +13,70 @@
 /// @version 1.0
 /// @date 2021-09-14
 
+/// @return [StatusCode] the movement a pair of signed wheel speeds amounts to, as reported by [drive].
+inline StatusCode differentialStatus(int leftSpeed, int rightSpeed) {
+    if (leftSpeed == 0 && rightSpeed == 0) return StatusCode::STOPPED;
+    if (leftSpeed < 0 && rightSpeed < 0) return StatusCode::BACKWARD;
+    if (leftSpeed == 0 && rightSpeed > 0) return StatusCode::SMOOTH_LEFT;
+    if (rightSpeed == 0 && leftSpeed > 0) return StatusCode::SMOOTH_RIGHT;
+    if (leftSpeed <= 0) return StatusCode::HARD_LEFT;
+    if (rightSpeed <= 0) return StatusCode::HARD_RIGHT;
+    if (leftSpeed < rightSpeed) return StatusCode::SMOOTH_LEFT;
+    if (leftSpeed > rightSpeed) return StatusCode::SMOOTH_RIGHT;
+    return StatusCode::FORWARD;
+}
+
 /// Template class for all motor driver based Classes.
 class MotorDriverInterface {
 protected:
-    String status;
+    StatusCode status;
+
+    /// Curves of the motors, NULL if uncalibrated (see [setCalibration]).
+    const SpeedCalibration *calibration;
+
+    /// Numbers of the left and right motor in the [calibration].
+    uint8_t leftMotor, rightMotor;
+
+    /// @return [int] the duty to write for [speed] on the left motor.
+    int leftDuty(int speed) const {
+        return calibration == NULL ? speed : calibration->apply(leftMotor, speed);
+    }
+
+    /// @return [int] the duty to write for [speed] on the right motor.
+    int rightDuty(int speed) const {
+        return calibration == NULL ? speed : calibration->apply(rightMotor, speed);
+    }
+
+    /// @brief Body of [drive] for a [driver] of type [Driver]. When [Driver] is a final class, its primitive
+    /// movements are called directly instead of through the virtual table (see [NDualWheelDrive]).
+    /// @param leftSpeed Signed speed of the left motor, negative for reverse. Range: -255-255
+    /// @param rightSpeed Signed speed of the right motor, negative for reverse. Range: -255-255
+    template <typename Driver>
+    static void driveMotors(Driver &driver, int leftSpeed, int rightSpeed) {
+        if (leftSpeed > 0) driver.leftMotorForward(leftSpeed);
+        else if (leftSpeed < 0) driver.leftMotorBackward(-leftSpeed);
+        else driver.leftMotorStop();
+        if (rightSpeed > 0) driver.rightMotorForward(rightSpeed);
+        else if (rightSpeed < 0) driver.rightMotorBackward(-rightSpeed);
+        else driver.rightMotorStop();
+        driver.status = differentialStatus(leftSpeed, rightSpeed);
+    }
 
 public:
+    /// @brief Constuctor initializing an uncalibrated [MotorDriverInterface].
+    MotorDriverInterface() : calibration(NULL), leftMotor(0), rightMotor(0) {}
+
+    /// @brief Linearises the motors' speeds with the curves of [calibration]: the left motor is [firstMotor] and
+    /// the right one [firstMotor] + 1. The speeds passed to the movements are then mapped to duties as they are
+    /// written.
+    /// @param calibration Curves of the robot's motors, NULL to write the speeds unchanged
+    /// @param firstMotor Number of the left motor in [calibration]
+    void setCalibration(const SpeedCalibration *calibration, int firstMotor) {
+        this->calibration = calibration;
+        leftMotor = (uint8_t) firstMotor;
+        rightMotor = (uint8_t) (firstMotor + 1);
+    }
+
     /// PRIMITIVE MOVEMENT -> Left Motor Forward. MUST be Overridden.
     /// @param speed Speed of the right motor. Range: 0-255. Default: 255
     virtual void leftMotorForward(int speed) = 0;
@@ -42,7 +104,7 @@ public:
     virtual void smoothLeft(int speed) {
         rightMotorForward(speed);
         leftMotorStop();
-        status = "smooth_left";
+        status = StatusCode::SMOOTH_LEFT;
     }
 
     /// MOVEMENT FUNCTIONS --> Right
@@ -50,7 +112,7 @@ public:
     virtual void smoothRight(int speed) {
         leftMotorForward(speed);
         rightMotorStop();
-        status = "smooth_right";
+        status = StatusCode::SMOOTH_RIGHT;
     }
 
     /// MOVEMENT FUNCTIONS --> On-Spot Left
@@ -58,7 +120,7 @@ public:
     virtual void hardLeft(int speed) {
         rightMotorForward(speed);
         leftMotorBackward(speed);
-        status = "hard_left";
+        status = StatusCode::HARD_LEFT;
     }
 
     /// MOVEMENT FUNCTIONS --> On-Spot Right
@@ -66,7 +128,7 @@ public:
     virtual void hardRight(int speed) {
         leftMotorForward(speed);
         rightMotorBackward(speed);
-        status = "hard_right";
+        status = StatusCode::HARD_RIGHT;
     }
 
     /// MOVEMENT FUNCTIONS --> Forward
@@ -74,7 +136,7 @@ public:
     virtual void forward(int speed) { 
         leftMotorForward(speed);
         rightMotorForward(speed);
-        status = "forward";
+        status = StatusCode::FORWARD;
     }
     
     /// MOVEMENT FUNCTIONS --> Backward
@@ -82,21 +144,39 @@ public:
     virtual void backward(int speed) {
         leftMotorBackward(speed);
         rightMotorBackward(speed);
-        status = "backward";
+        status = StatusCode::BACKWARD;
+    }
+
+    /// MOVEMENT FUNCTIONS --> Differential
+    /// @param leftSpeed Signed speed of the left motor, negative for reverse. Range: -255-255
+    /// @param rightSpeed Signed speed of the right motor, negative for reverse. Range: -255-255
+    virtual void drive(int leftSpeed, int rightSpeed) {
+        driveMotors(*this, leftSpeed, rightSpeed);
     }
 
     /// MOVEMENT FUNCTIONS --> Stop
     virtual void stop() {
         leftMotorStop();
         rightMotorStop();
-        status = "stop";
+        status = StatusCode::STOPPED;
+    }
+
+    /// BATCHED MOVEMENT --> Adds the direction pin writes of [drive] to [batch], to be written together with
+    /// those of other drivers, and keeps the speeds for [commitDrive].
+    /// @return [bool] false if this driver cannot batch its pins, in which case [drive] is called instead.
+    virtual bool prepareDrive(PortWriteBatch &batch, int leftSpeed, int rightSpeed) {
+        return false;
     }
 
+    /// BATCHED MOVEMENT --> Writes the speeds kept by [prepareDrive], between the release and apply of the [batch].
+    /// Called with interrupts held off.
+    virtual void commitDrive() {}
+
     /// GETTER FUNCTION --> Status
-    /// @return [String] status of the Motor Driver.
+    /// @return [StatusCode] status of the Motor Driver.
     /// @param verbose [bool] if true, prints the status of the motor driver in Serial.
-    virtual String getStatus(bool verbose = false) {
-        if (verbose) Serial.println(status);
+    virtual StatusCode getStatus(bool verbose = false) {
+        if (verbose) hal::console().println(statusText(status));
         return status;
     }
 };
@@ -107,7 +187,7 @@ public:
 ///
 /// @details Initialize with [leftForwardPin, leftBackwardPin, rightForwardPin, rightBackwardPin]
 /// [enableLeftPin, enableRightPin] are optional for speed control.
-class L298NInterface : public MotorDriverInterface {
+class L298NInterface final : public MotorDriverInterface {
 private:
     int lmf, lmb, rmf, rmb;
 
@@ -130,8 +210,8 @@ public:
         int enableLeftPin=-1,
         int enableRightPin=-1
     ) {
-        if (enableLeftPin == -1) Serial.println("Left Motor Speed Control pin not set up!");
-        if (enableRightPin == -1) Serial.println("Right Motor Speed Control pin not set up!");
+        if (enableLeftPin == -1) hal::console().println("Left Motor Speed Control pin not set up!");
+        if (enableRightPin == -1) hal::console().println("Right Motor Speed Control pin not set up!");
         // Set pin numbers
         lmf = leftForwardPin;
         lmb = leftBackwardPin;
@@ -140,57 +220,200 @@ public:
         enl = enableLeftPin;
         enr = enableRightPin;
         // Set pin as output
-        pinMode(lmf, OUTPUT);
-        pinMode(lmb, OUTPUT);
-        pinMode(rmf, OUTPUT);
-        pinMode(rmb, OUTPUT);
-        if (enl != -1) pinMode(enl, OUTPUT);
-        if (enr != -1) pinMode(enr, OUTPUT);
+        hal::pinMode(lmf, OUTPUT);
+        hal::pinMode(lmb, OUTPUT);
+        hal::pinMode(rmf, OUTPUT);
+        hal::pinMode(rmb, OUTPUT);
+        if (enl != -1) hal::pinMode(enl, OUTPUT);
+        if (enr != -1) hal::pinMode(enr, OUTPUT);
         // Status of Bot: Ready!
-        status = "ready";
+        status = StatusCode::READY;
     }
 
     /// PRIMITIVE MOVEMENT -> Left Motor Stop.
     void leftMotorStop() override {
-        digitalWrite(lmf, 0);
-        digitalWrite(lmb, 0);
+        hal::digitalWrite(lmf, 0);
+        hal::digitalWrite(lmb, 0);
     }
 
     /// PRIMITIVE MOVEMENT -> Right Motor Stop.
     void rightMotorStop() override {
-        digitalWrite(rmf, 0);
-        digitalWrite(rmb, 0);
+        hal::digitalWrite(rmf, 0);
+        hal::digitalWrite(rmb, 0);
+    }
+
+    /// MOVEMENT FUNCTIONS --> Differential, calling the primitive movements above directly.
+    void drive(int leftSpeed, int rightSpeed) override {
+        driveMotors(*this, leftSpeed, rightSpeed);
     }
 
     /// PRIMITIVE MOVEMENT -> Left Motor Forward
     /// @param speed Speed of the right motor. Range: 0-255. Default: 255
     void leftMotorForward(int speed) override {
-        digitalWrite(lmf, 1);
-        digitalWrite(lmb, 0);
-        if (enl != -1) analogWrite(enl, speed);
+        hal::digitalWrite(lmf, 1);
+        hal::digitalWrite(lmb, 0);
+        if (enl != -1) hal::analogWrite(enl, leftDuty(speed));
     }
 
     /// PRIMITIVE MOVEMENT -> Left Motor Backward
     /// @param speed Speed of the right motor. Range: 0-255. Default: 255
     void leftMotorBackward(int speed) override {
-        digitalWrite(lmf, 0);
-        digitalWrite(lmb, 1);
-        if (enl != -1) analogWrite(enl, speed);
+        hal::digitalWrite(lmf, 0);
+        hal::digitalWrite(lmb, 1);
+        if (enl != -1) hal::analogWrite(enl, leftDuty(speed));
     }
 
     /// PRIMITIVE MOVEMENT -> Right Motor Forward
     /// @param speed Speed of the right motor. Range: 0-255. Default: 255
     void rightMotorForward(int speed) override {
-        digitalWrite(rmf, 1);
-        digitalWrite(rmb, 0);
-        if (enr != -1) analogWrite(enr, speed);
+        hal::digitalWrite(rmf, 1);
+        hal::digitalWrite(rmb, 0);
+        if (enr != -1) hal::analogWrite(enr, rightDuty(speed));
     }
 
     /// PRIMITIVE MOVEMENT -> Right Motor Backward
     /// @param speed Speed of the right motor. Range: 0-255. Default: 255
     void rightMotorBackward(int speed) override {
-        digitalWrite(rmf, 0);
-        digitalWrite(rmb, 1);
-        if (enr != -1) analogWrite(enr, speed);
+        hal::digitalWrite(rmf, 0);
+        hal::digitalWrite(rmb, 1);
+        if (enr != -1) hal::analogWrite(enr, rightDuty(speed));
     }
 };
+
+
+/// @class FastL298NInterface
+/// @brief Drop-in replacement for [L298NInterface] that writes the direction pins through port registers.
+///
+/// @details Same pins and wiring as [L298NInterface]. The pins are resolved to PORTx/bit masks once in the
+/// constructor (see [FastOutputPin]), each motor's two direction pins are written with a single port
+/// operation when they share a port, and the enable pins only see analogWrite() when the speed changes.
+/// Given a PWM frequency, the enable pins run on their 16-bit timers at it instead (see [TimerPwmOutput]).
+class FastL298NInterface final : public MotorDriverInterface {
+private:
+    FastOutputPin lmf, lmb, rmf, rmb;
+
+    int enl, enr;
+
+    /// Timer PWM of the enable pins, attached when a PWM frequency is given.
+    TimerPwmOutput enlPwm, enrPwm;
+
+    /// Duties last written to the enable pins.
+    int leftSpeed, rightSpeed;
+
+    /// Signed speeds kept by [prepareDrive] for [commitDrive].
+    int preparedLeft, preparedRight;
+
+    /// Writes the duty of one motor's enable pin, skipping the write if it is unchanged.
+    void writeSpeed(int enablePin, TimerPwmOutput &pwm, int &lastDuty, int duty) {
+        if (enablePin == -1 || duty == lastDuty) return;
+        if (pwm.isAttached()) pwm.write(duty);
+        else hal::analogWrite(enablePin, duty);
+        lastDuty = duty;
+    }
+
+public:
+    /// @brief Constuctor initializing the [FastL298NInterface].
+    /// @param leftForwardPin Pin for left motor forward direction
+    /// @param leftBackwardPin Pin for left motor backward direction
+    /// @param rightForwardPin Pin for right motor forward direction
+    /// @param rightBackwardPin Pin for right motor backward direction
+    /// @param enableLeftPin Pin for left motor speed control. Default -1 (Speed control Disabled)
+    /// @param enableRightPin Pin for right motor speed control. Default -1 (Speed control Disabled)
+    /// @param pwmFrequencyHz PWM frequency of the enable pins, which must then be on a 16-bit timer (see
+    /// [timer_pwm::isTimerPwmPin]). Default 0 (analogWrite() at the Arduino core's frequencies)
+    /// @return [FastL298NInterface] object
+    FastL298NInterface(
+        int leftForwardPin,
+        int leftBackwardPin,
+        int rightForwardPin,
+        int rightBackwardPin,
+        int enableLeftPin=-1,
+        int enableRightPin=-1,
+        unsigned long pwmFrequencyHz=0
+    ) {
+        if (enableLeftPin == -1) hal::console().println("Left Motor Speed Control pin not set up!");
+        if (enableRightPin == -1) hal::console().println("Right Motor Speed Control pin not set up!");
+        // Resolve pins to port registers and set them as output
+        lmf.attach(leftForwardPin);
+        lmb.attach(leftBackwardPin);
+        rmf.attach(rightForwardPin);
+        rmb.attach(rightBackwardPin);
+        enl = enableLeftPin;
+        enr = enableRightPin;
+        if (enl != -1) hal::pinMode(enl, OUTPUT);
+        if (enr != -1) hal::pinMode(enr, OUTPUT);
+        if (pwmFrequencyHz != 0 && enl != -1 && !enlPwm.attach(enl, pwmFrequencyHz)) {
+            hal::console().println("Left Motor Speed Control pin has no 16-bit timer: using analogWrite()!");
+        }
+        if (pwmFrequencyHz != 0 && enr != -1 && !enrPwm.attach(enr, pwmFrequencyHz)) {
+            hal::console().println("Right Motor Speed Control pin has no 16-bit timer: using analogWrite()!");
+        }
+        // No speed written yet
+        leftSpeed = -1;
+        rightSpeed = -1;
+        preparedLeft = preparedRight = 0;
+        // Status of Bot: Ready!
+        status = StatusCode::READY;
+    }
+
+    /// PRIMITIVE MOVEMENT -> Left Motor Stop.
+    void leftMotorStop() override {
+        FastOutputPin::writePair(lmf, false, lmb, false);
+    }
+
+    /// PRIMITIVE MOVEMENT -> Right Motor Stop.
+    void rightMotorStop() override {
+        FastOutputPin::writePair(rmf, false, rmb, false);
+    }
+
+    /// MOVEMENT FUNCTIONS --> Differential, calling the primitive movements above directly.
+    void drive(int leftSpeed, int rightSpeed) override {
+        driveMotors(*this, leftSpeed, rightSpeed);
+    }
+
+    /// BATCHED MOVEMENT --> Direction pins of [drive] added to [batch].
+    bool prepareDrive(PortWriteBatch &batch, int leftSpeed, int rightSpeed) override {
+        batch.add(lmf, leftSpeed > 0);
+        batch.add(lmb, leftSpeed < 0);
+        batch.add(rmf, rightSpeed > 0);
+        batch.add(rmb, rightSpeed < 0);
+        preparedLeft = leftSpeed;
+        preparedRight = rightSpeed;
+        return true;
+    }
+
+    /// BATCHED MOVEMENT --> Enable pin speeds of [drive]. A stopped motor keeps its last speed, as in [drive].
+    void commitDrive() override {
+        if (preparedLeft != 0) writeSpeed(enl, enlPwm, leftSpeed, leftDuty(preparedLeft > 0 ? preparedLeft : -preparedLeft));
+        if (preparedRight != 0) writeSpeed(enr, enrPwm, rightSpeed, rightDuty(preparedRight > 0 ? preparedRight : -preparedRight));
+        status = differentialStatus(preparedLeft, preparedRight);
+    }
+
+    /// PRIMITIVE MOVEMENT -> Left Motor Forward
+    /// @param speed Speed of the left motor. Range: 0-255. Default: 255
+    void leftMotorForward(int speed) override {
+        FastOutputPin::writePair(lmf, true, lmb, false);
+        writeSpeed(enl, enlPwm, leftSpeed, leftDuty(speed));
+    }
+
+    /// PRIMITIVE MOVEMENT -> Left Motor Backward
+    /// @param speed Speed of the left motor. Range: 0-255. Default: 255
+    void leftMotorBackward(int speed) override {
+        FastOutputPin::writePair(lmf, false, lmb, true);
+        writeSpeed(enl, enlPwm, leftSpeed, leftDuty(speed));
+    }
+
+    /// PRIMITIVE MOVEMENT -> Right Motor Forward
+    /// @param speed Speed of the right motor. Range: 0-255. Default: 255
+    void rightMotorForward(int speed) override {
+        FastOutputPin::writePair(rmf, true, rmb, false);
+        writeSpeed(enr, enrPwm, rightSpeed, rightDuty(speed));
+    }
+
+    /// PRIMITIVE MOVEMENT -> Right Motor Backward
+    /// @param speed Speed of the right motor. Range: 0-255. Default: 255
+    void rightMotorBackward(int speed) override {
+        FastOutputPin::writePair(rmf, false, rmb, true);
+        writeSpeed(enr, enrPwm, rightSpeed, rightDuty(speed));
+    }
+};
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "hal/hal.hpp"
+
+/// <summary>
+/// @file serial_transport.hpp
+/// @brief This file contains the [SerialTransport] interface and its SoftwareSerial and hardware UART backends.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+
+/// @class SerialTransport
+/// @brief Byte stream a [BluetoothInterface] talks to its module over.
+///
+/// @details Extended by [SoftwareSerialTransport] and [HardwareSerialTransport], so the Bluetooth link can be
+/// moved from any pair of pins onto one of the Mega's hardware UARTs without touching the code above it.
+class SerialTransport {
+public:
+    virtual ~SerialTransport() {}
+
+    /// @return [int] number of received bytes waiting to be read.
+    virtual int available() = 0;
+
+    /// @return [int] the next received byte, or -1 if there is none.
+    virtual int read() = 0;
+
+    /// @brief Sends one byte. Waits if the transmit buffer is full.
+    /// @return [size_t] number of bytes sent.
+    virtual size_t write(uint8_t byte) = 0;
+
+    /// @return [int] number of bytes [write] can send now without waiting for the line.
+    virtual int availableForWrite() = 0;
+
+    /// @brief Sends [text] followed by a line break.
+    /// @return [size_t] number of bytes sent.
+    virtual size_t println(const char *text) = 0;
+};
+
+/// @class SoftwareSerialTransport
+/// @brief [SerialTransport] over SoftwareSerial on any pair of pins.
+///
+/// @details SoftwareSerial receives each byte inside a pin change interrupt that busy-waits, with interrupts
+/// off, for the whole character (about 1 ms at 9600 baud). This jitters motor PWM and millis(), and limits
+/// reliable reception to about 57600 baud. Kept as the fallback when no hardware UART is free.
+///
+/// Sending has no buffer either: each byte is bit-banged before write returns (about 1 ms at 9600 baud).
+class SoftwareSerialTransport : public SerialTransport {
+private:
+    hal::SoftwareSerial serial;
+
+public:
+    /// @brief Constuctor initializing the [SoftwareSerialTransport] Class.
+    /// @param rx The Serial receiver pin. Must support pin change interrupts.
+    /// @param tx The Serial transmitter pin.
+    /// @param baud The baud rate of the serial communication.
+    /// @return [SoftwareSerialTransport] object
+    SoftwareSerialTransport(int rx, int tx, long baud) : serial(rx, tx) {
+        serial.begin(baud);
+    }
+
+    int available() {
+        return serial.available();
+    }
+
+    int read() {
+        return serial.read();
+    }
+
+    size_t write(uint8_t byte) {
+        return serial.write(byte);
+    }
+
+    /// @return [int] always 1: there is no transmit buffer, so the best a caller can do is send a byte at a
+    /// time, holding the loop for one character time per call.
+    int availableForWrite() {
+        return 1;
+    }
+
+    size_t println(const char *text) {
+        return serial.println(text);
+    }
+};
+
+/// @class HardwareSerialTransport
+/// @brief [SerialTransport] over one of the Mega's hardware UARTs (Serial1, Serial2 or Serial3).
+///
+/// @details The USART shifts bits in hardware; its receive interrupt only moves each byte into the core's
+/// ring buffer, a few microseconds per byte, so 115200 baud and above leave the loop and PWM undisturbed.
+class HardwareSerialTransport : public SerialTransport {
+private:
+    hal::HardwareSerial *serial;
+
+public:
+    /// @brief Constuctor initializing the [HardwareSerialTransport] Class.
+    /// @param serial Hardware UART, e.g. hal::serial2().
+    /// @param baud The baud rate of the serial communication. Default is 115200.
+    /// @return [HardwareSerialTransport] object
+    HardwareSerialTransport(hal::HardwareSerial &serial, long baud=115200) {
+        this->serial = &serial;
+        this->serial->begin(baud);
+    }
+
+    int available() {
+        return serial->available();
+    }
+
+    int read() {
+        return serial->read();
+    }
+
+    size_t write(uint8_t byte) {
+        return serial->write(byte);
+    }
+
+    /// @return [int] free bytes of the core's 64 byte transmit buffer, emptied by the USART interrupt.
+    int availableForWrite() {
+        return serial->availableForWrite();
+    }
+
+    size_t println(const char *text) {
+        return serial->println(text);
+    }
+};
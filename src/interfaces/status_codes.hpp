@@ -0,0 +1,111 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// <summary>
+/// @file status_codes.hpp
+/// @brief Compact status codes shared by the interfaces and controllers, and their on-demand text.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+
+/// The states an interface or controller can report. Stored as a single byte instead of a heap String.
+enum StatusCode : uint8_t {
+    READY,
+    NOT_READY,
+    FORWARD,
+    BACKWARD,
+    SMOOTH_LEFT,
+    SMOOTH_RIGHT,
+    HARD_LEFT,
+    HARD_RIGHT,
+    STOPPED,
+    LIFT_UP,
+    LIFT_DOWN,
+    LIFT_STALLED
+};
+
+/// @return [const char*] the text of a [StatusCode], as printed in debug output.
+inline const char *statusText(StatusCode status) {
+    switch (status) {
+        case StatusCode::READY: return "ready";
+        case StatusCode::NOT_READY: return "not_ready";
+        case StatusCode::FORWARD: return "forward";
+        case StatusCode::BACKWARD: return "backward";
+        case StatusCode::SMOOTH_LEFT: return "smooth_left";
+        case StatusCode::SMOOTH_RIGHT: return "smooth_right";
+        case StatusCode::HARD_LEFT: return "hard_left";
+        case StatusCode::HARD_RIGHT: return "hard_right";
+        case StatusCode::STOPPED: return "stopped";
+        case StatusCode::LIFT_UP: return "lift_up";
+        case StatusCode::LIFT_DOWN: return "lift_down";
+        case StatusCode::LIFT_STALLED: return "lift_stalled";
+    }
+    return "unknown";
+}
+
+/// @class StatusWriter
+/// @brief Appends text and numbers to a caller-supplied buffer, truncating instead of overflowing.
+///
+/// @details Used to build status text only when it is asked for, on the caller's stack, so that no
+/// String is allocated on the heap.
+class StatusWriter {
+private:
+    char *buffer;
+
+    size_t size;
+
+    size_t length;
+
+public:
+    /// @brief Constuctor initializing the [StatusWriter] with an empty, NUL-terminated [buffer].
+    /// @param buffer Buffer the text is written into.
+    /// @param size Size of [buffer] in bytes, including the terminating NUL.
+    /// @return [StatusWriter] object
+    StatusWriter(char *buffer, size_t size) {
+        this->buffer = buffer;
+        this->size = size;
+        length = 0;
+        if (size > 0) buffer[0] = '\0';
+    }
+
+    /// @brief Appends [text], truncated to the space left.
+    StatusWriter &append(const char *text) {
+        while (*text != '\0' && length + 1 < size) buffer[length++] = *text++;
+        if (size > 0) buffer[length] = '\0';
+        return *this;
+    }
+
+    /// @brief Appends the decimal form of [number].
+    StatusWriter &append(int number) {
+        char digits[12];
+        int i = sizeof(digits) - 1;
+        bool negative = number < 0;
+        unsigned int value = negative ? -(unsigned int) number : number;
+        digits[i] = '\0';
+        do {
+            digits[--i] = '0' + value % 10;
+            value /= 10;
+        } while (value > 0);
+        if (negative) digits[--i] = '-';
+        return append(digits + i);
+    }
+
+    /// @brief Appends the decimal form of [number].
+    StatusWriter &append(unsigned long number) {
+        char digits[12];
+        int i = sizeof(digits) - 1;
+        digits[i] = '\0';
+        do {
+            digits[--i] = '0' + number % 10;
+            number /= 10;
+        } while (number > 0);
+        return append(digits + i);
+    }
+
+    /// @return [size_t] the number of characters written so far, excluding the terminating NUL.
+    size_t getLength() const {
+        return length;
+    }
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "hal/hal.hpp"
+
+/// <summary>
+/// @file timer_pwm.hpp
+/// @brief PWM outputs on the Mega's 16-bit timers at a chosen frequency, written straight to their compare registers.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details analogWrite() leaves the timers as the Arduino core set them up: Timer0 in 8-bit fast PWM at 976 Hz,
+/// the others in 8-bit phase correct PWM at 490 Hz. Motors whine at those frequencies, and two wheels on
+/// different timers get different pulse widths for the same speed. A [TimerPwmOutput] runs its pin's timer in
+/// fast PWM with ICRn as TOP, so every pin on Timer1, 3, 4 and 5 runs at the same chosen frequency (20 kHz is
+/// above hearing and still gives 800 duty steps), and writes duties to OCRnx directly. [timer_pwm::timerOf]
+/// maps the pins to their timers at compile time, so a pin choice can be checked with static_assert.
+
+namespace timer_pwm {
+
+/// Timer of the pins without PWM.
+static const uint8_t NO_TIMER = 0xFF;
+
+/// Timer0 runs millis(), micros(), delay() and the tick interrupt: its pins (4 and 13) are refused.
+static const uint8_t MILLIS_TIMER = 0;
+
+/// Highest frequency: a period of 256 CPU cycles, for at least the 8-bit duty steps of analogWrite().
+static const unsigned long MAX_FREQUENCY_HZ = hal::CPU_CLOCK_HZ / 256;
+
+/// @return [uint8_t] the timer whose compare output drives [pin] on the Mega, or [NO_TIMER].
+constexpr uint8_t timerOf(int pin) {
+    return (pin == 4 || pin == 13) ? 0
+        : (pin == 11 || pin == 12) ? 1
+        : (pin == 9 || pin == 10) ? 2
+        : (pin == 2 || pin == 3 || pin == 5) ? 3
+        : (pin >= 6 && pin <= 8) ? 4
+        : (pin >= 44 && pin <= 46) ? 5
+        : NO_TIMER;
+}
+
+/// @return [uint8_t] the compare channel of [pin] on its timer: 0, 1 or 2 for A, B or C.
+constexpr uint8_t channelOf(int pin) {
+    return (pin == 13 || pin == 11 || pin == 10 || pin == 5 || pin == 6 || pin == 46) ? 0
+        : (pin == 4 || pin == 12 || pin == 9 || pin == 2 || pin == 7 || pin == 45) ? 1
+        : 2;
+}
+
+/// @return [bool] true if [pin] can be a [TimerPwmOutput]: driven by one of the 16-bit timers 1, 3, 4 and 5.
+/// Timer0's pins conflict with millis(), and Timer2 is 8-bit, so its frequencies are not selectable.
+constexpr bool isTimerPwmPin(int pin) {
+    return timerOf(pin) == 1 || timerOf(pin) == 3 || timerOf(pin) == 4 || timerOf(pin) == 5;
+}
+
+/// @return [unsigned long] the prescaler of the timer clock select bits [clockSelect] (1-5).
+constexpr unsigned long prescalerOf(uint8_t clockSelect) {
+    return clockSelect == 1 ? 1 : (clockSelect == 2 ? 8 : (clockSelect == 3 ? 64 : (clockSelect == 4 ? 256 : 1024)));
+}
+
+/// @return [uint8_t] clock select bits of the smallest prescaler, from [clockSelect] up, whose counts of a period
+/// of [frequencyHz] fit in 16 bits (so the duty has the finest steps), or 0 if the frequency is out of range.
+constexpr uint8_t clockSelectFor(unsigned long frequencyHz, uint8_t clockSelect = 1) {
+    return (frequencyHz == 0 || frequencyHz > MAX_FREQUENCY_HZ || clockSelect > 5) ? 0
+        : (hal::CPU_CLOCK_HZ / (prescalerOf(clockSelect) * frequencyHz) <= 65536UL) ? clockSelect
+        : clockSelectFor(frequencyHz, clockSelect + 1);
+}
+
+/// @return [uint16_t] TOP of a timer running at [frequencyHz] with [clockSelectFor] its clock select bits.
+constexpr uint16_t topFor(unsigned long frequencyHz) {
+    return clockSelectFor(frequencyHz) == 0 ? 0
+        : uint16_t(hal::CPU_CLOCK_HZ / (prescalerOf(clockSelectFor(frequencyHz)) * frequencyHz) - 1);
+}
+
+/// @return [bool] true if the timers can run at [frequencyHz].
+constexpr bool isFrequency(unsigned long frequencyHz) {
+    return clockSelectFor(frequencyHz) != 0;
+}
+
+}
+
+
+/// @class TimerPwmOutput
+/// @brief A PWM pin driven by its 16-bit timer at a chosen frequency, with duties written straight to OCRnx.
+///
+/// @details [attach] sets the pin's timer up once; [write] is then a 16-bit register write (and a TCCRnA write
+/// when the pin starts or stops pulsing), where analogWrite() looks the pin up in flash tables on every call.
+/// Other pins of the same timer share its frequency, so they must be attached with the same one.
+class TimerPwmOutput {
+private:
+    hal::PwmRegister *compareRegister;
+
+    uint16_t top;
+
+    uint8_t timer, channel;
+
+    bool connected;
+
+public:
+    /// @brief Constuctor initializing a detached [TimerPwmOutput]. Writes to it are ignored.
+    /// @return [TimerPwmOutput] object
+    TimerPwmOutput() : compareRegister(NULL), top(0), timer(timer_pwm::NO_TIMER), channel(0), connected(false) {}
+
+    /// @brief Drives [pin] LOW and runs its timer at [frequencyHz].
+    /// @param pin Arduino pin number
+    /// @param frequencyHz PWM frequency. Range: 1 to [timer_pwm::MAX_FREQUENCY_HZ]
+    /// @return [bool] false, leaving the output detached, if [pin] is not on a 16-bit timer (see
+    /// [timer_pwm::isTimerPwmPin]) or the timers cannot run at [frequencyHz].
+    bool attach(int pin, unsigned long frequencyHz) {
+        compareRegister = NULL;
+        connected = false;
+        if (pin < 0 || !timer_pwm::isTimerPwmPin(pin) || !timer_pwm::isFrequency(frequencyHz)) return false;
+        timer = timer_pwm::timerOf(pin);
+        channel = timer_pwm::channelOf(pin);
+        top = timer_pwm::topFor(frequencyHz);
+        // digitalWrite() also disconnects the channel from the pin
+        hal::pinMode(pin, OUTPUT);
+        hal::digitalWrite(pin, LOW);
+        hal::pwmTimerBegin(timer, timer_pwm::clockSelectFor(frequencyHz), top);
+        compareRegister = hal::pwmCompareRegister(timer, channel);
+        return compareRegister != NULL;
+    }
+
+    /// @return [bool] true if the pin was set up by [attach].
+    bool isAttached() const {
+        return compareRegister != NULL;
+    }
+
+    /// @return [uint16_t] TOP of the pin's timer: a period is TOP + 1 counts.
+    uint16_t getTop() const {
+        return top;
+    }
+
+    /// @brief Sets the duty, scaled to the timer's period. 0 disconnects the channel, so the pin stays LOW instead
+    /// of pulsing for one count a period, and 255 holds it HIGH.
+    /// @param duty Range: 0-255, as analogWrite().
+    void write(int duty) {
+        if (compareRegister == NULL) return;
+        hal::InterruptLock lock;
+        if (duty <= 0) {
+            if (connected) hal::pwmConnect(timer, channel, false);
+            connected = false;
+            return;
+        }
+        *compareRegister = duty >= 255 ? top : uint16_t((uint32_t) duty * top / 255);
+        if (!connected) hal::pwmConnect(timer, channel, true);
+        connected = true;
+    }
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "hal/hal.hpp"
+#include "status_codes.hpp"
+#include "../utils/odometry.hpp"
+
+/// <summary>
+/// @file wheel_encoders_interface.hpp
+/// @brief This file contains the [WheelEncodersInterface] class.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+
+/// @class WheelEncodersInterface
+/// @brief This class counts the edges of a wheel encoder on each side of the robot and keeps the robot's
+/// [Odometry] from them.
+///
+/// @details Each side has a single channel encoder (a slotted disk and an optical switch) on a pin with an
+/// external interrupt. Both edges are counted, from the interrupt, so a count is only a few cycles of ISR time
+/// and none is missed while the loop is busy. A single channel cannot tell the direction, so the drive tells it
+/// through [setDirections] from the speeds it writes: a side keeps its last direction while it coasts to a
+/// stop. [update] moves the counts since the last call into the [Odometry]; call it periodically (the drive
+/// does, from its own [update]).
+class WheelEncodersInterface {
+private:
+    uint8_t leftPin, rightPin;
+
+    /// Signed counts since the last [update], written by the interrupts.
+    volatile int16_t leftCounts, rightCounts;
+
+    /// +1 or -1, added to the counts on every edge.
+    volatile int8_t leftDirection, rightDirection;
+
+    Odometry odometry;
+
+    StatusCode status;
+
+    static void leftEdge(void *context) {
+        WheelEncodersInterface *encoders = static_cast<WheelEncodersInterface *>(context);
+        encoders->leftCounts += encoders->leftDirection;
+    }
+
+    static void rightEdge(void *context) {
+        WheelEncodersInterface *encoders = static_cast<WheelEncodersInterface *>(context);
+        encoders->rightCounts += encoders->rightDirection;
+    }
+
+public:
+    /// @brief Constuctor initializing the [WheelEncodersInterface] Class and attaching its pin interrupts.
+    /// @param leftPin Pin of the left encoder. Must have an external interrupt (2, 3, 18-21 on the Mega).
+    /// @param rightPin Pin of the right encoder. Must have an external interrupt (2, 3, 18-21 on the Mega).
+    /// @param countsPerRevolution Counted edges per turn of a wheel: twice the slots of the disk.
+    /// @param wheelDiameterMm Diameter of the wheels in millimetres.
+    /// @param wheelBaseMm Effective distance between the left and right wheels in millimetres (see [Odometry]).
+    /// @return [WheelEncodersInterface] object
+    WheelEncodersInterface(uint8_t leftPin, uint8_t rightPin, int countsPerRevolution, int wheelDiameterMm, int wheelBaseMm)
+        : odometry(countsPerRevolution, wheelDiameterMm, wheelBaseMm) {
+        this->leftPin = leftPin;
+        this->rightPin = rightPin;
+        leftCounts = rightCounts = 0;
+        leftDirection = rightDirection = 1;
+        hal::pinMode(leftPin, INPUT);
+        hal::pinMode(rightPin, INPUT);
+        bool attached = hal::attachPinInterrupt(leftPin, leftEdge, this, CHANGE);
+        attached = hal::attachPinInterrupt(rightPin, rightEdge, this, CHANGE) && attached;
+        status = attached ? StatusCode::READY : StatusCode::NOT_READY;
+    }
+
+    ~WheelEncodersInterface() {
+        hal::attachPinInterrupt(leftPin, NULL, NULL, CHANGE);
+        hal::attachPinInterrupt(rightPin, NULL, NULL, CHANGE);
+    }
+
+    /// @brief Sets the direction the wheels are counted in from the signed speeds written to them. A side with
+    /// speed 0 keeps its direction, as it is still coasting the way it went.
+    void setDirections(int leftSpeed, int rightSpeed) {
+        if (leftSpeed != 0) leftDirection = leftSpeed > 0 ? 1 : -1;
+        if (rightSpeed != 0) rightDirection = rightSpeed > 0 ? 1 : -1;
+    }
+
+    /// @brief Moves the counts since the last call into the [Odometry]. Non-blocking.
+    void update() {
+        int16_t left, right;
+        {
+            hal::InterruptLock lock;
+            left = leftCounts;
+            right = rightCounts;
+            leftCounts = rightCounts = 0;
+        }
+        if (left != 0 || right != 0) odometry.advance(left, right);
+    }
+
+    /// @return [Odometry] the pose and counts, as of the last [update].
+    Odometry &getOdometry() {
+        return odometry;
+    }
+
+    /// GETTER FUNCTION --> Status
+    /// @param verbose [bool] if true, prints the status of the encoders in Serial.
+    /// @return [StatusCode] READY, or NOT_READY if a pin has no external interrupt.
+    StatusCode getStatus(bool verbose=false) {
+        if (verbose) hal::console().println(statusText(status));
+        return status;
+    }
+};
@@ -1,6 +1,12 @@
-#include "controllers\bluetooth_controller.hpp"
-#include "controllers\autonomous_controller.hpp"
-#include "controllers\test_controller.hpp"
+#include "controllers/bluetooth_controller.hpp"
+#include "controllers/autonomous_controller.hpp"
+#include "controllers/test_controller.hpp"
+#include "controllers/motion_arbiter.hpp"
+#include "controllers/calibration_sweep.hpp"
+#include "utils/task_scheduler.hpp"
+#include "utils/latency_probe.hpp"
+#include "utils/static_arena.hpp"
+#include "utils/session_recording.hpp"
 
 /// The Control Mode types available to be used by the Robot.
 enum ControlModes {
@@ -13,103 +19,423 @@ enum ControlModes {
 // Define Control Mode
 const ControlModes controlMode = ControlModes::BLUETOOTH;
 
+/// Serial port of the HC05 Bluetooth module: 0 for SoftwareSerial on pins 53/52 at 9600 baud, or 1-3 for the
+/// hardware UART Serial1-3 at 115200 baud (the HC05 must be set to that rate first). Serial1-3 use pins 14-19,
+/// which are wired to the back motor driver, so that driver must be moved before choosing one.
+const int bluetoothSerialPort = 0;
+
+/// Analog pins of the IR line sensor array (leftmost first), used by the PID line follower. Set
+/// [numberOfLineSensors] to 0 if the array is not fitted, to follow the line with the 2 digital IR sensors.
+const uint8_t lineSensorPins[] = {54, 55, 56, 57, 58, 59, 60, 61};
+const int numberOfLineSensors = 0;
+
+/// Digital IR line sensors: sampled together from the tick interrupt every [irSamplePeriodTicks] ticks (of
+/// 1.024 ms), with a change taken once [irDebounceSamples] samples in a row agree. Decisions see a change of the
+/// floor at most period * samples ticks late; shorter periods cost more interrupt time.
+const uint8_t irSamplePeriodTicks = 1;
+const uint8_t irDebounceSamples = 3;
+
+/// Largest change of the wheel speeds, in PWM steps per second when speeding up and when slowing down (see
+/// [DualWheelDriveBase::setRamp]). 0 writes speeds at once, as full-speed jumps.
+const int driveAcceleration = 1000;
+const int driveDeceleration = 2000;
+
+/// Enable (speed) pins of the front and back drive motor drivers, and their PWM frequency. With
+/// [drivePwmFrequencyHz] 0 they run on analogWrite() at the Arduino core's 490/976 Hz, which the motors whine at.
+/// Otherwise their timers run at that frequency (20000 is above hearing; see interfaces/timer_pwm.hpp), and every
+/// enable pin must be on one of the 16-bit timers 1, 3, 4 and 5, checked at compile time: Timer0's pins 4 and 13
+/// would conflict with millis(), and pins 18/19 have no timer at all, so the back driver's enable pins must be
+/// rewired first, e.g. to Timer5's pins 46 and 45.
+const int frontEnableLeftPin = 6, frontEnableRightPin = 7;
+const int backEnableLeftPin = 18, backEnableRightPin = 19;
+const unsigned long drivePwmFrequencyHz = 0;
+static_assert(drivePwmFrequencyHz == 0 || timer_pwm::isFrequency(drivePwmFrequencyHz),
+  "drivePwmFrequencyHz is above timer_pwm::MAX_FREQUENCY_HZ");
+static_assert(drivePwmFrequencyHz == 0 || (timer_pwm::isTimerPwmPin(frontEnableLeftPin)
+  && timer_pwm::isTimerPwmPin(frontEnableRightPin) && timer_pwm::isTimerPwmPin(backEnableLeftPin)
+  && timer_pwm::isTimerPwmPin(backEnableRightPin)), "timer PWM needs every drive enable pin on Timer1, 3, 4 or 5");
+
+/// Single channel wheel encoders, one per side on the external interrupt pins 20 (left) and 21 (right), for the
+/// manoeuvres measured by distance and angle (see [DualWheelDriveBase::driveDistance]). Not fitted on the robot
+/// as built, which runs the timed manoeuvres: set [wheelEncodersFitted] to true once they are. Both edges of the
+/// 20 slot disks are counted. The wheel base is the effective one of the skid-steer chassis, wider than its
+/// 180 mm track as the wheels scrub in a turn; 300 mm is the value of the host model (benchmarks/odometry_sim.hpp),
+/// not measured, and must be measured on the robot (wheels turned for a 180 degree turn) once the encoders are in.
+const bool wheelEncodersFitted = false;
+const uint8_t leftEncoderPin = 20, rightEncoderPin = 21;
+const int encoderCountsPerRevolution = 40;
+const int wheelDiameterMm = 65;
+const int wheelBaseMm = 300;
+
+/// Speed curves of the drive motors, which make both sides turn alike for the same speed: loaded from EEPROM at
+/// boot (after the uploaded mission), and measured by sending 'C' in BLUETOOTH or HYBRID mode once
+/// [calibrationSweepFitted] is set, which needs the wheel encoders. The Robot then turns on the spot for about
+/// 16 s (see [CalibrationSweep]); any drive command aborts it. Uncalibrated motors, or curves failing their
+/// CRC, are written the speeds unchanged.
+const bool calibrationSweepFitted = false;
+static_assert(!calibrationSweepFitted || wheelEncodersFitted, "calibrationSweepFitted needs wheelEncodersFitted");
+
+/// Feedback of the lifter claw, -1 where not fitted: limit switches pressed at the bottom and top of its travel
+/// (to ground, with a pull-up), and a potentiometer turned by it, with its analogRead() with the claw down and up.
+/// With them the arena missions stop the claw as soon as it is there instead of after a fixed time, and the
+/// power is cut if it stalls (see [LifterInterface]).
+const int lifterLowerLimitPin = -1, lifterUpperLimitPin = -1;
+const int lifterPotentiometerPin = -1;
+const int lifterPotentiometerDown = 0, lifterPotentiometerUp = 1023;
+
+/// Driving sessions in BLUETOOTH or HYBRID mode: 'M' records the speed, drive and lifter commands received until
+/// 'm', and 'Y' replays them with their timing; any drive command stops the replay. Kept in EEPROM (after the
+/// speed curves), about 250 commands and across power cycles, or else in RAM, about 30 commands.
+const bool sessionSpillToEeprom = true;
+
+/// HYBRID Control Mode: both controllers run, each submitting its wheel speeds to a [MotionArbiter]. Bluetooth
+/// (manual) commands override the autonomous controller and keep the wheels for [manualHoldMs] after the last
+/// one, then autonomy takes over again. Sending 'X' keeps manual control until 'x' is sent.
+const uint8_t autonomousPriority = 0, manualPriority = 1;
+const unsigned long manualHoldMs = 1500;
+
+/// Deadman of the Bluetooth controller: the Robot keeps moving while commands keep arriving and stops once the
+/// link has been silent for [commandTimeoutMs] (a held button repeats its command faster than that). The
+/// hardware watchdog resets the board if a loop() pass takes longer than [watchdogTimeoutMs] (15 ms to 8 s,
+/// rounded down to the AVR's steps). It is left off in TEST mode, whose tests wait with delay().
+const unsigned long commandTimeoutMs = 200;
+const unsigned long watchdogTimeoutMs = 250;
+
+/// Booleans to determine whether debug information should be printed. Bluetooth debug information is the binary
+/// telemetry stream (see utils/telemetry.hpp; src/tools/telemetry_to_csv.cpp decodes it), one record every
+/// [telemetrySamplePeriodMs], sent without holding up the controller. It needs a hardware UART
+/// ([bluetoothSerialPort] 1-3): SoftwareSerial sends each byte with interrupts off, about 1 ms at 9600 baud,
+/// and loses the commands arriving meanwhile.
+const bool printSerialDebug = false;
+const bool printBluetoothDebug = false;
+const unsigned long telemetrySamplePeriodMs = 50;
+static_assert(!printBluetoothDebug || bluetoothSerialPort != 0,
+  "printBluetoothDebug needs the HC05 on a hardware UART (bluetoothSerialPort 1-3)");
+
+/// The drive system: both drive motor drivers are [FastL298NInterface]s, so by default the drive is the
+/// [NDualWheelDrive] fixed to them, whose motor driver calls are direct. Building with
+/// -D RUNTIME_DRIVE_TOPOLOGY (see platformio.ini) selects the [NDualWheelDriveInterface] that any mix of motor
+/// drivers can be given, to compare the two.
+#ifdef RUNTIME_DRIVE_TOPOLOGY
+typedef MotorDriverInterface RobotDriveDriver;
+typedef NDualWheelDriveInterface RobotDrive;
+#else
+typedef FastL298NInterface RobotDriveDriver;
+typedef NDualWheelDrive<FastL298NInterface, 2> RobotDrive;
+#endif
+
+/// @return [size_t] bytes of the object graph setup() builds for [mode], with the settings above.
+constexpr size_t robotFootprint(ControlModes mode) {
+  return 2 * arenaFootprint<FastL298NInterface>()
+    + arenaFootprint<RobotDrive>()
+    + arenaFootprint<WheelEncodersInterface>(wheelEncodersFitted)
+    + arenaFootprint<SpeedCalibration>()
+    + arenaFootprint<CalibrationSweep>(calibrationSweepFitted && (mode == ControlModes::BLUETOOTH || mode == ControlModes::HYBRID))
+    + arenaFootprint<L298NInterface>()
+    + arenaFootprint<LifterInterface>()
+    + arenaFootprint<SoftwareSerialTransport>(bluetoothSerialPort == 0)
+    + arenaFootprint<HardwareSerialTransport>(bluetoothSerialPort != 0)
+    + arenaFootprint<BluetoothInterface>()
+    + arenaFootprint<LineSensorArrayInterface>(numberOfLineSensors > 0)
+    + arenaFootprint<DigitalLineSensorsInterface>(mode == ControlModes::AUTONOMOUS || mode == ControlModes::HYBRID)
+    + arenaFootprint<AutonomousController>(mode == ControlModes::AUTONOMOUS || mode == ControlModes::HYBRID)
+    + arenaFootprint<BluetoothController>(mode == ControlModes::BLUETOOTH || mode == ControlModes::HYBRID)
+    + arenaFootprint<MotionArbiter>(mode == ControlModes::HYBRID)
+    + 2 * arenaFootprint<ArbitratedDrive>(mode == ControlModes::HYBRID)
+    + arenaFootprint<SessionRecorder>(mode == ControlModes::BLUETOOTH || mode == ControlModes::HYBRID)
+    + arenaFootprint<SessionReplayer>(mode == ControlModes::BLUETOOTH || mode == ControlModes::HYBRID)
+    + arenaFootprint<Telemetry>(printBluetoothDebug && (mode == ControlModes::BLUETOOTH || mode == ControlModes::HYBRID))
+    + arenaFootprint<TestController>(mode == ControlModes::TEST);
+}
+
+#ifdef RAM_FOOTPRINT_REPORT
+/// Build-time report: every use prints a compiler warning naming a control mode and its arena size.
+template <ControlModes CONTROL_MODE, size_t ARENA_BYTES>
+__attribute__((deprecated("RAM footprint of the objects built by setup()"))) inline void ramFootprint() {}
+
+inline void reportRamFootprints() {
+  ramFootprint<ControlModes::AUTONOMOUS, robotFootprint(ControlModes::AUTONOMOUS)>();
+  ramFootprint<ControlModes::BLUETOOTH, robotFootprint(ControlModes::BLUETOOTH)>();
+  ramFootprint<ControlModes::HYBRID, robotFootprint(ControlModes::HYBRID)>();
+  ramFootprint<ControlModes::TEST, robotFootprint(ControlModes::TEST)>();
+}
+#endif
+
+/// Static storage of every interface and controller, sized at compile time for the selected Control Mode, so
+/// the robot makes no heap allocations. The HYBRID Control Mode builds the most objects, 18.
+StaticArena<robotFootprint(controlMode), 20> arena;
+
 // Define Controllers
 BluetoothController *bluetoothController;
 AutonomousController *autonomousController;
 TestController *testController;
 
-/// Booleans to determine whether debug information should be printed.
-const bool printSerialDebug = false;
-const bool printBluetoothDebug = false;
+// Define the cooperative Scheduler ticked by loop()
+TaskScheduler scheduler;
+
+void setup();
+
+/// Scheduled task acting using Autonomous Controller logic.
+void autonomousControllerTask(void *) {
+  // Validate if AutonomousController is set up.
+  if (autonomousController == NULL) {
+    hal::console().println("Autonomous+ Controller is NULL");
+    setup();
+    return;
+  }
+  autonomousController->step1(printSerialDebug);
+  // autonomousController->step2(printSerialDebug);
+}
+
+/// Scheduled task acting using Bluetooth Controller logic.
+void bluetoothControllerTask(void *) {
+  // Validate if BluetoothController is set up.
+  if (bluetoothController == NULL) {
+    hal::console().println("Bluetooth Controller is NULL");
+    setup();
+    return;
+  }
+  bluetoothController->step(printSerialDebug);
+}
+
+/// Scheduled task running Tests using Test Controller logic.
+void testControllerTask(void *) {
+  // Validate if TestController is set up.
+  if (testController == NULL) {
+    hal::console().println("Test Controller is NULL");
+    setup();
+    return;
+  }
+  testController->runTests(printSerialDebug);
+  // testController->motorsTest(255, printSerialDebug);
+  // testController->motorsTest(0, printSerialDebug);
+  //testController->motorsTest(125, printSerialDebug);
+  // testController->bluetoothTest(printSerialDebug);
+  // testController->lifterTest(printSerialDebug);
+}
+
+/// Scheduled task ramping the wheel speeds of the drive interface given as [context] towards their targets.
+void driveRampTask(void *context) {
+  static_cast<DualWheelDriveBase *>(context)->update();
+}
+
+/// Scheduled task stopping the claw of the [LifterInterface] given as [context] at its target, or when it stalls.
+void lifterTask(void *context) {
+  static_cast<LifterInterface *>(context)->update();
+}
+
+/// Scheduled task of the HYBRID Control Mode: the [MotionArbiter] given as [context] follows the manoeuvres of
+/// its channels, decides which of them drives and ramps the wheel speeds.
+void arbiterTask(void *context) {
+  static_cast<MotionArbiter *>(context)->update();
+}
+
+/// Builds the driving session of [controller], loading the one kept in EEPROM.
+void setupSession(BluetoothController *controller) {
+  SessionRecorder *recorder = arena.create<SessionRecorder>(sessionSpillToEeprom);
+  if (sessionSpillToEeprom && !recorder->load()) hal::console().println("No driving session stored");
+  controller->setSession(recorder, arena.create<SessionReplayer>(recorder));
+}
+
+#ifdef LATENCY_PROBES
+/// Scheduled task printing the latency summaries when 'P' is typed in the Serial Monitor.
+void latencyReportTask(void *) {
+  while (hal::console().available() > 0) {
+    if (hal::console().read() == 'P') printLatencyReport();
+  }
+}
+#endif
 
 void setup() {
-  Serial.begin(9600);
+  // After a watchdog reset the watchdog keeps running until its flag is cleared.
+  bool resetByWatchdog = hal::resetByWatchdog();
+  hal::watchdogDisable();
+  hal::console().begin(9600);
+  if (resetByWatchdog) hal::console().println("Reset by the watchdog: loop() hung");
+  scheduler.clear();
+  // Destroy the objects of an earlier setup(), so setting up again rebuilds them in the same storage.
+  hal::attachTickInterrupt(NULL, NULL);
+  arena.reset();
+  bluetoothController = NULL;
+  autonomousController = NULL;
+  testController = NULL;
+
   // Set up 4-wheel, 2 motor-driver drive interface
-  L298NInterface *frontL298N = new L298NInterface(2, 3, 4, 5, 6, 7);
-  L298NInterface *backL298N = new L298NInterface(14, 15, 16, 17, 18, 19);
-  MotorDriverInterface *motorDrivers[] = {frontL298N, backL298N};
-  NDualWheelDriveInterface *nDualWheelDrive = new NDualWheelDriveInterface(2, motorDrivers);
+  FastL298NInterface *frontL298N = arena.create<FastL298NInterface>(2, 3, 4, 5, frontEnableLeftPin, frontEnableRightPin,
+    drivePwmFrequencyHz);
+  FastL298NInterface *backL298N = arena.create<FastL298NInterface>(14, 15, 16, 17, backEnableLeftPin, backEnableRightPin,
+    drivePwmFrequencyHz);
+  // Linearise their speeds with the curves stored in EEPROM, if any (motors 0-1 front, 2-3 back)
+  SpeedCalibration *speedCalibration = arena.create<SpeedCalibration>();
+  if (!speedCalibration->load()) hal::console().println("Drive motors not calibrated");
+  frontL298N->setCalibration(speedCalibration, 0);
+  backL298N->setCalibration(speedCalibration, 2);
+  RobotDriveDriver *motorDrivers[] = {frontL298N, backL298N};
+#ifdef RUNTIME_DRIVE_TOPOLOGY
+  RobotDrive *nDualWheelDrive = arena.create<RobotDrive>(2, motorDrivers);
+#else
+  RobotDrive *nDualWheelDrive = arena.create<RobotDrive>(motorDrivers);
+#endif
+  nDualWheelDrive->setRamp(driveAcceleration, driveDeceleration);
+  if (wheelEncodersFitted) {
+    nDualWheelDrive->setEncoders(arena.create<WheelEncodersInterface>(leftEncoderPin, rightEncoderPin,
+      encoderCountsPerRevolution, wheelDiameterMm, wheelBaseMm));
+  }
 
   // Set up 1 motor-driver Lifter interface
-  L298NInterface *clawL298N = new L298NInterface(8, 9, 10, 11);
-  LifterInterface *lifter = new LifterInterface(clawL298N);
+  L298NInterface *clawL298N = arena.create<L298NInterface>(8, 9, 10, 11);
+  LifterInterface *lifter = arena.create<LifterInterface>(clawL298N);
+  lifter->setLimitSwitches(lifterLowerLimitPin, lifterUpperLimitPin);
+  lifter->setPotentiometer(lifterPotentiometerPin, lifterPotentiometerDown, lifterPotentiometerUp);
 
   // Set up Bluetooth communication interface
-  BluetoothInterface *bluetooth = new BluetoothInterface(53, 52);
-
-  // Setup based on Control Mode.
-  switch (controlMode) {
-    case ControlModes::AUTONOMOUS:
-      autonomousController = new AutonomousController(nDualWheelDrive, lifter, 12, 13);
-      delete bluetooth; // Bluetoooth not needed in Autonomouos Control Mode.
+  SerialTransport *bluetoothTransport;
+  switch (bluetoothSerialPort) {
+    case 1:
+      bluetoothTransport = arena.create<HardwareSerialTransport>(hal::serial1());
       break;
 
-    case ControlModes::BLUETOOTH:
-      bluetoothController = new BluetoothController(bluetooth, nDualWheelDrive, lifter);
+    case 2:
+      bluetoothTransport = arena.create<HardwareSerialTransport>(hal::serial2());
       break;
 
-    case ControlModes::HYBRID:
-      autonomousController = new AutonomousController(nDualWheelDrive, lifter, 13, 12);
-      bluetoothController = new BluetoothController(bluetooth, nDualWheelDrive, lifter);
+    case 3:
+      bluetoothTransport = arena.create<HardwareSerialTransport>(hal::serial3());
       break;
 
-    case ControlModes::TEST:
-      testController = new TestController(bluetooth, nDualWheelDrive);
+    default:
+      bluetoothTransport = arena.create<SoftwareSerialTransport>(53, 52, 9600);
       break;
   }
-}
+  BluetoothInterface *bluetooth = arena.create<BluetoothInterface>(bluetoothTransport);
 
-void loop() {
-  // Run based on Control Mode.
+  // Set up the analog IR line sensor array, if fitted
+  LineSensorArrayInterface *lineSensors = NULL;
+  if (numberOfLineSensors > 0) lineSensors = arena.create<LineSensorArrayInterface>(numberOfLineSensors, lineSensorPins);
+
+  // Set up the 2 digital IR sensors (left, right), sampled from the tick interrupt
+  DigitalLineSensorsInterface *irSensors = NULL;
+  if (controlMode == ControlModes::AUTONOMOUS || controlMode == ControlModes::HYBRID) {
+    const uint8_t irPins[] = {12, 13};
+    const uint8_t swappedIrPins[] = {13, 12};
+    irSensors = arena.create<DigitalLineSensorsInterface>(2, controlMode == ControlModes::HYBRID ? swappedIrPins : irPins,
+      irSamplePeriodTicks, irDebounceSamples);
+    hal::attachTickInterrupt(DigitalLineSensorsInterface::tickHandler, irSensors);
+  }
+
+  // Setup based on Control Mode.
+  MotionArbiter *arbiter = NULL;
   switch (controlMode) {
     case ControlModes::AUTONOMOUS:
-      // Validate if BluetoothController is set up.
-      if (autonomousController == NULL) {
-        Serial.println("Autonomous+ Controller is NULL");
-        setup();
-      }
-      // Act using Autonomous Controller logic.
-      autonomousController->step1(printSerialDebug);
-      // autonomousController->step2(printSerialDebug);
+      autonomousController = arena.create<AutonomousController>(nDualWheelDrive, lifter, irSensors);
+      autonomousController->setLineSensors(lineSensors);
+      // Bluetooth is only used to tune the line follower in Autonomous Control Mode.
+      autonomousController->setTuningLink(bluetooth);
+      scheduler.every(0, autonomousControllerTask);
       break;
 
     case ControlModes::BLUETOOTH:
-      // Validate if BluetoothController is set up.
-      if (bluetoothController == NULL) {
-        Serial.println("Bluetooth Controller is NULL");
-        setup();
+      bluetoothController = arena.create<BluetoothController>(bluetooth, nDualWheelDrive, lifter);
+      bluetoothController->setCommandTimeout(commandTimeoutMs);
+      if (calibrationSweepFitted) {
+        bluetoothController->setCalibrationSweep(arena.create<CalibrationSweep>(nDualWheelDrive,
+          nDualWheelDrive->getEncoders(), speedCalibration, nDualWheelDrive->getNumberOfMotorDrivers()));
+      }
+      setupSession(bluetoothController);
+      if (printBluetoothDebug) {
+        bluetoothController->setTelemetry(arena.create<Telemetry>(bluetooth, telemetrySamplePeriodMs));
       }
-      // Act using Bluetooth Controller logic.
-      bluetoothController->step(printSerialDebug, printBluetoothDebug);
+      scheduler.every(0, bluetoothControllerTask);
       break;
 
-    case ControlModes::HYBRID:
-      // Validate if BluetoothController is set up.
-      if (bluetoothController == NULL) {
-        Serial.println("Bluetooth Controller is NULL");
-        setup();
+    case ControlModes::HYBRID: {
+      // Each controller drives its own channel of the arbiter, which decides which of them reaches the wheels.
+      arbiter = arena.create<MotionArbiter>(nDualWheelDrive);
+      ArbitratedDrive *autonomousDrive = arena.create<ArbitratedDrive>(arbiter, autonomousPriority, 0);
+      ArbitratedDrive *manualDrive = arena.create<ArbitratedDrive>(arbiter, manualPriority, manualHoldMs);
+      autonomousDrive->setEncoders(nDualWheelDrive->getEncoders(), true);
+      autonomousController = arena.create<AutonomousController>(autonomousDrive, lifter, irSensors);
+      autonomousController->setLineSensors(lineSensors);
+      bluetoothController = arena.create<BluetoothController>(bluetooth, manualDrive, lifter);
+      bluetoothController->setArbiter(arbiter, manualDrive->getChannel());
+      bluetoothController->setCommandTimeout(commandTimeoutMs);
+      if (calibrationSweepFitted) {
+        // The sweep drives the manual channel, pinned by the override while it runs, and counts on the wheels.
+        bluetoothController->setCalibrationSweep(arena.create<CalibrationSweep>(manualDrive,
+          nDualWheelDrive->getEncoders(), speedCalibration, nDualWheelDrive->getNumberOfMotorDrivers()));
       }
-      // Act using Bluetooth Controller logic.
-      bluetoothController->step(printSerialDebug, printBluetoothDebug);
-      // Act using Autonomous Controller logic.
+      setupSession(bluetoothController);
+      if (printBluetoothDebug) {
+        bluetoothController->setTelemetry(arena.create<Telemetry>(bluetooth, telemetrySamplePeriodMs), irSensors);
+      }
+      scheduler.every(0, autonomousControllerTask);
+      scheduler.every(0, bluetoothControllerTask);
       break;
+    }
 
     case ControlModes::TEST:
-      // Validate if BluetoothController is set up.
-      if (testController == NULL) {
-        Serial.println("Test Controller is NULL");
-        setup();
-      }
-      // Run Tests using Test Controller logic.
-      testController->runTests(printSerialDebug);
-      // testController->motorsTest(255, printSerialDebug);
-      // testController->motorsTest(0, printSerialDebug);
-      //testController->motorsTest(125, printSerialDebug);
-      // testController->bluetoothTest(printSerialDebug);
-      // testController->lifterTest(printSerialDebug);
+      testController = arena.create<TestController>(bluetooth, nDualWheelDrive);
+      scheduler.every(0, testControllerTask);
       break;
+  }
+  if (arbiter != NULL) scheduler.every(DualWheelDriveBase::RAMP_PERIOD_MS, arbiterTask, arbiter);
+  else scheduler.every(DualWheelDriveBase::RAMP_PERIOD_MS, driveRampTask, nDualWheelDrive);
+  scheduler.every(LifterInterface::UPDATE_PERIOD_MS, lifterTask, lifter);
+#ifdef LATENCY_PROBES
+  resetLatencyHistograms();
+  scheduler.every(100, latencyReportTask);
+#endif
+  if (controlMode != ControlModes::TEST) hal::watchdogEnable(watchdogTimeoutMs);
+}
 
-    default:
-      Serial.println("Invalid Control Mode: " + String(controlMode));
+void loop() {
+  LATENCY_PROBE(LatencyStage::LOOP_PASS);
+  hal::watchdogReset();
+  // Run the tasks of the selected Control Mode. The controller tasks are non-blocking, so sensors are read
+  // and Bluetooth input is drained on every pass, even while a manoeuvre is in progress.
+  scheduler.tick();
+}
+
+#ifndef ARDUINO
+#include <chrono>
+#include <cstdlib>
+
+/// Host (native) entry point: runs the robot on the mock HAL in deterministic virtual time.
+/// Usage: `program [bluetoothCommands] [runTimeMs]`, e.g. `program FFFLLS 2000`. The commands are queued on the
+/// mocked HC05 serial port before the first loop(), and each loop() pass takes [loopPeriodUs] of virtual time.
+int main(int argc, char **argv) {
+  const unsigned long loopPeriodUs = 100;
+  const unsigned long runTimeMs = argc > 2 ? strtoul(argv[2], NULL, 10) : 5000;
+
+  // A watchdog reset runs setup() again, as on the robot.
+  hal::native::watchdog().handler = setup;
+  setup();
+  const uint8_t bluetoothRxPins[] = {53, 19, 17, 15};
+  hal::native::SerialPort *bluetoothSerial = hal::native::findSerial(bluetoothRxPins[bluetoothSerialPort]);
+  if (argc > 1 && bluetoothSerial != NULL) bluetoothSerial->inject(argv[1]);
+
+  unsigned long loops = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  while (hal::millis() < runTimeMs) {
+    loop();
+    hal::native::advanceMicros(loopPeriodUs);
+    loops++;
   }
-}
\ No newline at end of file
+  double hostNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+  printf("Ran %lu loop() passes in %lu ms of virtual time, %.1f ns of host time per pass.\n", loops, runTimeMs, hostNs / loops);
+  printf("Object arena: %lu of %lu bytes used.\n", (unsigned long) arena.getUsed(),
+    (unsigned long) arena.getCapacity());
+  printf("Drive pin duties (pin:duty):");
+  const int drivePins[] = {2, 3, 4, 5, frontEnableLeftPin, frontEnableRightPin, 14, 15, 16, 17, backEnableLeftPin,
+    backEnableRightPin};
+  for (unsigned int i = 0; i < sizeof(drivePins) / sizeof(drivePins[0]); i++)
+    printf(" %d:%d", drivePins[i], hal::native::outputDuty(drivePins[i]));
+  printf("\n");
+  if (hal::native::watchdog().bites > 0) printf("Watchdog resets: %lu.\n", hal::native::watchdog().bites);
+#ifdef LATENCY_PROBES
+  printLatencyReport();
+#endif
+  return 0;
+}
+#endif
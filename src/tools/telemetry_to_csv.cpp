@@ -0,0 +1,39 @@
+/// <summary>
+/// @file telemetry_to_csv.cpp
+/// @brief Host tool turning a capture of the robot's binary telemetry stream (see utils/telemetry.hpp) into CSV.
+/// Build with `pio run -e telemetry_to_csv`.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details Usage: `telemetry_to_csv [capture]`, reading standard input without [capture], e.g. a capture of
+/// the HC05's serial port saved by any terminal program. One CSV row per record is written to standard output,
+/// and a summary of the records decoded, corrupted, lost on the link and dropped on the robot to standard error.
+
+#include <cstdio>
+#include "../utils/telemetry.hpp"
+
+int main(int argc, char **argv) {
+    FILE *input = argc > 1 ? std::fopen(argv[1], "rb") : stdin;
+    if (input == NULL) {
+        std::fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    TelemetryDecoder decoder;
+    unsigned long dropped = 0;
+    std::printf("sequence,time_ms,left_speed,right_speed,sensors,loop_us,dropped\n");
+    int byte;
+    while ((byte = std::fgetc(input)) != EOF) {
+        if (!decoder.feed((uint8_t) byte)) continue;
+        const TelemetryRecord &record = decoder.getRecord();
+        std::printf("%u,%lu,%d,%d,%u,%u,%u\n", record.sequence, (unsigned long) record.timeMs, record.leftSpeed,
+            record.rightSpeed, record.sensors, record.loopUs, record.dropped);
+        dropped += record.dropped;
+    }
+    if (input != stdin) std::fclose(input);
+
+    std::fprintf(stderr, "%lu records, %lu corrupted frames, %lu lost on the link, %lu dropped on the robot\n",
+        decoder.getDecoded(), decoder.getCorrupted(), decoder.getLost(), dropped);
+    return 0;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// <summary>
+/// @file crc8.hpp
+/// @brief CRC-8 (polynomial 0x07, initial value 0x00, as CRC-8/SMBUS) used to check command frames.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details Computed a nibble at a time from a 16 entry table, which keeps the table out of the way of the
+/// Mega's small RAM while costing only two lookups per byte.
+
+/// @return [uint8_t] [crc] updated with one more [byte].
+inline uint8_t crc8Update(uint8_t crc, uint8_t byte) {
+    static const uint8_t NIBBLE_TABLE[16] = {
+        0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15, 0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D
+    };
+    crc ^= byte;
+    crc = (uint8_t) (crc << 4) ^ NIBBLE_TABLE[crc >> 4];
+    crc = (uint8_t) (crc << 4) ^ NIBBLE_TABLE[crc >> 4];
+    return crc;
+}
+
+/// @return [uint8_t] CRC-8 of [length] bytes of [data], continuing from [crc]. Default: a fresh CRC.
+inline uint8_t crc8(const uint8_t *data, size_t length, uint8_t crc = 0) {
+    for (size_t i = 0; i < length; i++) crc = crc8Update(crc, data[i]);
+    return crc;
+}
@@ -0,0 +1,329 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#endif
+
+/// <summary>
+/// @file fixed_point.hpp
+/// @brief This file contains the [Fixed] point number class template, with the [Q8_8] and [Q16_16] types.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details The Mega has no FPU, so every float operation is a soft-float library call of a hundred or more
+/// cycles. Fixed point numbers are plain integers with an implied binary point, so their arithmetic is the
+/// AVR's own integer arithmetic. All of it saturates: a result out of range is clamped to the largest or
+/// smallest value instead of wrapping around, so an overflow can never flip a wheel's direction.
+///
+/// Q16.16 multiplication and division are built from 16x16 bit multiplies and 32 bit shifts, so no 64 bit
+/// library routine (slow on AVR) is ever called.
+
+namespace fixed_point {
+
+/// Limits of the integer types a [Fixed] can be stored in.
+template <typename Storage>
+struct Limits;
+
+template <>
+struct Limits<int16_t> {
+    typedef uint16_t Unsigned;
+    static int16_t max() { return 32767; }
+    static int16_t min() { return -32767 - 1; }
+};
+
+template <>
+struct Limits<int32_t> {
+    typedef uint32_t Unsigned;
+    static int32_t max() { return 2147483647L; }
+    static int32_t min() { return -2147483647L - 1; }
+};
+
+/// @return [Storage] [value] clamped to the range of [Storage].
+template <typename Storage>
+inline Storage saturate(int32_t value) {
+    if (value > (int32_t) Limits<Storage>::max()) return Limits<Storage>::max();
+    if (value < (int32_t) Limits<Storage>::min()) return Limits<Storage>::min();
+    return (Storage) value;
+}
+
+/// @return [Storage] a magnitude and a sign as a [Storage], clamped to its range.
+template <typename Storage>
+inline Storage saturate(uint32_t magnitude, bool negative) {
+    if (negative) return magnitude >= (uint32_t) Limits<Storage>::max() + 1 ? Limits<Storage>::min() : -(Storage) magnitude;
+    return magnitude >= (uint32_t) Limits<Storage>::max() ? Limits<Storage>::max() : (Storage) magnitude;
+}
+
+/// @return [uint32_t] the magnitude of [value], exact even for the most negative value.
+inline uint32_t magnitude(int32_t value) {
+    return value < 0 ? 0u - (uint32_t) value : (uint32_t) value;
+}
+
+/// @return [int16_t] rounded Q(16-F).F product of two Q(16-F).F raw values, saturated.
+template <int FRACTION_BITS>
+inline int16_t multiply(int16_t a, int16_t b) {
+    int32_t product = (int32_t) a * b + ((int32_t) 1 << (FRACTION_BITS - 1));
+    return saturate<int16_t>(product >> FRACTION_BITS);
+}
+
+/// @return [int32_t] rounded Q(32-F).F product of two Q(32-F).F raw values, saturated.
+///
+/// @details The 64 bit product of the magnitudes is assembled as a high and a low 32 bit word from four 16x16
+/// bit multiplies, which the AVR's MUL instruction does in a few cycles each.
+template <int FRACTION_BITS>
+inline int32_t multiply(int32_t a, int32_t b) {
+    bool negative = (a < 0) != (b < 0);
+    uint32_t ua = magnitude(a), ub = magnitude(b);
+    uint32_t ah = ua >> 16, al = ua & 0xFFFF, bh = ub >> 16, bl = ub & 0xFFFF;
+    uint32_t hh = ah * bh, middle = al * bh, low = al * bl;
+    uint32_t other = ah * bl;
+    middle += other;
+    uint32_t high = hh + (middle >> 16) + (middle < other ? 0x10000UL : 0);
+    uint32_t lowSum = low + (middle << 16);
+    if (lowSum < low) high++;
+    // Round half away from zero
+    uint32_t rounded = lowSum + ((uint32_t) 1 << (FRACTION_BITS - 1));
+    if (rounded < lowSum) high++;
+    if (high >> FRACTION_BITS) return negative ? Limits<int32_t>::min() : Limits<int32_t>::max();
+    uint32_t result = (high << (32 - FRACTION_BITS)) | (rounded >> FRACTION_BITS);
+    return saturate<int32_t>(result, negative);
+}
+
+/// @return [Storage] rounded quotient of two Q.F raw values, saturated. Division by zero saturates to the
+/// largest magnitude of the dividend's sign (0 for 0 / 0).
+///
+/// @details Integer part by one division of the storage width (16 bit for Q8.8, which is several times
+/// cheaper than a 32 bit one on AVR), then the fraction bits by shift and subtract.
+template <typename Storage, int FRACTION_BITS>
+inline Storage divide(Storage a, Storage b) {
+    typedef typename Limits<Storage>::Unsigned Unsigned;
+    const int INTEGER_BITS = (int) sizeof(Storage) * 8 - 1 - FRACTION_BITS;
+    bool negative = (a < 0) != (b < 0);
+    Unsigned ua = (Unsigned) magnitude(a), ub = (Unsigned) magnitude(b);
+    if (ub == 0) return a == 0 ? 0 : (a < 0 ? Limits<Storage>::min() : Limits<Storage>::max());
+    Unsigned quotient = ua / ub, remainder = ua % ub;
+    if (quotient >> INTEGER_BITS) return negative ? Limits<Storage>::min() : Limits<Storage>::max();
+    for (int i = 0; i <= FRACTION_BITS; i++) {
+        // One extra bit, for rounding. remainder < ub <= 2^(bits - 1), so neither can overflow.
+        remainder <<= 1;
+        quotient <<= 1;
+        if (remainder >= ub) {
+            remainder -= ub;
+            quotient |= 1;
+        }
+    }
+    return saturate<Storage>((uint32_t) (quotient >> 1) + (quotient & 1), negative);
+}
+
+/// Quarter wave of sin() in 1/32768, at 64 steps of a quarter turn and its end, interpolated linearly.
+#ifdef __AVR__
+static const uint16_t SINE_TABLE[65] PROGMEM = {
+#else
+static const uint16_t SINE_TABLE[65] = {
+#endif
+        0,   804,  1608,  2411,  3212,  4011,  4808,  5602,  6393,  7180,  7962,  8740,  9512, 10279, 11039, 11793,
+    12540, 13279, 14010, 14733, 15447, 16151, 16846, 17531, 18205, 18868, 19520, 20160, 20788, 21403, 22006, 22595,
+    23170, 23732, 24279, 24812, 25330, 25833, 26320, 26791, 27246, 27684, 28106, 28511, 28899, 29269, 29622, 29957,
+    30274, 30572, 30853, 31114, 31357, 31581, 31786, 31972, 32138, 32286, 32413, 32522, 32610, 32679, 32729, 32758,
+    32768
+};
+
+inline uint16_t sineTableEntry(uint8_t index) {
+#ifdef __AVR__
+    return pgm_read_word(&SINE_TABLE[index]);
+#else
+    return SINE_TABLE[index];
+#endif
+}
+
+/// @return [int32_t] sin() of a [BinaryAngle] in 1/65536 (Q16.16), from the table.
+inline int32_t sineQ16(uint16_t angle) {
+    uint16_t quarterAngle = angle & 0x3FFF;
+    // Second and fourth quarters run the table backwards
+    if (angle & 0x4000) quarterAngle = 0x4000 - quarterAngle;
+    uint8_t index = quarterAngle >> 8;
+    uint16_t weight = quarterAngle & 0xFF;
+    uint32_t value = sineTableEntry(index);
+    if (weight) value += ((uint32_t) (sineTableEntry(index + 1) - value) * weight + 128) >> 8;
+    int32_t sine = (int32_t) (value << 1);
+    return angle & 0x8000 ? -sine : sine;
+}
+
+}
+
+/// Angle in 1/65536 of a full turn, which wraps around for free in 16 bit arithmetic.
+typedef uint16_t BinaryAngle;
+
+/// @return [BinaryAngle] the angle of [degrees], rounded.
+inline BinaryAngle degreesToBinaryAngle(long degrees) {
+    degrees %= 360;
+    if (degrees < 0) degrees += 360;
+    return (BinaryAngle) ((degrees * 65536L + 180) / 360);
+}
+
+/// @class Fixed
+/// @brief Signed, saturating fixed point number of [FRACTION_BITS] fraction bits stored in a [Storage] integer.
+///
+/// @details Use the [Q8_8] and [Q16_16] types. A value is made with [fromInt], [fromRatio] or [fromPwm]
+/// (or [fromFloat] for constants and host code), and read back with [toInt] or [toPwm]. The raw integer is
+/// available through [fromRaw] and [raw], e.g. to send it over the command protocol.
+template <typename Storage, int FRACTION_BITS>
+class Fixed {
+public:
+    /// Raw value of 1.0.
+    static const Storage ONE = (Storage) 1 << FRACTION_BITS;
+
+private:
+    Storage value;
+
+    typedef fixed_point::Limits<Storage> Limits;
+
+public:
+    /// @brief Constuctor initializing the [Fixed] to 0.
+    Fixed() : value(0) {}
+
+    /// @return [Fixed] with the raw integer [raw], in 1/2^FRACTION_BITS.
+    static Fixed fromRaw(Storage raw) {
+        Fixed result;
+        result.value = raw;
+        return result;
+    }
+
+    /// @return [Fixed] of the integer [integer], saturated.
+    static Fixed fromInt(long integer) {
+        if (integer > (long) (Limits::max() >> FRACTION_BITS)) return fromRaw(Limits::max());
+        if (integer < (long) (Limits::min() >> FRACTION_BITS)) return fromRaw(Limits::min());
+        return fromRaw((Storage) ((Storage) integer * ONE));
+    }
+
+    /// @return [Fixed] of [numerator] / [denominator], rounded and saturated.
+    static Fixed fromRatio(long numerator, long denominator) {
+        return fromInt(numerator) / fromInt(denominator);
+    }
+
+    /// @return [Fixed] of [value], rounded and saturated. Soft-float on AVR: meant for constants and host code.
+    static Fixed fromFloat(double value) {
+        double raw = value * ONE + (value < 0 ? -0.5 : 0.5);
+        if (raw >= (double) Limits::max()) return fromRaw(Limits::max());
+        if (raw <= (double) Limits::min()) return fromRaw(Limits::min());
+        return fromRaw((Storage) raw);
+    }
+
+    /// @return [Fixed] fraction of full speed of a signed PWM [speed]. Range: -255-255, clamped, to -1.0-1.0.
+    static Fixed fromPwm(int speed) {
+        speed = speed > 255 ? 255 : (speed < -255 ? -255 : speed);
+        // Rounded division by 255 without a division, exact over the whole range
+        uint32_t scaled = (uint32_t) (speed < 0 ? -speed : speed) * ONE + 127;
+        Storage raw = (Storage) ((scaled + 1 + (scaled >> 8) + (scaled >> 16)) >> 8);
+        return fromRaw(speed < 0 ? (Storage) -raw : raw);
+    }
+
+    /// @return [Fixed] the largest value.
+    static Fixed max() { return fromRaw(Limits::max()); }
+
+    /// @return [Fixed] the smallest (most negative) value.
+    static Fixed min() { return fromRaw(Limits::min()); }
+
+    /// @return [Fixed] a value of another [Fixed] type, rounded and saturated.
+    template <typename OtherStorage, int OTHER_FRACTION_BITS>
+    static Fixed from(Fixed<OtherStorage, OTHER_FRACTION_BITS> other) {
+        int32_t raw = other.raw();
+        if (OTHER_FRACTION_BITS > FRACTION_BITS) {
+            const int shift = OTHER_FRACTION_BITS > FRACTION_BITS ? OTHER_FRACTION_BITS - FRACTION_BITS : 0;
+            uint32_t shifted = (fixed_point::magnitude(raw) + ((uint32_t) 1 << shift >> 1)) >> shift;
+            return fromRaw(fixed_point::saturate<Storage>(shifted, raw < 0));
+        }
+        const int shift = FRACTION_BITS > OTHER_FRACTION_BITS ? FRACTION_BITS - OTHER_FRACTION_BITS : 0;
+        if (raw > (Limits::max() >> shift)) return fromRaw(Limits::max());
+        if (raw < (Limits::min() >> shift)) return fromRaw(Limits::min());
+        return fromRaw((Storage) (raw * ((int32_t) 1 << shift)));
+    }
+
+    /// @return [Storage] the raw integer, in 1/2^FRACTION_BITS.
+    Storage raw() const { return value; }
+
+    /// @return [long] the value rounded to the nearest integer, halves away from zero.
+    long toInt() const {
+        uint32_t rounded = (fixed_point::magnitude(value) + (ONE >> 1)) >> FRACTION_BITS;
+        return value < 0 ? -(long) rounded : (long) rounded;
+    }
+
+    /// @return [float] the value. Soft-float on AVR: meant for host code and debug output.
+    float toFloat() const { return (float) value / ONE; }
+
+    /// @return [int] the value as a signed PWM speed, with 1.0 as full speed. Range: -255-255, clamped.
+    int toPwm() const {
+        if (value >= ONE) return 255;
+        if (value <= -ONE) return -255;
+        int32_t speed = ((int32_t) fixed_point::magnitude(value) * 255 + (ONE >> 1)) >> FRACTION_BITS;
+        return value < 0 ? -(int) speed : (int) speed;
+    }
+
+    /// @return [Fixed] the magnitude, saturated (the most negative value has no positive counterpart).
+    Fixed abs() const { return value < 0 ? -*this : *this; }
+
+    Fixed operator-() const {
+        return fromRaw(value == Limits::min() ? Limits::max() : (Storage) -value);
+    }
+
+    Fixed operator+(Fixed other) const {
+        Storage sum = (Storage) ((typename Limits::Unsigned) value + (typename Limits::Unsigned) other.value);
+        // Overflow happened if both operands share a sign the sum does not have
+        if (((value ^ sum) & (other.value ^ sum)) < 0) return fromRaw(value < 0 ? Limits::min() : Limits::max());
+        return fromRaw(sum);
+    }
+
+    Fixed operator-(Fixed other) const {
+        Storage difference = (Storage) ((typename Limits::Unsigned) value - (typename Limits::Unsigned) other.value);
+        // Overflow happened if the operands differ in sign and the difference has the subtrahend's sign
+        if (((value ^ other.value) & (value ^ difference)) < 0) return fromRaw(value < 0 ? Limits::min() : Limits::max());
+        return fromRaw(difference);
+    }
+
+    Fixed operator*(Fixed other) const {
+        return fromRaw(fixed_point::multiply<FRACTION_BITS>(value, other.value));
+    }
+
+    Fixed operator/(Fixed other) const {
+        return fromRaw(fixed_point::divide<Storage, FRACTION_BITS>(value, other.value));
+    }
+
+    Fixed &operator+=(Fixed other) { return *this = *this + other; }
+
+    Fixed &operator-=(Fixed other) { return *this = *this - other; }
+
+    Fixed &operator*=(Fixed other) { return *this = *this * other; }
+
+    Fixed &operator/=(Fixed other) { return *this = *this / other; }
+
+    bool operator==(Fixed other) const { return value == other.value; }
+
+    bool operator!=(Fixed other) const { return value != other.value; }
+
+    bool operator<(Fixed other) const { return value < other.value; }
+
+    bool operator<=(Fixed other) const { return value <= other.value; }
+
+    bool operator>(Fixed other) const { return value > other.value; }
+
+    bool operator>=(Fixed other) const { return value >= other.value; }
+};
+
+/// 8 integer bits (sign included) and 8 fraction bits: -128 to 127.996 in steps of 1/256. Wheel speeds are
+/// fractions of full speed in this type.
+typedef Fixed<int16_t, 8> Q8_8;
+
+/// 16 integer bits (sign included) and 16 fraction bits: -32768 to 32767.99998 in steps of 1/65536.
+typedef Fixed<int32_t, 16> Q16_16;
+
+/// @return [Q16_16] sin() of [angle], with an error below 1/10000.
+inline Q16_16 fixedSin(BinaryAngle angle) {
+    return Q16_16::fromRaw(fixed_point::sineQ16(angle));
+}
+
+/// @return [Q16_16] cos() of [angle], with an error below 1/10000.
+inline Q16_16 fixedCos(BinaryAngle angle) {
+    return Q16_16::fromRaw(fixed_point::sineQ16((BinaryAngle) (angle + 0x4000)));
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include "../interfaces/hal/hal.hpp"
+#include "../interfaces/status_codes.hpp"
+
+/// <summary>
+/// @file latency_probe.hpp
+/// @brief This file contains the micros() based latency probes and their fixed-bucket histograms.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details A probe is placed at the top of a block with LATENCY_PROBE(stage) and records the time the block
+/// took into the histogram of that [LatencyStage] when it leaves scope. The probes only exist when the build
+/// defines LATENCY_PROBES (e.g. `build_flags = -D LATENCY_PROBES`); otherwise LATENCY_PROBE expands to nothing
+/// and no histogram memory is reserved.
+
+/// The parts of a loop() pass that are timed.
+enum LatencyStage : uint8_t {
+    LOOP_PASS,
+    BLUETOOTH_RECEIVE,
+    COMMAND_EXECUTE,
+    MOTOR_OUTPUT,
+    LINE_FOLLOWER,
+    STATUS_REPORT,
+    MOTION_ARBITER,
+    NUMBER_OF_LATENCY_STAGES
+};
+
+/// @return [const char*] the name of a [LatencyStage], as printed in latency reports.
+inline const char *latencyStageText(uint8_t stage) {
+    switch (stage) {
+        case LatencyStage::LOOP_PASS: return "loop";
+        case LatencyStage::BLUETOOTH_RECEIVE: return "bluetooth_receive";
+        case LatencyStage::COMMAND_EXECUTE: return "command_execute";
+        case LatencyStage::MOTOR_OUTPUT: return "motor_output";
+        case LatencyStage::LINE_FOLLOWER: return "line_follower";
+        case LatencyStage::STATUS_REPORT: return "status_report";
+        case LatencyStage::MOTION_ARBITER: return "motion_arbiter";
+    }
+    return "unknown";
+}
+
+/// Size of a buffer that fits one line written by [formatLatencySummary].
+static const int LATENCY_SUMMARY_SIZE = 96;
+
+#ifdef LATENCY_PROBES
+
+/// @class LatencyHistogram
+/// @brief Histogram of durations in microseconds, in [NUMBER_OF_BUCKETS] power-of-two buckets.
+///
+/// @details Bucket 0 counts durations below 2 us and bucket i those from 2^i to 2^(i+1) - 1 us; the last bucket
+/// also takes everything longer. Percentiles are therefore reported as the upper bound of their bucket.
+class LatencyHistogram {
+public:
+    static const int NUMBER_OF_BUCKETS = 16;
+
+private:
+    /// Saturating counts of each bucket.
+    uint16_t buckets[NUMBER_OF_BUCKETS];
+
+    unsigned long count;
+
+    unsigned long minimumUs, maximumUs;
+
+public:
+    /// @brief Constuctor initializing an empty [LatencyHistogram].
+    /// @return [LatencyHistogram] object
+    LatencyHistogram() {
+        reset();
+    }
+
+    /// @brief Forgets every recorded duration.
+    void reset() {
+        for (int i = 0; i < NUMBER_OF_BUCKETS; i++) buckets[i] = 0;
+        count = 0;
+        minimumUs = 0;
+        maximumUs = 0;
+    }
+
+    /// @brief Records one duration.
+    /// @param durationUs Duration in microseconds.
+    void record(unsigned long durationUs) {
+        int bucket = 0;
+        while (bucket < NUMBER_OF_BUCKETS - 1 && (durationUs >> bucket) > 1) bucket++;
+        if (buckets[bucket] < 0xFFFF) buckets[bucket]++;
+        if (count == 0 || durationUs < minimumUs) minimumUs = durationUs;
+        if (durationUs > maximumUs) maximumUs = durationUs;
+        count++;
+    }
+
+    /// @return [unsigned long] number of durations recorded.
+    unsigned long getCount() const {
+        return count;
+    }
+
+    /// @return [unsigned long] shortest duration recorded in microseconds, 0 if there is none.
+    unsigned long getMinimum() const {
+        return minimumUs;
+    }
+
+    /// @return [unsigned long] longest duration recorded in microseconds, 0 if there is none.
+    unsigned long getMaximum() const {
+        return maximumUs;
+    }
+
+    /// @param percent Percentile wanted. Range: 0-100.
+    /// @return [unsigned long] duration in microseconds that [percent] % of the recorded durations do not exceed,
+    /// rounded up to the upper bound of its bucket (and capped at the maximum). 0 if nothing is recorded.
+    unsigned long getPercentile(uint8_t percent) const {
+        unsigned long total = 0;
+        for (int i = 0; i < NUMBER_OF_BUCKETS; i++) total += buckets[i];
+        if (total == 0) return 0;
+        unsigned long wanted = (total * percent + 99) / 100;
+        if (wanted == 0) wanted = 1;
+        unsigned long seen = 0;
+        for (int i = 0; i < NUMBER_OF_BUCKETS - 1; i++) {
+            seen += buckets[i];
+            if (seen >= wanted) {
+                unsigned long upperBound = (2UL << i) - 1;
+                return upperBound < maximumUs ? upperBound : maximumUs;
+            }
+        }
+        return maximumUs;
+    }
+};
+
+/// @return [LatencyHistogram*] the histograms of every [LatencyStage], in static memory.
+inline LatencyHistogram *latencyHistograms() {
+    static LatencyHistogram histograms[LatencyStage::NUMBER_OF_LATENCY_STAGES];
+    return histograms;
+}
+
+/// @class LatencyProbe
+/// @brief Times the scope it lives in and records the duration in the histogram of its [LatencyStage].
+class LatencyProbe {
+private:
+    uint8_t stage;
+
+    unsigned long startUs;
+
+public:
+    /// @brief Constuctor starting the [LatencyProbe].
+    /// @param stage [LatencyStage] the time is recorded for.
+    /// @return [LatencyProbe] object
+    LatencyProbe(LatencyStage stage) {
+        this->stage = stage;
+        startUs = hal::micros();
+    }
+
+    ~LatencyProbe() {
+        latencyHistograms()[stage].record(hal::micros() - startUs);
+    }
+};
+
+/// Times the rest of the enclosing block as [stage]. At most one per block.
+#define LATENCY_PROBE(stage) LatencyProbe latencyProbe(stage)
+
+/// @brief Forgets the durations recorded for every stage.
+inline void resetLatencyHistograms() {
+    for (int i = 0; i < LatencyStage::NUMBER_OF_LATENCY_STAGES; i++) latencyHistograms()[i].reset();
+}
+
+/// @brief Writes the summary of one stage, e.g. "loop: n=812 min=4 p50=7 p90=15 p99=31 max=40 us".
+/// @param stage [LatencyStage] to summarise.
+/// @param buffer Caller-supplied buffer the text is written into. [LATENCY_SUMMARY_SIZE] bytes always fit.
+/// @param size Size of [buffer] in bytes. The text is truncated to fit.
+/// @return [size_t] length of the text written.
+inline size_t formatLatencySummary(uint8_t stage, char *buffer, size_t size) {
+    const LatencyHistogram &histogram = latencyHistograms()[stage];
+    StatusWriter writer(buffer, size);
+    writer.append(latencyStageText(stage)).append(": n=").append(histogram.getCount())
+        .append(" min=").append(histogram.getMinimum())
+        .append(" p50=").append(histogram.getPercentile(50))
+        .append(" p90=").append(histogram.getPercentile(90))
+        .append(" p99=").append(histogram.getPercentile(99))
+        .append(" max=").append(histogram.getMaximum()).append(" us");
+    return writer.getLength();
+}
+
+#else
+
+#define LATENCY_PROBE(stage)
+
+inline void resetLatencyHistograms() {}
+
+inline size_t formatLatencySummary(uint8_t stage, char *buffer, size_t size) {
+    StatusWriter writer(buffer, size);
+    writer.append(latencyStageText(stage)).append(": latency probes disabled");
+    return writer.getLength();
+}
+
+#endif
+
+/// @brief Prints the summary of every stage on the Serial Monitor.
+inline void printLatencyReport() {
+    char summary[LATENCY_SUMMARY_SIZE];
+    for (int i = 0; i < LatencyStage::NUMBER_OF_LATENCY_STAGES; i++) {
+        formatLatencySummary(i, summary, sizeof(summary));
+        hal::console().println(summary);
+    }
+}
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../interfaces/hal/hal.hpp"
+#include "crc8.hpp"
+#include "ring_buffer.hpp"
+
+/// <summary>
+/// @file mission.hpp
+/// @brief This file contains the mission bytecode run by the [AutonomousController]: the [MissionOpcode]s, the
+/// [Mission] view of a program in RAM, flash or EEPROM, and the [MissionStore] missions are uploaded into.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details A mission is a sequence of 4 byte instructions:
+///
+///     OPCODE | ARGUMENT | VALUE (int16, low byte first)
+///
+/// Actions (following the line, driving, lifting) start at once and keep going; waits hold the mission until
+/// their condition is met, while the action started last (e.g. following the line) goes on. A mission ends
+/// at [MISSION_END] or after its last instruction, which stop the robot.
+///
+/// Missions built into the firmware are byte tables declared PROGMEM, written with [MISSION_VALUE]:
+///
+///     const uint8_t SQUARE[] PROGMEM = {
+///         MISSION_DRIVE_DISTANCE, 200, MISSION_VALUE(500), MISSION_WAIT_MANOEUVRE, 0, MISSION_VALUE(2000),
+///         MISSION_TURN_ANGLE, 185, MISSION_VALUE(90), MISSION_WAIT_MANOEUVRE, 0, MISSION_VALUE(1200), ...
+///     };
+
+/// The bytes of a signed 16-bit instruction value, low byte first.
+#define MISSION_VALUE(value) (uint8_t) ((value) & 0xFF), (uint8_t) (((value) >> 8) & 0xFF)
+
+/// Operations of a mission instruction, with the meaning of their ARGUMENT and VALUE.
+enum MissionOpcode : uint8_t {
+    /// Stops the wheels and the lifter and ends the mission.
+    MISSION_END = 0x00,
+    /// Follows the line until another action. Argument: speed (0-255). Value: [MissionFollower]. The PID
+    /// follower is used instead when a line sensor array is attached.
+    MISSION_FOLLOW_LINE = 0x01,
+    /// Stops following the line, leaving the wheels on their last command.
+    MISSION_HOLD = 0x02,
+    /// Drives straight. Value: signed speed (-255-255), negative to reverse.
+    MISSION_DRIVE = 0x03,
+    /// Turns on the spot. Value: signed speed (-255-255), positive to the left.
+    MISSION_SPIN = 0x04,
+    /// Drives straight for a distance measured by the wheel encoders, or at the speed until the next
+    /// [MISSION_WAIT_MANOEUVRE] is up without them. Argument: speed (0-255). Value: millimetres, negative to reverse.
+    MISSION_DRIVE_DISTANCE = 0x05,
+    /// Turns on the spot by an angle measured by the wheel encoders, or at the speed until the next
+    /// [MISSION_WAIT_MANOEUVRE] is up without them. Argument: speed (0-255). Value: degrees, positive to the left.
+    MISSION_TURN_ANGLE = 0x06,
+    /// Stops the wheels (ramped down while ramping).
+    MISSION_STOP = 0x07,
+    /// Moves the lifter. Value: 1 up, -1 down, 0 stop.
+    MISSION_LIFT = 0x08,
+    /// Waits. Value: milliseconds, unsigned (0-65535).
+    MISSION_WAIT = 0x09,
+    /// Waits until an IR sensor sees the line, or the floor. Argument: sensor (0 left, 1 right). Value: 1 for
+    /// white, 0 for black.
+    MISSION_WAIT_LINE = 0x0A,
+    /// Waits for the last [MISSION_DRIVE_DISTANCE] or [MISSION_TURN_ANGLE]. Value: milliseconds it lasts when
+    /// timed (no encoders), unsigned. Measured by the encoders, it times out after twice that.
+    MISSION_WAIT_MANOEUVRE = 0x0B,
+    /// Moves the lifter to a position measured by its limit switches or potentiometer, or towards the nearer
+    /// end until the next [MISSION_WAIT_LIFT] is up without them. Argument: speed (0-255). Value: thousandths
+    /// of the travel, 0 down to 1000 up.
+    MISSION_LIFT_TO = 0x0C,
+    /// Waits for the last [MISSION_LIFT_TO], then stops the lifter. Value: milliseconds it lasts when timed (no
+    /// feedback), unsigned. Measured, it ends as soon as the lifter is there or stalls, or after twice that.
+    MISSION_WAIT_LIFT = 0x0D
+};
+
+/// Line followers of [MISSION_FOLLOW_LINE] on the two digital IR sensors.
+enum MissionFollower : uint8_t {
+    /// [AutonomousController::lineFollow], turning on the spot.
+    FOLLOW_ON_SPOT = 0,
+    /// [AutonomousController::lineFollowSmooth], turning with one side stopped.
+    FOLLOW_SMOOTH = 1
+};
+
+/// One decoded mission instruction.
+struct MissionInstruction {
+    static const uint8_t SIZE = 4;
+
+    uint8_t opcode;
+    uint8_t argument;
+    int16_t value;
+};
+
+/// @class Mission
+/// @brief Read-only view of a mission program, wherever it is stored.
+///
+/// @details Holds only the address and length: instructions are read one at a time when they run, so a
+/// mission in flash or EEPROM takes no RAM.
+class Mission {
+public:
+    /// Memory a [Mission] is read from.
+    enum Storage : uint8_t {
+        IN_RAM,
+        IN_FLASH,
+        IN_EEPROM
+    };
+
+private:
+    Storage storage;
+
+    const uint8_t *bytes;
+
+    int eepromAddress;
+
+    int numberOfInstructions;
+
+    uint8_t readByte(int offset) const {
+        switch (storage) {
+            case Storage::IN_FLASH: return hal::readProgramByte(bytes + offset);
+            case Storage::IN_EEPROM: return hal::eepromRead(eepromAddress + offset);
+            default: return bytes[offset];
+        }
+    }
+
+public:
+    /// @brief Constuctor initializing an empty [Mission], which ends at once.
+    /// @return [Mission] object
+    Mission() {
+        storage = Storage::IN_RAM;
+        bytes = NULL;
+        eepromAddress = 0;
+        numberOfInstructions = 0;
+    }
+
+    /// @return [Mission] over [size] bytes of a table in RAM.
+    static Mission inRam(const uint8_t *bytes, size_t size) {
+        Mission mission;
+        mission.bytes = bytes;
+        mission.numberOfInstructions = (int) (size / MissionInstruction::SIZE);
+        return mission;
+    }
+
+    /// @return [Mission] over [size] bytes of a table declared PROGMEM.
+    static Mission inFlash(const uint8_t *bytes, size_t size) {
+        Mission mission = inRam(bytes, size);
+        mission.storage = Storage::IN_FLASH;
+        return mission;
+    }
+
+    /// @return [Mission] over [numberOfInstructions] instructions in EEPROM from [address].
+    static Mission inEeprom(int address, int numberOfInstructions) {
+        Mission mission;
+        mission.storage = Storage::IN_EEPROM;
+        mission.eepromAddress = address;
+        mission.numberOfInstructions = numberOfInstructions;
+        return mission;
+    }
+
+    /// @return [bool] true if the mission is read from EEPROM, which an upload overwrites.
+    bool isInEeprom() const {
+        return storage == Storage::IN_EEPROM;
+    }
+
+    /// @return [int] number of instructions.
+    int getNumberOfInstructions() const {
+        return numberOfInstructions;
+    }
+
+    /// @return [MissionInstruction] instruction [index], [MISSION_END] past the last one.
+    MissionInstruction read(int index) const {
+        MissionInstruction instruction = {MissionOpcode::MISSION_END, 0, 0};
+        if (index < 0 || index >= numberOfInstructions) return instruction;
+        int offset = index * MissionInstruction::SIZE;
+        instruction.opcode = readByte(offset);
+        instruction.argument = readByte(offset + 1);
+        instruction.value = (int16_t) (readByte(offset + 2) | (readByte(offset + 3) << 8));
+        return instruction;
+    }
+};
+
+/// @class MissionStore
+/// @brief The mission uploaded over Bluetooth, kept in EEPROM across power cycles.
+///
+/// @details Layout from [EEPROM_ADDRESS]: the number of instructions, the CRC-8 of the instructions, then the
+/// instructions. An upload [begin]s, [append]s instructions and [commit]s. Appended instructions only go into a
+/// [WRITE_QUEUE_SIZE] byte queue in RAM; [update] moves it into EEPROM a byte at a time, whenever the EEPROM has
+/// finished its previous write (about 3.3 ms each), so an upload never holds the loop. [commit] is given the
+/// number of instructions and their CRC as the sender computed them, and refuses an upload that lost or
+/// corrupted an instruction on the way. The header is written last, once everything else is: a mission cut off
+/// mid-upload, refused or corrupted fails its CRC and [load] gives the empty mission instead.
+class MissionStore {
+public:
+    static const int EEPROM_ADDRESS = 0;
+
+    static const int MAX_NUMBER_OF_INSTRUCTIONS = 64;
+
+    /// EEPROM bytes used, from [EEPROM_ADDRESS].
+    static const int EEPROM_BYTES = 2 + MAX_NUMBER_OF_INSTRUCTIONS * MissionInstruction::SIZE;
+
+    /// Instruction bytes appended and not yet written to EEPROM, at most.
+    static const uint8_t WRITE_QUEUE_SIZE = 128;
+
+private:
+    RingBuffer<uint8_t, WRITE_QUEUE_SIZE> writeQueue;
+
+    /// Instructions appended, and bytes of them written to EEPROM.
+    int numberOfInstructions, written;
+
+    uint8_t crc;
+
+    bool uploading;
+
+    /// Whether the stored mission's length must still be invalidated, at the start of an upload.
+    bool invalidatePending;
+
+    /// Header bytes still to write once the instructions are, 0 for none.
+    uint8_t headerPending;
+
+public:
+    /// @brief Constuctor initializing the [MissionStore] Class.
+    /// @return [MissionStore] object
+    MissionStore() {
+        numberOfInstructions = written = 0;
+        crc = 0;
+        uploading = false;
+        invalidatePending = false;
+        headerPending = 0;
+    }
+
+    /// @brief Starts an upload, invalidating the stored mission until [commit].
+    void begin() {
+        writeQueue.clear();
+        numberOfInstructions = written = 0;
+        crc = 0;
+        uploading = true;
+        invalidatePending = true;
+        headerPending = 0;
+    }
+
+    /// @return [bool] true if the write queue has room for another instruction.
+    bool canAppend() const {
+        return writeQueue.available() >= MissionInstruction::SIZE;
+    }
+
+    /// @brief Appends the 4 bytes of an instruction to the upload. Non-blocking, see [update].
+    /// @return [bool] false if no upload was begun, the mission is full or the write queue is (see [canAppend]).
+    bool append(const uint8_t instruction[MissionInstruction::SIZE]) {
+        if (!uploading || numberOfInstructions >= MAX_NUMBER_OF_INSTRUCTIONS || !canAppend()) return false;
+        for (int i = 0; i < MissionInstruction::SIZE; i++) writeQueue.push(instruction[i]);
+        crc = crc8(instruction, MissionInstruction::SIZE, crc);
+        numberOfInstructions++;
+        return true;
+    }
+
+    /// @brief Completes the upload, making it the stored mission once [update] has written it.
+    /// @param expectedInstructions Number of instructions the sender uploaded.
+    /// @param expectedCrc CRC-8 of their bytes, computed by the sender.
+    /// @return [bool] false if no upload was begun, or the instructions appended are not the ones sent: the
+    /// upload is then dropped and no mission is stored.
+    bool commit(int expectedInstructions, uint8_t expectedCrc) {
+        if (!uploading) return false;
+        uploading = false;
+        if (expectedInstructions != numberOfInstructions || expectedCrc != crc) {
+            writeQueue.clear();
+            return false;
+        }
+        headerPending = 2;
+        return true;
+    }
+
+    /// @brief Writes the next byte of the upload to EEPROM, if the EEPROM is ready for it. Non-blocking; call
+    /// every loop pass.
+    void update() {
+        if (!isWriting() || !hal::eepromReady()) return;
+        uint8_t byte;
+        if (invalidatePending) {
+            invalidatePending = false;
+            hal::eepromWrite(EEPROM_ADDRESS, 0xFF);
+        } else if (writeQueue.pop(byte)) {
+            hal::eepromWrite(EEPROM_ADDRESS + 2 + written++, byte);
+        } else if (headerPending == 2) {
+            headerPending--;
+            hal::eepromWrite(EEPROM_ADDRESS + 1, crc);
+        } else if (headerPending == 1) {
+            headerPending--;
+            hal::eepromWrite(EEPROM_ADDRESS, (uint8_t) numberOfInstructions);
+        }
+    }
+
+    /// @return [bool] true while bytes of an upload are still to be written to EEPROM by [update].
+    bool isWriting() const {
+        return invalidatePending || !writeQueue.isEmpty() || headerPending > 0;
+    }
+
+    /// @return [Mission] stored in EEPROM, or the empty mission if there is none or it fails its CRC.
+    Mission load() const {
+        int length = hal::eepromRead(EEPROM_ADDRESS);
+        if (length > MAX_NUMBER_OF_INSTRUCTIONS) return Mission();
+        uint8_t check = 0;
+        for (int i = 0; i < length * MissionInstruction::SIZE; i++) {
+            check = crc8Update(check, hal::eepromRead(EEPROM_ADDRESS + 2 + i));
+        }
+        if (check != hal::eepromRead(EEPROM_ADDRESS + 1)) return Mission();
+        return Mission::inEeprom(EEPROM_ADDRESS + 2, length);
+    }
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <stdint.h>
+#include "fixed_point.hpp"
+
+/// <summary>
+/// @file odometry.hpp
+/// @brief This file contains the [Odometry] class, dead reckoning of the robot's pose from wheel encoder counts.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+
+/// @class Odometry
+/// @brief Integer dead reckoning of a differential drive: position in millimetres and heading, from the counts
+/// of an encoder on each side.
+///
+/// @details A count is one encoder edge of one wheel. Every [advance] moves the position by the distance of
+/// the centre of the axle along the heading halfway through the step, with [Q16_16] millimetres and the table
+/// based [fixedCos]/[fixedSin], and turns the heading, kept in 1/2^32 of a turn so that it wraps on its own.
+/// The counts driven and turned are also summed without any rounding, for manoeuvres measured in counts
+/// ([countsForDistance], [countsForAngle]), which need no trigonometry at all.
+///
+/// The wheel base should be the effective one, found by turning the robot on the spot: a 4-wheel skid-steer
+/// robot turns less per count than its track width suggests, as its tyres slip sideways.
+class Odometry {
+private:
+    int countsPerRevolution, wheelDiameterMm, wheelBaseMm;
+
+    /// Distance of the centre of the axle per count of one wheel, in millimetres.
+    Q16_16 mmPerHalfCount;
+
+    /// Heading change per count of difference between the wheels, in 1/2^32 of a turn.
+    uint32_t headingPerCount;
+
+    Q16_16 x, y;
+
+    uint32_t heading;
+
+    long distanceCounts, rotationCounts;
+
+public:
+    /// @brief Constuctor initializing the [Odometry] at the origin, heading along x.
+    /// @param countsPerRevolution Encoder counts per turn of a wheel.
+    /// @param wheelDiameterMm Diameter of the wheels in millimetres.
+    /// @param wheelBaseMm Effective distance between the left and right wheels in millimetres.
+    /// @return [Odometry] object
+    Odometry(int countsPerRevolution, int wheelDiameterMm, int wheelBaseMm) {
+        this->countsPerRevolution = countsPerRevolution > 0 ? countsPerRevolution : 1;
+        this->wheelDiameterMm = wheelDiameterMm > 0 ? wheelDiameterMm : 1;
+        this->wheelBaseMm = wheelBaseMm > 0 ? wheelBaseMm : 1;
+        // pi * D / (2 N), with pi as 355 / 113
+        mmPerHalfCount = Q16_16::fromRatio(355L * this->wheelDiameterMm, 226L * this->countsPerRevolution);
+        // D / (2 B N) turns, in 1/2^32 of a turn: the pi of the wheel circumference cancels out
+        headingPerCount = (uint32_t) (((uint64_t) this->wheelDiameterMm << 31)
+            / ((uint32_t) this->wheelBaseMm * (uint32_t) this->countsPerRevolution));
+        reset();
+    }
+
+    /// @brief Puts the robot at a pose and clears the counts driven and turned.
+    /// @param xMm Position along x in millimetres.
+    /// @param yMm Position along y in millimetres.
+    /// @param heading Heading, anticlockwise from x.
+    void reset(int xMm = 0, int yMm = 0, BinaryAngle heading = 0) {
+        x = Q16_16::fromInt(xMm);
+        y = Q16_16::fromInt(yMm);
+        this->heading = (uint32_t) heading << 16;
+        distanceCounts = 0;
+        rotationCounts = 0;
+    }
+
+    /// @brief Moves the pose by the counts of the left and right wheels since the last call, negative for reverse.
+    void advance(int leftCounts, int rightCounts) {
+        distanceCounts += (long) leftCounts + rightCounts;
+        rotationCounts += (long) rightCounts - leftCounts;
+        uint32_t turn = (uint32_t) ((int32_t) rightCounts - leftCounts) * headingPerCount;
+        BinaryAngle middle = (BinaryAngle) ((heading + (uint32_t) ((int32_t) turn >> 1)) >> 16);
+        heading += turn;
+        Q16_16 centre = mmPerHalfCount * Q16_16::fromInt((long) leftCounts + rightCounts);
+        x += centre * fixedCos(middle);
+        y += centre * fixedSin(middle);
+    }
+
+    /// @return [Q16_16] position along x in millimetres.
+    Q16_16 getX() const {
+        return x;
+    }
+
+    /// @return [Q16_16] position along y in millimetres.
+    Q16_16 getY() const {
+        return y;
+    }
+
+    /// @return [BinaryAngle] heading, anticlockwise from x.
+    BinaryAngle getHeading() const {
+        return (BinaryAngle) (heading >> 16);
+    }
+
+    /// @return [long] sum of the counts of both wheels since [reset]: twice the counts the centre drove.
+    long getDistanceCounts() const {
+        return distanceCounts;
+    }
+
+    /// @return [long] counts of the right wheel minus those of the left since [reset], positive turning left.
+    long getRotationCounts() const {
+        return rotationCounts;
+    }
+
+    /// @return [long] [getDistanceCounts] change of a drive of [distanceMm] millimetres, rounded.
+    long countsForDistance(long distanceMm) const {
+        long numerator = 2 * 113L * countsPerRevolution * distanceMm, denominator = 355L * wheelDiameterMm;
+        return (numerator + (numerator < 0 ? -denominator : denominator) / 2) / denominator;
+    }
+
+    /// @return [long] [getRotationCounts] change of a turn of [degrees] on the spot, positive to the left, rounded.
+    long countsForAngle(long degrees) const {
+        long numerator = 2L * wheelBaseMm * countsPerRevolution * degrees, denominator = 360L * wheelDiameterMm;
+        return (numerator + (numerator < 0 ? -denominator : denominator) / 2) / denominator;
+    }
+};
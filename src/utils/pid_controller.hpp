@@ -0,0 +1,115 @@
+#pragma once
+
+#include <stdint.h>
+
+/// <summary>
+/// @file pid_controller.hpp
+/// @brief This file contains the [PIDController] class.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+
+/// @class PIDController
+/// @brief Integer PID controller, meant to be updated at a fixed period.
+///
+/// @details Gains are integers in units of 1 / 2^[GAIN_SHIFT], so that they can be tuned finely without floating
+/// point: a proportional gain of 256 outputs the error unchanged. The integral is clamped so that its term alone
+/// can never exceed the output limit (anti-windup), and the derivative is taken on the change of error between
+/// two updates.
+class PIDController {
+public:
+    /// Gains are in units of 1 / 2^GAIN_SHIFT.
+    static const int GAIN_SHIFT = 8;
+
+    /// The gains of the controller, as addressed by [setGain].
+    enum Gain : uint8_t {
+        PROPORTIONAL,
+        INTEGRAL,
+        DERIVATIVE
+    };
+
+private:
+    int gains[3];
+
+    int outputLimit;
+
+    long integral;
+
+    long integralLimit;
+
+    int previousError;
+
+    bool hasPreviousError;
+
+    /// Recomputes the integral clamp after a gain or limit change.
+    void updateIntegralLimit() {
+        integralLimit = gains[Gain::INTEGRAL] > 0 ? ((long) outputLimit << GAIN_SHIFT) / gains[Gain::INTEGRAL] : 0;
+        if (integral > integralLimit) integral = integralLimit;
+        if (integral < -integralLimit) integral = -integralLimit;
+    }
+
+public:
+    /// @brief Constuctor initializing the [PIDController] Class.
+    /// @param proportionalGain Proportional gain, in 1/256.
+    /// @param integralGain Integral gain per update, in 1/256.
+    /// @param derivativeGain Derivative gain per update, in 1/256.
+    /// @param outputLimit Largest magnitude of the output.
+    /// @return [PIDController] object
+    PIDController(int proportionalGain, int integralGain, int derivativeGain, int outputLimit) {
+        gains[Gain::PROPORTIONAL] = proportionalGain;
+        gains[Gain::INTEGRAL] = integralGain;
+        gains[Gain::DERIVATIVE] = derivativeGain;
+        this->outputLimit = outputLimit;
+        integral = 0;
+        reset();
+    }
+
+    /// @brief Clears the integral and the remembered error, e.g. when the controller is (re)engaged.
+    void reset() {
+        integral = 0;
+        previousError = 0;
+        hasPreviousError = false;
+        updateIntegralLimit();
+    }
+
+    /// @brief Changes one gain at runtime.
+    /// @param gain [Gain] to change. Unknown gains are ignored.
+    /// @param value New value of the gain, in 1/256. Negative values are taken as 0.
+    void setGain(uint8_t gain, int value) {
+        if (gain > Gain::DERIVATIVE) return;
+        gains[gain] = value < 0 ? 0 : value;
+        updateIntegralLimit();
+    }
+
+    /// @param gain [Gain] wanted.
+    /// @return [int] value of the gain in 1/256, 0 for unknown gains.
+    int getGain(uint8_t gain) const {
+        return gain <= Gain::DERIVATIVE ? gains[gain] : 0;
+    }
+
+    /// @brief Changes the largest magnitude of the output.
+    void setOutputLimit(int outputLimit) {
+        this->outputLimit = outputLimit;
+        updateIntegralLimit();
+    }
+
+    /// @brief Runs one update of the controller.
+    /// @param error Setpoint minus measurement (or the measured deviation itself).
+    /// @return [int] output of the controller. Range: -outputLimit-outputLimit
+    int update(int error) {
+        integral += error;
+        if (integral > integralLimit) integral = integralLimit;
+        if (integral < -integralLimit) integral = -integralLimit;
+        long derivative = hasPreviousError ? (long) error - previousError : 0;
+        previousError = error;
+        hasPreviousError = true;
+
+        long output = (long) gains[Gain::PROPORTIONAL] * error
+            + (long) gains[Gain::INTEGRAL] * integral
+            + (long) gains[Gain::DERIVATIVE] * derivative;
+        output >>= GAIN_SHIFT;
+        if (output > outputLimit) return outputLimit;
+        if (output < -outputLimit) return -outputLimit;
+        return (int) output;
+    }
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdint.h>
+
+/// <summary>
+/// @file ring_buffer.hpp
+/// @brief This file contains the [RingBuffer] class template.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+
+/// @class RingBuffer
+/// @brief Fixed-capacity FIFO queue in static memory.
+///
+/// @details [CAPACITY] must be a power of two (at most 128) so that wrapping is a bit mask. The indices are
+/// free-running bytes, so one producer and one consumer (e.g. an ISR and loop()) can share a buffer without
+/// locks as long as each only moves its own index.
+template <typename T, uint8_t CAPACITY>
+class RingBuffer {
+    static_assert(CAPACITY > 0 && CAPACITY <= 128 && (CAPACITY & (CAPACITY - 1)) == 0,
+        "RingBuffer CAPACITY must be a power of two, at most 128");
+
+private:
+    T items[CAPACITY];
+
+    volatile uint8_t head;
+
+    volatile uint8_t tail;
+
+public:
+    /// @brief Constuctor initializing an empty [RingBuffer].
+    /// @return [RingBuffer] object
+    RingBuffer() {
+        head = 0;
+        tail = 0;
+    }
+
+    /// @return [uint8_t] number of items queued.
+    uint8_t size() const {
+        return (uint8_t) (head - tail);
+    }
+
+    /// @return [uint8_t] number of items that can still be pushed.
+    uint8_t available() const {
+        return CAPACITY - size();
+    }
+
+    bool isEmpty() const {
+        return head == tail;
+    }
+
+    bool isFull() const {
+        return size() == CAPACITY;
+    }
+
+    /// @brief Queues [item] at the back.
+    /// @return [bool] false (and nothing queued) if the buffer is full.
+    bool push(const T &item) {
+        if (isFull()) return false;
+        items[head & (CAPACITY - 1)] = item;
+        head = head + 1;
+        return true;
+    }
+
+    /// @brief Removes the item at the front into [item].
+    /// @return [bool] false (and [item] untouched) if the buffer is empty.
+    bool pop(T &item) {
+        if (isEmpty()) return false;
+        item = items[tail & (CAPACITY - 1)];
+        tail = tail + 1;
+        return true;
+    }
+
+    /// @brief Copies the item at the front into [item] without removing it.
+    /// @return [bool] false if the buffer is empty.
+    bool peek(T &item) const {
+        if (isEmpty()) return false;
+        item = items[tail & (CAPACITY - 1)];
+        return true;
+    }
+
+    /// @return [T] the item [index] places behind the front, without removing it. [index] must be below [size].
+    const T &at(uint8_t index) const {
+        return items[(uint8_t) (tail + index) & (CAPACITY - 1)];
+    }
+
+    /// @brief Drops all queued items.
+    void clear() {
+        tail = head;
+    }
+};
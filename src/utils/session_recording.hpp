@@ -0,0 +1,296 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../interfaces/hal/hal.hpp"
+#include "../interfaces/command_protocol.hpp"
+#include "crc8.hpp"
+#include "ring_buffer.hpp"
+#include "speed_calibration.hpp"
+
+/// <summary>
+/// @file session_recording.hpp
+/// @brief This file contains the [SessionRecorder], which records the driving commands of a Bluetooth session
+/// with their timing, and the [SessionReplayer] that plays them back.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details A session is a sequence of records, each the time since the previous one and a [Command]:
+///
+///     DELTA (ms, 7 bits a byte, low first, top bit set on all but the last byte) | OPCODE [PAYLOAD]
+///
+/// A command repeated by a held button takes 2 bytes, a joystick frame 4. The session ends with a
+/// [CommandOpcode::NO_COMMAND] record at the time recording stopped, so a replay lasts as long as the recording.
+
+/// @class SessionRecorder
+/// @brief Records the driving commands executed by the [BluetoothController] into a ring buffer, optionally
+/// spilling it to EEPROM.
+///
+/// @details [record] only encodes the command into the RAM ring buffer (a few bytes and their CRC-8), so it
+/// takes a few microseconds and never waits. Without spill the session is what the [BUFFER_SIZE] byte buffer
+/// holds. With spill, [update] moves the buffer into EEPROM a byte at a time, whenever the EEPROM has finished
+/// its previous write (about 3.3 ms each), so a session can fill the EEPROM area of [EEPROM_BYTES] and is kept
+/// across power cycles. Recording stops by itself when the space runs out.
+///
+/// EEPROM layout from [EEPROM_ADDRESS], after the [SpeedCalibration]: the CRC-8 of the records, their length
+/// (low byte first), then the records. [start] invalidates the length first and it is written last, once the
+/// buffer has been spilled, so [load] rejects a session cut off by a reset, or corrupted.
+class SessionRecorder {
+public:
+    static const uint8_t BUFFER_SIZE = 128;
+
+    static const int EEPROM_ADDRESS = SpeedCalibration::EEPROM_ADDRESS + SpeedCalibration::EEPROM_BYTES;
+
+    /// EEPROM bytes used, from [EEPROM_ADDRESS].
+    static const int EEPROM_BYTES = 1024;
+
+    /// Largest record: 3 bytes of time (up to [MAX_DELTA_MS]), the opcode and the largest payload.
+    static const int MAX_RECORD_SIZE = 3 + 1 + Command::MAX_PAYLOAD;
+
+    static const unsigned long MAX_DELTA_MS = (1UL << 21) - 1;
+
+private:
+    static const int HEADER_SIZE = 3;
+
+    /// Room kept for the closing [CommandOpcode::NO_COMMAND] record.
+    static const int END_RECORD_SIZE = 4;
+
+    RingBuffer<uint8_t, BUFFER_SIZE> buffer;
+
+    bool spillToEeprom;
+
+    bool recording;
+
+    /// Whether the last recording stopped because the space ran out.
+    bool full;
+
+    /// Bytes of the session, and those of them already moved to EEPROM.
+    uint16_t length, spilled;
+
+    uint8_t crc;
+
+    /// Header bytes still to write once the buffer is spilled, 0 for none.
+    uint8_t headerPending;
+
+    unsigned long lastMs;
+
+    /// @return [int] bytes a session can take.
+    int capacity() const {
+        return spillToEeprom ? EEPROM_BYTES - HEADER_SIZE : BUFFER_SIZE;
+    }
+
+    void put(uint8_t byte) {
+        buffer.push(byte);
+        crc = crc8Update(crc, byte);
+        length++;
+    }
+
+    /// @brief Appends the record of [opcode] and its [payload], timed now.
+    /// @return [bool] false, appending nothing, if it would not leave room for the closing record.
+    bool append(uint8_t opcode, const uint8_t *payload, int payloadLength, int reserve) {
+        unsigned long nowMs = hal::millis();
+        unsigned long deltaMs = nowMs - lastMs;
+        if (deltaMs > MAX_DELTA_MS) deltaMs = MAX_DELTA_MS;
+        int size = (deltaMs < (1UL << 7) ? 1 : (deltaMs < (1UL << 14) ? 2 : 3)) + 1 + payloadLength;
+        if (length + size + reserve > capacity() || size + reserve > buffer.available()) return false;
+        lastMs = nowMs;
+        while (deltaMs >= 0x80) {
+            put((uint8_t) (deltaMs | 0x80));
+            deltaMs >>= 7;
+        }
+        put((uint8_t) deltaMs);
+        put(opcode);
+        for (int i = 0; i < payloadLength; i++) put(payload[i]);
+        return true;
+    }
+
+    /// @brief Closes the session with its [CommandOpcode::NO_COMMAND] record.
+    void finish() {
+        append(CommandOpcode::NO_COMMAND, NULL, 0, 0);
+        recording = false;
+        if (spillToEeprom) headerPending = HEADER_SIZE;
+    }
+
+public:
+    /// @brief Constuctor initializing an empty [SessionRecorder].
+    /// @param spillToEeprom true to keep sessions in EEPROM, longer and across power cycles.
+    /// @return [SessionRecorder] object
+    explicit SessionRecorder(bool spillToEeprom) {
+        this->spillToEeprom = spillToEeprom;
+        recording = false;
+        full = false;
+        length = spilled = 0;
+        crc = 0;
+        headerPending = 0;
+        lastMs = 0;
+    }
+
+    /// @return [bool] true for the commands a session records: speeds, drive and lifter commands.
+    static bool isRecorded(uint8_t opcode) {
+        return (opcode >= CommandOpcode::DRIVE_STOP && opcode <= CommandOpcode::LIFTER_STOP)
+            || opcode == CommandOpcode::DRIVE_ARCADE || opcode == CommandOpcode::DRIVE_TANK;
+    }
+
+    /// @brief Starts a new session, dropping the last one.
+    void start() {
+        if (spillToEeprom) hal::eepromWrite(EEPROM_ADDRESS + 2, 0xFF);
+        buffer.clear();
+        length = spilled = 0;
+        crc = 0;
+        headerPending = 0;
+        full = false;
+        lastMs = hal::millis();
+        recording = true;
+    }
+
+    /// @brief Records [command] if it is one a session keeps (see [isRecorded]). Takes a few microseconds.
+    void record(const Command &command) {
+        if (!recording || !isRecorded(command.opcode)) return;
+        if (!append(command.opcode, command.payload, commandPayloadLength(command.opcode), END_RECORD_SIZE)) {
+            full = true;
+            finish();
+        }
+    }
+
+    /// @brief Ends the session. With spill, it is stored once [update] has moved the rest of it to EEPROM.
+    void stop() {
+        if (recording) finish();
+    }
+
+    /// @brief Moves a byte of the session to EEPROM, or writes a byte of its header once all are, if the
+    /// EEPROM is ready for it. Non-blocking; call every loop pass.
+    void update() {
+        if (!spillToEeprom || !hal::eepromReady()) return;
+        uint8_t byte;
+        if (buffer.pop(byte)) {
+            hal::eepromWrite(EEPROM_ADDRESS + HEADER_SIZE + spilled, byte);
+            spilled++;
+        } else if (headerPending > 0) {
+            headerPending--;
+            uint8_t header[HEADER_SIZE] = {crc, (uint8_t) length, (uint8_t) (length >> 8)};
+            hal::eepromWrite(EEPROM_ADDRESS + HEADER_SIZE - 1 - headerPending, header[HEADER_SIZE - 1 - headerPending]);
+        }
+    }
+
+    /// @brief Reads the session stored in EEPROM, e.g. at boot.
+    /// @return [bool] false if spill is off, or no session is stored or it fails its CRC.
+    bool load() {
+        recording = false;
+        buffer.clear();
+        headerPending = 0;
+        length = spilled = 0;
+        if (!spillToEeprom) return false;
+        int stored = hal::eepromRead(EEPROM_ADDRESS + 1) | (hal::eepromRead(EEPROM_ADDRESS + 2) << 8);
+        if (stored > capacity()) return false;
+        uint8_t check = 0;
+        for (int i = 0; i < stored; i++) check = crc8Update(check, hal::eepromRead(EEPROM_ADDRESS + HEADER_SIZE + i));
+        if (check != hal::eepromRead(EEPROM_ADDRESS)) return false;
+        crc = check;
+        length = spilled = (uint16_t) stored;
+        return true;
+    }
+
+    /// @return [uint8_t] byte [offset] of the session, from EEPROM or from the buffer not spilled yet.
+    uint8_t readByte(int offset) const {
+        if (offset < spilled) return hal::eepromRead(EEPROM_ADDRESS + HEADER_SIZE + offset);
+        return buffer.at((uint8_t) (offset - spilled));
+    }
+
+    /// @return [int] bytes of the session.
+    int getLength() const {
+        return length;
+    }
+
+    bool isRecording() const {
+        return recording;
+    }
+
+    /// @return [bool] true if the last session stopped because the space ran out.
+    bool isFull() const {
+        return full;
+    }
+
+    /// @return [bool] true once the session is complete in EEPROM, so it survives a reset.
+    bool isStored() const {
+        return spillToEeprom && !recording && length > 0 && spilled == length && headerPending == 0;
+    }
+};
+
+
+/// @class SessionReplayer
+/// @brief Plays the session of a [SessionRecorder] back with its timing, a due command at a time.
+///
+/// @details Each command is due at its time since the start of the recording, counted from [start], so the
+/// timing does not drift over a long session: a command runs on the first loop pass after it is due.
+/// Non-blocking: [next] returns the commands due, which the caller executes as it would received ones.
+class SessionReplayer {
+private:
+    const SessionRecorder *session;
+
+    bool replaying;
+
+    /// Offset of the opcode of the next record, and when it is due, in milliseconds after [startMs].
+    int offset;
+
+    unsigned long dueMs, startMs;
+
+    /// @brief Reads the time of the record at [offset] into [dueMs], leaving [offset] at its opcode.
+    void readDelta() {
+        unsigned long deltaMs = 0;
+        for (int shift = 0; shift < 21 && offset < session->getLength(); shift += 7) {
+            uint8_t byte = session->readByte(offset++);
+            deltaMs |= (unsigned long) (byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) break;
+        }
+        dueMs += deltaMs;
+    }
+
+public:
+    /// @brief Constuctor initializing the [SessionReplayer] of [session].
+    /// @return [SessionReplayer] object
+    explicit SessionReplayer(const SessionRecorder *session) {
+        this->session = session;
+        replaying = false;
+        offset = 0;
+        dueMs = startMs = 0;
+    }
+
+    /// @brief Starts the replay: its first command is due at once. Non-blocking, see [next].
+    /// @return [bool] false if there is no session, or it is still being recorded.
+    bool start() {
+        if (session->isRecording() || session->getLength() == 0) return false;
+        offset = 0;
+        dueMs = 0;
+        readDelta();
+        startMs = hal::millis();
+        replaying = true;
+        return true;
+    }
+
+    /// @brief Ends the replay.
+    void stop() {
+        replaying = false;
+    }
+
+    /// @brief Takes the next command of the replay if it is due.
+    /// @param command [Command] filled in.
+    /// @return [bool] false if none is due yet, or the replay has ended (see [isReplaying]).
+    bool next(Command &command) {
+        if (!replaying || hal::millis() - startMs < dueMs) return false;
+        command.opcode = offset < session->getLength() ? session->readByte(offset++) : (uint8_t) CommandOpcode::NO_COMMAND;
+        int payloadLength = commandPayloadLength(command.opcode);
+        if (command.opcode == CommandOpcode::NO_COMMAND || payloadLength < 0 || offset + payloadLength > session->getLength()) {
+            replaying = false;
+            return false;
+        }
+        for (int i = 0; i < payloadLength; i++) command.payload[i] = session->readByte(offset++);
+        readDelta();
+        return true;
+    }
+
+    /// @return [bool] true until the replay has reached the end of the session, or was stopped.
+    bool isReplaying() const {
+        return replaying;
+    }
+};
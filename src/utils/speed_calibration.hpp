@@ -0,0 +1,190 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../interfaces/hal/hal.hpp"
+#include "crc8.hpp"
+#include "mission.hpp"
+
+/// <summary>
+/// @file speed_calibration.hpp
+/// @brief This file contains the [SpeedCurve] linearising a motor's response to PWM, and the [SpeedCalibration]
+/// holding the curves of the robot's motors and keeping them in EEPROM.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details No two DC motors turn at the same speed for the same duty: each has its own dead band, gain and
+/// curve, so a straight [DualWheelDriveBase::forward] drifts to the weaker side. A [SpeedCurve] maps the speed
+/// asked for (0-255) to the duty that makes a motor turn at that fraction of the common full speed, so every
+/// motor responds alike and linearly. The motor drivers apply it on their speed path (see
+/// [MotorDriverInterface::setCalibration]); [CalibrationSweep] measures the curves.
+
+/// @class SpeedCurve
+/// @brief Piecewise linear map of a motor from the speed asked for to the PWM duty written.
+///
+/// @details The duty is kept at [NUMBER_OF_KNOTS] speeds, every [KNOT_SPACING] from 0 (the last knot is the duty
+/// of full speed, 255), 17 bytes where a full table would take 256. [apply] interpolates between the two knots
+/// around a speed: a shift, a mask and one multiplication, the same cost for every speed.
+class SpeedCurve {
+public:
+    static const int NUMBER_OF_KNOTS = 17;
+
+    static const int KNOT_SPACING = 16;
+
+    /// Duty written at speeds 0, 16, ... 240 and 255. The first is the duty the motor starts turning at.
+    uint8_t knots[NUMBER_OF_KNOTS];
+
+    /// @brief Constuctor initializing the identity [SpeedCurve].
+    /// @return [SpeedCurve] object
+    SpeedCurve() {
+        for (int i = 0; i < NUMBER_OF_KNOTS - 1; i++) knots[i] = (uint8_t) (i * KNOT_SPACING);
+        knots[NUMBER_OF_KNOTS - 1] = 255;
+    }
+
+    /// @return [int] the duty to write for [speed]. 0 stays 0, so a stopped motor is never driven.
+    /// @param speed Speed asked for. Range: 0-255
+    int apply(int speed) const {
+        if (speed <= 0) return 0;
+        if (speed >= 255) return knots[NUMBER_OF_KNOTS - 1];
+        int low = knots[speed >> 4], high = knots[(speed >> 4) + 1];
+        return low + (high - low) * (speed & (KNOT_SPACING - 1)) / KNOT_SPACING;
+    }
+};
+
+
+/// @class SpeedCalibration
+/// @brief The [SpeedCurve]s of the robot's motors, loaded from EEPROM at boot and saved there after a sweep.
+///
+/// @details Motors are numbered along the drivers: the left and right motor of the first driver are 0 and 1,
+/// those of the next 2 and 3, and so on. Motors without a curve, and all of them while the calibration is
+/// disabled (during a sweep), are written the speed asked for.
+///
+/// EEPROM layout from [EEPROM_ADDRESS], after the [MissionStore]: the number of curves, the CRC-8 of that number
+/// and the knots, then the knots of each curve. [save] writes the count last, so a save cut off midway, or
+/// corrupted tables, fail the CRC and [load] leaves the motors uncalibrated instead of applying them.
+class SpeedCalibration {
+public:
+    static const int MAX_NUMBER_OF_MOTORS = 4;
+
+    static const int EEPROM_ADDRESS = MissionStore::EEPROM_ADDRESS + MissionStore::EEPROM_BYTES;
+
+    /// EEPROM bytes used, from [EEPROM_ADDRESS].
+    static const int EEPROM_BYTES = 2 + MAX_NUMBER_OF_MOTORS * SpeedCurve::NUMBER_OF_KNOTS;
+
+private:
+    SpeedCurve curves[MAX_NUMBER_OF_MOTORS];
+
+    int numberOfCurves;
+
+    bool enabled;
+
+    /// Next byte [saveStep] writes, -1 when no save is in progress.
+    int saveOffset;
+
+    /// @return [uint8_t] CRC-8 of the curve count and the knots of the first [count] curves.
+    uint8_t checksum(int count) const {
+        uint8_t crc = crc8Update(0, (uint8_t) count);
+        for (int i = 0; i < count; i++) crc = crc8(curves[i].knots, SpeedCurve::NUMBER_OF_KNOTS, crc);
+        return crc;
+    }
+
+    /// @brief Writes the next byte of the save, waiting for the EEPROM if it is busy.
+    /// @return [bool] true once the save is complete.
+    bool writeNext() {
+        int knotBytes = numberOfCurves * SpeedCurve::NUMBER_OF_KNOTS;
+        if (saveOffset < knotBytes) {
+            const SpeedCurve &curve = curves[saveOffset / SpeedCurve::NUMBER_OF_KNOTS];
+            hal::eepromWrite(EEPROM_ADDRESS + 2 + saveOffset, curve.knots[saveOffset % SpeedCurve::NUMBER_OF_KNOTS]);
+        } else if (saveOffset == knotBytes) {
+            hal::eepromWrite(EEPROM_ADDRESS + 1, checksum(numberOfCurves));
+        } else {
+            hal::eepromWrite(EEPROM_ADDRESS, (uint8_t) numberOfCurves);
+            saveOffset = -1;
+            return true;
+        }
+        saveOffset++;
+        return false;
+    }
+
+public:
+    /// @brief Constuctor initializing an uncalibrated [SpeedCalibration].
+    /// @return [SpeedCalibration] object
+    SpeedCalibration() {
+        numberOfCurves = 0;
+        enabled = true;
+        saveOffset = -1;
+    }
+
+    /// @return [int] the duty to write for [speed] on [motor]. O(1), see [SpeedCurve::apply].
+    int apply(int motor, int speed) const {
+        if (!enabled || motor >= numberOfCurves) return speed;
+        return curves[motor].apply(speed);
+    }
+
+    /// @return [SpeedCurve&] the curve of [motor], to be filled in; [setNumberOfCurves] puts it to use.
+    SpeedCurve &getCurve(int motor) {
+        return curves[motor];
+    }
+
+    /// @brief Applies the curves of motors 0 to [count] - 1; the others are uncalibrated.
+    void setNumberOfCurves(int count) {
+        numberOfCurves = count < 0 ? 0 : (count > MAX_NUMBER_OF_MOTORS ? MAX_NUMBER_OF_MOTORS : count);
+    }
+
+    /// @return [int] number of calibrated motors.
+    int getNumberOfCurves() const {
+        return numberOfCurves;
+    }
+
+    /// @brief Turns the curves on or off, e.g. off while a sweep measures the motors' own response.
+    void setEnabled(bool enabled) {
+        this->enabled = enabled;
+    }
+
+    /// @return [bool] true if the curves are applied.
+    bool isEnabled() const {
+        return enabled;
+    }
+
+    /// @brief Reads the curves from EEPROM.
+    /// @return [bool] false if none are stored, or they fail their CRC: the motors are then left uncalibrated.
+    bool load() {
+        numberOfCurves = 0;
+        int count = hal::eepromRead(EEPROM_ADDRESS);
+        if (count > MAX_NUMBER_OF_MOTORS) return false;
+        for (int i = 0; i < count; i++) {
+            for (int k = 0; k < SpeedCurve::NUMBER_OF_KNOTS; k++) {
+                curves[i].knots[k] = hal::eepromRead(EEPROM_ADDRESS + 2 + i * SpeedCurve::NUMBER_OF_KNOTS + k);
+            }
+        }
+        if (checksum(count) != hal::eepromRead(EEPROM_ADDRESS + 1)) {
+            for (int i = 0; i < count; i++) curves[i] = SpeedCurve();
+            return false;
+        }
+        numberOfCurves = count;
+        return count > 0;
+    }
+
+    /// @brief Starts saving the curves in use to EEPROM, a byte per [saveStep]: an EEPROM write takes about
+    /// 3.3 ms, too long to write them all in one loop pass. The stored curves are invalid until it completes.
+    void beginSave() {
+        hal::eepromWrite(EEPROM_ADDRESS, 0xFF);
+        saveOffset = 0;
+    }
+
+    /// @brief Writes the next byte of a save begun by [beginSave], if the EEPROM has completed its last write.
+    /// Non-blocking.
+    /// @return [bool] true once the save is complete (and while none is in progress).
+    bool saveStep() {
+        if (saveOffset < 0) return true;
+        if (!hal::eepromReady()) return false;
+        return writeNext();
+    }
+
+    /// @brief Writes the whole save at once, blocking for every EEPROM write. For setup and tests.
+    void save() {
+        beginSave();
+        while (!writeNext()) {}
+    }
+};
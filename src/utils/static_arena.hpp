@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <new.h>
+#else
+#include <new>
+#endif
+
+/// <summary>
+/// @file static_arena.hpp
+/// @brief This file contains the [StaticArena] class, fixed storage the robot's objects are built in.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details The Mega has 8 KB of RAM and no use for a heap: every object of the robot lives for the whole run,
+/// and heap allocations that are never freed (or freed out of order) fragment it. A [StaticArena] is a byte
+/// array whose size is fixed at compile time, with [arenaFootprint] adding up the space of the objects it
+/// will hold. [create] builds objects in it one after another with placement new, and [reset] destroys them
+/// all (last first), so building the same objects again reuses the same bytes.
+
+/// Alignment of every object in a [StaticArena]: 1 byte on AVR, the largest scalar alignment on a host.
+static const size_t ARENA_ALIGNMENT = alignof(long double) > alignof(void *) ? alignof(long double) : alignof(void *);
+
+/// @return [size_t] bytes a [StaticArena] gives an object of [size] bytes, padded to [ARENA_ALIGNMENT].
+constexpr size_t arenaSlot(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+}
+
+/// @return [size_t] bytes a [StaticArena] needs for an object of type [T], or 0 if it is not built.
+template <typename T>
+constexpr size_t arenaFootprint(bool built = true) {
+    return built ? arenaSlot(sizeof(T)) : 0;
+}
+
+/// @class StaticArena
+/// @brief Fixed storage of [SIZE] bytes that up to [MAX_NUMBER_OF_OBJECTS] objects are built in.
+///
+/// @details Objects are created with [create], which never touches the heap, and live until [reset] or the
+/// arena's own destruction. An object that does not fit is not built, and [create] returns NULL.
+template <size_t SIZE, int MAX_NUMBER_OF_OBJECTS = 16>
+class StaticArena {
+private:
+    /// Destroys an object of type [T] built in the arena.
+    template <typename T>
+    static void destroy(void *object) {
+        static_cast<T *>(object)->~T();
+    }
+
+    struct Object {
+        void (*destroy)(void *object);
+        void *object;
+    };
+
+    alignas(ARENA_ALIGNMENT) uint8_t storage[SIZE > 0 ? SIZE : 1];
+
+    size_t used;
+
+    Object objects[MAX_NUMBER_OF_OBJECTS];
+
+    int numberOfObjects;
+
+public:
+    /// @brief Constuctor initializing an empty [StaticArena].
+    /// @return [StaticArena] object
+    StaticArena() : used(0), numberOfObjects(0) {}
+
+    ~StaticArena() {
+        reset();
+    }
+
+    /// @brief Builds an object of type [T] in the arena, passing [arguments] to its constructor.
+    /// @return [T*] the object, or NULL if it does not fit.
+    template <typename T, typename... Arguments>
+    T *create(Arguments &&... arguments) {
+        if (used + arenaSlot(sizeof(T)) > SIZE || numberOfObjects == MAX_NUMBER_OF_OBJECTS) return NULL;
+        T *object = new (storage + used) T(static_cast<Arguments &&>(arguments)...);
+        used += arenaSlot(sizeof(T));
+        objects[numberOfObjects].destroy = &StaticArena::destroy<T>;
+        objects[numberOfObjects].object = object;
+        numberOfObjects++;
+        return object;
+    }
+
+    /// @brief Destroys every object in the arena, the last one built first, and frees its space.
+    void reset() {
+        while (numberOfObjects > 0) {
+            numberOfObjects--;
+            objects[numberOfObjects].destroy(objects[numberOfObjects].object);
+        }
+        used = 0;
+    }
+
+    /// @return [size_t] bytes taken by the objects built so far.
+    size_t getUsed() const {
+        return used;
+    }
+
+    /// @return [size_t] size of the arena in bytes.
+    static constexpr size_t getCapacity() {
+        return SIZE;
+    }
+};
@@ -0,0 +1,161 @@
+#pragma once
+#include "../interfaces/hal/hal.hpp"
+
+/// <summary>
+/// @file task_scheduler.hpp
+/// @brief This file contains the [Timer] and [TaskScheduler] classes.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+
+/// @class Timer
+/// @brief One-shot millis() based timer used by the controllers' state machines instead of delay().
+///
+/// @details A [Timer] is started with a duration and then polled. It never blocks, so the caller keeps
+/// reading sensors and draining Bluetooth input while a manoeuvre is timed.
+class Timer {
+private:
+    unsigned long startTime;
+
+    unsigned long duration;
+
+    bool running;
+
+public:
+    /// @brief Constuctor initializing a stopped [Timer].
+    /// @return [Timer] object
+    Timer() {
+        startTime = 0;
+        duration = 0;
+        running = false;
+    }
+
+    /// @brief Starts (or restarts) the timer.
+    /// @param durationMs Time in milliseconds after which the timer expires.
+    void start(unsigned long durationMs) {
+        startTime = hal::millis();
+        duration = durationMs;
+        running = true;
+    }
+
+    /// @brief Stops the timer. A stopped timer never expires.
+    void stop() {
+        running = false;
+    }
+
+    /// @return [bool] true if the timer has been started and not stopped since.
+    bool isRunning() const {
+        return running;
+    }
+
+    /// @return [bool] true if the timer is running and its duration has elapsed. Safe across millis() rollover.
+    bool hasExpired() const {
+        return running && (hal::millis() - startTime >= duration);
+    }
+};
+
+/// @class TaskScheduler
+/// @brief Cooperative, non-blocking scheduler ticked from loop().
+///
+/// @details Holds up to [MAX_NUMBER_OF_TASKS] tasks in a fixed table (no heap). Each task is a plain function
+/// pointer with a context pointer, run either every [interval] milliseconds or once after a delay.
+/// Tasks must return quickly; anything that takes long should be a state machine driven by a [Timer].
+class TaskScheduler {
+public:
+    static const int MAX_NUMBER_OF_TASKS = 8;
+
+    /// Signature of a scheduled task. [context] is the pointer given when the task was scheduled.
+    typedef void (*TaskCallback)(void *context);
+
+private:
+    struct Task {
+        TaskCallback callback;
+        void *context;
+        unsigned long interval;
+        unsigned long lastRun;
+        bool repeating;
+    };
+
+    Task tasks[MAX_NUMBER_OF_TASKS];
+
+    /// Puts a task in the first free slot of the table.
+    /// @return [int] id of the task, or -1 if the table is full.
+    int addTask(unsigned long interval, TaskCallback callback, void *context, bool repeating) {
+        for (int i = 0; i < MAX_NUMBER_OF_TASKS; i++) {
+            if (tasks[i].callback == NULL) {
+                tasks[i].callback = callback;
+                tasks[i].context = context;
+                tasks[i].interval = interval;
+                tasks[i].lastRun = hal::millis();
+                tasks[i].repeating = repeating;
+                return i;
+            }
+        }
+        return -1;
+    }
+
+public:
+    /// @brief Constuctor initializing an empty [TaskScheduler].
+    /// @return [TaskScheduler] object
+    TaskScheduler() {
+        clear();
+    }
+
+    /// @brief Schedules a task to run periodically.
+    /// @param intervalMs Period in milliseconds. 0 runs the task on every tick.
+    /// @param callback Task function.
+    /// @param context Pointer passed to the task function. Default NULL.
+    /// @return [int] id of the task, or -1 if [MAX_NUMBER_OF_TASKS] are already scheduled.
+    int every(unsigned long intervalMs, TaskCallback callback, void *context = NULL) {
+        return addTask(intervalMs, callback, context, true);
+    }
+
+    /// @brief Schedules a task to run once.
+    /// @param delayMs Time in milliseconds after which the task runs.
+    /// @param callback Task function.
+    /// @param context Pointer passed to the task function. Default NULL.
+    /// @return [int] id of the task, or -1 if [MAX_NUMBER_OF_TASKS] are already scheduled.
+    int after(unsigned long delayMs, TaskCallback callback, void *context = NULL) {
+        return addTask(delayMs, callback, context, false);
+    }
+
+    /// @brief Removes a scheduled task. Ids that are out of range or already free are ignored.
+    /// @param taskId Id returned by [every] or [after].
+    void cancel(int taskId) {
+        if (taskId >= 0 && taskId < MAX_NUMBER_OF_TASKS) tasks[taskId].callback = NULL;
+    }
+
+    /// @brief Removes all scheduled tasks.
+    void clear() {
+        for (int i = 0; i < MAX_NUMBER_OF_TASKS; i++) tasks[i].callback = NULL;
+    }
+
+    /// @return [bool] true if the task with [taskId] is still waiting to run (or repeating).
+    bool isScheduled(int taskId) const {
+        return taskId >= 0 && taskId < MAX_NUMBER_OF_TASKS && tasks[taskId].callback != NULL;
+    }
+
+    /// @brief Runs every task that is due. Called once per loop().
+    ///
+    /// Periodic tasks keep their phase (next run is based on the previous due time, not on when they
+    /// actually ran), unless they fell a whole period behind, in which case they are re-synchronised
+    /// instead of being run back-to-back to catch up.
+    void tick() {
+        for (int i = 0; i < MAX_NUMBER_OF_TASKS; i++) {
+            if (tasks[i].callback == NULL) continue;
+            unsigned long now = hal::millis();
+            if (now - tasks[i].lastRun < tasks[i].interval) continue;
+
+            TaskCallback callback = tasks[i].callback;
+            void *context = tasks[i].context;
+            if (tasks[i].repeating) {
+                tasks[i].lastRun += tasks[i].interval;
+                if (now - tasks[i].lastRun >= tasks[i].interval) tasks[i].lastRun = now;
+            } else {
+                // One-shot: free the slot before running so the task may re-schedule itself.
+                tasks[i].callback = NULL;
+            }
+            callback(context);
+        }
+    }
+};
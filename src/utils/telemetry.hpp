@@ -0,0 +1,287 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../interfaces/bluetooth_interface.hpp"
+#include "crc8.hpp"
+#include "ring_buffer.hpp"
+#include "task_scheduler.hpp"
+
+/// <summary>
+/// @file telemetry.hpp
+/// @brief This file contains the binary telemetry stream sent over Bluetooth: the [TelemetryRecord] frame,
+/// the [Telemetry] sender and the [TelemetryDecoder] the host tools read it back with.
+/// @author Dhiman Seal
+/// @version 1.0
+/// @date 2026-10-16
+///
+/// @details Every record is one fixed-size frame, integers low byte first:
+///
+///     SYNC (0x55) | SEQUENCE | TIME (uint32, ms) | LEFT (int16) | RIGHT (int16) | SENSORS | LOOP (uint16, us) |
+///     DROPPED | CRC8
+///
+/// LEFT and RIGHT are the wheel speeds last written, SENSORS the bitmask of the IR sensors seeing white, LOOP
+/// the longest time between two controller steps since the previous record and DROPPED the records dropped
+/// just before this one because the buffer was full (both saturate). SEQUENCE counts the records queued, so
+/// the host can tell records lost on the link from records dropped on the robot. The CRC-8 covers everything
+/// from SEQUENCE to DROPPED. Text sent on the same link (e.g. the latency report) is skipped by the decoder.
+///
+/// Host side: src/tools/telemetry_to_csv.cpp turns a capture of the stream into CSV.
+
+/// One telemetry sample.
+struct TelemetryRecord {
+    /// Size of the frame of a record in bytes.
+    static const uint8_t FRAME_SIZE = 15;
+
+    static const uint8_t SYNC_BYTE = 0x55;
+
+    uint8_t sequence;
+    uint32_t timeMs;
+    int16_t leftSpeed;
+    int16_t rightSpeed;
+    uint8_t sensors;
+    uint16_t loopUs;
+    uint8_t dropped;
+
+    /// @brief Writes the frame of the record into [frame].
+    void encode(uint8_t frame[FRAME_SIZE]) const {
+        frame[0] = SYNC_BYTE;
+        frame[1] = sequence;
+        for (int i = 0; i < 4; i++) frame[2 + i] = (uint8_t) (timeMs >> (8 * i));
+        frame[6] = (uint8_t) leftSpeed;
+        frame[7] = (uint8_t) ((uint16_t) leftSpeed >> 8);
+        frame[8] = (uint8_t) rightSpeed;
+        frame[9] = (uint8_t) ((uint16_t) rightSpeed >> 8);
+        frame[10] = sensors;
+        frame[11] = (uint8_t) loopUs;
+        frame[12] = (uint8_t) (loopUs >> 8);
+        frame[13] = dropped;
+        frame[14] = crc8(frame + 1, FRAME_SIZE - 2);
+    }
+
+    /// @brief Reads the record from [frame].
+    /// @return [bool] false (and the record untouched) if [frame] has no sync byte or fails its CRC.
+    bool decode(const uint8_t frame[FRAME_SIZE]) {
+        if (frame[0] != SYNC_BYTE || crc8(frame + 1, FRAME_SIZE - 2) != frame[14]) return false;
+        sequence = frame[1];
+        timeMs = 0;
+        for (int i = 0; i < 4; i++) timeMs |= (uint32_t) frame[2 + i] << (8 * i);
+        leftSpeed = (int16_t) (frame[6] | (frame[7] << 8));
+        rightSpeed = (int16_t) (frame[8] | (frame[9] << 8));
+        sensors = frame[10];
+        loopUs = (uint16_t) (frame[11] | (frame[12] << 8));
+        dropped = frame[13];
+        return true;
+    }
+};
+
+/// @class Telemetry
+/// @brief Samples the robot into [TelemetryRecord] frames and streams them over Bluetooth without blocking.
+///
+/// @details [sample] is called on every controller step: it times the step, and every [samplePeriodMs]
+/// queues a frame in a [BUFFER_SIZE] byte ring buffer, or drops the record (counting it) if the frame does not
+/// fit. [flush] only hands the transport what it takes without waiting: the free space of a hardware UART's
+/// transmit buffer, or one byte per call on SoftwareSerial, which has none (a byte then holds the loop for its
+/// character time, about 1 ms at 9600 baud). A frame costs about 15 bytes of line time, so 20 records per
+/// second need 300 bytes/s: a third of SoftwareSerial at 9600 baud, and 3% of a UART at 115200.
+class Telemetry {
+public:
+    /// Bytes of queued frames: 8 records.
+    static const uint8_t BUFFER_SIZE = 128;
+
+    static const unsigned long DEFAULT_SAMPLE_PERIOD_MS = 50;
+
+private:
+    BluetoothInterface *bluetooth;
+
+    RingBuffer<uint8_t, BUFFER_SIZE> buffer;
+
+    unsigned long samplePeriodMs;
+
+    Timer sampleTimer;
+
+    uint8_t sequence;
+
+    /// Records dropped since the last one queued, sent with the next one.
+    uint8_t droppedSinceQueued;
+
+    /// Time of the last [sample] call, and the longest time between two calls since the last record.
+    unsigned long lastStepUs;
+
+    uint16_t longestStepUs;
+
+    bool stepping;
+
+    unsigned long recorded, dropped, sent;
+
+public:
+    /// @brief Constuctor initializing the [Telemetry] Class.
+    /// @param bluetooth [BluetoothInterface] the frames are sent over. Not owned.
+    /// @param samplePeriodMs Milliseconds between two records. 0 records on every [sample]. Default:
+    /// [DEFAULT_SAMPLE_PERIOD_MS]
+    /// @return [Telemetry] object
+    Telemetry(BluetoothInterface *bluetooth, unsigned long samplePeriodMs = DEFAULT_SAMPLE_PERIOD_MS) {
+        this->bluetooth = bluetooth;
+        this->samplePeriodMs = samplePeriodMs;
+        sequence = 0;
+        droppedSinceQueued = 0;
+        lastStepUs = 0;
+        longestStepUs = 0;
+        stepping = false;
+        resetCounters();
+    }
+
+    /// @brief Sets the milliseconds between two records. 0 records on every [sample].
+    void setSamplePeriod(unsigned long samplePeriodMs) {
+        this->samplePeriodMs = samplePeriodMs;
+        sampleTimer.stop();
+    }
+
+    unsigned long getSamplePeriod() const {
+        return samplePeriodMs;
+    }
+
+    /// @brief Times the controller step and queues a record if one is due. Non-blocking; call on every step.
+    /// @param leftSpeed Signed speed of the left wheels.
+    /// @param rightSpeed Signed speed of the right wheels.
+    /// @param sensors Bitmask of the IR sensors seeing white.
+    /// @return [bool] true if a record was due, whether it was queued or dropped.
+    bool sample(int leftSpeed, int rightSpeed, uint8_t sensors) {
+        unsigned long now = hal::micros();
+        if (stepping) {
+            unsigned long step = now - lastStepUs;
+            if (step > longestStepUs) longestStepUs = step > 0xFFFF ? 0xFFFF : (uint16_t) step;
+        }
+        lastStepUs = now;
+        stepping = true;
+
+        if (sampleTimer.isRunning() && !sampleTimer.hasExpired()) return false;
+        sampleTimer.start(samplePeriodMs);
+        recorded++;
+        if (buffer.available() < TelemetryRecord::FRAME_SIZE) {
+            dropped++;
+            if (droppedSinceQueued < 0xFF) droppedSinceQueued++;
+            return true;
+        }
+        TelemetryRecord record = {sequence++, (uint32_t) hal::millis(), (int16_t) leftSpeed, (int16_t) rightSpeed, sensors,
+            longestStepUs, droppedSinceQueued};
+        uint8_t frame[TelemetryRecord::FRAME_SIZE];
+        record.encode(frame);
+        for (int i = 0; i < TelemetryRecord::FRAME_SIZE; i++) buffer.push(frame[i]);
+        droppedSinceQueued = 0;
+        longestStepUs = 0;
+        return true;
+    }
+
+    /// @brief Sends the queued bytes the transport takes without waiting. Non-blocking; call on every step.
+    /// @return [size_t] number of bytes sent.
+    size_t flush() {
+        size_t count = 0;
+        int room = bluetooth->availableForSend();
+        uint8_t byte;
+        while (room-- > 0 && buffer.peek(byte) && bluetooth->sendAvailable(&byte, 1) == 1) {
+            buffer.pop(byte);
+            count++;
+        }
+        sent += count;
+        return count;
+    }
+
+    /// @return [unsigned long] records due since the counters were reset, queued or dropped.
+    unsigned long getRecorded() const {
+        return recorded;
+    }
+
+    /// @return [unsigned long] records dropped since the counters were reset, as the buffer was full.
+    unsigned long getDropped() const {
+        return dropped;
+    }
+
+    /// @return [unsigned long] bytes sent since the counters were reset.
+    unsigned long getSent() const {
+        return sent;
+    }
+
+    /// @return [uint8_t] bytes queued, not sent yet.
+    uint8_t getQueued() const {
+        return buffer.size();
+    }
+
+    /// @brief Zeroes the counters of records and bytes.
+    void resetCounters() {
+        recorded = 0;
+        dropped = 0;
+        sent = 0;
+    }
+};
+
+/// @class TelemetryDecoder
+/// @brief Finds the [TelemetryRecord] frames in a received byte stream, fed one byte at a time.
+///
+/// @details Bytes before a sync byte are skipped. A frame failing its CRC is counted as corrupted and the
+/// search goes on from the byte after its sync byte, so text or noise on the link costs no good frames.
+/// Gaps in the sequence numbers are counted as records lost on the link.
+class TelemetryDecoder {
+private:
+    uint8_t frame[TelemetryRecord::FRAME_SIZE];
+
+    int length;
+
+    TelemetryRecord record;
+
+    bool receivedAny;
+
+    unsigned long decoded, corrupted, lost;
+
+public:
+    /// @brief Constuctor initializing the [TelemetryDecoder] Class.
+    /// @return [TelemetryDecoder] object
+    TelemetryDecoder() {
+        length = 0;
+        record = TelemetryRecord();
+        receivedAny = false;
+        decoded = corrupted = lost = 0;
+    }
+
+    /// @brief Feeds the next received byte.
+    /// @return [bool] true if it completed a record, then read by [getRecord].
+    bool feed(uint8_t byte) {
+        if (length == 0 && byte != TelemetryRecord::SYNC_BYTE) return false;
+        frame[length++] = byte;
+        if (length < TelemetryRecord::FRAME_SIZE) return false;
+        uint8_t expected = (uint8_t) (record.sequence + 1);
+        if (record.decode(frame)) {
+            if (receivedAny) lost += (uint8_t) (record.sequence - expected);
+            receivedAny = true;
+            decoded++;
+            length = 0;
+            return true;
+        }
+        // Resynchronise on the next sync byte within the rejected frame.
+        corrupted++;
+        int next = 1;
+        while (next < length && frame[next] != TelemetryRecord::SYNC_BYTE) next++;
+        for (int i = next; i < length; i++) frame[i - next] = frame[i];
+        length -= next;
+        return false;
+    }
+
+    /// @return [TelemetryRecord&] the record completed by the last [feed] that returned true.
+    const TelemetryRecord &getRecord() const {
+        return record;
+    }
+
+    unsigned long getDecoded() const {
+        return decoded;
+    }
+
+    /// @return [unsigned long] frames that failed their CRC.
+    unsigned long getCorrupted() const {
+        return corrupted;
+    }
+
+    /// @return [unsigned long] records missing from the sequence numbers, lost on the link.
+    unsigned long getLost() const {
+        return lost;
+    }
+};